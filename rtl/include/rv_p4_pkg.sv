@@ -134,6 +134,10 @@ parameter logic [11:0] TUE_REG_ACTION_P1    = 12'h098;
 parameter logic [11:0] TUE_REG_ACTION_P2    = 12'h09C;
 parameter logic [11:0] TUE_REG_STATUS       = 12'h0A0;
 parameter logic [11:0] TUE_REG_COMMIT       = 12'h0A4;
+parameter logic [11:0] TUE_REG_BATCH        = 12'h0A8; // 写 1 开批 / 写 0 提交；读 {count, depth, open}
+
+// 批量暂存 FIFO 深度是 tue / rv_p4_top 的参数（默认 0 = 不实现，见 tue.sv）
+parameter int TUE_APPLY_GAP    = 4;     // 批内相邻 apply 脉冲间隔（clk_ctrl cycles）
 
 endpackage
 
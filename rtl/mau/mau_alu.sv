@@ -1,6 +1,6 @@
 // mau_alu.sv
 // MAU 动作 ALU
-// 支持：字段赋值、加减、位操作、条件赋值、哈希写回
+// 支持：字段赋值、加减、位操作、条件赋值、哈希写回（含 ECMP 选桶）
 
 `include "rv_p4_pkg.sv"
 
@@ -48,6 +48,11 @@ module mau_alu
     localparam logic [3:0] OP_HASH_SET  = 4'hC;  // phv[dst] = hash_result
     localparam logic [3:0] OP_COND_SET  = 4'hD;  // if phv[cond] then set
 
+    // OP_HASH_SET 子操作码（action_id[7:0]）
+    // HASH_SUB_BUCKET：phv[dst] = base + (hash & mask)，2 字节网络字节序（ECMP 选桶）
+    //   imm_value = {base[15:0], mask[15:0]}
+    localparam logic [7:0] HASH_SUB_BUCKET = 8'h01;
+
     // action_params 位域解析
     // [111:80] dst_offset  (32b → 实际用低 10b，PHV 字节偏移)
     // [79:48]  src_offset  (32b → 实际用低 10b)
@@ -67,6 +72,9 @@ module mau_alu
     assign imm_val = action_params[47:16];
     assign fwidth  = action_params[15:8];
 
+    logic [15:0] hash_bucket;
+    assign hash_bucket = imm_val[31:16] + (hash_result[15:0] & imm_val[15:0]);
+
     // ── 组合 ALU 逻辑 ─────────────────────────
     logic [PHV_BITS-1:0] phv_modified;
     phv_meta_t           meta_modified;
@@ -125,11 +133,15 @@ module mau_alu
                 OP_SET_PRIO: meta_modified.qos_prio = imm_val[2:0];
 
                 OP_HASH_SET: begin
-                    case (fwidth)
-                        8'd2: phv_modified[dst_off*8 +: 16] = hash_result[15:0];
-                        8'd4: phv_modified[dst_off*8 +: 32] = hash_result;
-                        default: phv_modified[dst_off*8 +: 32] = hash_result;
-                    endcase
+                    if (action_id[7:0] == HASH_SUB_BUCKET)
+                        // PHV 字节 dst 为高字节（与 Parser 提取的报头字段同序）
+                        phv_modified[dst_off*8 +: 16] = {hash_bucket[7:0], hash_bucket[15:8]};
+                    else
+                        case (fwidth)
+                            8'd2: phv_modified[dst_off*8 +: 16] = hash_result[15:0];
+                            8'd4: phv_modified[dst_off*8 +: 32] = hash_result;
+                            default: phv_modified[dst_off*8 +: 32] = hash_result;
+                        endcase
                 end
 
                 OP_COND_SET: begin
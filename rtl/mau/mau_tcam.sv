@@ -5,6 +5,13 @@
 
 `include "rv_p4_pkg.sv"
 
+// Verilator 仿真默认走 DPI 查找模型（MAU_TCAM_DPI 分支）
+`ifdef VERILATOR
+`ifndef MAU_TCAM_RTL
+`define MAU_TCAM_DPI
+`endif
+`endif
+
 module mau_tcam
     import rv_p4_pkg::*;
 (
@@ -31,6 +38,50 @@ module mau_tcam
 
     localparam int DEPTH = MAU_TCAM_DEPTH; // 2048
 
+`ifdef MAU_TCAM_DPI
+    // ─────────────────────────────────────────
+    // 仿真专用：查找委托给 C++ 索引 TCAM（tb/cosim/mau_tcam_dpi.cpp）
+    // Verilator 下默认启用（+define+MAU_TCAM_RTL 回退到下方并行比较模型）。
+    // C 侧按掩码分组（tuple space），每组以 key & ~mask 做哈希，
+    // 查找只需每组一次哈希探测，取最低索引命中 — 与下方优先编码逐位等价。
+    // 时序不变：写口 posedge 生效；查找在 lookup_en 的 posedge 读表
+    // （同拍写入不可见，先查后写），输出寄存 1 cycle。
+    // ─────────────────────────────────────────
+    import "DPI-C" function int  mau_tcam_new   (input int depth, input int key_w);
+    import "DPI-C" function void mau_tcam_write (input int h, input int addr,
+                                                 input bit [MAU_TCAM_KEY_W-1:0] key,
+                                                 input bit [MAU_TCAM_KEY_W-1:0] mask,
+                                                 input int act_id, input int act_ptr,
+                                                 input bit valid);
+    import "DPI-C" function int  mau_tcam_lookup(input int h,
+                                                 input bit [MAU_TCAM_KEY_W-1:0] key,
+                                                 output int act_id, output int act_ptr);
+
+    int tcam_h;   // C 侧 TCAM 句柄
+    initial tcam_h = mau_tcam_new(DEPTH, MAU_TCAM_KEY_W);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        int idx, aid, aptr;
+        if (!rst_n) begin
+            hit        <= 1'b0;
+            hit_idx    <= '0;
+            action_id  <= '0;
+            action_ptr <= '0;
+        end else begin
+            if (lookup_en) begin
+                idx = mau_tcam_lookup(tcam_h, key, aid, aptr);   // -1 = miss
+                hit        <= (idx >= 0);
+                hit_idx    <= (idx >= 0) ? 11'(idx) : '0;
+                action_id  <= (idx >= 0) ? 16'(aid)  : '0;
+                action_ptr <= (idx >= 0) ? 16'(aptr) : '0;
+            end
+            if (wr_en)
+                mau_tcam_write(tcam_h, int'(wr_addr), wr_key, wr_mask,
+                               int'(wr_action_id), int'(wr_action_ptr), wr_valid);
+        end
+    end
+
+`else
     // TCAM 存储
     logic [MAU_TCAM_KEY_W-1:0] t_key  [DEPTH];
     logic [MAU_TCAM_KEY_W-1:0] t_mask [DEPTH];
@@ -88,4 +139,6 @@ module mau_tcam
         end
     end
 
+`endif
+
 endmodule
@@ -25,6 +25,105 @@ module pkt_buffer
     cell_alloc_if.allocator alloc
 );
 
+`ifdef PB_SPARSE_DPI
+    // ─────────────────────────────────────────
+    // 仿真专用稀疏存储（+define+PB_SPARSE_DPI，见 tb/cosim/pkt_buffer_dpi.cpp）
+    // cell_data / cell_next / cell_eof / free_list 存放在 C 侧按页懒分配的
+    // 页表中，只有写过的页才占内存；free_list 未写位置读出其下标，
+    // 等价于下方 initial 初始化，省去 1M 次循环与 ~70MB 内存。
+    // 端口时序与 SRAM 模型一致：同拍先读后写（读到旧值）。
+    // ─────────────────────────────────────────
+    import "DPI-C" function int  pb_sparse_new(input int num_cells);
+    import "DPI-C" function void pb_sparse_wr (input int h, input int id,
+                                               input bit [511:0] data,
+                                               input int next, input bit eof);
+    import "DPI-C" function void pb_sparse_rd (input int h, input int id,
+                                               output bit [511:0] data,
+                                               output int next, output bit eof);
+    import "DPI-C" function int  pb_fl_get    (input int h, input int pos);
+    import "DPI-C" function void pb_fl_set    (input int h, input int pos, input int id);
+
+    int pb_h;   // C 侧存储句柄
+    initial pb_h = pb_sparse_new(NUM_CELLS);
+
+    localparam int FL_DEPTH = NUM_CELLS;
+    localparam int FL_PTR_W = CELL_ID_W;
+
+    logic [FL_PTR_W-1:0]  fl_head;     // 出队指针（分配）
+    logic [FL_PTR_W-1:0]  fl_tail;     // 入队指针（释放）
+    logic [FL_PTR_W:0]    fl_count;    // 空闲 cell 数
+    logic [FL_PTR_W-1:0]  fl_head_nx;
+    logic [CELL_ID_W-1:0] fl_head_id;  // free_list[fl_head] 的寄存副本
+
+    // free_list 内容在 C 侧，组合读无法感知其变化，故在更新指针的同一拍
+    // 先写入释放的 ID，再读出新 head 位置的 ID
+    assign fl_head_nx = (alloc.alloc_req && alloc.alloc_valid) ? fl_head + 1'b1 : fl_head;
+
+    assign alloc.alloc_valid = (fl_count > 0);
+    assign alloc.alloc_empty = (fl_count == 0);
+    assign alloc.alloc_id    = fl_head_id;
+
+    always_ff @(posedge clk_dp or negedge rst_dp_n) begin
+        if (!rst_dp_n) begin
+            fl_head    <= '0;
+            fl_tail    <= '0;
+            fl_count   <= (FL_PTR_W+1)'(FL_DEPTH);
+            fl_head_id <= CELL_ID_W'(pb_fl_get(pb_h, 0));
+        end else begin
+            // 分配
+            if (alloc.alloc_req && alloc.alloc_valid)
+                fl_count <= fl_count - 1'b1;
+            // 释放
+            if (alloc.free_req) begin
+                pb_fl_set(pb_h, int'(fl_tail), int'(alloc.free_id));
+                fl_tail  <= fl_tail + 1'b1;
+                fl_count <= fl_count + 1'b1;
+            end
+            fl_head    <= fl_head_nx;
+            fl_head_id <= CELL_ID_W'(pb_fl_get(pb_h, int'(fl_head_nx)));
+        end
+    end
+
+    // Port 0：写入 / Port 1：TM 读取 / Port 2：Deparser 读取（1 cycle 延迟）
+    assign wr.ready        = 1'b1;
+    assign rd_tm.req_ready = 1'b1;
+    assign rd_dp.req_ready = 1'b1;
+
+    always_ff @(posedge clk_dp or negedge rst_dp_n) begin
+        bit [511:0] tm_data, dp_data;
+        int         tm_next, dp_next;
+        bit         tm_eof,  dp_eof;
+        if (!rst_dp_n) begin
+            rd_tm.rsp_valid        <= 1'b0;
+            rd_tm.rsp_data         <= '0;
+            rd_tm.rsp_next_cell_id <= '0;
+            rd_tm.rsp_eof          <= 1'b0;
+            rd_dp.rsp_valid        <= 1'b0;
+            rd_dp.rsp_data         <= '0;
+            rd_dp.rsp_next_cell_id <= '0;
+            rd_dp.rsp_eof          <= 1'b0;
+        end else begin
+            pb_sparse_rd(pb_h, int'(rd_tm.req_cell_id), tm_data, tm_next, tm_eof);
+            pb_sparse_rd(pb_h, int'(rd_dp.req_cell_id), dp_data, dp_next, dp_eof);
+            rd_tm.rsp_valid        <= rd_tm.req_valid;
+            rd_tm.rsp_data         <= tm_data;
+            rd_tm.rsp_next_cell_id <= CELL_ID_W'(tm_next);
+            rd_tm.rsp_eof          <= tm_eof;
+            rd_dp.rsp_valid        <= rd_dp.req_valid;
+            rd_dp.rsp_data         <= dp_data;
+            rd_dp.rsp_next_cell_id <= CELL_ID_W'(dp_next);
+            rd_dp.rsp_eof          <= dp_eof;
+
+            // next = cell_id + 1，帧末尾为 0xFFFFF（同 SRAM 模型）
+            if (wr.valid && wr.ready)
+                pb_sparse_wr(pb_h, int'(wr.cell_id), wr.data,
+                             wr.eof ? int'({CELL_ID_W{1'b1}})
+                                    : int'(wr.cell_id + CELL_ID_W'(1)),
+                             wr.eof);
+        end
+    end
+
+`else
     // ─────────────────────────────────────────
     // Cell 数据 SRAM（综合时映射到片上 SRAM）
     // 实际 64MiB 需要外部 SRAM 宏，此处用 logic 数组建模
@@ -141,4 +240,6 @@ module pkt_buffer
         end
     end
 
+`endif
+
 endmodule
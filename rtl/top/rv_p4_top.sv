@@ -7,6 +7,9 @@
 
 module rv_p4_top
     import rv_p4_pkg::*;
+#(
+    parameter int TUE_BATCH_DEPTH = 0       // TUE 批量暂存 FIFO，0 = 不实现（见 tue.sv）
+)
 (
     // Clocks
     input  logic clk_dp,      // 1.6 GHz  P4 datapath
@@ -47,6 +50,10 @@ module rv_p4_top
     input  logic [7:0]                    tb_parser_wr_addr,
     input  logic [PARSER_TCAM_WIDTH-1:0]  tb_parser_wr_data,
 
+    // Test observation: PHV handed from the parser to MAU[0] (cosim --lockstep parser)
+    output logic                          tb_parser_phv_valid,
+    output logic [PHV_BITS-1:0]           tb_parser_phv_data,
+
     // Test backdoor: TUE APB direct access (tie to 0 in production)
     input  logic [11:0] tb_tue_paddr,
     input  logic [31:0] tb_tue_pwdata,
@@ -184,6 +191,9 @@ p4_parser u_parser (
     .csr          (apb_bus[0].slave)
 );
 
+assign tb_parser_phv_valid = phv_bus[0].valid & phv_bus[0].ready;
+assign tb_parser_phv_data  = phv_bus[0].data;
+
 // ─────────────────────────────────────────────
 // MAU pipeline (24 stages)
 // ─────────────────────────────────────────────
@@ -253,7 +263,7 @@ pkt_buffer u_pkt_buf (
 // ─────────────────────────────────────────────
 // Table Update Engine
 // ─────────────────────────────────────────────
-tue u_tue (
+tue #(.BATCH_DEPTH(TUE_BATCH_DEPTH)) u_tue (
     .clk_ctrl       (clk_ctrl),
     .rst_ctrl_n     (rst_ctrl_n),
     .clk_dp         (clk_dp),
@@ -2,12 +2,31 @@
 // Table Update Engine — 原子更新 TCAM/SRAM
 // shadow write + pointer swap，保证数据面不中断
 // APB 从端接收控制面写请求，跨时钟域同步到 clk_dp
+//
+// 批量模式（TUE_REG_BATCH，参数 BATCH_DEPTH > 0 时实现）：写 1 开批后，每次
+// COMMIT 只把当前寄存器组压入暂存 FIFO（BATCH_DEPTH 条，不排空、STATUS 保持
+// idle，溢出置 err）；写 0 提交：只排空一次（32 cycles），随后按入队顺序逐条
+// apply，相邻两条间隔 TUE_APPLY_GAP 个 clk_ctrl，保证 dp 域在下一条锁存前已完成写入。
+// 批不是原子的：省掉的只是每条一次的排空，条目仍逐条写入 TCAM/ASRAM，数据面
+// 在两条之间会看到每个中间状态（与逐条 COMMIT 相同），没有整批一次的 pointer swap。
+// 面积：每条是完整 tue_req_t（key + mask 2 × 512b + action），64 条约 75 Kbit
+// 触发器，因此 BATCH_DEPTH 默认 0：开批请求被忽略（BATCH 读回 open=0、depth=0），
+// FIFO 与批量状态机在综合时被常量折叠掉。仿真 / 需要的 SoC 配置经
+// rv_p4_top #(.TUE_BATCH_DEPTH(n)) 打开（n ≤ 255，读回 [15:8]）。
+//
+// COMMIT / BATCH 写入在 APB 写入当拍记为挂起请求（任何状态都接收，不丢脉冲），
+// 回到 TS_IDLE 后按 关批 → 开批 → COMMIT 的顺序处理；挂起的单条 COMMIT / 关批
+// 在写入当拍起 STATUS 即读到 busy，软件等 busy 出现再消失即可确认已生效。
+// 挂起的 COMMIT 在被接收前仍读当前寄存器组，期间不要改写（HAL 等事务完成才写下一条）。
 
 `include "rv_p4_pkg.sv"
 `include "rv_p4_if.sv"
 
 module tue
     import rv_p4_pkg::*;
+#(
+    parameter int BATCH_DEPTH = 0           // 批量暂存 FIFO 条数，0 = 不实现
+)
 (
     input  logic clk_ctrl,
     input  logic rst_ctrl_n,
@@ -38,8 +57,25 @@ module tue
     logic [MAU_TCAM_KEY_W-1:0]     reg_mask;
     logic [15:0]                   reg_action_id;
     logic [95:0]                   reg_action_params; // 3 × 32b
-    logic                          reg_commit;     // 写 1 触发事务
     logic [1:0]                    reg_status;     // 0=idle,1=busy,2=done,3=err
+    logic [1:0]                    status_rd;      // STATUS 读值（含挂起请求）
+    logic                          apb_wr;
+    logic                          commit_pend;    // COMMIT 写 1，待 TS_IDLE 接收
+    logic                          open_pend;      // BATCH 写 1
+    logic                          close_pend;     // BATCH 写 0
+
+    assign apb_wr = csr.psel && csr.penable && csr.pwrite;
+
+    // 批量暂存 FIFO（clk_ctrl 域）；BATCH_DEPTH = 0 时 batch_open 恒 0，无读写
+    localparam bit BATCH_EN = (BATCH_DEPTH > 0);
+    localparam int BQ_N     = BATCH_EN ? BATCH_DEPTH : 1;
+    localparam int BQ_AW    = (BQ_N > 1) ? $clog2(BQ_N) : 1;
+    tue_req_t                      batch_q [BQ_N];
+    logic                          batch_open;
+    logic                          batch_run;      // 正在提交批（排空 + 逐条 apply）
+    logic [BQ_AW:0]                batch_cnt;
+    logic [BQ_AW:0]                batch_idx;
+    logic [2:0]                    gap_cnt;
 
     // APB 写
     always_ff @(posedge clk_ctrl or negedge rst_ctrl_n) begin
@@ -51,10 +87,9 @@ module tue
             reg_mask         <= '0;
             reg_action_id    <= '0;
             reg_action_params<= '0;
-            reg_commit       <= 1'b0;
         end else begin
-            reg_commit <= 1'b0; // 自清
-            if (csr.psel && csr.penable && csr.pwrite) begin
+            // COMMIT / BATCH 由事务状态机锁存为挂起请求
+            if (apb_wr) begin
                 case (csr.paddr)
                     TUE_REG_CMD:      reg_cmd       <= csr.pwdata[1:0];
                     TUE_REG_TABLE_ID: reg_table_id  <= csr.pwdata[15:0];
@@ -79,8 +114,6 @@ module tue
                             reg_action_params[63:32] <= csr.pwdata;
                         if (csr.paddr == TUE_REG_ACTION_P2)
                             reg_action_params[95:64] <= csr.pwdata;
-                        if (csr.paddr == TUE_REG_COMMIT)
-                            reg_commit <= csr.pwdata[0];
                     end
                 endcase
             end
@@ -92,26 +125,39 @@ module tue
         csr.prdata  = '0;
         csr.pslverr = 1'b0;
         case (csr.paddr)
-            TUE_REG_STATUS: csr.prdata = {30'b0, reg_status};
+            TUE_REG_STATUS: csr.prdata = {30'b0, status_rd};
             TUE_REG_STAGE:  csr.prdata = {27'b0, reg_stage};
+            TUE_REG_BATCH:  csr.prdata = {16'(batch_cnt), 8'(BATCH_DEPTH), 7'b0, batch_open};
             default:        csr.prdata = '0;
         endcase
     end
     assign csr.pready = 1'b1;
 
+    // 挂起的单条 COMMIT / 关批：FSM 下一拍才置 busy，这里当拍就报 busy
+    assign status_rd = (close_pend || (commit_pend && !batch_open && !open_pend))
+                       ? 2'b01 : reg_status;
+
     // ─────────────────────────────────────────
     // 事务状态机（clk_ctrl 域）
     // ─────────────────────────────────────────
-    typedef enum logic [1:0] {
+    typedef enum logic [2:0] {
         TS_IDLE,
         TS_WAIT_DRAIN,  // 等待 dp 流水线排空（计数 32 cycles）
         TS_APPLY,       // 写入 shadow，触发 pointer swap
-        TS_DONE
+        TS_DONE,
+        TS_BATCH        // 批量：逐条锁存 FIFO 条目并触发 apply
     } tue_state_t;
 
     tue_state_t  ts;
     logic [5:0]  drain_cnt;  // 等待 32 cycles
 
+`ifdef TUE_DRAIN_DPI
+    // 仿真专用（+define+TUE_DRAIN_DPI，tb/cosim 默认打开）：cosim 在 dp 流水线
+    // 已空闲时置位，WAIT_DRAIN 下一拍直接清零计数，不再逐拍数满 32 个 ctrl cycle。
+    // 综合路径与未置位时行为不变。
+    import "DPI-C" function bit tue_drain_skip();
+`endif
+
     // 跨时钟域：ctrl → dp 的写使能脉冲（2-FF 同步）
     logic apply_pulse_ctrl;
     logic apply_pulse_dp_ff1, apply_pulse_dp;
@@ -122,31 +168,100 @@ module tue
             drain_cnt      <= '0;
             reg_status     <= 2'b00;
             apply_pulse_ctrl <= 1'b0;
+            batch_open     <= 1'b0;
+            batch_run      <= 1'b0;
+            batch_cnt      <= '0;
+            batch_idx      <= '0;
+            gap_cnt        <= '0;
+            commit_pend    <= 1'b0;
+            open_pend      <= 1'b0;
+            close_pend     <= 1'b0;
         end else begin
             apply_pulse_ctrl <= 1'b0;
             case (ts)
                 TS_IDLE: begin
-                    if (reg_commit) begin
-                        reg_commit <= 1'b0;  // 自清
-                        ts         <= TS_WAIT_DRAIN;
-                        drain_cnt  <= 6'd32;
-                        reg_status <= 2'b01; // busy
+                    if (close_pend) begin
+                        // 提交：整批只排空一次
+                        close_pend <= 1'b0;
+                        batch_open <= 1'b0;
+                        if (batch_open && batch_cnt != 0) begin
+                            batch_run  <= 1'b1;
+                            batch_idx  <= '0;
+                            ts         <= TS_WAIT_DRAIN;
+                            drain_cnt  <= 6'd32;
+                            reg_status <= 2'b01; // busy
+                        end
+                    end else if (open_pend) begin
+                        // 开批：清空 FIFO 和上一批的 err（未实现批量时忽略）
+                        open_pend  <= 1'b0;
+                        batch_open <= BATCH_EN;
+                        batch_cnt  <= '0;
+                        reg_status <= 2'b00;
+                    end else if (commit_pend && batch_open) begin
+                        commit_pend <= 1'b0;
+                        if (batch_cnt == (BQ_AW+1)'(BATCH_DEPTH))
+                            reg_status <= 2'b11; // 溢出：err，直到下次开批
+                        else begin
+                            batch_q[batch_cnt[BQ_AW-1:0]] <= '{
+                                op:            tue_op_t'(reg_cmd),
+                                stage:         reg_stage,
+                                table_id:      reg_table_id,
+                                key:           reg_key,
+                                mask:          reg_mask,
+                                action_id:     reg_action_id,
+                                action_params: 112'(reg_action_params)
+                            };
+                            batch_cnt <= batch_cnt + 1'b1;
+                        end
+                    end else if (commit_pend) begin
+                        commit_pend <= 1'b0;
+                        ts          <= TS_WAIT_DRAIN;
+                        drain_cnt   <= 6'd32;
+                        reg_status  <= 2'b01; // busy
                     end
                 end
                 TS_WAIT_DRAIN: begin
-                    if (drain_cnt == 0) begin
+                    if (drain_cnt == 0 && batch_run) begin
+                        ts      <= TS_BATCH;
+                        gap_cnt <= '0;
+                    end else if (drain_cnt == 0) begin
                         ts               <= TS_APPLY;
                         apply_pulse_ctrl <= 1'b1;
                         // 提前锁存，确保 dp 域信号在 apply_pulse_dp 触发前已稳定
                         dp_stage         <= reg_stage;
+                        dp_table_id      <= reg_table_id;
                         dp_key           <= reg_key;
                         dp_mask          <= reg_mask;
                         dp_action_id     <= reg_action_id;
                         dp_action_params <= reg_action_params;
                         dp_cmd           <= reg_cmd;
+`ifdef TUE_DRAIN_DPI
+                    end else if (tue_drain_skip()) begin
+                        drain_cnt <= '0;
+`endif
                     end else
                         drain_cnt <= drain_cnt - 1'b1;
                 end
+                TS_BATCH: begin
+                    if (gap_cnt != 0)
+                        gap_cnt <= gap_cnt - 1'b1;
+                    else if (batch_idx == batch_cnt) begin
+                        batch_run  <= 1'b0;
+                        ts         <= TS_DONE;
+                        reg_status <= 2'b10; // done
+                    end else begin
+                        apply_pulse_ctrl <= 1'b1;
+                        dp_stage         <= batch_q[batch_idx[BQ_AW-1:0]].stage;
+                        dp_table_id      <= batch_q[batch_idx[BQ_AW-1:0]].table_id;
+                        dp_key           <= batch_q[batch_idx[BQ_AW-1:0]].key;
+                        dp_mask          <= batch_q[batch_idx[BQ_AW-1:0]].mask;
+                        dp_action_id     <= batch_q[batch_idx[BQ_AW-1:0]].action_id;
+                        dp_action_params <= batch_q[batch_idx[BQ_AW-1:0]].action_params[95:0];
+                        dp_cmd           <= batch_q[batch_idx[BQ_AW-1:0]].op;
+                        batch_idx        <= batch_idx + 1'b1;
+                        gap_cnt          <= 3'(TUE_APPLY_GAP - 1);
+                    end
+                end
                 TS_APPLY: begin
                     ts         <= TS_DONE;
                     reg_status <= 2'b10; // done
@@ -156,6 +271,14 @@ module tue
                     reg_status <= 2'b00;
                 end
             endcase
+
+            // APB 写 COMMIT / BATCH：写入当拍挂起（放在 case 之后，同拍的新请求不被上面的清除覆盖）
+            if (apb_wr && csr.paddr == TUE_REG_COMMIT && csr.pwdata[0])
+                commit_pend <= 1'b1;
+            if (apb_wr && csr.paddr == TUE_REG_BATCH) begin
+                if (csr.pwdata[0]) open_pend  <= 1'b1;
+                else               close_pend <= 1'b1;
+            end
         end
     end
 
@@ -170,6 +293,7 @@ module tue
     // ─────────────────────────────────────────
     // 寄存配置值（跨时钟域，在 apply_pulse_dp 时已稳定）
     logic [4:0]                  dp_stage;
+    logic [15:0]                 dp_table_id;    // 批量 apply 时 reg_table_id 已不对应当前条目
     logic [MAU_TCAM_KEY_W-1:0]   dp_key, dp_mask;
     logic [15:0]                 dp_action_id;
     logic [95:0]                 dp_action_params;
@@ -182,14 +306,14 @@ module tue
         for (genvar i = 0; i < NUM_MAU_STAGES; i++) begin : gen_mau_cfg
             assign mau_cfg[i].tcam_wr_en     = apply_pulse_dp && (dp_stage == 5'(i))
                                                && (dp_cmd != 2'b11);
-            assign mau_cfg[i].tcam_wr_addr   = 11'(reg_table_id[10:0]);
+            assign mau_cfg[i].tcam_wr_addr   = 11'(dp_table_id[10:0]);
             assign mau_cfg[i].tcam_wr_key    = dp_key;
             assign mau_cfg[i].tcam_wr_mask   = dp_mask;
             assign mau_cfg[i].tcam_action_id = dp_action_id;
-            assign mau_cfg[i].tcam_action_ptr= reg_table_id;
+            assign mau_cfg[i].tcam_action_ptr= dp_table_id;
             assign mau_cfg[i].tcam_wr_valid  = (dp_cmd == 2'b00);
             assign mau_cfg[i].asram_wr_en    = apply_pulse_dp && (dp_stage == 5'(i));
-            assign mau_cfg[i].asram_wr_addr  = reg_table_id;
+            assign mau_cfg[i].asram_wr_addr  = dp_table_id;
             assign mau_cfg[i].asram_wr_data  = {dp_action_id, 16'b0, dp_action_params};
         end
     endgenerate
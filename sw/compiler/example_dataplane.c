@@ -127,6 +127,8 @@ void action_ttl_dec(phv_t *phv) {
 __attribute__((rvp4_table))
 __attribute__((rvp4_lpm))
 __attribute__((rvp4_stage(0)))
+__attribute__((rvp4_key(ipv4_dst)))
+__attribute__((rvp4_actions(action_forward, action_drop)))
 __attribute__((rvp4_size(65536)))
 void table_ipv4_lpm(phv_t *phv, metadata_t *meta) {
     /* key: ipv4_dst */
@@ -142,6 +144,8 @@ void table_ipv4_lpm(phv_t *phv, metadata_t *meta) {
 __attribute__((rvp4_table))
 __attribute__((rvp4_ternary))
 __attribute__((rvp4_stage(1)))
+__attribute__((rvp4_key(ipv4_src, ipv4_dst, tcp_dport)))
+__attribute__((rvp4_actions(action_permit, action_deny)))
 __attribute__((rvp4_size(4096)))
 void table_acl_ingress(phv_t *phv, metadata_t *meta) {
     /* key: ipv4_src, ipv4_dst, tcp_dport */
@@ -157,6 +161,8 @@ void table_acl_ingress(phv_t *phv, metadata_t *meta) {
 __attribute__((rvp4_table))
 __attribute__((rvp4_exact))
 __attribute__((rvp4_stage(2)))
+__attribute__((rvp4_key(eth_dst)))
+__attribute__((rvp4_actions(action_l2_forward, action_flood)))
 __attribute__((rvp4_size(32768)))
 void table_l2_fdb(phv_t *phv, metadata_t *meta) {
     /* key: eth_dst */
@@ -172,8 +178,10 @@ void table_l2_fdb(phv_t *phv, metadata_t *meta) {
 __attribute__((rvp4_table))
 __attribute__((rvp4_exact))
 __attribute__((rvp4_stage(3)))
+__attribute__((rvp4_key(ipv4_dscp)))
+__attribute__((rvp4_actions(set_prio)))
 __attribute__((rvp4_size(64)))
 void table_qos_mark(phv_t *phv, metadata_t *meta) {
     /* key: ipv4_dscp */
-    /* actions: action_set_prio */
+    /* actions: set_prio（内置） */
 }
@@ -0,0 +1,97 @@
+/*
+ * firmware_dataplane.c
+ * RV-P4 固件数据面描述 — 与 sw/firmware/table_map.h 的 8 张表一一对应
+ *
+ * 控制面固件（route / acl / fdb / arp / vlan / qos）按这里的键布局写 TCAM；
+ * 编译产物 fw_pipeline/*.json 由功能模型 pkt_prog_load_dir() 加载，
+ * 与模型内置程序等价（test_dp_cosim CS-10 校验）。
+ *
+ * 编译：make fw-pipeline
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ─────────────────────────────────────────────
+ * 动作：全部使用编译器内置动作（action_id 与 table_map.h ACTION_* 一致）
+ *   forward / drop / ecmp_group / permit / deny / l2_forward / flood / punt_cpu
+ *   vlan_assign_pvid / vlan_accept_tagged / vlan_drop
+ *   vlan_strip_tag / vlan_keep_tag / set_prio
+ * ───────────────────────────────────────────── */
+
+/* ─────────────────────────────────────────────
+ * 入口表（Stage 0-15）
+ * ───────────────────────────────────────────── */
+
+/* Stage 0 — IPv4 LPM（route.c）：ipv4_dst；ECMP 路由按五元组 hash 选成员 */
+__attribute__((rvp4_table))
+__attribute__((rvp4_lpm))
+__attribute__((rvp4_stage(0)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(ipv4_dst)))
+__attribute__((rvp4_hash(ipv4_src, ipv4_dst, ipv4_proto, tcp_sport, tcp_dport)))
+__attribute__((rvp4_actions(forward, drop, ecmp_group)))
+void table_ipv4_lpm(void) { }
+
+/* Stage 1 — ACL 入方向（acl.c）：ipv4_src + ipv4_dst + dport */
+__attribute__((rvp4_table))
+__attribute__((rvp4_ternary))
+__attribute__((rvp4_stage(1)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(ipv4_src, ipv4_dst, tcp_dport)))
+__attribute__((rvp4_actions(permit, deny)))
+void table_acl_ingress(void) { }
+
+/* Stage 2 — L2 FDB（fdb.c）：eth_dst */
+__attribute__((rvp4_table))
+__attribute__((rvp4_exact))
+__attribute__((rvp4_stage(2)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(eth_dst)))
+__attribute__((rvp4_actions(l2_forward, flood)))
+void table_l2_fdb(void) { }
+
+/* Stage 3 — ARP Punt（arp.c）：eth_type */
+__attribute__((rvp4_table))
+__attribute__((rvp4_exact))
+__attribute__((rvp4_stage(3)))
+__attribute__((rvp4_size(16)))
+__attribute__((rvp4_key(eth_type)))
+__attribute__((rvp4_actions(punt_cpu)))
+void table_arp_trap(void) { }
+
+/* Stage 4 — VLAN 入口分类（vlan.c）：ig_port + vlan_tci */
+__attribute__((rvp4_table))
+__attribute__((rvp4_ternary))
+__attribute__((rvp4_stage(4)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(meta_ig_port, vlan_tci)))
+__attribute__((rvp4_actions(vlan_assign_pvid, vlan_accept_tagged, vlan_drop)))
+void table_vlan_ingress(void) { }
+
+/* Stage 5 — DSCP → 优先级（qos.c）：TOS 字节 */
+__attribute__((rvp4_table))
+__attribute__((rvp4_ternary))
+__attribute__((rvp4_stage(5)))
+__attribute__((rvp4_size(64)))
+__attribute__((rvp4_key(ipv4_dscp)))
+__attribute__((rvp4_actions(set_prio)))
+void table_dscp_map(void) { }
+
+/* Stage 6 — ECMP 成员（route.c）：ecmp_idx */
+__attribute__((rvp4_table))
+__attribute__((rvp4_exact))
+__attribute__((rvp4_stage(6)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(meta_ecmp_idx)))
+__attribute__((rvp4_actions(forward)))
+void table_ecmp_member(void) { }
+
+/* Stage 7 — VLAN 出口标签处理（vlan.c）：eg_port + vlan_id 低字节（在 ECMP 成员表之后） */
+__attribute__((rvp4_table))
+__attribute__((rvp4_exact))
+__attribute__((rvp4_stage(7)))
+__attribute__((rvp4_size(2048)))
+__attribute__((rvp4_key(meta_eg_port, meta_vlan_id_lo)))
+__attribute__((rvp4_actions(vlan_strip_tag, vlan_keep_tag)))
+void table_vlan_egress(void) { }
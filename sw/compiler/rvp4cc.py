@@ -32,6 +32,7 @@ from typing import Dict, List, Optional, Tuple
 # 硬件常量（与 rv_p4_pkg.sv 一致）
 # ─────────────────────────────────────────────
 NUM_MAU_STAGES      = 24
+NUM_INGRESS_STAGES  = 16    # 16 ingress + 8 egress
 PARSER_TCAM_DEPTH   = 256
 PARSER_TCAM_WIDTH   = 640   # bits = 80 bytes
 MAU_TCAM_DEPTH      = 2048
@@ -74,8 +75,22 @@ PHV_FIELDS = {
     "tcp_dport":    (40, 2),
     "udp_sport":    (38, 2),
     "udp_dport":    (40, 2),
+    # 元数据区（偏移 >= 256）
+    "meta_ig_port":     (256, 1),
+    "meta_eg_port":     (257, 1),
+    "meta_drop":        (258, 1),
+    "meta_vlan_id":     (261, 2),
+    "meta_vlan_id_lo":  (262, 1),   # vlan_id 低字节（VLAN 出口表键）
+    "meta_qos_prio":    (263, 1),
+    "meta_punt":        (264, 1),   # 以下两项仅功能模型使用（pkt_prog.h）
+    "meta_vlan_action": (265, 1),
+    "meta_ecmp_idx":    (266, 2),   # ECMP 成员索引（Stage 0 ecmp_group 写，Stage 6 匹配）
 }
 
+# VLAN 出口动作（与 pkt_model.h VLAN_ACT_* 一致）
+VLAN_ACT_STRIP = 1
+VLAN_ACT_KEEP  = 2
+
 # ─────────────────────────────────────────────
 # 数据结构
 # ─────────────────────────────────────────────
@@ -92,6 +107,7 @@ class ActionPrimitive:
     src_off: int = 0
     imm_val: int = 0
     fwidth:  int = 4
+    param:   int = -1   # >= 0：取值来自表项 action_params[param..]，否则用 imm_val
 
 @dataclass
 class ActionDef:
@@ -109,6 +125,7 @@ class TableDef:
     size:       int
     key_fields: List[str] = field(default_factory=list)
     actions:    List[str] = field(default_factory=list)
+    hash_fields: List[str] = field(default_factory=list)  # 空：以匹配键为 hash 输入
 
 @dataclass
 class ParserState:
@@ -200,16 +217,32 @@ def make_action_id(op: int, field_group: int = 0, sub_op: int = 0) -> int:
 # 内置动作库
 # ─────────────────────────────────────────────
 
+# action_id 与固件 table_map.h ACTION_* 一致；用户动作从 USER_ACTION_BASE 起分配
+USER_ACTION_BASE = 0x8000
+
+_VLAN_ID = PHV_FIELDS["meta_vlan_id"][0]
+_ECMP_IDX = PHV_FIELDS["meta_ecmp_idx"][0]
+
 BUILTIN_ACTIONS: Dict[str, ActionDef] = {
     "forward": ActionDef(
         name="forward", action_id=0x1001,
-        primitives=[ActionPrimitive(op=OP_SET_PORT, dst_off=0, imm_val=0, fwidth=1)],
-        params=["port"]
+        primitives=[ActionPrimitive(op=OP_SET_PORT, fwidth=1, param=0),
+                    ActionPrimitive(op=OP_SET, dst_off=PHV_FIELDS["eth_dst"][0],
+                                    fwidth=6, param=1)],
+        params=["port", "dmac"]
     ),
     "drop": ActionDef(
         name="drop", action_id=0x1002,
         primitives=[ActionPrimitive(op=OP_DROP)],
     ),
+    # ecmp_idx = base + (flow_hash & mask)；hash 输入由表的 rvp4_hash 指定
+    "ecmp_group": ActionDef(
+        name="ecmp_group", action_id=0x1003,
+        primitives=[ActionPrimitive(op=OP_HASH_SET, dst_off=_ECMP_IDX, fwidth=2),
+                    ActionPrimitive(op=OP_AND, dst_off=_ECMP_IDX, fwidth=2, param=2),
+                    ActionPrimitive(op=OP_ADD, dst_off=_ECMP_IDX, fwidth=2, param=0)],
+        params=["base", "mask"]
+    ),
     "permit": ActionDef(
         name="permit", action_id=0x2001,
         primitives=[ActionPrimitive(op=OP_NOP)],
@@ -220,22 +253,64 @@ BUILTIN_ACTIONS: Dict[str, ActionDef] = {
     ),
     "l2_forward": ActionDef(
         name="l2_forward", action_id=0x3001,
-        primitives=[ActionPrimitive(op=OP_SET_PORT, dst_off=0, imm_val=0, fwidth=1)],
+        primitives=[ActionPrimitive(op=OP_SET_PORT, fwidth=1, param=0)],
         params=["port"]
     ),
     "flood": ActionDef(
         name="flood", action_id=0x3002,
-        primitives=[ActionPrimitive(op=OP_NOP)],
+        primitives=[ActionPrimitive(op=OP_SET_PORT, imm_val=0xFF, fwidth=1)],
+    ),
+    "punt_cpu": ActionDef(
+        name="punt_cpu", action_id=0x4001,
+        primitives=[ActionPrimitive(op=OP_SET_META, dst_off=PHV_FIELDS["meta_punt"][0],
+                                    imm_val=1, fwidth=1)],
+    ),
+    "vlan_assign_pvid": ActionDef(
+        name="vlan_assign_pvid", action_id=0x5001,
+        primitives=[ActionPrimitive(op=OP_SET_META, dst_off=_VLAN_ID, fwidth=2, param=0)],
+        params=["pvid"]
+    ),
+    # vlan_id = tci & 0xFFF；参数非 0 时以参数覆盖
+    "vlan_accept_tagged": ActionDef(
+        name="vlan_accept_tagged", action_id=0x5002,
+        primitives=[ActionPrimitive(op=OP_COPY, dst_off=_VLAN_ID,
+                                    src_off=PHV_FIELDS["vlan_tci"][0], fwidth=2),
+                    ActionPrimitive(op=OP_AND, dst_off=_VLAN_ID, imm_val=0x0FFF, fwidth=2),
+                    ActionPrimitive(op=OP_COND_SET, dst_off=_VLAN_ID, fwidth=2, param=0)],
+        params=["vlan_id"]
+    ),
+    "vlan_drop": ActionDef(
+        name="vlan_drop", action_id=0x5003,
+        primitives=[ActionPrimitive(op=OP_DROP)],
+    ),
+    "vlan_strip_tag": ActionDef(
+        name="vlan_strip_tag", action_id=0x5004,
+        primitives=[ActionPrimitive(op=OP_SET_META,
+                                    dst_off=PHV_FIELDS["meta_vlan_action"][0],
+                                    imm_val=VLAN_ACT_STRIP, fwidth=1),
+                    ActionPrimitive(op=OP_SET, dst_off=PHV_FIELDS["vlan_tci"][0],
+                                    imm_val=0, fwidth=2)],
+    ),
+    "vlan_keep_tag": ActionDef(
+        name="vlan_keep_tag", action_id=0x5005,
+        primitives=[ActionPrimitive(op=OP_SET_META,
+                                    dst_off=PHV_FIELDS["meta_vlan_action"][0],
+                                    imm_val=VLAN_ACT_KEEP, fwidth=1)],
+    ),
+    "set_prio": ActionDef(
+        name="set_prio", action_id=0x6001,
+        primitives=[ActionPrimitive(op=OP_SET_PRIO, fwidth=1, param=0)],
+        params=["prio"]
     ),
     "set_ttl_dec": ActionDef(
-        name="set_ttl_dec", action_id=0x4001,
+        name="set_ttl_dec", action_id=0x7001,
         primitives=[ActionPrimitive(op=OP_ADD, dst_off=PHV_FIELDS["ipv4_ttl"][0],
                                     imm_val=0xFFFFFFFF, fwidth=1)],  # -1 via wrap
     ),
     "set_dscp": ActionDef(
-        name="set_dscp", action_id=0x4002,
+        name="set_dscp", action_id=0x7002,
         primitives=[ActionPrimitive(op=OP_SET, dst_off=PHV_FIELDS["ipv4_dscp"][0],
-                                    imm_val=0, fwidth=1)],
+                                    fwidth=1, param=0)],
         params=["dscp"]
     ),
     "nop": ActionDef(
@@ -256,7 +331,7 @@ class RVP4Compiler:
         self.warnings: List[str] = []
         self.errors:   List[str] = []
         self._next_table_id = 0
-        self._next_action_id = 0x5000
+        self._next_action_id = USER_ACTION_BASE
         self._next_state_id  = 1
 
     def compile(self, src: str):
@@ -290,12 +365,32 @@ class RVP4Compiler:
         if get_attr(attrs, 'rvp4_exact'):  match_type = "exact"
         if get_attr(attrs, 'rvp4_ternary'): match_type = "ternary"
 
+        # rvp4_key(f1, f2, ...)：匹配键字段，按书写顺序拼接
+        key_attr = get_attr(attrs, 'rvp4_key')
+        key_fields = [a for a in key_attr.args if a] if key_attr else []
+        for k in key_fields:
+            if k not in PHV_FIELDS:
+                self.errors.append(f"Table '{name}': unknown key field '{k}'")
+
+        # rvp4_hash(f1, f2, ...)：HASH_SET 的 hash 输入（缺省为匹配键）
+        hash_attr = get_attr(attrs, 'rvp4_hash')
+        hash_fields = [a for a in hash_attr.args if a] if hash_attr else []
+        for k in hash_fields:
+            if k not in PHV_FIELDS:
+                self.errors.append(f"Table '{name}': unknown hash field '{k}'")
+
+        # rvp4_actions(a1, a2, ...)：可用动作
+        act_attr = get_attr(attrs, 'rvp4_actions')
+        actions = [a for a in act_attr.args if a] if act_attr else []
+
         tid = self._next_table_id
         self._next_table_id += 1
 
         self.tables[name] = TableDef(
             name=name, stage=stage, table_id=tid,
-            match_type=match_type, size=size
+            match_type=match_type, size=size,
+            key_fields=key_fields, actions=actions,
+            hash_fields=hash_fields
         )
 
     def _register_action(self, name: str, attrs: List[Attribute]):
@@ -340,6 +435,23 @@ class RVP4Compiler:
                     f"Table '{t.name}' size {t.size} exceeds TCAM depth "
                     f"{MAU_TCAM_DEPTH}, truncating")
                 t.size = MAU_TCAM_DEPTH
+            if not t.key_fields:
+                self.warnings.append(f"Table '{t.name}' has no rvp4_key")
+            key_bytes = sum(PHV_FIELDS[k][1] for k in t.key_fields if k in PHV_FIELDS)
+            if key_bytes > MAU_TCAM_KEY_W // 8:
+                self.errors.append(
+                    f"Table '{t.name}' key is {key_bytes} bytes "
+                    f"(max {MAU_TCAM_KEY_W // 8})")
+            for a in t.actions:
+                if a not in self.actions:
+                    self.errors.append(f"Table '{t.name}': unknown action '{a}'")
+        by_stage: Dict[int, str] = {}
+        for t in self.tables.values():
+            if t.stage in by_stage:
+                self.errors.append(
+                    f"Tables '{by_stage[t.stage]}' and '{t.name}' "
+                    f"share stage {t.stage}")
+            by_stage[t.stage] = t.name
 
     # ── 二进制生成 ────────────────────────────
 
@@ -430,7 +542,10 @@ class RVP4Compiler:
                 for name, (off, w) in PHV_FIELDS.items()}
 
     def gen_table_info(self) -> dict:
-        return {
+        # "_pipeline"：流水线形态（下划线开头的键不是表）
+        info = {"_pipeline": {"num_stages":     NUM_MAU_STAGES,
+                              "ingress_stages": NUM_INGRESS_STAGES}}
+        info.update({
             name: {
                 "stage":      t.stage,
                 "table_id":   t.table_id,
@@ -438,9 +553,11 @@ class RVP4Compiler:
                 "size":       t.size,
                 "key_fields": t.key_fields,
                 "actions":    t.actions,
+                **({"hash_fields": t.hash_fields} if t.hash_fields else {}),
             }
             for name, t in self.tables.items()
-        }
+        })
+        return info
 
     def gen_action_info(self) -> dict:
         return {
@@ -450,7 +567,7 @@ class RVP4Compiler:
                 "primitives": [
                     {"op": p.op, "dst_off": p.dst_off,
                      "src_off": p.src_off, "imm_val": p.imm_val,
-                     "fwidth": p.fwidth}
+                     "fwidth": p.fwidth, "param": p.param}
                     for p in a.primitives
                 ],
             }
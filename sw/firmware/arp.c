@@ -85,7 +85,7 @@ static void install_arp_punt_rule(void) {
 }
 
 /* 调用 cp_main.c 中的 fdb_learn（外部链接）*/
-extern int fdb_learn(uint64_t dmac, uint8_t port);
+extern int fdb_learn(uint64_t dmac, uint16_t vlan, uint8_t port);
 
 /* 构造并发送 ARP 应答 */
 static void send_arp_reply(port_id_t eg_port, uint16_t vlan,
@@ -159,7 +159,7 @@ int arp_add(uint32_t ip, const uint8_t *mac, port_id_t port, uint16_t vlan) {
     uint64_t dmac = ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) |
                     ((uint64_t)mac[2] << 24) | ((uint64_t)mac[3] << 16) |
                     ((uint64_t)mac[4] <<  8) | ((uint64_t)mac[5]);
-    fdb_learn(dmac, port);
+    fdb_learn(dmac, vlan, port);
 
     return HAL_OK;
 }
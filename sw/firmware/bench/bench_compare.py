@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""
+bench_compare.py — 比较两次 bench_fwd --json 的结果
+
+用法:
+    python3 bench_compare.py <baseline.json> <current.json> [--tolerance PCT]
+
+逐项对比:
+    results[]  端到端 mpps（下降为退化）
+    stages[]   逐级 ns_per_lookup（上升为退化）
+    缓存缺失计数只打印，不参与判定（虚拟机上常不可用，且受系统噪声影响大）
+
+任一项退化超过 tolerance%（默认 10）时以返回码 1 退出；两次运行的
+表规模 / 流量配置不同时返回 2。
+"""
+
+import sys
+import json
+import argparse
+
+CONFIG_KEYS = ("routes", "fdb", "acl", "flows", "pkts", "zipf", "seed")
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("bench") != "bench_fwd":
+        raise SystemExit(f"{path}: not a bench_fwd result")
+    return data
+
+
+def fmt_cnt(v):
+    return "n/a" if v is None else f"{v:.2f}"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("baseline")
+    ap.add_argument("current")
+    ap.add_argument("--tolerance", type=float, default=10.0,
+                    help="允许的退化百分比（默认 10）")
+    args = ap.parse_args()
+
+    base, cur = load(args.baseline), load(args.current)
+
+    diff = [k for k in CONFIG_KEYS if base["config"].get(k) != cur["config"].get(k)]
+    if diff:
+        print("config mismatch: " + ", ".join(
+            f"{k} {base['config'].get(k)} -> {cur['config'].get(k)}" for k in diff))
+        return 2
+
+    tol = args.tolerance / 100.0
+    failed = []
+
+    print(f"{'item':<22} {'baseline':>10} {'current':>10} {'change':>8}  LLC miss (base -> cur)")
+    base_runs = {r["name"]: r for r in base["results"]}
+    for r in cur["results"]:
+        b = base_runs.get(r["name"])
+        if not b:
+            continue
+        chg = r["mpps"] / b["mpps"] - 1.0 if b["mpps"] else 0.0
+        bad = chg < -tol
+        print(f"{r['name'] + ' Mpps':<22} {b['mpps']:>10.3f} {r['mpps']:>10.3f} {chg:>+8.1%}  "
+              f"{fmt_cnt(b['llc_miss_per_pkt'])} -> {fmt_cnt(r['llc_miss_per_pkt'])}"
+              f"{'  REGRESSION' if bad else ''}")
+        if bad:
+            failed.append(r["name"])
+
+    base_st = {s["stage"]: s for s in base["stages"]}
+    for s in cur["stages"]:
+        b = base_st.get(s["stage"])
+        if not b:
+            continue
+        chg = s["ns_per_lookup"] / b["ns_per_lookup"] - 1.0 if b["ns_per_lookup"] else 0.0
+        bad = chg > tol
+        name = f"s{s['stage']} {s['table']} ns"
+        print(f"{name:<22} {b['ns_per_lookup']:>10.1f} {s['ns_per_lookup']:>10.1f} {chg:>+8.1%}  "
+              f"{fmt_cnt(b['llc_miss_per_lookup'])} -> {fmt_cnt(s['llc_miss_per_lookup'])}"
+              f"{'  REGRESSION' if bad else ''}")
+        if bad:
+            failed.append(name)
+
+    if failed:
+        print(f"\n{len(failed)} regression(s) beyond {args.tolerance:g}%: " + ", ".join(failed))
+        return 1
+    print(f"\nno regression beyond {args.tolerance:g}%")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,664 @@
+// bench_fwd.c
+// 转发模型吞吐基准：按实际部署规模装表，Zipf 流量驱动 pkt_process()
+//
+// 用法：./bench_fwd [--routes N] [--fdb N] [--acl N] [--flows N] [--zipf S]
+//                   [--pkts N] [--secs S] [--seed N] [--json FILE]
+//   --routes  Stage 0 路由条数（默认 65535 + 默认路由，即 table_id 空间上限；
+//             前缀长度按公网 BGP 表分布，/24 约占 59%）
+//   --fdb     Stage 2 FDB 条数（默认 32768）
+//   --acl     Stage 1 ACL 条数（默认 4096，7/8 deny、1/8 permit）
+//   --flows   不同流（五元组 + 目的 MAC）数（默认 262144）
+//   --zipf    流热度的 Zipf 指数（默认 1.0；0 = 均匀）
+//   --pkts    报文池大小（默认 262144，循环使用）
+//   --secs    每项测量时长（默认 1.0 s；逐级回放每级 secs / 2）
+//   --seed    随机数种子（默认固定，保证多次运行表项与流量一致）
+//   --json    把结果写成 JSON（供 bench_compare.py 做回归比较）
+//
+// 测量项：
+//   1. pkt_process 逐帧、pkt_process_burst 批量的 Mpps 与 ns/pkt；
+//   2. 逐级：先以跟踪回调（-DPKT_MODEL_TRACE）记录报文池前 TRACE_PKTS 帧
+//      在每级提取的键，再对每级单独回放 sim_tcam_lookup，得到每帧查找次数、
+//      命中率、ns/lookup。
+// 缓存缺失由 perf_event_open 计数（LLC miss 与 L1D 读缺失，只计用户态）；
+// 内核或虚拟机不提供硬件计数器时输出 n/a，JSON 中为 null。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "sim_hal.h"
+#include "pkt_model.h"
+#include "pkt_prog.h"
+#include "table_map.h"
+#include "vlan.h"
+#include "arp.h"
+#include "qos.h"
+
+#define TRACE_PKTS  65536       // 逐级键跟踪的报文数上限
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// ─────────────────────────────────────────────
+// 硬件计数器（perf_event_open，失败时 fd = -1）
+// ─────────────────────────────────────────────
+#define PMU_LLC     0
+#define PMU_L1D     1
+#define PMU_N       2
+
+typedef struct {
+    int     fd[PMU_N];
+    int64_t val[PMU_N];         // 最近一次测量值，-1 = 不可用
+} pmu_t;
+
+static int pmu_open_one(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size           = sizeof(a);
+    a.type           = type;
+    a.config         = config;
+    a.disabled       = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+}
+
+static void pmu_open(pmu_t *p)
+{
+    p->fd[PMU_LLC] = pmu_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    p->fd[PMU_L1D] = pmu_open_one(PERF_TYPE_HW_CACHE,
+                                  PERF_COUNT_HW_CACHE_L1D |
+                                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+}
+
+static void pmu_start(pmu_t *p)
+{
+    for (int i = 0; i < PMU_N; i++) {
+        if (p->fd[i] < 0) continue;
+        ioctl(p->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static void pmu_stop(pmu_t *p)
+{
+    for (int i = 0; i < PMU_N; i++) {
+        p->val[i] = -1;
+        if (p->fd[i] < 0) continue;
+        ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t v;
+        if (read(p->fd[i], &v, sizeof(v)) == (ssize_t)sizeof(v)) p->val[i] = (int64_t)v;
+    }
+}
+
+// 每次操作的计数；不可用为 -1
+static double pmu_per(const pmu_t *p, int i, uint64_t ops)
+{
+    return p->val[i] >= 0 && ops ? (double)p->val[i] / (double)ops : -1.0;
+}
+
+// ─────────────────────────────────────────────
+// 装表（直接写 TCAM，键编码与 route.c / acl.c / fdb.c 一致；
+// 各模块软件表只有几百条，装不下这个规模）
+// ─────────────────────────────────────────────
+
+// 开放寻址去重集合（值 0 保留为空槽）
+typedef struct {
+    uint64_t *slot;
+    uint32_t  mask;
+} uset_t;
+
+static int uset_init(uset_t *s, int n)
+{
+    uint32_t cap = 16;
+    while (cap < (uint32_t)n * 2) cap <<= 1;
+    s->slot = (uint64_t *)calloc(cap, sizeof(uint64_t));
+    s->mask = cap - 1;
+    return s->slot ? 0 : -1;
+}
+
+// 插入成功返回 1，已存在返回 0
+static int uset_add(uset_t *s, uint64_t v)
+{
+    uint32_t i = (uint32_t)((v * 0x9E3779B97F4A7C15ULL) >> 32) & s->mask;
+    while (s->slot[i]) {
+        if (s->slot[i] == v) return 0;
+        i = (i + 1) & s->mask;
+    }
+    s->slot[i] = v;
+    return 1;
+}
+
+// 公网 BGP 表的前缀长度分布（‰，/8 - /24）
+static const uint16_t rib_len_permille[25] = {
+    [8] = 1, [9] = 1, [10] = 1, [11] = 2, [12] = 3, [13] = 5, [14] = 8, [15] = 10,
+    [16] = 14, [17] = 8, [18] = 13, [19] = 28, [20] = 45, [21] = 50, [22] = 120,
+    [23] = 100, [24] = 591,
+};
+
+typedef struct {
+    uint32_t pfx;
+    uint8_t  len;
+} rib_pfx_t;
+
+static int cmp_len_desc(const void *a, const void *b)
+{
+    const rib_pfx_t *x = (const rib_pfx_t *)a, *y = (const rib_pfx_t *)b;
+    if (x->len != y->len) return (int)y->len - (int)x->len;
+    return x->pfx < y->pfx ? -1 : x->pfx > y->pfx;
+}
+
+static uint32_t len_mask(uint8_t len)
+{
+    return len ? 0xFFFFFFFFu << (32 - len) : 0;
+}
+
+static void put_be32(uint8_t *b, uint32_t v)
+{
+    b[0] = (uint8_t)(v >> 24); b[1] = (uint8_t)(v >> 16);
+    b[2] = (uint8_t)(v >> 8);  b[3] = (uint8_t)v;
+}
+
+// 生成 n 条不重复前缀并按长度降序写入 Stage 0（table_id 递增 = 优先级递减，
+// 保证最长前缀优先），另加 0.0.0.0/0 → 端口 31（table_id 0xFFFF）。
+// 下一跳 MAC 取自 FDB，路由后的报文在 Stage 2 命中
+static rib_pfx_t *load_rib(int n, const uint64_t *nh_mac, int n_mac)
+{
+    rib_pfx_t *rib = (rib_pfx_t *)malloc((size_t)n * sizeof(rib_pfx_t));
+    uset_t seen;
+    if (!rib || uset_init(&seen, n)) return NULL;
+
+    for (int i = 0; i < n; ) {
+        uint32_t r = rng() % 1000, acc = 0;
+        uint8_t len = 24;
+        for (int l = 8; l <= 24; l++) {
+            acc += rib_len_permille[l];
+            if (r < acc) { len = (uint8_t)l; break; }
+        }
+        uint32_t a  = rng();
+        uint8_t  o1 = (uint8_t)(1 + (a >> 24) % 223);           // 1-223，跳过 10 / 127
+        if (o1 == 10 || o1 == 127) continue;
+        uint32_t pfx = (((uint32_t)o1 << 24) | (a & 0x00FFFFFFu)) & len_mask(len);
+        if (!uset_add(&seen, ((uint64_t)pfx << 8) | len | (1ULL << 40))) continue;
+        rib[i].pfx = pfx;
+        rib[i].len = len;
+        i++;
+    }
+    free(seen.slot);
+    qsort(rib, (size_t)n, sizeof(rib_pfx_t), cmp_len_desc);
+
+    for (int i = 0; i <= n; i++) {
+        tcam_entry_t e;
+        memset(&e, 0, sizeof(e));
+        uint32_t pfx = i < n ? rib[i].pfx : 0;
+        uint8_t  len = i < n ? rib[i].len : 0;
+        e.stage       = TABLE_IPV4_LPM_STAGE;
+        e.table_id    = (uint16_t)(i < n ? TABLE_IPV4_LPM_BASE + i : TABLE_IPV4_LPM_BASE + 0xFFFF);
+        e.key.key_len = e.mask.key_len = 4;
+        put_be32(e.key.bytes, pfx);
+        put_be32(e.mask.bytes, len_mask(len));
+        e.action_id        = ACTION_FORWARD;
+        e.action_params[0] = (uint8_t)(i < n ? i % 31 : 31);
+        uint64_t nh = nh_mac[i % n_mac];
+        for (int k = 0; k < 6; k++) e.action_params[1 + k] = (uint8_t)(nh >> (40 - 8 * k));
+        if (hal_tcam_insert(&e) != HAL_OK) { free(rib); return NULL; }
+    }
+    return rib;
+}
+
+// 本地管理单播 MAC 02:xx:xx:xx:xx:xx，精确匹配
+static uint64_t *load_fdb(int n)
+{
+    uint64_t *mac = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+    uset_t seen;
+    if (!mac || uset_init(&seen, n)) return NULL;
+
+    for (int i = 0; i < n; ) {
+        uint64_t m = (0x02ULL << 40) | ((uint64_t)rng() << 8) | (rng() & 0xFF);
+        if (!uset_add(&seen, m)) continue;
+        mac[i] = m;
+
+        tcam_entry_t e;
+        memset(&e, 0, sizeof(e));
+        e.stage       = TABLE_L2_FDB_STAGE;
+        e.table_id    = (uint16_t)(TABLE_L2_FDB_BASE + i);
+        e.key.key_len = e.mask.key_len = 6;
+        for (int k = 0; k < 6; k++) e.key.bytes[k] = (uint8_t)(m >> (40 - 8 * k));
+        memset(e.mask.bytes, 0xFF, 6);
+        e.action_id        = ACTION_L2_FORWARD;
+        e.action_params[0] = (uint8_t)(i % 31);
+        if (hal_tcam_insert(&e) != HAL_OK) { free(mac); free(seen.slot); return NULL; }
+        i++;
+    }
+    free(seen.slot);
+    return mac;
+}
+
+// 源 /16 /24 /32，目的取自 RIB 前缀或其 /24 子网；deny 一半带目的端口
+static int load_acl(int n, const rib_pfx_t *rib, int n_rib)
+{
+    static const uint8_t  src_len[] = { 16, 24, 32 };
+    static const uint16_t ports[]   = { 22, 23, 25, 53, 80, 135, 443, 445, 1433, 3389 };
+
+    for (int i = 0; i < n; i++) {
+        const rib_pfx_t *d = &rib[rng() % (uint32_t)n_rib];
+        uint8_t  sl   = src_len[rng() % 3];
+        uint8_t  dl   = (rng() & 1) ? d->len : 24;
+        uint32_t dst  = (d->pfx | (rng() & ~len_mask(d->len))) & len_mask(dl);
+        uint32_t src  = rng() & len_mask(sl);
+        int      deny = (i & 7) != 7;
+        uint16_t dport = deny && (rng() & 1) ? ports[rng() % 10] : 0;
+
+        tcam_entry_t e;
+        memset(&e, 0, sizeof(e));
+        e.stage       = TABLE_ACL_INGRESS_STAGE;
+        e.table_id    = (uint16_t)(TABLE_ACL_INGRESS_BASE + i);
+        e.key.key_len = e.mask.key_len = deny ? 10 : 8;
+        put_be32(e.key.bytes, src);
+        put_be32(e.key.bytes + 4, dst);
+        put_be32(e.mask.bytes, len_mask(sl));
+        put_be32(e.mask.bytes + 4, len_mask(dl));
+        if (dport) {
+            e.key.bytes[8] = (uint8_t)(dport >> 8); e.key.bytes[9] = (uint8_t)dport;
+            e.mask.bytes[8] = e.mask.bytes[9] = 0xFF;
+        }
+        e.action_id = deny ? ACTION_DENY : ACTION_PERMIT;
+        if (hal_tcam_insert(&e) != HAL_OK) return -1;
+    }
+    return 0;
+}
+
+// ─────────────────────────────────────────────
+// 流量
+// ─────────────────────────────────────────────
+
+static uint16_t build_udp(uint8_t *b, uint64_t dmac, uint32_t src, uint32_t dst,
+                          uint8_t tos, uint16_t sport, uint16_t dport)
+{
+    memset(b, 0, 42);
+    for (int k = 0; k < 6; k++) b[k] = (uint8_t)(dmac >> (40 - 8 * k));
+    b[6] = 0x02; b[11] = 0x01;
+    b[12] = 0x08; b[13] = 0x00;
+    b[14] = 0x45; b[15] = tos; b[17] = 28; b[22] = 64; b[23] = 17;
+    put_be32(b + 26, src);
+    put_be32(b + 30, dst);
+    b[34] = (uint8_t)(sport >> 8); b[35] = (uint8_t)sport;
+    b[36] = (uint8_t)(dport >> 8); b[37] = (uint8_t)dport;
+    return 42;
+}
+
+// Zipf(s) 采样：累积分布 + 二分查找
+static int zipf_pick(const double *cdf, int n)
+{
+    double u = (double)rng() / 4294967296.0;
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else              hi = mid;
+    }
+    return lo;
+}
+
+// ─────────────────────────────────────────────
+// 逐级键跟踪与回放
+// ─────────────────────────────────────────────
+typedef struct {
+    uint8_t *keys[PKT_NUM_STAGES];      // 每级 TRACE_PKTS × SIM_TCAM_KEY_STRIDE
+    uint8_t *lens[PKT_NUM_STAGES];
+    int      n[PKT_NUM_STAGES];
+    int      oom;
+} trace_t;
+
+static void trace_key(int stage, const uint8_t *key, uint8_t key_len, void *ctx)
+{
+    trace_t *t = (trace_t *)ctx;
+    if (!t->keys[stage]) {
+        t->keys[stage] = (uint8_t *)malloc((size_t)TRACE_PKTS * SIM_TCAM_KEY_STRIDE);
+        t->lens[stage] = (uint8_t *)malloc(TRACE_PKTS);
+        if (!t->keys[stage] || !t->lens[stage]) { t->oom = 1; return; }
+    }
+    if (t->n[stage] >= TRACE_PKTS) return;
+    memcpy(t->keys[stage] + (size_t)t->n[stage] * SIM_TCAM_KEY_STRIDE, key, SIM_TCAM_KEY_STRIDE);
+    t->lens[stage][t->n[stage]++] = key_len;
+}
+
+static const char *stage_name(int s)
+{
+    switch (s) {
+    case TABLE_IPV4_LPM_STAGE:     return "ipv4_lpm";
+    case TABLE_ACL_INGRESS_STAGE:  return "acl_ingress";
+    case TABLE_L2_FDB_STAGE:       return "l2_fdb";
+    case TABLE_ARP_TRAP_STAGE:     return "arp_trap";
+    case TABLE_VLAN_INGRESS_STAGE: return "vlan_ingress";
+    case TABLE_DSCP_MAP_STAGE:     return "dscp_map";
+    case TABLE_VLAN_EGRESS_STAGE:  return "vlan_egress";
+    default:                       return "-";
+    }
+}
+
+typedef struct {
+    const char *name;
+    double      mpps, ns;
+    double      llc, l1d;           // 每帧（每次查找）缺失数，-1 = 不可用
+} run_t;
+
+typedef struct {
+    int    stage, entries;
+    double per_pkt, hit;
+    run_t  r;
+} stage_run_t;
+
+static run_t run_single(pmu_t *pmu, const pkt_desc_t *desc, int n, double secs)
+{
+    run_t r = { "pkt_process", 0, 0, -1, -1 };
+    fwd_result_t res;
+    uint64_t done = 0;
+    double t0 = now_s(), t;
+    pmu_start(pmu);
+    do {
+        for (int i = 0; i < n; i++)
+            pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &res);
+        done += (uint64_t)n;
+    } while ((t = now_s()) - t0 < secs);
+    pmu_stop(pmu);
+    r.mpps = (double)done / (t - t0) / 1e6;
+    r.ns   = (t - t0) * 1e9 / (double)done;
+    r.llc  = pmu_per(pmu, PMU_LLC, done);
+    r.l1d  = pmu_per(pmu, PMU_L1D, done);
+    return r;
+}
+
+static run_t run_burst(pmu_t *pmu, const pkt_desc_t *desc, int n, double secs)
+{
+    run_t r = { "pkt_process_burst", 0, 0, -1, -1 };
+    fwd_result_t res[PKT_BURST_MAX];
+    uint64_t done = 0;
+    double t0 = now_s(), t;
+    pmu_start(pmu);
+    do {
+        for (int i = 0; i < n; i += PKT_BURST_MAX) {
+            int cnt = n - i < PKT_BURST_MAX ? n - i : PKT_BURST_MAX;
+            pkt_process_burst(desc + i, cnt, res);
+        }
+        done += (uint64_t)n;
+    } while ((t = now_s()) - t0 < secs);
+    pmu_stop(pmu);
+    r.mpps = (double)done / (t - t0) / 1e6;
+    r.ns   = (t - t0) * 1e9 / (double)done;
+    r.llc  = pmu_per(pmu, PMU_LLC, done);
+    r.l1d  = pmu_per(pmu, PMU_L1D, done);
+    return r;
+}
+
+static stage_run_t run_stage(pmu_t *pmu, const trace_t *tr, int stage, int traced, double secs)
+{
+    stage_run_t s;
+    memset(&s, 0, sizeof(s));
+    s.stage   = stage;
+    s.entries = sim_tcam_count_stage((uint8_t)stage);
+    s.r.name  = stage_name(stage);
+    s.r.llc   = s.r.l1d = -1;
+
+    const int      n    = tr->n[stage];
+    const uint8_t *keys = tr->keys[stage];
+    const uint8_t *lens = tr->lens[stage];
+    s.per_pkt = (double)n / (double)traced;
+    if (!n) return s;
+
+    uint64_t done = 0, hits = 0;
+    double t0 = now_s(), t;
+    pmu_start(pmu);
+    do {
+        hits = 0;
+        for (int i = 0; i < n; i++)
+            hits += sim_tcam_lookup((uint8_t)stage, keys + (size_t)i * SIM_TCAM_KEY_STRIDE,
+                                    lens[i]) != NULL;
+        done += (uint64_t)n;
+    } while ((t = now_s()) - t0 < secs);
+    pmu_stop(pmu);
+
+    s.hit    = (double)hits / (double)n;
+    s.r.mpps = (double)done / (t - t0) / 1e6;
+    s.r.ns   = (t - t0) * 1e9 / (double)done;
+    s.r.llc  = pmu_per(pmu, PMU_LLC, done);
+    s.r.l1d  = pmu_per(pmu, PMU_L1D, done);
+    return s;
+}
+
+// ─────────────────────────────────────────────
+// 输出
+// ─────────────────────────────────────────────
+
+static void print_cnt(double v)
+{
+    if (v < 0) printf(" %12s", "n/a");
+    else       printf(" %12.2f", v);
+}
+
+static void json_cnt(FILE *f, const char *key, double v)
+{
+    if (v < 0) fprintf(f, "\"%s\": null", key);
+    else       fprintf(f, "\"%s\": %.3f", key, v);
+}
+
+typedef struct {
+    int    routes, fdb, acl, flows, pkts;
+    double zipf, secs;
+    uint64_t seed;
+} bench_cfg_t;
+
+static int write_json(const char *path, const bench_cfg_t *c, const run_t *runs, int n_runs,
+                      const stage_run_t *st, int n_st, int n_fwd, int n_drop, int n_punt)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return -1; }
+
+    fprintf(f, "{\n  \"bench\": \"bench_fwd\",\n  \"schema\": 1,\n");
+    fprintf(f, "  \"config\": {\"routes\": %d, \"fdb\": %d, \"acl\": %d, \"flows\": %d, "
+               "\"pkts\": %d, \"zipf\": %.2f, \"secs\": %.2f, \"seed\": %llu},\n",
+            c->routes, c->fdb, c->acl, c->flows, c->pkts, c->zipf, c->secs,
+            (unsigned long long)c->seed);
+    fprintf(f, "  \"traffic\": {\"forward\": %d, \"drop\": %d, \"punt\": %d},\n",
+            n_fwd, n_drop, n_punt);
+
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < n_runs; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"mpps\": %.3f, \"ns_per_pkt\": %.1f, ",
+                runs[i].name, runs[i].mpps, runs[i].ns);
+        json_cnt(f, "llc_miss_per_pkt", runs[i].llc);
+        fprintf(f, ", ");
+        json_cnt(f, "l1d_miss_per_pkt", runs[i].l1d);
+        fprintf(f, "}%s\n", i + 1 < n_runs ? "," : "");
+    }
+    fprintf(f, "  ],\n  \"stages\": [\n");
+    for (int i = 0; i < n_st; i++) {
+        fprintf(f, "    {\"stage\": %d, \"table\": \"%s\", \"entries\": %d, "
+                   "\"lookups_per_pkt\": %.3f, \"hit_rate\": %.3f, \"ns_per_lookup\": %.1f, ",
+                st[i].stage, st[i].r.name, st[i].entries, st[i].per_pkt, st[i].hit, st[i].r.ns);
+        json_cnt(f, "llc_miss_per_lookup", st[i].r.llc);
+        fprintf(f, ", ");
+        json_cnt(f, "l1d_miss_per_lookup", st[i].r.l1d);
+        fprintf(f, "}%s\n", i + 1 < n_st ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f);
+}
+
+// ─────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────
+int main(int argc, char **argv)
+{
+    bench_cfg_t c = { 65535, 32768, 4096, 262144, 262144, 1.0, 1.0, 1 };
+    const char *json = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--routes") && i + 1 < argc) c.routes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--fdb")    && i + 1 < argc) c.fdb    = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--acl")    && i + 1 < argc) c.acl    = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--flows")  && i + 1 < argc) c.flows  = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--zipf")   && i + 1 < argc) c.zipf   = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--pkts")   && i + 1 < argc) c.pkts   = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--secs")   && i + 1 < argc) c.secs   = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed")   && i + 1 < argc) c.seed   = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--json")   && i + 1 < argc) json     = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--routes N] [--fdb N] [--acl N] [--flows N] [--zipf S] "
+                            "[--pkts N] [--secs S] [--seed N] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    // table_id 为 16 位：路由另留 0xFFFF 给默认路由
+    if (c.routes < 1) c.routes = 1;
+    if (c.routes > 65535) c.routes = 65535;
+    if (c.fdb < 1) c.fdb = 1;
+    if (c.fdb > 65536) c.fdb = 65536;
+    if (c.acl < 0) c.acl = 0;
+    if (c.acl > 65536) c.acl = 65536;
+    if (c.flows < 1) c.flows = 1;
+    if (c.pkts < 1) c.pkts = 1;
+    rng_state ^= c.seed * 0xD1B54A32D192ED03ULL;
+
+    // ── 装表：VLAN / ARP trap / DSCP 走固件模块，大表直接写 TCAM ──
+    sim_hal_reset();
+    vlan_init();
+    vlan_create(10);
+    for (int p = 0; p < 31; p++) {
+        vlan_port_set_pvid((port_id_t)p, 10);
+        vlan_port_set_mode((port_id_t)p, VLAN_MODE_ACCESS);
+        vlan_port_add(10, (port_id_t)p, 0);
+    }
+    vlan_port_set_mode(31, VLAN_MODE_TRUNK);
+    vlan_port_add(10, 31, 1);
+    arp_init();
+    qos_init();
+
+    double t_load = now_s();
+    uint64_t  *mac = load_fdb(c.fdb);
+    rib_pfx_t *rib = mac ? load_rib(c.routes, mac, c.fdb) : NULL;
+    if (!rib || !mac || load_acl(c.acl, rib, c.routes)) {
+        fprintf(stderr, "bench_fwd: table load failed\n");
+        return 1;
+    }
+    t_load = now_s() - t_load;
+
+    // ── 流与报文池 ──
+    typedef struct { uint64_t dmac; uint32_t src, dst; uint16_t sport, dport; uint8_t tos, port; } flow_t;
+    flow_t     *flows = (flow_t *)malloc((size_t)c.flows * sizeof(flow_t));
+    double     *cdf   = (double *)malloc((size_t)c.flows * sizeof(double));
+    uint8_t    *buf   = (uint8_t *)malloc((size_t)c.pkts * 64);
+    pkt_desc_t *desc  = (pkt_desc_t *)malloc((size_t)c.pkts * sizeof(pkt_desc_t));
+    if (!flows || !cdf || !buf || !desc) return 1;
+
+    double sum = 0;
+    for (int f = 0; f < c.flows; f++) {
+        const rib_pfx_t *r = &rib[rng() % (uint32_t)c.routes];
+        flows[f].dmac  = mac[rng() % (uint32_t)c.fdb];
+        flows[f].src   = rng();
+        flows[f].dst   = r->pfx | (rng() & ~len_mask(r->len));
+        flows[f].sport = (uint16_t)rng();
+        flows[f].dport = (uint16_t)(rng() % 1024);
+        flows[f].tos   = (uint8_t)((rng() % 64) << 2);
+        flows[f].port  = (uint8_t)(rng() % 31);
+        sum += c.zipf > 0 ? 1.0 / pow((double)(f + 1), c.zipf) : 1.0;
+        cdf[f] = sum;
+    }
+    for (int f = 0; f < c.flows; f++) cdf[f] /= sum;
+
+    int n_fwd = 0, n_drop = 0, n_punt = 0;
+    for (int i = 0; i < c.pkts; i++) {
+        const flow_t *fl = &flows[zipf_pick(cdf, c.flows)];
+        desc[i].data    = buf + (size_t)i * 64;
+        desc[i].len     = build_udp(buf + (size_t)i * 64, fl->dmac, fl->src, fl->dst,
+                                    fl->tos, fl->sport, fl->dport);
+        desc[i].ig_port = fl->port;
+    }
+
+    // ── 逐级键跟踪（同时统计转发 / 丢弃 / 上送比例） ──
+    trace_t tr;
+    memset(&tr, 0, sizeof(tr));
+    int traced = c.pkts < TRACE_PKTS ? c.pkts : TRACE_PKTS;
+    pkt_model_set_key_trace(trace_key, &tr);
+    for (int i = 0; i < traced; i++) {
+        fwd_result_t r;
+        pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &r);
+        if (r.punt)      n_punt++;
+        else if (r.drop) n_drop++;
+        else             n_fwd++;
+    }
+    pkt_model_set_key_trace(NULL, NULL);
+    if (tr.oom) { fprintf(stderr, "bench_fwd: out of memory\n"); return 1; }
+
+    pmu_t pmu;
+    pmu_open(&pmu);
+
+    printf("\nbench_fwd: routes %d (BGP prefix mix) + default, FDB %d, ACL %d, "
+           "flows %d, zipf %.2f, pool %d pkts\n",
+           c.routes, c.fdb, c.acl, c.flows, c.zipf, c.pkts);
+    printf("  load %.2f s; traffic %.1f%% forward, %.1f%% drop, %.1f%% punt; "
+           "cache counters %s\n\n",
+           t_load, 100.0 * n_fwd / traced, 100.0 * n_drop / traced, 100.0 * n_punt / traced,
+           pmu.fd[PMU_LLC] >= 0 ? "on" : "unavailable");
+
+    // ── 端到端 ──
+    run_t runs[2];
+    runs[0] = run_single(&pmu, desc, c.pkts, c.secs);
+    runs[1] = run_burst(&pmu, desc, c.pkts, c.secs);
+
+    printf("  %-18s %10s %10s %12s %12s\n", "mode", "Mpps", "ns/pkt", "LLC miss/pkt", "L1D miss/pkt");
+    for (int i = 0; i < 2; i++) {
+        printf("  %-18s %10.3f %10.1f", runs[i].name, runs[i].mpps, runs[i].ns);
+        print_cnt(runs[i].llc);
+        print_cnt(runs[i].l1d);
+        printf("\n");
+    }
+
+    // ── 逐级回放 ──
+    const pkt_prog_t *pg = pkt_prog_current();
+    stage_run_t st[PKT_NUM_STAGES];
+    int n_st = 0;
+    for (int s = 0; s < pg->n_stages; s++) {
+        if (!pg->stage[s].n_seg) continue;
+        st[n_st++] = run_stage(&pmu, &tr, s, traced, c.secs / 2);
+    }
+
+    printf("\n  %-5s %-13s %8s %11s %7s %10s %12s %12s\n", "stage", "table", "entries",
+           "lookups/pkt", "hit %", "ns/lookup", "LLC miss/lk", "L1D miss/lk");
+    for (int i = 0; i < n_st; i++) {
+        printf("  %-5d %-13s %8d %11.3f %7.1f %10.1f", st[i].stage, st[i].r.name,
+               st[i].entries, st[i].per_pkt, 100.0 * st[i].hit, st[i].r.ns);
+        print_cnt(st[i].r.llc);
+        print_cnt(st[i].r.l1d);
+        printf("\n");
+    }
+    printf("\n");
+
+    // traffic 记录逐帧跟踪的前 traced 帧中转发 / 丢弃 / 上送的帧数
+    int rc = json ? write_json(json, &c, runs, 2, st, n_st, n_fwd, n_drop, n_punt) : 0;
+
+    for (int s = 0; s < PKT_NUM_STAGES; s++) { free(tr.keys[s]); free(tr.lens[s]); }
+    free(flows); free(cdf); free(buf); free(desc); free(rib); free(mac);
+    return rc ? 1 : 0;
+}
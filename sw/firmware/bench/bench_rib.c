@@ -0,0 +1,289 @@
+// bench_rib.c
+// 软件 RIB 规模测试：全表 BGP 规模下 route_add / route_lookup / route_del 的开销与内存
+//
+// 用法：./bench_rib [--routes N] [--lookups N] [--tcam N] [--churn N] [--seed S]
+//                   [--json FILE]
+//   --routes   装入的前缀数（默认 1000000，长度分布近似公网 BGP 表，/24 约 60%）
+//   --lookups  随机地址查找次数（默认 4000000）
+//   --tcam     TCAM 布局测试的区间大小（默认 2047 = 硬件 Stage 0 可用条目）
+//   --churn    TCAM 布局测试的增删次数（默认 200000）
+//   --seed     随机种子
+//   --json     把结果写成 JSON（schema 与 bench_fwd 相同的外层结构）
+//
+// 只链接 route.c，hal_tcam_insert / hal_tcam_delete 由本文件打桩并计数
+// （TUE 排空 / 批量提交的开销见 bench_tue）：
+//   1. RIB：TCAM 区间设为 0（只维护 RIB），测节点池 + Patricia 树 + 下一跳表的开销；
+//   2. TCAM 布局：区间装到 90% 后随机删一条、加一条新前缀，统计每次更新的
+//      TCAM 写入（= TUE 事务）次数。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "route.h"
+
+static uint64_t n_insert, n_delete;
+
+int hal_tcam_insert(const tcam_entry_t *e)           { (void)e; n_insert++; return HAL_OK; }
+int hal_tcam_delete(uint8_t stage, uint16_t table_id) { (void)stage; (void)table_id; n_delete++; return HAL_OK; }
+int hal_tcam_batch_begin(void)                        { return HAL_OK; }
+int hal_tcam_batch_commit(void)                       { return HAL_OK; }
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// 前缀长度分布（千分比，与 bench_fwd.c 相同）
+static const uint16_t len_permille[25] = {
+    [8] = 1, [9] = 1, [10] = 1, [11] = 2, [12] = 3, [13] = 5, [14] = 8, [15] = 10,
+    [16] = 14, [17] = 8, [18] = 13, [19] = 28, [20] = 45, [21] = 50, [22] = 120,
+    [23] = 100, [24] = 591,
+};
+
+typedef struct {
+    uint32_t pfx;
+    uint8_t  len;
+} pfx_t;
+
+static pfx_t rand_prefix(void)
+{
+    uint32_t r = rng() % 1000, acc = 0;
+    uint8_t len = 24;
+    for (int l = 8; l <= 24; l++) {
+        acc += len_permille[l];
+        if (r < acc) { len = (uint8_t)l; break; }
+    }
+    uint32_t a = rng();
+    a = (((1u + (a >> 24) % 223) << 24) | (a & 0x00FFFFFFu));
+    pfx_t p = { len ? a & (0xFFFFFFFFu << (32 - len)) : 0, len };
+    return p;
+}
+
+typedef struct {
+    const char *name;
+    double      ns;             // ns/op
+    double      mops;
+} run_t;
+
+typedef struct {
+    int      slots, routes, churn, fail;
+    double   add_w, del_w;      // 每次更新的 TCAM 写入数
+    uint64_t add_max, del_max;
+    uint32_t moves;
+    double   ns;                // ns / (del + add)
+} tcam_run_t;
+
+// 每个 RIB 节点的存储：rib_node_t（16 B）+ rib_slot[] 偏移（2 B）
+#define NODE_BYTES  (16 + 2)
+
+// TCAM 布局：区间装到 90%，再做 n_churn 次“删一条旧前缀 + 加一条新前缀”
+static int bench_tcam(int slots, int n_churn, tcam_run_t *out)
+{
+    int    fill = slots * 9 / 10;
+    pfx_t *live = (pfx_t *)malloc((size_t)(fill > 0 ? fill : 1) * sizeof(pfx_t));
+    if (!live) return 1;
+
+    route_init();
+    route_tcam_region(0, (uint16_t)slots);
+    int n = 0;
+    while (n < fill) {
+        pfx_t p = rand_prefix();
+        if (route_tcam_slot(p.pfx, p.len) >= 0) continue;
+        if (route_add(p.pfx, p.len, 1, 0x020000000001ULL) != HAL_OK) break;
+        live[n++] = p;
+    }
+
+    uint64_t add_w = 0, add_max = 0, del_w = 0, del_max = 0, adds = 0, dels = 0;
+    int fail = 0;
+    double t0 = now_s();
+    for (int i = 0; i < n_churn && n > 0; i++) {
+        int k = (int)(rng() % (uint32_t)n);
+        uint64_t w0 = n_insert + n_delete;
+        route_del(live[k].pfx, live[k].len);
+        uint64_t w = n_insert + n_delete - w0;
+        del_w += w; dels++;
+        if (w > del_max) del_max = w;
+
+        pfx_t p;
+        do p = rand_prefix(); while (route_tcam_slot(p.pfx, p.len) >= 0);
+        w0 = n_insert + n_delete;
+        if (route_add(p.pfx, p.len, 1, 0x020000000001ULL) != HAL_OK) {
+            fail++;
+            live[k] = live[--n];
+            continue;
+        }
+        w = n_insert + n_delete - w0;
+        add_w += w; adds++;
+        if (w > add_max) add_max = w;
+        live[k] = p;
+    }
+    double t = now_s() - t0;
+
+    route_stats_t st;
+    route_get_stats(&st);
+    printf("\n  TCAM layout: %d slots, %d routes (%.0f%% full), %d churn ops (%d failed)\n",
+           slots, n, 100.0 * n / slots, n_churn, fail);
+    printf("  %-10s %12s %10s\n", "op", "writes/op", "max");
+    printf("  %-10s %12.2f %10llu\n", "add", adds ? (double)add_w / adds : 0.0,
+           (unsigned long long)add_max);
+    printf("  %-10s %12.2f %10llu\n", "del", dels ? (double)del_w / dels : 0.0,
+           (unsigned long long)del_max);
+    printf("  entry moves %u, %.1f ns per churn op (del + add)\n",
+           st.tcam_moves, n_churn ? t * 1e9 / n_churn : 0.0);
+
+    out->slots   = slots;
+    out->routes  = n;
+    out->churn   = n_churn;
+    out->fail    = fail;
+    out->add_w   = adds ? (double)add_w / adds : 0.0;
+    out->del_w   = dels ? (double)del_w / dels : 0.0;
+    out->add_max = add_max;
+    out->del_max = del_max;
+    out->moves   = st.tcam_moves;
+    out->ns      = n_churn ? t * 1e9 / n_churn : 0.0;
+    free(live);
+    return 0;
+}
+
+typedef struct {
+    int      routes, lookups, tcam, churn;
+    uint64_t seed;
+} bench_cfg_t;
+
+static int write_json(const char *path, const bench_cfg_t *c, const run_t *runs, int n_runs,
+                      const route_stats_t *st, int fail, double hit, const tcam_run_t *tc)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return -1; }
+
+    fprintf(f, "{\n  \"bench\": \"bench_rib\",\n  \"schema\": 1,\n");
+    fprintf(f, "  \"config\": {\"routes\": %d, \"lookups\": %d, \"tcam\": %d, \"churn\": %d, "
+               "\"seed\": %llu},\n",
+            c->routes, c->lookups, c->tcam, c->churn, (unsigned long long)c->seed);
+    fprintf(f, "  \"rib\": {\"routes\": %u, \"failed\": %d, \"nodes\": %u, \"nodes_max\": %u, "
+               "\"next_hops\": %u, \"bytes_per_node\": %d, \"mb\": %.1f, \"hit_rate\": %.3f},\n",
+            st->routes, fail, st->nodes, st->nodes_max, st->next_hops, NODE_BYTES,
+            (double)st->nodes * NODE_BYTES / 1048576.0, hit);
+
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < n_runs; i++)
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.1f, \"mops\": %.3f}%s\n",
+                runs[i].name, runs[i].ns, runs[i].mops, i + 1 < n_runs ? "," : "");
+    fprintf(f, "  ],\n");
+    fprintf(f, "  \"tcam\": {\"slots\": %d, \"routes\": %d, \"churn\": %d, \"failed\": %d, "
+               "\"add_writes_per_op\": %.3f, \"add_writes_max\": %llu, "
+               "\"del_writes_per_op\": %.3f, \"del_writes_max\": %llu, "
+               "\"moves\": %u, \"ns_per_churn\": %.1f}\n}\n",
+            tc->slots, tc->routes, tc->churn, tc->fail,
+            tc->add_w, (unsigned long long)tc->add_max,
+            tc->del_w, (unsigned long long)tc->del_max, tc->moves, tc->ns);
+    return fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    int n_routes = 1000000, n_lookups = 4000000, n_slots = ROUTE_TCAM_SLOTS, n_churn = 200000;
+    const char *json = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--routes")  && i + 1 < argc) n_routes  = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--lookups") && i + 1 < argc) n_lookups = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tcam")    && i + 1 < argc) n_slots   = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--churn")   && i + 1 < argc) n_churn   = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed")    && i + 1 < argc) rng_state = strtoull(argv[++i], NULL, 0) | 1;
+        else if (!strcmp(argv[i], "--json")    && i + 1 < argc) json      = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--routes N] [--lookups N] [--tcam N] [--churn N] "
+                    "[--seed S] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n_routes < 1) n_routes = 1;
+    if (n_lookups < 1) n_lookups = 1;
+    if (n_slots < 1) n_slots = 1;
+    if (n_slots > (int)ROUTE_TCAM_SLOTS_MAX) n_slots = (int)ROUTE_TCAM_SLOTS_MAX;
+    if (n_churn < 0) n_churn = 0;
+    bench_cfg_t cfg = { n_routes, n_lookups, n_slots, n_churn, rng_state };
+
+    pfx_t    *tab  = (pfx_t *)malloc((size_t)n_routes * sizeof(pfx_t));
+    uint32_t *addr = (uint32_t *)malloc((size_t)n_lookups * sizeof(uint32_t));
+    if (!tab || !addr) return 1;
+
+    for (int i = 0; i < n_routes; i++)
+        tab[i] = rand_prefix();
+    for (int i = 0; i < n_lookups; i++)
+        addr[i] = ((1u + rng() % 223) << 24) | (rng() & 0x00FFFFFFu);
+
+    route_init();
+    route_tcam_region(0, 0);
+
+    // 256 个下一跳，按前缀轮流分配
+    int fail = 0;
+    double t0 = now_s();
+    for (int i = 0; i < n_routes; i++)
+        fail += route_add(tab[i].pfx, tab[i].len, (uint8_t)(i % 32),
+                          0x020000000000ULL | (uint64_t)(i & 0xFF)) != HAL_OK;
+    double t_add = now_s() - t0;
+
+    route_stats_t st;
+    route_get_stats(&st);
+
+    int hits = 0;
+    route_info_t ri;
+    t0 = now_s();
+    for (int i = 0; i < n_lookups; i++)
+        hits += route_lookup(addr[i], &ri) == HAL_OK;
+    double t_lookup = now_s() - t0;
+
+    // 乱序删除
+    for (int i = n_routes - 1; i > 0; i--) {
+        int j = (int)(rng() % (uint32_t)(i + 1));
+        pfx_t tmp = tab[i]; tab[i] = tab[j]; tab[j] = tmp;
+    }
+    t0 = now_s();
+    for (int i = 0; i < n_routes; i++)
+        route_del(tab[i].pfx, tab[i].len);
+    double t_del = now_s() - t0;
+
+    route_stats_t end;
+    route_get_stats(&end);
+
+    run_t runs[3] = {
+        { "add",    t_add    * 1e9 / n_routes,  n_routes  / t_add    / 1e6 },
+        { "lookup", t_lookup * 1e9 / n_lookups, n_lookups / t_lookup / 1e6 },
+        { "del",    t_del    * 1e9 / n_routes,  n_routes  / t_del    / 1e6 },
+    };
+    printf("\nbench_rib: %d prefixes requested (%u distinct, %d failed), %d lookups\n\n",
+           n_routes, st.routes, fail, n_lookups);
+    printf("  %-10s %12s %10s\n", "op", "ns/op", "Mops");
+    for (int i = 0; i < 3; i++)
+        printf("  %-10s %12.1f %10.2f\n", runs[i].name, runs[i].ns, runs[i].mops);
+    printf("\n  nodes %u / %u (%.2f per route, %.1f MB at %d B/node), next hops %u, "
+           "lookup hit %.1f%%\n",
+           st.nodes, st.nodes_max, st.routes ? (double)st.nodes / st.routes : 0.0,
+           (double)st.nodes * NODE_BYTES / 1048576.0, NODE_BYTES, st.next_hops,
+           100.0 * hits / n_lookups);
+    printf("  after delete: %u routes, %u nodes, %u next hops\n",
+           end.routes, end.nodes, end.next_hops);
+
+    free(tab);
+    free(addr);
+    if (end.routes || end.nodes != 1 || end.next_hops) return 1;
+
+    tcam_run_t tc;
+    if (bench_tcam(n_slots, n_churn, &tc) != 0) return 1;
+    return json ? (write_json(json, &cfg, runs, 3, &st, fail, (double)hits / n_lookups, &tc) != 0) : 0;
+}
@@ -0,0 +1,399 @@
+// bench_tue.c
+// 路由下发吞吐：route_add / route_del 逐条 vs route_add_bulk / route_del_bulk
+//
+// 用法：./bench_tue [--routes N] [--seed S] [--wr-lat N] [--fifo N] [--legacy]
+//                   [--json FILE]
+//   --routes   装入的前缀数（默认 1842 = Stage 0 路由区间 2047 条的 90%）
+//   --seed     随机种子
+//   --wr-lat   APB 写从发出到在 TUE 生效的 clk_ctrl 周期数（默认 4，posted write）
+//   --fifo     TUE 批量暂存 FIFO 深度（tue.sv BATCH_DEPTH，默认 64，≤ HAL_TCAM_BATCH_MAX；
+//              0 = rv_p4_top 默认配置，开批被忽略，HAL 逐条提交）
+//   --legacy   按旧 tue.sv 建模：COMMIT / BATCH 是单周期脉冲，只在 TS_IDLE 接收，
+//              STATUS 不反映未接收的请求（用于复现批满重开丢失 / 提前返回）
+//   --json     把结果写成 JSON（外层结构同 bench_fwd）
+//
+// 链接 route.c 与真实 HAL（../../hal/rv_p4_hal.c，-DHAL_MMIO_HOOK），MMIO 由本文件
+// 的 TUE 周期模型接管，逐个 clk_ctrl（200 MHz）推进 tue.sv 的事务状态机：
+//   - APB 读 / 写各 3 cycles（setup + access + 空闲，同 tb_tue.sv）；写入在 --wr-lat
+//     周期后才落到寄存器 / 挂起请求，读在访问结束时采样 STATUS；
+//   - 单条 COMMIT：TS_IDLE 接收 → WAIT_DRAIN 33 → APPLY → DONE 1 cycle → IDLE；
+//   - 批量：COMMIT 只入队；BATCH 写 0 后排空一次，每条再加 TUE_APPLY_GAP = 4。
+// 条目在状态机 apply 的那一拍才写入模型 TCAM；每轮结束时不再推进时间，直接与
+// route_tcam_slot() 逐条核对 —— HAL 若在条目生效前返回，或重开批的请求丢失，
+// 核对即失败。
+// routes/s 只按 TUE 模型时间（APB 访问 + 排空 + apply）计算；host 列是本进程
+// 的墙钟时间（含寄存器模型本身），仅供参考，RIB 计算开销见 bench_rib。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "route.h"
+
+#define CTRL_MHZ        200.0
+#define APB_CYC         3
+#define TUE_DRAIN       32
+#define TUE_APPLY_GAP   4
+#define WR_Q_MAX        64
+
+// ─────────────────────────────────────────────
+// TUE 周期模型（tue.sv 事务状态机）
+// ─────────────────────────────────────────────
+
+typedef struct {
+    uint32_t cmd, stage, table_id, key0;
+} tue_op_t;
+
+enum { TS_IDLE, TS_WAIT_DRAIN, TS_APPLY, TS_DONE, TS_BATCH };
+
+static struct {
+    tue_op_t reg;                       // 寄存器组
+    tue_op_t q[HAL_TCAM_BATCH_MAX];
+    int      ts, drain, status, gap;
+    int      batch_open, batch_run, batch_cnt, batch_idx;
+    int      commit_pend, open_pend, close_pend;
+} tue;
+
+// 已发出、尚未生效的 APB 写（按发出顺序生效）
+static struct { uint64_t eff; uint32_t off, val; } wr_q[WR_Q_MAX];
+static int wr_head, wr_n;
+
+static int      wr_lat = 4, legacy;
+static int      fifo_depth = HAL_TCAM_BATCH_MAX;
+static uint64_t cyc;
+static uint64_t n_apb_wr, n_apb_rd, n_drain;
+
+// Stage 0 条目：valid + key 首字
+static uint8_t  s0_valid[65536];
+static uint32_t s0_key[65536];
+
+static void tue_apply(const tue_op_t *op) {
+    if (op->stage != 0) return;
+    if (op->cmd == TUE_CMD_INSERT || op->cmd == TUE_CMD_MODIFY) {
+        s0_valid[op->table_id & 0xFFFF] = 1;
+        s0_key[op->table_id & 0xFFFF]   = op->key0;
+    } else if (op->cmd == TUE_CMD_DELETE) {
+        s0_valid[op->table_id & 0xFFFF] = 0;
+    } else {
+        memset(s0_valid, 0, sizeof(s0_valid));
+    }
+}
+
+// 一个 clk_ctrl 上升沿：先按上一拍的值推进状态机，再落本拍生效的 APB 写
+static void tue_edge(void) {
+    cyc++;
+    switch (tue.ts) {
+    case TS_IDLE:
+        if (tue.close_pend) {
+            tue.close_pend = 0;
+            if (tue.batch_open && tue.batch_cnt) {
+                tue.batch_run = 1;
+                tue.batch_idx = 0;
+                tue.ts        = TS_WAIT_DRAIN;
+                tue.drain     = TUE_DRAIN;
+                tue.status    = TUE_STATUS_BUSY;
+                n_drain++;
+            }
+            tue.batch_open = 0;
+        } else if (tue.open_pend) {
+            tue.open_pend  = 0;
+            tue.batch_open = fifo_depth > 0;
+            tue.batch_cnt  = 0;
+            tue.status     = TUE_STATUS_IDLE;
+        } else if (tue.commit_pend && tue.batch_open) {
+            tue.commit_pend = 0;
+            if (tue.batch_cnt == fifo_depth) tue.status = TUE_STATUS_ERROR;
+            else tue.q[tue.batch_cnt++] = tue.reg;
+        } else if (tue.commit_pend) {
+            tue.commit_pend = 0;
+            tue.ts     = TS_WAIT_DRAIN;
+            tue.drain  = TUE_DRAIN;
+            tue.status = TUE_STATUS_BUSY;
+            n_drain++;
+        }
+        break;
+    case TS_WAIT_DRAIN:
+        if (tue.drain) tue.drain--;
+        else if (tue.batch_run) { tue.ts = TS_BATCH; tue.gap = 0; }
+        else { tue.ts = TS_APPLY; tue_apply(&tue.reg); }
+        break;
+    case TS_BATCH:
+        if (tue.gap) tue.gap--;
+        else if (tue.batch_idx == tue.batch_cnt) {
+            tue.batch_run = 0;
+            tue.ts        = TS_DONE;
+            tue.status    = TUE_STATUS_DONE;
+        } else {
+            tue_apply(&tue.q[tue.batch_idx++]);
+            tue.gap = TUE_APPLY_GAP - 1;
+        }
+        break;
+    case TS_APPLY:
+        tue.ts     = TS_DONE;
+        tue.status = TUE_STATUS_DONE;
+        break;
+    case TS_DONE:
+        tue.ts     = TS_IDLE;
+        tue.status = TUE_STATUS_IDLE;
+        break;
+    }
+    // 旧 RTL：请求是单周期脉冲，状态机这一拍没接收就丢失
+    if (legacy) tue.commit_pend = tue.open_pend = tue.close_pend = 0;
+
+    while (wr_n && wr_q[wr_head].eff <= cyc) {
+        uint32_t off = wr_q[wr_head].off, val = wr_q[wr_head].val;
+        wr_head = (wr_head + 1) % WR_Q_MAX;
+        wr_n--;
+        switch (off) {
+        case TUE_REG_CMD:      tue.reg.cmd      = val; break;
+        case TUE_REG_STAGE:    tue.reg.stage    = val; break;
+        case TUE_REG_TABLE_ID: tue.reg.table_id = val; break;
+        case TUE_REG_KEY_BASE: tue.reg.key0     = val; break;
+        case TUE_REG_COMMIT:   if (val & 1) tue.commit_pend = 1; break;
+        case TUE_REG_BATCH:
+            if (val & 1) tue.open_pend  = 1;
+            else         tue.close_pend = 1;
+            break;
+        default: break;
+        }
+    }
+}
+
+static void tue_run(int n) {
+    while (n--) tue_edge();
+}
+
+static uint32_t tue_status_rd(void) {
+    if (!legacy && (tue.close_pend || (tue.commit_pend && !tue.batch_open && !tue.open_pend)))
+        return TUE_STATUS_BUSY;
+    return (uint32_t)tue.status;
+}
+
+void hal_mmio_wr32(uintptr_t addr, uint32_t val) {
+    uint32_t off = (uint32_t)(addr - HAL_BASE_TUE);
+    tue_run(APB_CYC);
+    n_apb_wr++;
+    if (addr < HAL_BASE_TUE || off >= 0x100) return;
+    while (wr_n == WR_Q_MAX) tue_edge();
+    int t = (wr_head + wr_n++) % WR_Q_MAX;
+    wr_q[t].eff = cyc + (uint64_t)wr_lat;
+    wr_q[t].off = off;
+    wr_q[t].val = val;
+}
+
+uint32_t hal_mmio_rd32(uintptr_t addr) {
+    tue_run(APB_CYC);
+    n_apb_rd++;
+    if (addr == HAL_BASE_TUE + TUE_REG_BATCH)
+        return ((uint32_t)tue.batch_cnt << 16) | ((uint32_t)fifo_depth << 8) |
+               (uint32_t)tue.batch_open;
+    if (addr != HAL_BASE_TUE + TUE_REG_STATUS) return 0;
+    return tue_status_rd();
+}
+
+// ─────────────────────────────────────────────
+// 工具
+// ─────────────────────────────────────────────
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// 前缀长度分布（千分比，与 bench_rib.c 相同）
+static const uint16_t len_permille[25] = {
+    [8] = 1, [9] = 1, [10] = 1, [11] = 2, [12] = 3, [13] = 5, [14] = 8, [15] = 10,
+    [16] = 14, [17] = 8, [18] = 13, [19] = 28, [20] = 45, [21] = 50, [22] = 120,
+    [23] = 100, [24] = 591,
+};
+
+static route_entry_t rand_route(uint32_t i)
+{
+    uint32_t r = rng() % 1000, acc = 0;
+    uint8_t len = 24;
+    for (int l = 8; l <= 24; l++) {
+        acc += len_permille[l];
+        if (r < acc) { len = (uint8_t)l; break; }
+    }
+    uint32_t a = rng();
+    a = (((1u + (a >> 24) % 223) << 24) | (a & 0x00FFFFFFu));
+    route_entry_t e = { a & (0xFFFFFFFFu << (32 - len)), len,
+                        (uint8_t)(i % 32), 0x020000000000ULL | (i & 0xFF) };
+    return e;
+}
+
+typedef struct {
+    double   host_s;
+    uint64_t cyc, apb_wr, apb_rd, drain;
+} run_t;
+
+// 两轮之间让模型跑完已发出的写入（不计入下一轮）
+static void tue_settle(void)
+{
+    while (wr_n || tue.ts != TS_IDLE) tue_edge();
+}
+
+static void run_begin(run_t *r)
+{
+    tue_settle();
+    r->cyc = cyc; r->apb_wr = n_apb_wr; r->apb_rd = n_apb_rd; r->drain = n_drain;
+    r->host_s = now_s();
+}
+
+static void run_end(run_t *r)
+{
+    r->host_s = now_s() - r->host_s;
+    r->cyc    = cyc - r->cyc;
+    r->apb_wr = n_apb_wr - r->apb_wr;
+    r->apb_rd = n_apb_rd - r->apb_rd;
+    r->drain  = n_drain - r->drain;
+}
+
+static void run_print(const char *name, const run_t *r, int n)
+{
+    double tue_s = (double)r->cyc / (CTRL_MHZ * 1e6);
+    printf("  %-12s %9.1f %9.1f %8llu %10.1f %10.1f %12.0f\n", name,
+           (double)r->apb_wr / n, (double)r->apb_rd / n, (unsigned long long)r->drain,
+           tue_s * 1e6, r->host_s * 1e6, n / tue_s);
+}
+
+static const char *run_name[4] = { "add", "del", "add_bulk", "del_bulk" };
+
+static int write_json(const char *path, int n, uint64_t seed, const run_t *r, int bad)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return -1; }
+
+    fprintf(f, "{\n  \"bench\": \"bench_tue\",\n  \"schema\": 1,\n");
+    fprintf(f, "  \"config\": {\"routes\": %d, \"seed\": %llu, \"wr_lat\": %d, \"fifo\": %d, "
+               "\"legacy\": %s, \"clk_ctrl_mhz\": %.0f},\n",
+            n, (unsigned long long)seed, wr_lat, fifo_depth, legacy ? "true" : "false", CTRL_MHZ);
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < 4; i++) {
+        double tue_s = (double)r[i].cyc / (CTRL_MHZ * 1e6);
+        fprintf(f, "    {\"name\": \"%s\", \"apb_wr_per_route\": %.2f, \"apb_rd_per_route\": %.2f, "
+                   "\"drains\": %llu, \"tue_us\": %.1f, \"routes_per_s\": %.0f}%s\n",
+                run_name[i], (double)r[i].apb_wr / n, (double)r[i].apb_rd / n,
+                (unsigned long long)r[i].drain, tue_s * 1e6, n / tue_s, i < 3 ? "," : "");
+    }
+    fprintf(f, "  ],\n  \"speedup\": {\"add\": %.2f, \"del\": %.2f},\n",
+            (double)r[0].cyc / r[2].cyc, (double)r[1].cyc / r[3].cyc);
+    fprintf(f, "  \"tcam_matches_rib\": %s\n}\n", bad ? "false" : "true");
+    return fclose(f);
+}
+
+// TCAM 模型与 RIB 一致：每条路由在其 slot 上，且 Stage 0 共 expect 条
+static int verify(const route_entry_t *tab, int n, int expect)
+{
+    int valid = 0;
+    for (uint32_t t = 0; t < 65536; t++) valid += s0_valid[t];
+    if (valid != expect) return -1;
+    for (int i = 0; i < n && expect; i++) {
+        int slot = route_tcam_slot(tab[i].prefix, tab[i].len);
+        if (slot < 0 || !s0_valid[slot]) return -1;
+        uint32_t k = s0_key[slot];      // 小端打包的 key 前 4 字节（大端 IPv4）
+        uint32_t pfx = (k >> 24) | ((k >> 8) & 0xFF00u) | ((k << 8) & 0xFF0000u) | (k << 24);
+        if (pfx != tab[i].prefix) return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int n_routes = ROUTE_TCAM_SLOTS * 9 / 10;
+    const char *json = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--routes") && i + 1 < argc) n_routes  = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed")   && i + 1 < argc) rng_state = strtoull(argv[++i], NULL, 0) | 1;
+        else if (!strcmp(argv[i], "--wr-lat") && i + 1 < argc) wr_lat    = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--fifo")   && i + 1 < argc) fifo_depth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--legacy"))                 legacy    = 1;
+        else if (!strcmp(argv[i], "--json")   && i + 1 < argc) json      = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--routes N] [--seed S] [--wr-lat N] [--fifo N] [--legacy] "
+                    "[--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (fifo_depth < 0 || fifo_depth > HAL_TCAM_BATCH_MAX) {
+        fprintf(stderr, "--fifo must be 0..%d\n", HAL_TCAM_BATCH_MAX);
+        return 2;
+    }
+    if (n_routes < 1) n_routes = 1;
+    if (n_routes > ROUTE_TCAM_SLOTS) n_routes = ROUTE_TCAM_SLOTS;
+    uint64_t seed = rng_state;
+
+    // 不重复的前缀
+    route_entry_t *tab = (route_entry_t *)malloc((size_t)n_routes * sizeof(route_entry_t));
+    if (!tab) return 1;
+    route_init();
+    route_tcam_region(0, 0);
+    for (int n = 0; n < n_routes; ) {
+        route_entry_t e = rand_route((uint32_t)n);
+        route_stats_t st;
+        route_add(e.prefix, e.len, e.port, e.dmac);
+        route_get_stats(&st);
+        if (st.routes > (uint32_t)n) tab[n++] = e;
+    }
+
+    run_t r[4];
+    int   bad = 0;
+
+    // 逐条
+    route_init();
+    run_begin(&r[0]);
+    for (int i = 0; i < n_routes; i++)
+        bad += route_add(tab[i].prefix, tab[i].len, tab[i].port, tab[i].dmac) != HAL_OK;
+    run_end(&r[0]);
+    bad += verify(tab, n_routes, n_routes) != 0;
+
+    run_begin(&r[1]);
+    for (int i = 0; i < n_routes; i++)
+        bad += route_del(tab[i].prefix, tab[i].len) != HAL_OK;
+    run_end(&r[1]);
+    bad += verify(tab, 0, 0) != 0;
+
+    // 批量
+    route_init();
+    run_begin(&r[2]);
+    bad += route_add_bulk(tab, n_routes) != n_routes;
+    run_end(&r[2]);
+    bad += verify(tab, n_routes, n_routes) != 0;
+
+    run_begin(&r[3]);
+    bad += route_del_bulk(tab, n_routes) != n_routes;
+    run_end(&r[3]);
+    bad += verify(tab, 0, 0) != 0;
+
+    route_stats_t st;
+    route_get_stats(&st);
+    printf("\nbench_tue: %d routes into Stage 0 (%d slots), clk_ctrl %.0f MHz, "
+           "%d entries per TUE batch\n\n", n_routes, ROUTE_TCAM_SLOTS, CTRL_MHZ,
+           fifo_depth);
+    printf("  %-12s %9s %9s %8s %10s %10s %12s\n",
+           "op", "APB wr/rt", "APB rd/rt", "drains", "TUE us", "host us", "routes/s");
+    for (int i = 0; i < 4; i++)
+        run_print(run_name[i], &r[i], n_routes);
+    printf("\n  TCAM writes per route: add %.2f, del %.2f; bulk speedup add %.1fx, del %.1fx\n",
+           (double)r[0].drain / n_routes, (double)r[1].drain / n_routes,
+           (double)r[0].cyc / r[2].cyc, (double)r[1].cyc / r[3].cyc);
+    printf("  TCAM model %s at return (write latency %d cycles, %s TUE)\n",
+           bad ? "MISMATCH" : "matches RIB", wr_lat, legacy ? "legacy" : "sticky-request");
+
+    free(tab);
+    if (json && write_json(json, n_routes, seed, r, bad) != 0) return 1;
+    return bad ? 1 : 0;
+}
@@ -10,8 +10,9 @@
 //   arp   add <ip> <mac> <port> [<vlan>]
 //         del <ip>
 //         probe <ip> <port> [<vlan>]
-//   route add <ip/len> <port> <mac>
+//   route add <ip/len> <port> <mac> | add <ip/len> ecmp <group>
 //         del <ip/len>
+//         ecmp <group> add|del <port> <mac>
 //   acl   deny <src/len> <dst/len> [<dport>]
 //         permit <src/len> <dst/len>
 //         del <rule_id>
@@ -301,8 +302,19 @@ static int cmd_route(int argc, char **argv) {
     if (argc < 2) goto route_usage;
 
     if (strcmp(argv[1], "add") == 0) {
-        /* route add <ip/len> <port> <mac> */
+        /* route add <ip/len> <port> <mac> | route add <ip/len> ecmp <group> */
         if (argc < 5) goto route_usage;
+        if (strcmp(argv[3], "ecmp") == 0) {
+            uint32_t ip, grp;
+            uint8_t  len;
+            if (parse_prefix(argv[2], &ip, &len) < 0 || parse_u32(argv[4], &grp) < 0) {
+                printf("route add: parse error\n"); return 1;
+            }
+            int r = route_ecmp_add(ip, len, (uint16_t)grp);
+            if (r == HAL_OK) printf("Route added\n");
+            else             printf("route add failed: %d\n", r);
+            return 1;
+        }
         uint32_t ip, port;
         uint8_t  len;
         uint64_t dmac;
@@ -325,6 +337,23 @@ static int cmd_route(int argc, char **argv) {
         int r = route_del(ip, len);
         if (r == HAL_OK) printf("Route deleted\n");
         else             printf("route del failed: %d\n", r);
+
+    } else if (strcmp(argv[1], "ecmp") == 0) {
+        /* route ecmp <group> add|del <port> <mac> */
+        if (argc < 6) goto route_usage;
+        uint32_t grp, port;
+        uint64_t dmac;
+        int      add = strcmp(argv[3], "add") == 0;
+        if (parse_u32(argv[2], &grp) < 0 ||
+            (!add && strcmp(argv[3], "del") != 0) ||
+            parse_u32(argv[4], &port) < 0 || port >= 32 ||
+            parse_mac(argv[5], &dmac) < 0) {
+            printf("route ecmp: parse error\n"); return 1;
+        }
+        int r = add ? route_ecmp_member_add((uint16_t)grp, (uint8_t)port, dmac)
+                    : route_ecmp_member_del((uint16_t)grp, (uint8_t)port, dmac);
+        if (r == HAL_OK) printf("ECMP group %u: member %s\n", grp, add ? "added" : "removed");
+        else             printf("route ecmp failed: %d\n", r);
     } else {
         goto route_usage;
     }
@@ -333,7 +362,9 @@ static int cmd_route(int argc, char **argv) {
 route_usage:
     printf("Usage:\n"
            "  route add <ip/len> <port> <mac>\n"
-           "  route del <ip/len>\n");
+           "  route add <ip/len> ecmp <group>\n"
+           "  route del <ip/len>\n"
+           "  route ecmp <group> add|del <port> <mac>\n");
     return 1;
 }
 
@@ -544,6 +575,7 @@ static int cmd_help(int argc, char **argv) {
         "arp    add <ip> <mac> <port> [<vlan>]\n"
         "       del <ip> | probe <ip> <port> [<vlan>]\n"
         "route  add <ip/len> <port> <mac> | del <ip/len>\n"
+        "       add <ip/len> ecmp <grp> | ecmp <grp> add|del <port> <mac>\n"
         "acl    deny <src/len> <dst/len> [<dport>]\n"
         "       permit <src/len> <dst/len> | del <rule_id>\n"
         "qos    weight <port> <q0..q7>\n"
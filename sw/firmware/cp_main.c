@@ -1,7 +1,11 @@
 // cp_main.c
 // 控制面固件主文件
 // 初始化所有模块，主循环处理 Punt RX 包 + CLI 轮询 + 定时任务
+//
+// 主循环的各步拆成 cp_init / cp_punt_poll / cp_tick_100ms（见 cp_main.h），
+// host 仿真可定义 CP_NO_MAIN 后在独立线程中驱动同一套慢路径。
 
+#include "cp_main.h"
 #include "rv_p4_hal.h"
 #include "table_map.h"
 #include "vlan.h"
@@ -33,17 +37,17 @@ static void print_port_stats(uint8_t port) {
 }
 
 // ─────────────────────────────────────────────
-// 主函数
+// 初始化
 // ─────────────────────────────────────────────
 
-int main(void) {
+int cp_init(void) {
     int ret;
 
     // ── 初始化 HAL ──────────────────────────────
     ret = hal_init();
     if (ret != HAL_OK) {
         printf("HAL init failed: %d\n", ret);
-        return 1;
+        return ret;
     }
 
     // 使能所有端口
@@ -123,41 +127,71 @@ int main(void) {
 
     // ── CLI 初始化 ──────────────────────────────
     cli_init();
+    return HAL_OK;
+}
 
-    // ── 主循环 ────────────────────────────────
-    uint32_t tick     = 0;
-    uint32_t sec_tick = 0;
+// ─────────────────────────────────────────────
+// 主循环各步
+// ─────────────────────────────────────────────
+
+int cp_punt_poll(void) {
+    punt_pkt_t pkts[CP_PUNT_BURST];
+    int total = 0, n;
+
+    /* 按批取包：每批只推进一次 RX 消费指针 */
+    while ((n = hal_punt_rx_poll_burst(pkts, CP_PUNT_BURST)) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (pkts[i].reason == PUNT_REASON_ARP)
+                arp_process_pkt(&pkts[i]);
+        }
+        total += n;
+    }
+    return total;
+}
+
+void cp_tick_100ms(void) {
+    static uint32_t tick     = 0;
+    static uint32_t sec_tick = 0;
+
+    tick++;
+
+    /* ── 1 秒周期任务 ────────────────────── */
+    if (tick % 10 == 0) {
+        sec_tick++;
+        arp_age(sec_tick);
+        fdb_age(sec_tick);
+
+        /* ── 60 秒周期：打印统计 ─────────── */
+        if (sec_tick % 60 == 0) {
+            printf("=== Port Stats (t=%us) ===\n", sec_tick);
+            for (int p = 0; p < 4; p++)
+                print_port_stats((uint8_t)p);
+        }
+    }
+}
+
+// ─────────────────────────────────────────────
+// 主函数
+// ─────────────────────────────────────────────
+
+#ifndef CP_NO_MAIN
+int main(void) {
+    if (cp_init() != HAL_OK)
+        return 1;
 
     while (1) {
         /* 简化延时（实际应使用定时器中断） */
         for (volatile int i = 0; i < 100000; i++);
 
         /* ── 处理 Punt RX 包 ─────────────────── */
-        punt_pkt_t pkt;
-        while (hal_punt_rx_poll(&pkt) == HAL_OK) {
-            if (pkt.reason == PUNT_REASON_ARP)
-                arp_process_pkt(&pkt);
-        }
+        cp_punt_poll();
 
         /* ── CLI 轮询 ────────────────────────── */
         cli_poll();
 
-        tick++;
-
-        /* ── 1 秒周期任务 ────────────────────── */
-        if (tick % 10 == 0) {
-            sec_tick++;
-            arp_age(sec_tick);
-            fdb_age(sec_tick);
-
-            /* ── 60 秒周期：打印统计 ─────────── */
-            if (sec_tick % 60 == 0) {
-                printf("=== Port Stats (t=%us) ===\n", sec_tick);
-                for (int p = 0; p < 4; p++)
-                    print_port_stats((uint8_t)p);
-            }
-        }
+        cp_tick_100ms();
     }
 
     return 0;
 }
+#endif
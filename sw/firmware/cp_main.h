@@ -0,0 +1,28 @@
+// cp_main.h
+// 控制面固件主循环的分步接口
+//
+// 固件 main() 依次调用 cp_init()，再循环执行 cp_punt_poll() / cli_poll() /
+// cp_tick_100ms()。host 仿真以 -DCP_NO_MAIN 编译 cp_main.c，在独立线程中
+// 调用同样的步骤（Punt 环为无锁 SPSC，见 test/spsc_ring.h）。
+
+#ifndef CP_MAIN_H
+#define CP_MAIN_H
+
+#define CP_PUNT_BURST   16      // 每批收包数（= PUNT_RING_SLOTS）
+
+/**
+ * cp_init - 初始化 HAL 与全部模块，写入默认配置
+ * 返回 HAL_OK 或 hal_init() 的错误码。
+ */
+int cp_init(void);
+
+/**
+ * cp_punt_poll - 收空 Punt RX 环并分发给各模块（当前只有 ARP）
+ * 返回本次处理的包数。
+ */
+int cp_punt_poll(void);
+
+/** cp_tick_100ms - 100 ms 定时任务：每秒 ARP / FDB 老化，每分钟打印端口统计 */
+void cp_tick_100ms(void);
+
+#endif /* CP_MAIN_H */
@@ -1,39 +1,76 @@
 // fdb.c
 // L2 FDB 管理实现
-// 软件表：256 槽线性扫描；TCAM：Stage 2，table_id = dmac & 0xFFF
+// 软件表：4 路分桶 cuckoo 哈希，键 (MAC, VLAN)；TCAM：Stage 2，table_id = 基址 + 槽号
 
 #include "fdb.h"
 #include "table_map.h"
 #include <string.h>
 #include <stdio.h>
 
+#if (FDB_BUCKETS & (FDB_BUCKETS - 1)) || FDB_BUCKETS < 2
+#error "FDB_TABLE_SIZE / FDB_WAYS must be a power of two >= 2"
+#endif
+
+// RTL 承载 Stage 2 时（固件、cosim）槽号必须落在 TCAM 深度内，否则 table_id 混叠
+#if !defined(SIM_TCAM_HOST) && (TABLE_L2_FDB_BASE + FDB_TABLE_SIZE > HAL_TCAM_DEPTH)
+#error "TABLE_L2_FDB_BASE + FDB_TABLE_SIZE exceeds the Stage 2 TCAM (HAL_TCAM_DEPTH)"
+#endif
+
+#define FDB_BFS_MAX   1024    // 搬移路径搜索队列（8 × (1 + 4 + 16 + 64) = 680 足够）
+
 // ─────────────────────────────────────────────
 // 软件状态
 // ─────────────────────────────────────────────
-static fdb_entry_t fdb_table[FDB_TABLE_SIZE];
+static fdb_entry_t fdb_table[FDB_TABLE_SIZE];   // 槽 s 属于桶 s / FDB_WAYS
+static uint32_t    fdb_entries, fdb_moves, fdb_full;
+
+// BFS 节点：槽号 + 父节点下标（-1 = 起点桶内的槽）
+typedef struct {
+    int32_t slot;
+    int16_t parent;
+    uint8_t depth;
+} fdb_bfs_t;
+
+static fdb_bfs_t fdb_bfs[FDB_BFS_MAX];
 
 // ─────────────────────────────────────────────
 // 内部工具
 // ─────────────────────────────────────────────
 
-static fdb_entry_t *fdb_find(uint64_t dmac) {
-    for (int i = 0; i < FDB_TABLE_SIZE; i++) {
-        if (fdb_table[i].valid && fdb_table[i].dmac == dmac)
-            return &fdb_table[i];
-    }
-    return NULL;
+/* (MAC, VLAN) → 两个候选桶：64-bit 混合（murmur3 fmix64）的低 / 高半 */
+static void fdb_buckets(uint64_t dmac, uint16_t vlan, uint32_t b[2]) {
+    uint64_t h = ((dmac & 0xFFFFFFFFFFFFULL) << 12) | (vlan & 0xFFFu);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    b[0] = (uint32_t)h & (FDB_BUCKETS - 1);
+    b[1] = (uint32_t)(h >> 32) & (FDB_BUCKETS - 1);
+    if (b[1] == b[0]) b[1] = b[0] ^ 1u;     // 保证两个桶不同
 }
 
-static fdb_entry_t *fdb_alloc(void) {
-    for (int i = 0; i < FDB_TABLE_SIZE; i++) {
-        if (!fdb_table[i].valid)
-            return &fdb_table[i];
+static int fdb_find(uint64_t dmac, uint16_t vlan) {
+    uint32_t b[2];
+    fdb_buckets(dmac, vlan, b);
+    for (int i = 0; i < 2; i++) {
+        for (int w = 0; w < FDB_WAYS; w++) {
+            int s = (int)(b[i] * FDB_WAYS) + w;
+            if (fdb_table[s].valid && fdb_table[s].dmac == dmac && fdb_table[s].vlan == vlan)
+                return s;
+        }
     }
-    return NULL;
+    return -1;
+}
+
+static uint16_t fdb_tid(int slot) {
+    return (uint16_t)(TABLE_L2_FDB_BASE + slot);
 }
 
-/* 将 MAC→port 规则写入 Stage 2 TCAM（精确匹配） */
-static int fdb_install_tcam(uint64_t dmac, uint8_t port) {
+/* 将槽上的 MAC→port 规则写入 Stage 2 TCAM（精确匹配） */
+static int fdb_install_tcam(int slot) {
+    const fdb_entry_t *f = &fdb_table[slot];
+    uint64_t dmac = f->dmac;
     tcam_entry_t e;
     memset(&e, 0, sizeof(e));
 
@@ -49,78 +86,189 @@ static int fdb_install_tcam(uint64_t dmac, uint8_t port) {
     memset(e.mask.bytes, 0xFF, 6);   // 精确匹配全部 6 字节
 
     e.stage             = TABLE_L2_FDB_STAGE;
-    e.table_id          = TABLE_L2_FDB_BASE + (uint16_t)(dmac & 0xFFF);
+    e.table_id          = fdb_tid(slot);
     e.action_id         = ACTION_L2_FORWARD;
-    e.action_params[0]  = port;
+    e.action_params[0]  = f->port;
 
     return hal_tcam_insert(&e);
 }
 
-// ─────────────────────────────────────────────
-// 公共 API 实现
-// ─────────────────────────────────────────────
+static int fdb_free_way(uint32_t bucket) {
+    for (int w = 0; w < FDB_WAYS; w++) {
+        int s = (int)(bucket * FDB_WAYS) + w;
+        if (!fdb_table[s].valid) return s;
+    }
+    return -1;
+}
 
-void fdb_init(void) {
-    memset(fdb_table, 0, sizeof(fdb_table));
+/* 槽 s 已在节点 n 的祖先链上（路径不能两次经过同一槽） */
+static int fdb_on_path(int n, int32_t s) {
+    for (; n >= 0; n = fdb_bfs[n].parent)
+        if (fdb_bfs[n].slot == s) return 1;
+    return 0;
 }
 
-int fdb_learn(uint64_t dmac, uint8_t port) {
-    fdb_entry_t *e = fdb_find(dmac);
-    if (e) {
-        /* 已存在：更新端口并刷新 age */
-        e->port      = port;
-        e->age_ticks = 0;
-    } else {
-        e = fdb_alloc();
-        if (!e) return HAL_ERR_FULL;
-        e->dmac      = dmac;
-        e->port      = port;
-        e->vlan      = 0;
-        e->age_ticks = 0;
-        e->is_static = 0;
-        e->valid     = 1;
+/*
+ * 为新键腾出 b[0] / b[1] 中的一个槽：BFS 找最短搬移路径，从路径末端起
+ * 逐条把条目挪到它的另一个候选桶（先写新位置 TCAM，旧位置留给下一步覆盖）。
+ * 返回腾出的槽号（软件为空，TCAM 上可能残留被挪走条目的副本，由调用者覆盖）；
+ * 找不到路径返回 HAL_ERR_FULL（表不变），TCAM 写入失败返回其错误码。
+ */
+static int fdb_make_room(const uint32_t b[2]) {
+    int head = 0, tail = 0;
+    for (int i = 0; i < 2; i++) {
+        for (int w = 0; w < FDB_WAYS; w++) {
+            fdb_bfs_t n = { (int32_t)(b[i] * FDB_WAYS) + w, -1, 1 };
+            fdb_bfs[tail++] = n;
+        }
+    }
+
+    while (head < tail) {
+        int       n   = head++;
+        int32_t   s   = fdb_bfs[n].slot;
+        uint32_t  alt[2];
+        fdb_buckets(fdb_table[s].dmac, fdb_table[s].vlan, alt);
+        uint32_t  ab  = ((uint32_t)s / FDB_WAYS == alt[0]) ? alt[1] : alt[0];
+
+        int dst = fdb_free_way(ab);
+        if (dst >= 0) {
+            // 沿路径倒序搬移：n 的条目 → dst，父节点的条目 → n 的槽，……
+            for (int first = 1; n >= 0; n = fdb_bfs[n].parent, first = 0) {
+                int src = fdb_bfs[n].slot;
+                fdb_table[dst] = fdb_table[src];
+                int rc = fdb_install_tcam(dst);
+                if (rc != HAL_OK) {
+                    fdb_table[dst].valid = 0;
+                    // 非首步的 dst 上还有上一步挪走条目的旧副本，尽力撤销
+                    if (!first) hal_tcam_delete(TABLE_L2_FDB_STAGE, fdb_tid(dst));
+                    return rc;
+                }
+                fdb_table[src].valid = 0;
+                fdb_moves++;
+                dst = src;
+            }
+            return dst;
+        }
+
+        if (fdb_bfs[n].depth >= FDB_CUCKOO_DEPTH) continue;
+        for (int w = 0; w < FDB_WAYS && tail < FDB_BFS_MAX; w++) {
+            int32_t c = (int32_t)(ab * FDB_WAYS) + w;
+            if (fdb_on_path(n, c)) continue;
+            fdb_bfs_t child = { c, (int16_t)n, (uint8_t)(fdb_bfs[n].depth + 1) };
+            fdb_bfs[tail++] = child;
+        }
     }
-    return fdb_install_tcam(dmac, port);
+    return HAL_ERR_FULL;
 }
 
-int fdb_add_static(uint64_t dmac, uint8_t port, uint16_t vlan) {
-    fdb_entry_t *e = fdb_find(dmac);
-    if (!e) {
-        e = fdb_alloc();
-        if (!e) return HAL_ERR_FULL;
+/* 学习 / 静态添加的公共路径 */
+static int fdb_insert(uint64_t dmac, uint16_t vlan, uint8_t port, uint8_t is_static) {
+    dmac &= 0xFFFFFFFFFFFFULL;
+    vlan &= 0xFFFu;
+
+    int s = fdb_find(dmac, vlan);
+    if (s >= 0) {
+        /* 已存在：更新端口并刷新 age；端口不变时不重写 TCAM */
+        fdb_entry_t *e = &fdb_table[s];
+        port_id_t old = e->port;
+        e->age_ticks = 0;
+        if (is_static) e->is_static = 1;
+        if (old == port) return HAL_OK;
+        e->port = port;
+        int rc = fdb_install_tcam(s);
+        if (rc != HAL_OK) e->port = old;
+        return rc;
+    }
+
+    uint32_t b[2];
+    fdb_buckets(dmac, vlan, b);
+    s = fdb_free_way(b[0]);
+    if (s < 0) s = fdb_free_way(b[1]);
+    if (s < 0) {
+        s = fdb_make_room(b);
+        if (s == HAL_ERR_FULL) fdb_full++;
+        if (s < 0) return s;
     }
+
+    fdb_entry_t *e = &fdb_table[s];
     e->dmac      = dmac;
     e->port      = port;
     e->vlan      = vlan;
     e->age_ticks = 0;
-    e->is_static = 1;
+    e->is_static = is_static;
     e->valid     = 1;
-    return fdb_install_tcam(dmac, port);
+
+    int rc = fdb_install_tcam(s);
+    if (rc != HAL_OK) {
+        memset(e, 0, sizeof(*e));
+        hal_tcam_delete(TABLE_L2_FDB_STAGE, fdb_tid(s));   // 槽上可能有被挪走条目的副本
+        return rc;
+    }
+    fdb_entries++;
+    return HAL_OK;
 }
 
-int fdb_delete(uint64_t dmac) {
-    fdb_entry_t *e = fdb_find(dmac);
-    if (!e) return HAL_ERR_INVAL;
+static void fdb_remove(int slot) {
+    hal_tcam_delete(TABLE_L2_FDB_STAGE, fdb_tid(slot));
+    memset(&fdb_table[slot], 0, sizeof(fdb_table[slot]));
+    fdb_entries--;
+}
 
-    uint16_t tid = TABLE_L2_FDB_BASE + (uint16_t)(dmac & 0xFFF);
-    hal_tcam_delete(TABLE_L2_FDB_STAGE, tid);
-    memset(e, 0, sizeof(*e));
+// ─────────────────────────────────────────────
+// 公共 API 实现
+// ─────────────────────────────────────────────
+
+void fdb_init(void) {
+    memset(fdb_table, 0, sizeof(fdb_table));
+    fdb_entries = 0;
+    fdb_moves   = 0;
+    fdb_full    = 0;
+}
+
+int fdb_learn(uint64_t dmac, uint16_t vlan, uint8_t port) {
+    return fdb_insert(dmac, vlan, port, 0);
+}
+
+int fdb_add_static(uint64_t dmac, uint8_t port, uint16_t vlan) {
+    return fdb_insert(dmac, vlan, port, 1);
+}
+
+int fdb_delete(uint64_t dmac, uint16_t vlan) {
+    int s = fdb_find(dmac & 0xFFFFFFFFFFFFULL, vlan & 0xFFFu);
+    if (s < 0) return HAL_ERR_INVAL;
+    fdb_remove(s);
+    return HAL_OK;
+}
+
+int fdb_lookup(uint64_t dmac, uint16_t vlan, fdb_entry_t *out) {
+    int s = fdb_find(dmac & 0xFFFFFFFFFFFFULL, vlan & 0xFFFu);
+    if (s < 0) return -1;
+    if (out) *out = fdb_table[s];
     return HAL_OK;
 }
 
+int fdb_tcam_slot(uint64_t dmac, uint16_t vlan) {
+    int s = fdb_find(dmac & 0xFFFFFFFFFFFFULL, vlan & 0xFFFu);
+    return s < 0 ? -1 : (int)fdb_tid(s);
+}
+
 void fdb_age(uint32_t now_sec) {
     for (int i = 0; i < FDB_TABLE_SIZE; i++) {
         fdb_entry_t *e = &fdb_table[i];
         if (!e->valid || e->is_static) continue;
-        if ((now_sec - e->age_ticks) >= FDB_AGE_DYNAMIC) {
-            uint64_t dmac = e->dmac;   // save before memset
-            uint16_t tid  = TABLE_L2_FDB_BASE + (uint16_t)(dmac & 0xFFF);
-            hal_tcam_delete(TABLE_L2_FDB_STAGE, tid);
-            memset(e, 0, sizeof(*e));
-        }
+        if ((now_sec - e->age_ticks) >= FDB_AGE_DYNAMIC)
+            fdb_remove(i);
     }
 }
 
+void fdb_get_stats(fdb_stats_t *st) {
+    if (!st) return;
+    st->entries  = fdb_entries;
+    st->capacity = FDB_TABLE_SIZE;
+    st->moves    = fdb_moves;
+    st->full     = fdb_full;
+}
+
 void fdb_show(void) {
     printf("%-20s  %-5s  %-6s  %-7s\n", "MAC", "Port", "VLAN", "Type");
     printf("────────────────────────────────────────────\n");
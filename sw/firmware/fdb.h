@@ -1,6 +1,23 @@
 // fdb.h
 // L2 转发数据库（FDB）管理模块
-// 跟踪 MAC→端口映射，并向 Stage 2 TCAM 安装转发规则
+// 跟踪 (MAC, VLAN)→端口映射，并向 Stage 2 TCAM 安装转发规则
+//
+// 软件表为 4 路分桶 cuckoo 哈希，键 (MAC, VLAN)：
+//   - 每个键有两个候选桶（64-bit 混合哈希的高 / 低半），查找、删除只看这 8 个槽；
+//   - 学习时两个桶都满则按 BFS 找最短的搬移路径（≤ FDB_CUCKOO_DEPTH 次），
+//     沿路径把条目挪到各自的另一个候选桶，腾出空位；找不到返回 HAL_ERR_FULL，
+//     表不变。装载率 90% 以上仍可插入；
+//   - 槽号即 TCAM 条目：table_id = TABLE_L2_FDB_BASE + 槽号，每个条目独占一个
+//     TCAM 位置，不同 (MAC, VLAN) 不会互相覆盖。搬移先写新位置再释放旧位置，
+//     过程中数据面始终能命中每一条已有条目。
+//
+// 默认容量 = Stage 2 TCAM 深度 HAL_TCAM_DEPTH（mau_tcam.sv 按 table_id 低 11 位寻址，
+// 更大的表在 RTL 中会混叠）。只有 TCAM 由 host 模型 sim_tcam.c 承载的构建
+// （sw/firmware/test、sw/firmware/bench，-DSIM_TCAM_HOST）默认 32768（table_map.h
+// 上限）；Verilator cosim 虽然也定义 SIM_MODE，后端是 RTL，按 TCAM 深度检查。
+//
+// 限制：Stage 2 在 VLAN 入口分类（Stage 4）之前，数据面按 eth_dst 匹配；同一 MAC
+// 在多个 VLAN 中的条目各占一个 TCAM 位置，数据面命中 table_id 最小的一条。
 
 #ifndef FDB_H
 #define FDB_H
@@ -11,7 +28,17 @@
 // ─────────────────────────────────────────────
 // 常量
 // ─────────────────────────────────────────────
-#define FDB_TABLE_SIZE    256     // 软件 FDB 表容量
+#ifndef FDB_TABLE_SIZE
+#ifdef SIM_TCAM_HOST
+#define FDB_TABLE_SIZE    32768   // 软件 FDB 表容量（槽数，4 × 2 的幂）
+#else
+#define FDB_TABLE_SIZE    HAL_TCAM_DEPTH
+#endif
+#endif
+
+#define FDB_WAYS          4       // 每桶槽数
+#define FDB_BUCKETS       (FDB_TABLE_SIZE / FDB_WAYS)
+#define FDB_CUCKOO_DEPTH  4       // 学习时最多搬移的条目数
 #define FDB_AGE_DYNAMIC   300     // 动态条目老化时间（秒）
 
 // ─────────────────────────────────────────────
@@ -26,6 +53,14 @@ typedef struct {
     uint8_t   valid;
 } fdb_entry_t;
 
+// 占用统计
+typedef struct {
+    uint32_t entries;       // 有效条目数
+    uint32_t capacity;      // FDB_TABLE_SIZE
+    uint32_t moves;         // fdb_init 以来 cuckoo 搬移的条目数
+    uint32_t full;          // 找不到搬移路径而拒绝的学习次数
+} fdb_stats_t;
+
 // ─────────────────────────────────────────────
 // API
 // ─────────────────────────────────────────────
@@ -37,22 +72,34 @@ typedef struct {
 void fdb_init(void);
 
 /**
- * fdb_learn - 动态学习 MAC 条目（被 arp.c 调用）
- *   同时安装 TCAM 规则到 Stage 2（L2 FDB）
+ * fdb_learn - 动态学习 (MAC, VLAN) 条目（被 arp.c 调用）
+ *   同时安装 TCAM 规则到 Stage 2（L2 FDB）；已存在且端口不变时只刷新 age
  * 返回 HAL_OK 或 HAL_ERR_FULL
  */
-int fdb_learn(uint64_t dmac, uint8_t port);
+int fdb_learn(uint64_t dmac, uint16_t vlan, uint8_t port);
 
 /**
- * fdb_add_static - 添加静态 MAC 条目（不老化）
- * @vlan: 所属 VLAN（仅用于显示，不影响 TCAM 规则）
+ * fdb_add_static - 添加静态 (MAC, VLAN) 条目（不老化）
  */
 int fdb_add_static(uint64_t dmac, uint8_t port, uint16_t vlan);
 
 /**
  * fdb_delete - 删除条目，并从 TCAM 撤销规则
+ * 条目不存在返回 HAL_ERR_INVAL
+ */
+int fdb_delete(uint64_t dmac, uint16_t vlan);
+
+/**
+ * fdb_lookup - 查找 (MAC, VLAN)
+ * @out: 命中的条目（可为 NULL）
+ * 返回 HAL_OK（命中）或 -1
  */
-int fdb_delete(uint64_t dmac);
+int fdb_lookup(uint64_t dmac, uint16_t vlan, fdb_entry_t *out);
+
+/**
+ * fdb_tcam_slot - 条目当前所在的 Stage 2 table_id；不存在返回 -1
+ */
+int fdb_tcam_slot(uint64_t dmac, uint16_t vlan);
 
 /**
  * fdb_age - 周期性老化（每秒调用）
@@ -60,6 +107,11 @@ int fdb_delete(uint64_t dmac);
  */
 void fdb_age(uint32_t now_sec);
 
+/**
+ * fdb_get_stats - 占用统计
+ */
+void fdb_get_stats(fdb_stats_t *st);
+
 /**
  * fdb_show - 打印 FDB 表（调试 / CLI show fdb）
  */
@@ -1,5 +1,5 @@
 // route.c
-// IPv4 LPM 路由管理实现
+// IPv4 LPM 路由管理实现：Patricia RIB + Stage 0 TCAM 布局管理 + ECMP 组
 
 #include "route.h"
 #include "table_map.h"
@@ -9,15 +9,75 @@
 // ─────────────────────────────────────────────
 // 内部数据结构
 // ─────────────────────────────────────────────
+
+#define RIB_ROOT        1           // 根节点 = 0.0.0.0/0（常驻）；下标 0 = 空
+#define RIB_F_ROUTE     0x01        // 节点承载一条路由
+#define RIB_STACK       64          // 遍历栈深度（树高 <= 33）
+#define RIB_NH_ECMP     0x8000      // nh 最高位：低位为 ECMP 组号而非下一跳下标
+#define ECMP_UNSET      0xFF        // 桶未分配
+
+#if ROUTE_NH_MAX > RIB_NH_ECMP
+#error "ROUTE_NH_MAX must not exceed 0x8000"
+#endif
+#if (ROUTE_ECMP_BUCKETS & (ROUTE_ECMP_BUCKETS - 1)) || ROUTE_ECMP_MEMBERS > ROUTE_ECMP_BUCKETS || \
+    ROUTE_ECMP_BUCKETS > 255 || (ROUTE_ECMP_GROUPS + 1) * ROUTE_ECMP_BUCKETS > 65536
+#error "ROUTE_ECMP_BUCKETS must be a power of two in [ROUTE_ECMP_MEMBERS, 128]"
+#endif
+
+// 不承载路由的非根节点总有两个子节点
 typedef struct {
-    uint32_t  prefix;
+    uint32_t  prefix;       // 前缀（主机位为 0）
+    uint32_t  child[2];     // 按第 len 位（从最高位数）选择；空闲时 child[0] 串接空闲链
     uint8_t   len;
-    uint8_t   port;
+    uint8_t   flags;
+    uint16_t  nh;           // 下一跳下标或 RIB_NH_ECMP | 组号（RIB_F_ROUTE 时有效）
+} rib_node_t;
+
+typedef struct {
     uint64_t  dmac;
-    uint8_t   valid;
-} route_entry_t;
+    uint32_t  ref;          // 引用该下一跳的路由数
+    uint16_t  hnext;        // 哈希链 / 空闲链
+    port_id_t port;
+} rib_nh_t;
+
+#define NH_HASH_SIZE    1024        // 下一跳哈希桶数（2 的幂）
+
+static rib_node_t rib_node[ROUTE_RIB_NODES];
+static uint32_t   rib_top;          // 从未分配过的最小下标
+static uint32_t   rib_free;         // 空闲链表头
+static uint32_t   rib_used;
+static uint32_t   rib_routes;
+
+static rib_nh_t   nh_tab[ROUTE_NH_MAX];     // 下标 0 不用
+static uint16_t   nh_bucket[NH_HASH_SIZE];
+static uint16_t   nh_top;
+static uint16_t   nh_free;
+static uint32_t   nh_used;
+
+// TCAM 布局：长度 L 的路由占区间内偏移 [grp_lo[L], grp_hi[L])，
+// grp_lo[L] >= grp_hi[L + 1]（长前缀在前），组间空隙即空闲条目
+#define TC_GROUPS       33          // 前缀长度 0..32
+
+static uint16_t   tc_base;
+static uint16_t   tc_size;
+static uint32_t   tc_moves;
+static uint16_t   grp_lo[TC_GROUPS];
+static uint16_t   grp_hi[TC_GROUPS];
+static uint32_t   slot_node[ROUTE_TCAM_SLOTS_MAX];  // 偏移 → RIB 节点
+static uint16_t   rib_slot[ROUTE_RIB_NODES];        // RIB 节点 → 偏移（承载路由时有效）
+
+// ECMP 组：第 g 组占成员表下标 [(g + 1) * B, (g + 2) * B)，下标 0 不用
+// （非 ECMP 报文 ecmp_idx = 0，Stage 6 不命中）
+typedef struct {
+    uint8_t   n;                                // 成员数
+    uint32_t  routes;                           // 指向本组的路由数
+    port_id_t port[ROUTE_ECMP_MEMBERS];
+    uint64_t  dmac[ROUTE_ECMP_MEMBERS];
+    uint8_t   cnt[ROUTE_ECMP_MEMBERS];          // 各成员占有的桶数
+    uint8_t   bucket[ROUTE_ECMP_BUCKETS];       // 桶 → 成员下标（ECMP_UNSET = 未分配）
+} ecmp_grp_t;
 
-static route_entry_t route_table[ROUTE_TABLE_SIZE];
+static ecmp_grp_t ecmp_grp[ROUTE_ECMP_GROUPS];
 
 // ─────────────────────────────────────────────
 // 内部工具
@@ -36,50 +96,235 @@ static void u32_to_key(uint8_t *buf, int off, uint32_t val) {
     buf[off + 3] = (uint8_t)((val >>  0) & 0xFF);
 }
 
-/* TCAM table_id for a given prefix/len */
-static uint16_t route_tcam_id(uint32_t prefix, uint8_t len) {
-    if (len == 0) return (uint16_t)TABLE_IPV4_LPM_BASE;
-    return (uint16_t)(TABLE_IPV4_LPM_BASE + (prefix >> (32 - len)));
+/* 第 i 位（0 = 最高位） */
+static inline int addr_bit(uint32_t a, uint8_t i) {
+    return (int)((a >> (31 - i)) & 1U);
+}
+
+/* a、b 前 max 位中相同的前导位数 */
+static inline uint8_t common_len(uint32_t a, uint32_t b, uint8_t max) {
+    uint32_t x = a ^ b;
+    uint8_t  n = x ? (uint8_t)__builtin_clz(x) : 32;
+    return n < max ? n : max;
 }
 
 // ─────────────────────────────────────────────
-// 公共 API 实现
+// 下一跳表（按 (port, dmac) 去重，引用计数）
 // ─────────────────────────────────────────────
 
-void route_init(void) {
-    memset(route_table, 0, sizeof(route_table));
+static uint32_t nh_hash(port_id_t port, uint64_t dmac) {
+    uint64_t h = (dmac ^ ((uint64_t)port << 48)) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(h >> 54) & (NH_HASH_SIZE - 1);
 }
 
-int route_add(uint32_t prefix, uint8_t len, uint8_t port, uint64_t dmac) {
-    if (len > 32) return HAL_ERR_INVAL;
-
-    /* 更新软件表：优先找已有相同 prefix/len 的条目，否则找空槽 */
-    route_entry_t *slot = NULL;
-    for (int i = 0; i < ROUTE_TABLE_SIZE; i++) {
-        if (route_table[i].valid &&
-            route_table[i].prefix == prefix &&
-            route_table[i].len    == len) {
-            slot = &route_table[i];
-            break;
+/* 引用 (port, dmac)，必要时分配；表满返回 0 */
+static uint16_t nh_get(port_id_t port, uint64_t dmac) {
+    uint32_t b = nh_hash(port, dmac);
+    for (uint16_t i = nh_bucket[b]; i; i = nh_tab[i].hnext) {
+        if (nh_tab[i].port == port && nh_tab[i].dmac == dmac) {
+            nh_tab[i].ref++;
+            return i;
         }
     }
-    if (!slot) {
-        for (int i = 0; i < ROUTE_TABLE_SIZE; i++) {
-            if (!route_table[i].valid) {
-                slot = &route_table[i];
-                break;
+
+    uint16_t i;
+    if (nh_free) {
+        i = nh_free;
+        nh_free = nh_tab[i].hnext;
+    } else if (nh_top < ROUTE_NH_MAX) {
+        i = nh_top++;
+    } else {
+        return 0;
+    }
+    nh_tab[i].port  = port;
+    nh_tab[i].dmac  = dmac;
+    nh_tab[i].ref   = 1;
+    nh_tab[i].hnext = nh_bucket[b];
+    nh_bucket[b] = i;
+    nh_used++;
+    return i;
+}
+
+static void nh_put(uint16_t i) {
+    if (i & RIB_NH_ECMP) {                  // ECMP 组：只减路由引用
+        ecmp_grp[i & ~RIB_NH_ECMP].routes--;
+        return;
+    }
+    if (!i || --nh_tab[i].ref) return;
+
+    uint16_t *pp = &nh_bucket[nh_hash(nh_tab[i].port, nh_tab[i].dmac)];
+    while (*pp != i) pp = &nh_tab[*pp].hnext;
+    *pp = nh_tab[i].hnext;
+    nh_tab[i].hnext = nh_free;
+    nh_free = i;
+    nh_used--;
+}
+
+/* forward(port, dmac) 的 action_params */
+static void fwd_params(uint8_t *p, port_id_t port, uint64_t dmac) {
+    p[0] = (uint8_t)port;
+    p[1] = (uint8_t)((dmac >> 40) & 0xFF);
+    p[2] = (uint8_t)((dmac >> 32) & 0xFF);
+    p[3] = (uint8_t)((dmac >> 24) & 0xFF);
+    p[4] = (uint8_t)((dmac >> 16) & 0xFF);
+    p[5] = (uint8_t)((dmac >>  8) & 0xFF);
+    p[6] = (uint8_t)((dmac >>  0) & 0xFF);
+}
+
+// ─────────────────────────────────────────────
+// RIB 节点池 + Patricia 树
+// ─────────────────────────────────────────────
+
+static uint32_t node_alloc(uint32_t prefix, uint8_t len) {
+    uint32_t i;
+    if (rib_free) {
+        i = rib_free;
+        rib_free = rib_node[i].child[0];
+    } else {
+        i = rib_top++;
+    }
+    rib_node_t *n = &rib_node[i];
+    n->prefix   = prefix;
+    n->len      = len;
+    n->flags    = 0;
+    n->nh       = 0;
+    n->child[0] = n->child[1] = 0;
+    rib_used++;
+    return i;
+}
+
+static void node_free(uint32_t i) {
+    rib_node[i].child[0] = rib_free;
+    rib_free = i;
+    rib_used--;
+}
+
+/*
+ * 插入 / 更新 prefix/len → nh；*old_nh 返回原下一跳（新路由为 0），*node 返回
+ * 承载该路由的节点。一次插入最多新建 2 个节点（分叉点 + 叶），不足时返回
+ * HAL_ERR_FULL 且不修改树。
+ */
+static int rib_insert(uint32_t prefix, uint8_t len, uint16_t nh, uint16_t *old_nh,
+                      uint32_t *node) {
+    uint32_t cur = RIB_ROOT;
+    *old_nh = 0;
+
+    for (;;) {
+        rib_node_t *n = &rib_node[cur];
+        if (n->len == len) {                    // 祖先链上的同长度节点即目标
+            if (n->flags & RIB_F_ROUTE) {
+                *old_nh = n->nh;
+            } else {
+                n->flags |= RIB_F_ROUTE;
+                rib_routes++;
             }
+            n->nh = nh;
+            *node = cur;
+            return HAL_OK;
+        }
+        if (rib_used + 2 > ROUTE_RIB_NODES - 1) return HAL_ERR_FULL;
+
+        int      b = addr_bit(prefix, n->len);
+        uint32_t c = n->child[b];
+        if (!c) {
+            uint32_t leaf = node_alloc(prefix, len);
+            rib_node[leaf].flags = RIB_F_ROUTE;
+            rib_node[leaf].nh    = nh;
+            n->child[b] = leaf;
+            rib_routes++;
+            *node = leaf;
+            return HAL_OK;
         }
+
+        const rib_node_t *cn = &rib_node[c];
+        uint8_t cl = common_len(prefix, cn->prefix, len < cn->len ? len : cn->len);
+        if (cl == cn->len) {                    // 子节点是新前缀的祖先：下降
+            cur = c;
+            continue;
+        }
+
+        uint32_t m;
+        if (cl == len) {                        // 新前缀是子节点的祖先：插在中间
+            m = node_alloc(prefix, len);
+            rib_node[m].flags = RIB_F_ROUTE;
+            rib_node[m].nh    = nh;
+            rib_node[m].child[addr_bit(rib_node[c].prefix, len)] = c;
+            *node = m;
+        } else {                                // 在第 cl 位分叉
+            uint32_t leaf = node_alloc(prefix, len);
+            *node = leaf;
+            rib_node[leaf].flags = RIB_F_ROUTE;
+            rib_node[leaf].nh    = nh;
+            m = node_alloc(prefix & prefix_to_mask(cl), cl);
+            rib_node[m].child[addr_bit(prefix, cl)]              = leaf;
+            rib_node[m].child[addr_bit(rib_node[c].prefix, cl)]  = c;
+        }
+        rib_node[cur].child[b] = m;
+        rib_routes++;
+        return HAL_OK;
     }
-    if (!slot) return HAL_ERR_FULL;
+}
 
-    slot->prefix = prefix;
-    slot->len    = len;
-    slot->port   = port;
-    slot->dmac   = dmac;
-    slot->valid  = 1;
+/*
+ * 删除 prefix/len 的路由并压缩路径；*nh 返回原下一跳，*node 返回原承载节点
+ * （可能已回收，仅用于读取 rib_slot）。不存在返回 -1
+ */
+static int rib_remove(uint32_t prefix, uint8_t len, uint16_t *nh, uint32_t *node) {
+    uint32_t gp = 0, par = 0, cur = RIB_ROOT;
+    int      gd = 0, pd = 0;
+
+    while (cur) {
+        const rib_node_t *n = &rib_node[cur];
+        if (n->len > len || ((prefix ^ n->prefix) & prefix_to_mask(n->len))) return -1;
+        if (n->len == len) break;
+        gp = par; gd = pd;
+        par = cur;
+        pd  = addr_bit(prefix, n->len);
+        cur = n->child[pd];
+    }
+    if (!cur || !(rib_node[cur].flags & RIB_F_ROUTE)) return -1;
+
+    rib_node_t *n = &rib_node[cur];
+    *nh   = n->nh;
+    *node = cur;
+    n->flags &= (uint8_t)~RIB_F_ROUTE;
+    n->nh = 0;
+    rib_routes--;
+    if (cur == RIB_ROOT || (n->child[0] && n->child[1])) return 0;  // 保留为分叉点
+
+    int leaf = !n->child[0] && !n->child[1];
+    rib_node[par].child[pd] = n->child[0] ? n->child[0] : n->child[1];
+    node_free(cur);
+
+    // 叶被删除后，不承载路由的父节点只剩一个子节点 → 一并摘除
+    if (leaf && par != RIB_ROOT && !(rib_node[par].flags & RIB_F_ROUTE)) {
+        rib_node[gp].child[gd] = rib_node[par].child[pd ^ 1];
+        node_free(par);
+    }
+    return 0;
+}
+
+/* 精确查找承载 prefix/len 路由的节点；不存在返回 0 */
+static uint32_t rib_find(uint32_t prefix, uint8_t len) {
+    uint32_t cur = RIB_ROOT;
+    while (cur) {
+        const rib_node_t *n = &rib_node[cur];
+        if (n->len > len || ((prefix ^ n->prefix) & prefix_to_mask(n->len))) return 0;
+        if (n->len == len) return (n->flags & RIB_F_ROUTE) ? cur : 0;
+        cur = n->child[addr_bit(prefix, n->len)];
+    }
+    return 0;
+}
+
+// ─────────────────────────────────────────────
+// TCAM 写入 + 布局
+// ─────────────────────────────────────────────
+
+/* 把节点 node 的路由写到区间偏移 off */
+static int tcam_write(uint32_t node, uint16_t off) {
+    const rib_node_t *n  = &rib_node[node];
+    uint32_t prefix = n->prefix;
 
-    /* 安装 TCAM 规则 */
     tcam_entry_t e;
     memset(&e, 0, sizeof(e));
 
@@ -87,55 +332,510 @@ int route_add(uint32_t prefix, uint8_t len, uint8_t port, uint64_t dmac) {
     u32_to_key(e.key.bytes, 0, prefix);
 
     e.mask.key_len = 4;
-    u32_to_key(e.mask.bytes, 0, prefix_to_mask(len));
+    u32_to_key(e.mask.bytes, 0, prefix_to_mask(n->len));
 
     e.stage    = TABLE_IPV4_LPM_STAGE;
-    e.table_id = route_tcam_id(prefix, len);
-    e.action_id = ACTION_FORWARD;
+    e.table_id = (uint16_t)(tc_base + off);
 
-    e.action_params[0] = port;
-    e.action_params[1] = (uint8_t)((dmac >> 40) & 0xFF);
-    e.action_params[2] = (uint8_t)((dmac >> 32) & 0xFF);
-    e.action_params[3] = (uint8_t)((dmac >> 24) & 0xFF);
-    e.action_params[4] = (uint8_t)((dmac >> 16) & 0xFF);
-    e.action_params[5] = (uint8_t)((dmac >>  8) & 0xFF);
-    e.action_params[6] = (uint8_t)((dmac >>  0) & 0xFF);
+    if (n->nh & RIB_NH_ECMP) {
+        /* ecmp_group(base, mask)：base = 本组首桶下标 */
+        uint16_t base = (uint16_t)(((n->nh & ~RIB_NH_ECMP) + 1u) * ROUTE_ECMP_BUCKETS);
+        e.action_id = ACTION_ECMP_GROUP;
+        e.action_params[0] = (uint8_t)(base >> 8);
+        e.action_params[1] = (uint8_t)(base & 0xFF);
+        e.action_params[2] = (uint8_t)((ROUTE_ECMP_BUCKETS - 1) >> 8);
+        e.action_params[3] = (uint8_t)((ROUTE_ECMP_BUCKETS - 1) & 0xFF);
+    } else {
+        e.action_id = ACTION_FORWARD;
+        fwd_params(e.action_params, nh_tab[n->nh].port, nh_tab[n->nh].dmac);
+    }
 
     return hal_tcam_insert(&e);
 }
 
+/* 各长度组清空，按长度均匀分布在区间内，组间留出等量空位 */
+static void tc_reset(void) {
+    for (int l = 0; l < TC_GROUPS; l++) {
+        uint16_t a = tc_size ? (uint16_t)((uint32_t)(tc_size - 1) * (uint32_t)(32 - l) / 32) : 0;
+        grp_lo[l] = grp_hi[l] = a;
+    }
+}
+
+/* 条目从偏移 from 挪到 to：先写新位置，旧位置由调用方覆盖或删除 */
+static int tc_move(uint16_t from, uint16_t to) {
+    uint32_t node = slot_node[from];
+    int rc = tcam_write(node, to);
+    if (rc != HAL_OK) return rc;
+    slot_node[to]  = node;
+    rib_slot[node] = to;
+    tc_moves++;
+    return HAL_OK;
+}
+
+/*
+ * 为长度 len 的新路由腾出紧邻本组的空闲偏移 *off（grp_hi[len] 或
+ * grp_lo[len] - 1），由调用方写入成功后再计入本组。
+ * 向下（短前缀方向）和向上各找最近的空位，途经的每个非空组挪动一条，
+ * 取挪动次数少的方向。从离空位最近的组开始挪，每一步之后组序仍成立。
+ */
+static int tc_make_room(uint8_t len, uint16_t *off) {
+    int      k, dn_k, up_k, dn = -1, up = -1, moves;
+    uint32_t pos;
+
+    /* 向下：长度 len-1, len-2, ... 的组依次紧接在后 */
+    moves = 0;
+    pos   = grp_hi[len];
+    for (k = len - 1; k >= 0 && grp_lo[k] == pos; k--) {
+        if (grp_hi[k] > grp_lo[k]) moves++;
+        pos = grp_hi[k];
+    }
+    dn_k = k;
+    if (k >= 0 || pos < tc_size) dn = moves;
+
+    /* 向上：长度 len+1, len+2, ... 的组依次紧接在前 */
+    moves = 0;
+    pos   = grp_lo[len];
+    for (k = len + 1; k < TC_GROUPS && grp_hi[k] == pos; k++) {
+        if (grp_hi[k] > grp_lo[k]) moves++;
+        pos = grp_lo[k];
+    }
+    up_k = k;
+    if (k < TC_GROUPS || pos > 0) up = moves;
+
+    if (dn < 0 && up < 0) return HAL_ERR_FULL;
+
+    if (dn >= 0 && (up < 0 || dn <= up)) {
+        for (k = dn_k + 1; k < len; k++) {
+            if (grp_hi[k] > grp_lo[k]) {
+                int rc = tc_move(grp_lo[k], grp_hi[k]);
+                if (rc != HAL_OK) return rc;
+            }
+            grp_lo[k]++;
+            grp_hi[k]++;
+        }
+        *off = grp_hi[len];
+    } else {
+        for (k = up_k - 1; k > len; k--) {
+            if (grp_hi[k] > grp_lo[k]) {
+                int rc = tc_move((uint16_t)(grp_hi[k] - 1), (uint16_t)(grp_lo[k] - 1));
+                if (rc != HAL_OK) return rc;
+            }
+            grp_lo[k]--;
+            grp_hi[k]--;
+        }
+        *off = (uint16_t)(grp_lo[len] - 1);
+    }
+    return HAL_OK;
+}
+
+/* 新路由 node 已写入偏移 off（tc_make_room 给出），计入本组 */
+static void tc_claim(uint32_t node, uint8_t len, uint16_t off) {
+    if (off == grp_hi[len]) grp_hi[len]++;
+    else                    grp_lo[len]--;
+    slot_node[off]  = node;
+    rib_slot[node]  = off;
+}
+
+/*
+ * 撤销节点 node（长度 len）的 TCAM 条目：组内末条补洞后删除末位，组保持连续。
+ * 任一步 TCAM 写入失败时返回错误，已完成的步骤记入布局，可原样重试：
+ * 补洞成功后 node 改记为占用末位（此时末位是补洞条目的副本，先于它的原件
+ * 不会命中），组边界只在删除成功后收缩。
+ */
+static int tc_release(uint8_t len, uint32_t node) {
+    uint16_t off  = rib_slot[node];
+    uint16_t last = (uint16_t)(grp_hi[len] - 1);
+
+    if (off != grp_lo[len] && off != last) {
+        int rc = tc_move(last, off);
+        if (rc != HAL_OK) return rc;
+        slot_node[last] = node;
+        rib_slot[node]  = last;
+        off = last;
+    }
+    int rc = hal_tcam_delete(TABLE_IPV4_LPM_STAGE, (uint16_t)(tc_base + off));
+    if (rc != HAL_OK) return rc;
+    if (off == grp_lo[len]) grp_lo[len]++;
+    else                    grp_hi[len]--;
+    return HAL_OK;
+}
+
+// ─────────────────────────────────────────────
+// ECMP 成员表（Stage 6，resilient hashing）
+// ─────────────────────────────────────────────
+
+static void ecmp_reset(void) {
+    memset(ecmp_grp, 0, sizeof(ecmp_grp));
+    for (int g = 0; g < ROUTE_ECMP_GROUPS; g++)
+        memset(ecmp_grp[g].bucket, ECMP_UNSET, sizeof(ecmp_grp[g].bucket));
+}
+
+static uint16_t ecmp_table_id(uint16_t g, uint32_t b) {
+    return (uint16_t)(TABLE_ECMP_MEMBER_BASE + (g + 1u) * ROUTE_ECMP_BUCKETS + b);
+}
+
+static int ecmp_find(const ecmp_grp_t *gr, port_id_t port, uint64_t dmac) {
+    for (int m = 0; m < gr->n; m++)
+        if (gr->port[m] == port && gr->dmac[m] == dmac) return m;
+    return -1;
+}
+
+/* 桶 b 改指成员 m（一次原位覆盖），写入成功后更新桶表 */
+static int ecmp_write(uint16_t g, uint32_t b, uint8_t m) {
+    ecmp_grp_t *gr = &ecmp_grp[g];
+    uint16_t    id = ecmp_table_id(g, b);
+    uint16_t    idx = (uint16_t)(id - TABLE_ECMP_MEMBER_BASE);
+
+    tcam_entry_t e;
+    memset(&e, 0, sizeof(e));
+    e.key.key_len   = 2;
+    e.key.bytes[0]  = (uint8_t)(idx >> 8);
+    e.key.bytes[1]  = (uint8_t)(idx & 0xFF);
+    e.mask.key_len  = 2;
+    e.mask.bytes[0] = 0xFF;
+    e.mask.bytes[1] = 0xFF;
+    e.stage     = TABLE_ECMP_MEMBER_STAGE;
+    e.table_id  = id;
+    e.action_id = ACTION_FORWARD;
+    fwd_params(e.action_params, gr->port[m], gr->dmac[m]);
+
+    int rc = hal_tcam_insert(&e);
+    if (rc != HAL_OK) return rc;
+    if (gr->bucket[b] != ECMP_UNSET) gr->cnt[gr->bucket[b]]--;
+    gr->bucket[b] = m;
+    gr->cnt[m]++;
+    return HAL_OK;
+}
+
+/* 除 skip 外占桶最多（most = 1）/ 最少（most = 0）的成员 */
+static uint8_t ecmp_pick(const ecmp_grp_t *gr, int skip, int most) {
+    int best = -1;
+    for (int m = 0; m < gr->n; m++) {
+        if (m == skip) continue;
+        if (best < 0 || (most ? gr->cnt[m] > gr->cnt[best] : gr->cnt[m] < gr->cnt[best]))
+            best = m;
+    }
+    return (uint8_t)best;
+}
+
+// ─────────────────────────────────────────────
+// 公共 API 实现
+// ─────────────────────────────────────────────
+
+void route_init(void) {
+    // 节点池只重置分配指针，不清零整个数组
+    rib_top  = RIB_ROOT;
+    rib_free = 0;
+    rib_used = 0;
+    rib_routes = 0;
+    node_alloc(0, 0);
+
+    memset(nh_bucket, 0, sizeof(nh_bucket));
+    nh_top  = 1;
+    nh_free = 0;
+    nh_used = 0;
+
+    tc_base  = TABLE_IPV4_LPM_BASE;
+    tc_size  = ROUTE_TCAM_SLOTS < ROUTE_TCAM_SLOTS_MAX ? ROUTE_TCAM_SLOTS : ROUTE_TCAM_SLOTS_MAX;
+    tc_moves = 0;
+    tc_reset();
+
+    ecmp_reset();
+}
+
+int route_tcam_region(uint16_t base, uint16_t slots) {
+    if (!rib_top) route_init();
+    if (rib_routes) return HAL_ERR_BUSY;
+#if ROUTE_TCAM_SLOTS_MAX < 65535
+    if (slots > ROUTE_TCAM_SLOTS_MAX) return HAL_ERR_INVAL;
+#endif
+    if ((uint32_t)base + slots > 0x10000u) return HAL_ERR_INVAL;
+
+    tc_base = base;
+    tc_size = slots;
+    tc_reset();
+    return HAL_OK;
+}
+
+/* 安装 prefix/len → nh（nh 的引用已由调用方取得，失败时释放） */
+static int route_install(uint32_t prefix, uint8_t len, uint16_t nh) {
+    uint16_t old;
+    uint32_t node;
+    int rc = rib_insert(prefix, len, nh, &old, &node);
+    if (rc != HAL_OK) {
+        nh_put(nh);
+        return rc;
+    }
+    if (!tc_size) {
+        nh_put(old);
+        return HAL_OK;
+    }
+
+    if (old) {
+        rc = tcam_write(node, rib_slot[node]);      /* 原位改写下一跳 */
+    } else {
+        uint16_t off;
+        rc = tc_make_room(len, &off);
+        if (rc == HAL_OK) rc = tcam_write(node, off);
+        if (rc == HAL_OK) tc_claim(node, len, off);
+    }
+    if (rc != HAL_OK) {
+        /* 回滚：恢复原下一跳，或删除新建的路由 */
+        uint16_t tmp;
+        uint32_t tn;
+        if (old) rib_insert(prefix, len, old, &tmp, &tn);
+        else     rib_remove(prefix, len, &tmp, &tn);
+        nh_put(nh);
+        return rc;
+    }
+    nh_put(old);
+    return HAL_OK;
+}
+
+int route_add(uint32_t prefix, uint8_t len, uint8_t port, uint64_t dmac) {
+    if (len > 32) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+    prefix &= prefix_to_mask(len);
+
+    uint16_t nh = nh_get(port, dmac);
+    if (!nh) return HAL_ERR_FULL;
+    return route_install(prefix, len, nh);
+}
+
+int route_ecmp_add(uint32_t prefix, uint8_t len, uint16_t group) {
+    if (len > 32 || group >= ROUTE_ECMP_GROUPS) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+    if (!ecmp_grp[group].n) return HAL_ERR_INVAL;
+    prefix &= prefix_to_mask(len);
+
+    ecmp_grp[group].routes++;
+    return route_install(prefix, len, (uint16_t)(RIB_NH_ECMP | group));
+}
+
+int route_ecmp_member_add(uint16_t group, uint8_t port, uint64_t dmac) {
+    if (group >= ROUTE_ECMP_GROUPS) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+
+    ecmp_grp_t *gr = &ecmp_grp[group];
+    if (ecmp_find(gr, port, dmac) >= 0) return HAL_OK;
+    if (gr->n == ROUTE_ECMP_MEMBERS) return HAL_ERR_FULL;
+
+    uint8_t m = gr->n++;
+    gr->port[m] = port;
+    gr->dmac[m] = dmac;
+    gr->cnt[m]  = 0;
+
+    if (m == 0) {
+        for (uint32_t b = 0; b < ROUTE_ECMP_BUCKETS; b++) {
+            int rc = ecmp_write(group, b, 0);
+            if (rc != HAL_OK) return rc;
+        }
+        return HAL_OK;
+    }
+
+    /* 从占桶最多的成员处逐桶转移，直到新成员分得 B / n */
+    while (gr->cnt[m] < ROUTE_ECMP_BUCKETS / gr->n) {
+        uint8_t  donor = ecmp_pick(gr, m, 1);
+        uint32_t b = ROUTE_ECMP_BUCKETS;
+        while (gr->bucket[--b] != donor) ;
+        int rc = ecmp_write(group, b, m);
+        if (rc != HAL_OK) return rc;
+    }
+    return HAL_OK;
+}
+
+int route_ecmp_member_del(uint16_t group, uint8_t port, uint64_t dmac) {
+    if (group >= ROUTE_ECMP_GROUPS) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+
+    ecmp_grp_t *gr = &ecmp_grp[group];
+    int r = ecmp_find(gr, port, dmac);
+    if (r < 0) return HAL_ERR_INVAL;
+
+    if (gr->n == 1) {
+        if (gr->routes) return HAL_ERR_BUSY;
+        int rc = HAL_OK;
+        for (uint32_t b = 0; b < ROUTE_ECMP_BUCKETS; b++) {
+            if (gr->bucket[b] == ECMP_UNSET) continue;
+            int e = hal_tcam_delete(TABLE_ECMP_MEMBER_STAGE, ecmp_table_id(group, b));
+            if (e != HAL_OK) rc = e;
+            gr->bucket[b] = ECMP_UNSET;
+        }
+        gr->cnt[0] = 0;
+        gr->n = 0;
+        return rc;
+    }
+
+    /* 只改写被删成员的桶，逐个分给当前占桶最少的成员 */
+    for (uint32_t b = 0; b < ROUTE_ECMP_BUCKETS; b++) {
+        if (gr->bucket[b] != r) continue;
+        int rc = ecmp_write(group, b, ecmp_pick(gr, r, 0));
+        if (rc != HAL_OK) return rc;
+    }
+
+    /* 末位成员补到 r（只改软件下标，TCAM 条目不变） */
+    uint8_t last = (uint8_t)(gr->n - 1);
+    if (r != last) {
+        gr->port[r] = gr->port[last];
+        gr->dmac[r] = gr->dmac[last];
+        gr->cnt[r]  = gr->cnt[last];
+        for (uint32_t b = 0; b < ROUTE_ECMP_BUCKETS; b++)
+            if (gr->bucket[b] == last) gr->bucket[b] = (uint8_t)r;
+    }
+    gr->cnt[last] = 0;
+    gr->n--;
+    return HAL_OK;
+}
+
+int route_ecmp_select(uint16_t group, uint32_t hash, port_id_t *port, uint64_t *dmac) {
+    if (group >= ROUTE_ECMP_GROUPS || !rib_top) return HAL_ERR_INVAL;
+    const ecmp_grp_t *gr = &ecmp_grp[group];
+    uint8_t m = gr->bucket[hash & (ROUTE_ECMP_BUCKETS - 1)];
+    if (m == ECMP_UNSET) return HAL_ERR_INVAL;
+    if (port) *port = gr->port[m];
+    if (dmac) *dmac = gr->dmac[m];
+    return HAL_OK;
+}
+
+int route_ecmp_get(uint16_t group, route_ecmp_info_t *info) {
+    if (group >= ROUTE_ECMP_GROUPS || !info) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+    const ecmp_grp_t *gr = &ecmp_grp[group];
+    memset(info, 0, sizeof(*info));
+    info->members = gr->n;
+    info->routes  = gr->routes;
+    for (int m = 0; m < gr->n; m++) {
+        info->port[m]    = gr->port[m];
+        info->dmac[m]    = gr->dmac[m];
+        info->buckets[m] = gr->cnt[m];
+    }
+    return HAL_OK;
+}
+
 int route_del(uint32_t prefix, uint8_t len) {
     if (len > 32) return HAL_ERR_INVAL;
+    if (!rib_top) route_init();
+    prefix &= prefix_to_mask(len);
+
+    /* 先撤 TCAM 条目，成功后才删 RIB：失败时路由仍在，可重试 */
+    uint32_t node = rib_find(prefix, len);
+    if (!node) return HAL_ERR_INVAL;
+    if (tc_size) {
+        int rc = tc_release(len, node);
+        if (rc != HAL_OK) return rc;
+    }
+
+    uint16_t nh;
+    rib_remove(prefix, len, &nh, &node);
+    nh_put(nh);
+    return HAL_OK;
+}
+
+int route_add_bulk(const route_entry_t *routes, int n) {
+    if (n < 0 || (n && !routes)) return HAL_ERR_INVAL;
+    int rc = hal_tcam_batch_begin();
+    if (rc != HAL_OK) return rc;
+
+    int done = 0;
+    for (int i = 0; i < n; i++)
+        done += route_add(routes[i].prefix, routes[i].len,
+                          routes[i].port, routes[i].dmac) == HAL_OK;
+
+    rc = hal_tcam_batch_commit();
+    return rc != HAL_OK ? rc : done;
+}
+
+int route_del_bulk(const route_entry_t *routes, int n) {
+    if (n < 0 || (n && !routes)) return HAL_ERR_INVAL;
+    int rc = hal_tcam_batch_begin();
+    if (rc != HAL_OK) return rc;
+
+    int done = 0;
+    for (int i = 0; i < n; i++)
+        done += route_del(routes[i].prefix, routes[i].len) == HAL_OK;
 
-    for (int i = 0; i < ROUTE_TABLE_SIZE; i++) {
-        if (route_table[i].valid &&
-            route_table[i].prefix == prefix &&
-            route_table[i].len    == len) {
-            route_table[i].valid = 0;
-            break;
+    rc = hal_tcam_batch_commit();
+    return rc != HAL_OK ? rc : done;
+}
+
+int route_tcam_slot(uint32_t prefix, uint8_t len) {
+    if (!rib_top || !tc_size || len > 32) return -1;
+    uint32_t node = rib_find(prefix & prefix_to_mask(len), len);
+    return node ? (int)(tc_base + rib_slot[node]) : -1;
+}
+
+int route_lookup(uint32_t addr, route_info_t *out) {
+    if (!rib_top) return -1;
+
+    uint32_t cur = RIB_ROOT, best = 0;
+    while (cur) {
+        const rib_node_t *n = &rib_node[cur];
+        if ((addr ^ n->prefix) & prefix_to_mask(n->len)) break;
+        if (n->flags & RIB_F_ROUTE) best = cur;
+        if (n->len == 32) break;
+        cur = n->child[addr_bit(addr, n->len)];
+    }
+    if (!best) return -1;
+
+    if (out) {
+        const rib_node_t *n = &rib_node[best];
+        out->prefix = n->prefix;
+        out->len    = n->len;
+        if (n->nh & RIB_NH_ECMP) {
+            out->port  = 0;
+            out->dmac  = 0;
+            out->group = (uint16_t)(n->nh & ~RIB_NH_ECMP);
+        } else {
+            out->port  = nh_tab[n->nh].port;
+            out->dmac  = nh_tab[n->nh].dmac;
+            out->group = ROUTE_ECMP_NONE;
         }
     }
-    return hal_tcam_delete(TABLE_IPV4_LPM_STAGE, route_tcam_id(prefix, len));
+    return HAL_OK;
+}
+
+void route_get_stats(route_stats_t *st) {
+    if (!st) return;
+    st->routes    = rib_routes;
+    st->nodes     = rib_used;
+    st->nodes_max = ROUTE_RIB_NODES - 1;
+    st->next_hops = nh_used;
+    st->tcam_slots = tc_size;
+    st->tcam_moves = tc_moves;
 }
 
 void route_show(void) {
-    printf("%-20s  %-5s  %-17s\n", "Prefix/Len", "Port", "Next-Hop MAC");
-    printf("────────────────────────────────────────────────\n");
+    printf("%-20s  %-5s  %-17s  %s\n", "Prefix/Len", "Port", "Next-Hop MAC", "TCAM");
+    printf("────────────────────────────────────────────────────────\n");
     int found = 0;
-    for (int i = 0; i < ROUTE_TABLE_SIZE; i++) {
-        route_entry_t *e = &route_table[i];
-        if (!e->valid) continue;
+
+    /* 前序遍历：前缀升序，同一前缀短者在前 */
+    uint32_t stack[RIB_STACK];
+    int sp = 0;
+    if (rib_top) stack[sp++] = RIB_ROOT;
+    while (sp) {
+        const rib_node_t *e = &rib_node[stack[--sp]];
+        if (e->child[1]) stack[sp++] = e->child[1];
+        if (e->child[0]) stack[sp++] = e->child[0];
+        if (!(e->flags & RIB_F_ROUTE)) continue;
         found++;
         uint8_t a = (uint8_t)((e->prefix >> 24) & 0xFF);
         uint8_t b = (uint8_t)((e->prefix >> 16) & 0xFF);
         uint8_t c = (uint8_t)((e->prefix >>  8) & 0xFF);
         uint8_t d = (uint8_t)((e->prefix >>  0) & 0xFF);
-        uint64_t m = e->dmac;
-        printf("%u.%u.%u.%u/%-3u       %-5u  %02x:%02x:%02x:%02x:%02x:%02x\n",
-               a, b, c, d, e->len, e->port,
-               (unsigned)((m >> 40) & 0xFF), (unsigned)((m >> 32) & 0xFF),
-               (unsigned)((m >> 24) & 0xFF), (unsigned)((m >> 16) & 0xFF),
-               (unsigned)((m >>  8) & 0xFF), (unsigned)((m >>  0) & 0xFF));
+        if (e->nh & RIB_NH_ECMP) {
+            printf("%u.%u.%u.%u/%-3u       ecmp   group %-11u",
+                   a, b, c, d, e->len, (unsigned)(e->nh & ~RIB_NH_ECMP));
+        } else {
+            uint64_t m = nh_tab[e->nh].dmac;
+            printf("%u.%u.%u.%u/%-3u       %-5u  %02x:%02x:%02x:%02x:%02x:%02x",
+                   a, b, c, d, e->len, nh_tab[e->nh].port,
+                   (unsigned)((m >> 40) & 0xFF), (unsigned)((m >> 32) & 0xFF),
+                   (unsigned)((m >> 24) & 0xFF), (unsigned)((m >> 16) & 0xFF),
+                   (unsigned)((m >>  8) & 0xFF), (unsigned)((m >>  0) & 0xFF));
+        }
+        if (tc_size) printf("  0x%04x\n", (unsigned)(tc_base + rib_slot[e - rib_node]));
+        else         printf("  -\n");
     }
     if (!found) printf("(empty)\n");
 }
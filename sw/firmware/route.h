@@ -1,6 +1,51 @@
 // route.h
 // IPv4 路由管理模块
-// 维护 LPM 路由软件表，并向 Stage 0 TCAM 安装转发规则
+// 维护 LPM 路由软件表（RIB），并向 Stage 0 TCAM 安装转发规则
+//
+// RIB 为路径压缩二叉前缀树（Patricia）：
+//   - 每个节点带完整前缀 / 长度，只有分叉点和真实路由占节点，
+//     n 条前缀最多 2n - 1 个节点；add / del / lookup 均为 O(前缀长度)；
+//   - 节点从静态节点池分配（16 B / 节点，下标代替指针），删除即回收；
+//   - 下一跳 (port, dmac) 去重存放在独立的下一跳表中，节点只存下标。
+//
+// 片上 SRAM 仅 2 MB（link.ld）。固件默认配置下本模块的静态 SRAM 约 606 KB：
+//   节点池 rib_node[]       32K × 16 B = 512 KB
+//   节点 → TCAM 偏移 rib_slot[] 32K × 2 B  =  64 KB
+//   TCAM 偏移 → 节点 slot_node[] 2047 × 4 B ≈   8 KB
+//   下一跳表 nh_tab[] + 哈希桶  1024 × 16 B + 2 KB = 18 KB
+//   ECMP 组 ecmp_grp[]          16 × 232 B ≈ 3.6 KB
+// 随节点数增长的是每节点 18 B（rib_node + rib_slot）。承载全表 BGP（约百万
+// 前缀、≈ 2M 节点，≈ 36 MB）需把这两个数组放到片外 DRAM 并以
+// -DROUTE_RIB_NODES= 放大。host 仿真（SIM_MODE）默认 2M 节点。
+//
+// TCAM 布局：Stage 0 按最小 table_id 优先（mau_tcam.sv），路由在 TCAM 区间内
+// 按前缀长度分组排列（长前缀在低下标），组与组之间预留空位：
+//   - 插入：本组相邻有空位直接写入；否则向上 / 向下找最近的空位，沿途每个
+//     非空长度组把边界条目挪到另一端腾出位置，取挪动次数少的方向（≤ 32 次）；
+//   - 删除：组内最后一条挪进空洞后删除末位（≤ 1 次挪动）；
+//   - 挪动先写新位置再覆盖 / 删除旧位置，每次 TUE 写入后 TCAM 的 LPM 结果
+//     都正确（过程中同一条目短暂出现两份）。
+// 默认区间为 [TABLE_IPV4_LPM_BASE, +ROUTE_TCAM_SLOTS)，最后一个 TCAM 条目
+// （table_id 0xFFFF，RTL 取低 11 位即 2047）留给 cp_main 的默认 drop。
+// TCAM 区间满时 route_add 返回 HAL_ERR_FULL，RIB 不变。
+//
+// ECMP：路由可指向一个 ECMP 组（route_ecmp_add）。组在 Stage 6 成员表中占
+// ROUTE_ECMP_BUCKETS 个哈希桶，每桶一条 forward(port, dmac)；Stage 0 条目的
+// ecmp_group Action 以五元组 CRC32 的低位选桶（ecmp_idx = 组基址 + (hash & (桶数-1))）。
+// 成员增删采用 resilient hashing，只改写必须变动的桶：
+//   - 加成员：从占桶最多的成员处各取一桶，直到新成员占 桶数 / 成员数；
+//   - 删成员：仅把该成员的桶逐个分给占桶最少的成员；
+// 其他桶（及其上的流）不受影响；每个桶改写是一次原位 TCAM 覆盖。
+// 成员表位于 Stage 6，在 VLAN 出口（Stage 7）之前，出口标签按选出的成员端口处理；
+// L2 FDB（Stage 2）在它之前，与普通路由一样按原 eth_dst 匹配。
+//
+// 批量：route_add_bulk / route_del_bulk 把一批路由的全部 TCAM 写入（含腾位置
+// 的挪动）放进一个 TUE 批（hal_tcam_batch_begin / commit），每 HAL_TCAM_BATCH_MAX
+// 次写入只排空一次流水线，而不是每次写入一次；批内写入按原顺序生效，
+// 每一步之后 LPM 结果仍正确（同逐条调用）。用于邻居振荡后的整批撤销 / 重装。
+// 批不是原子的：TUE 逐条写入（间隔 TUE_APPLY_GAP 个 clk_ctrl），数据面会看到
+// 批内每个中间状态，不存在整批一次切换；需要一致性的调用方不能依赖批来保证。
+// TUE 未实现暂存 FIFO（rv_p4_top 默认 TUE_BATCH_DEPTH = 0）时退化为逐条提交。
 
 #ifndef ROUTE_H
 #define ROUTE_H
@@ -11,35 +56,189 @@
 // ─────────────────────────────────────────────
 // 常量
 // ─────────────────────────────────────────────
-#define ROUTE_TABLE_SIZE  256     // 软件路由表容量
+#ifndef ROUTE_RIB_NODES
+#ifdef SIM_MODE
+#define ROUTE_RIB_NODES   (1u << 21)    // RIB 节点池容量（含根节点）
+#else
+#define ROUTE_RIB_NODES   32768u
+#endif
+#endif
+
+#ifndef ROUTE_NH_MAX
+#define ROUTE_NH_MAX      1024          // 不同下一跳 (port, dmac) 个数上限
+#endif
+
+#define ROUTE_TCAM_SLOTS  2047          // 默认 TCAM 区间大小（MAU_TCAM_DEPTH - 1）
+
+#ifndef ROUTE_TCAM_SLOTS_MAX
+#ifdef SIM_MODE
+#define ROUTE_TCAM_SLOTS_MAX  65535u    // route_tcam_region() 可配置的区间上限
+#else
+#define ROUTE_TCAM_SLOTS_MAX  ROUTE_TCAM_SLOTS
+#endif
+#endif
+
+#ifndef ROUTE_ECMP_GROUPS
+#define ROUTE_ECMP_GROUPS   16          // ECMP 组数（组号 0..N-1）
+#endif
+
+#ifndef ROUTE_ECMP_MEMBERS
+#define ROUTE_ECMP_MEMBERS  16          // 每组成员上限
+#endif
+
+#ifndef ROUTE_ECMP_BUCKETS
+#define ROUTE_ECMP_BUCKETS  64          // 每组哈希桶数（2 的幂，>= 成员上限）
+#endif
+
+#define ROUTE_ECMP_NONE     0xFFFF      // route_info_t.group：非 ECMP 路由
+
+// ─────────────────────────────────────────────
+// 数据结构
+// ─────────────────────────────────────────────
+
+// 查找结果
+typedef struct {
+    uint32_t  prefix;
+    uint8_t   len;
+    port_id_t port;         // ECMP 路由为 0（用 route_ecmp_select 按流选成员）
+    uint64_t  dmac;
+    uint16_t  group;        // ECMP 组号；ROUTE_ECMP_NONE = 普通路由
+} route_info_t;
+
+// ECMP 组状态
+typedef struct {
+    uint8_t   members;                          // 成员数
+    uint32_t  routes;                           // 指向该组的路由数
+    port_id_t port[ROUTE_ECMP_MEMBERS];
+    uint64_t  dmac[ROUTE_ECMP_MEMBERS];
+    uint8_t   buckets[ROUTE_ECMP_MEMBERS];      // 各成员占有的桶数
+} route_ecmp_info_t;
+
+// 批量增删的路由描述（route_del_bulk 忽略 port / dmac）
+typedef struct {
+    uint32_t prefix;
+    uint8_t  len;
+    uint8_t  port;
+    uint64_t dmac;
+} route_entry_t;
+
+// RIB 占用统计
+typedef struct {
+    uint32_t routes;        // 路由条数
+    uint32_t nodes;         // 已用节点（含根）
+    uint32_t nodes_max;     // 节点池容量
+    uint32_t next_hops;     // 不同下一跳个数
+    uint32_t tcam_slots;    // TCAM 区间大小（0 = 只维护 RIB）
+    uint32_t tcam_moves;    // route_init 以来为腾位置挪动的 TCAM 条目数
+} route_stats_t;
 
 // ─────────────────────────────────────────────
 // API
 // ─────────────────────────────────────────────
 
 /**
- * route_init - 清空路由软件状态
+ * route_init - 清空路由软件状态，TCAM 区间恢复默认
+ * 不清除 TCAM 中已有的条目（与其他模块的 *_init 一致，配合 hal_tcam_flush 使用）
  */
 void route_init(void);
 
+/**
+ * route_tcam_region - 设置路由使用的 Stage 0 TCAM 区间 [base, base + slots)
+ * @slots: 区间大小（<= ROUTE_TCAM_SLOTS_MAX）；0 = 只维护 RIB、不写 TCAM
+ * 只能在没有路由时调用，否则返回 HAL_ERR_BUSY；区间越界返回 HAL_ERR_INVAL
+ */
+int route_tcam_region(uint16_t base, uint16_t slots);
+
 /**
  * route_add - 添加/更新一条 IPv4 LPM 路由
  * @prefix: 网络地址（主机字节序大端 uint32，如 10.0.0.0 = 0x0A000000）
+ *          主机位被忽略
  * @len:    前缀长度（0-32）
  * @port:   出端口
  * @dmac:   下一跳 MAC（48-bit，高 16 位为 0）
- * 返回 HAL_OK 或错误码
+ * 返回 HAL_OK 或错误码（节点池 / 下一跳表 / TCAM 区间满返回 HAL_ERR_FULL；
+ * TCAM 写入失败时 RIB 回滚到调用前的状态）
  */
 int route_add(uint32_t prefix, uint8_t len, uint8_t port, uint64_t dmac);
 
 /**
  * route_del - 删除路由，并从 TCAM 撤销规则
- * @prefix/@len: 与添加时一致
+ * @prefix/@len: 与添加时一致（主机位被忽略）
+ * 返回 HAL_OK；路由不存在返回 HAL_ERR_INVAL；TCAM 写入失败返回其错误码，
+ * 此时路由仍在 RIB 中，可原样重试。其余路由的 TCAM 结果不受影响；本路由的
+ * 条目可能已被组内补洞覆盖（流量已按删除后的结果转发）
  */
 int route_del(uint32_t prefix, uint8_t len);
 
 /**
- * route_show - 打印路由表（调试 / CLI show route）
+ * route_add_bulk - 批量添加/更新路由，全部 TCAM 写入在一个 TUE 批内提交
+ * @routes: n 条路由，逐条语义同 route_add（单条失败跳过，不影响其余）
+ * 返回成功添加的条数；参数非法返回 HAL_ERR_INVAL，已在 TUE 批内返回
+ * HAL_ERR_BUSY，批提交失败返回其错误码（此时 RIB 已更新，TCAM 内容须重装）
+ */
+int route_add_bulk(const route_entry_t *routes, int n);
+
+/**
+ * route_del_bulk - 批量删除路由，同 route_add_bulk
+ * 返回成功删除的条数（不存在或 TCAM 写入失败的路由不计入，后者仍在 RIB 中）
+ * 或错误码
+ */
+int route_del_bulk(const route_entry_t *routes, int n);
+
+/**
+ * route_lookup - 软件最长前缀匹配（用于 Punt 上来的报文）
+ * @addr: 目的 IPv4 地址
+ * @out:  命中的路由（可为 NULL）
+ * 返回 HAL_OK（命中）或 -1（无匹配路由）
+ */
+int route_lookup(uint32_t addr, route_info_t *out);
+
+/**
+ * route_tcam_slot - 路由当前所在的 TCAM table_id
+ * 返回 table_id；路由不存在或未写入 TCAM 返回 -1
+ */
+int route_tcam_slot(uint32_t prefix, uint8_t len);
+
+/**
+ * route_ecmp_member_add - 向 ECMP 组加入成员 (port, dmac)
+ * 第一个成员占全部桶；之后从现有成员各取部分桶（见文件头），其余流不迁移。
+ * 返回 HAL_OK（成员已存在也返回 HAL_OK）；组号非法返回 HAL_ERR_INVAL，
+ * 成员已满返回 HAL_ERR_FULL
+ */
+int route_ecmp_member_add(uint16_t group, uint8_t port, uint64_t dmac);
+
+/**
+ * route_ecmp_member_del - 从 ECMP 组删除成员，其桶分给剩余成员
+ * 组内最后一个成员被删除时撤销该组全部桶；仍有路由指向该组时
+ * 不允许删除最后一个成员（HAL_ERR_BUSY）。成员不存在返回 HAL_ERR_INVAL
+ */
+int route_ecmp_member_del(uint16_t group, uint8_t port, uint64_t dmac);
+
+/**
+ * route_ecmp_add - 添加/更新一条指向 ECMP 组的路由
+ * 组须已有成员（否则 HAL_ERR_INVAL）；其余同 route_add
+ */
+int route_ecmp_add(uint32_t prefix, uint8_t len, uint16_t group);
+
+/**
+ * route_ecmp_select - 软件选成员：与数据面相同，取 hash 低位选桶
+ * @hash: 流的五元组 CRC32（mau_hash.sv）
+ * 返回 HAL_OK；组号非法或组为空返回 HAL_ERR_INVAL
+ */
+int route_ecmp_select(uint16_t group, uint32_t hash, port_id_t *port, uint64_t *dmac);
+
+/**
+ * route_ecmp_get - 读取 ECMP 组状态；组号非法返回 HAL_ERR_INVAL
+ */
+int route_ecmp_get(uint16_t group, route_ecmp_info_t *info);
+
+/**
+ * route_get_stats - RIB 占用统计
+ */
+void route_get_stats(route_stats_t *st);
+
+/**
+ * route_show - 打印路由表（按前缀顺序；调试 / CLI show route）
  */
 void route_show(void);
 
@@ -1,6 +1,14 @@
 // table_map.h
-// 由 C-to-HW 编译器自动生成 — 勿手动修改
 // 数据面 C 代码编译后的表/动作 ID 映射
+//
+// 来源：
+//   - 文件开头到「PHV 字段偏移」为止（Stage 0-2、其 Action ID、PHV 报头/元数据偏移）
+//     最初由 C-to-HW 编译器生成；
+//   - 「扩展表」「Action ID 扩展」「计数器 / Meter ID」「PHV 字段偏移扩展」各节为手工维护
+//     （ARP / VLAN / DSCP / ECMP；VLAN 出口表由 stage 6 移到 7 也是手工修改）。
+// 编译器目前不生成本文件。修改级号 / Action ID / PHV 偏移时须同步
+// sw/compiler/firmware_dataplane.c 与 rvp4cc.py 的 PHV_FIELDS / BUILTIN_ACTIONS，
+// 再 make -C sw/compiler fw-pipeline；test_dp_cosim CS-10 校验两者等价。
 
 #ifndef TABLE_MAP_H
 #define TABLE_MAP_H
@@ -77,14 +85,23 @@
 #define TABLE_DSCP_MAP_STAGE        5
 #define TABLE_DSCP_MAP_BASE         0x0000
 
-// VLAN 出口标签处理表（stage 6）：(eg_port, vlan_id) → 保留/剥离标签
-#define TABLE_VLAN_EGRESS_STAGE     6
+// ECMP 成员表（stage 6）：ecmp_idx → forward(port, dmac)
+// 每组占 ROUTE_ECMP_BUCKETS 个连续下标（route.h），table_id = 下标；下标 0 不用
+// 位于 VLAN 出口表之前：出口标签处理按 ECMP 选出的 eg_port 进行
+#define TABLE_ECMP_MEMBER_STAGE     6
+#define TABLE_ECMP_MEMBER_BASE      0x0000
+
+// VLAN 出口标签处理表（stage 7）：(eg_port, vlan_id) → 保留/剥离标签
+#define TABLE_VLAN_EGRESS_STAGE     7
 #define TABLE_VLAN_EGRESS_BASE      0x0000
 
 // ─────────────────────────────────────────────
 // Action ID 扩展
 // ─────────────────────────────────────────────
 
+// ipv4_lpm 表：ECMP 路由
+#define ACTION_ECMP_GROUP           0x1003   // ecmp_group(base, mask)：ecmp_idx = base + (flow_hash & mask)
+
 // ARP Punt
 #define ACTION_PUNT_CPU             0x4001   // 复制报头到 CPU Punt 环
 
@@ -117,5 +134,6 @@
 // ─────────────────────────────────────────────
 #define PHV_OFF_VLAN_ID             261      // 已解析 VLAN ID（uint16_t）
 #define PHV_OFF_QOS_PRIO            263      // QoS 队列优先级（0-7）
+#define PHV_OFF_ECMP_IDX            266      // ECMP 成员表下标（uint16_t，0 = 非 ECMP 路由）
 
 #endif /* TABLE_MAP_H */
@@ -0,0 +1,250 @@
+// bench_flow.c
+// 流缓存收益测试：Zipf 分布流量下 pkt_flow 与直接走流水线的吞吐对比
+//
+// 用法：./bench_flow [--routes N] [--flows N] [--zipf S] [--pkts N] [--secs S]
+//                     [--cache N] [--churn N]
+//   --routes  Stage 0 预装 /24 路由条数（默认 16384，上限 43008）
+//   --flows   不同流（五元组）数（默认 65536）
+//   --zipf    流热度的 Zipf 指数（默认 1.0；0 = 均匀）
+//   --pkts    报文池大小（默认 262144，循环使用）
+//   --secs    每档测量时长（默认 1.0 s）
+//   --cache   只测一种缓存条目数（默认依次测 1K / 4K / 16K / 64K）
+//   --churn   每 N 个报文执行一次 route_add/route_del（0 = 无表项更新）
+//
+// 输出每档的命中率、Mpps、ns/pkt 及相对无缓存流水线的加速比。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "sim_hal.h"
+#include "pkt_model.h"
+#include "pkt_flow.h"
+#include "table_map.h"
+#include "route.h"
+#include "acl.h"
+#include "qos.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// ─────────────────────────────────────────────
+// 表项与流量
+// ─────────────────────────────────────────────
+
+// Stage 0：10.(i>>8).(i&0xFF).0/24 → port i%32，table_id = i
+// 直接写 TCAM 并指定 table_id，route_add 只用于 --churn（使用 CHURN_TID_BASE 起的独立区间）
+static void load_rib(int n)
+{
+    for (int i = 0; i < n; i++) {
+        tcam_entry_t e;
+        memset(&e, 0, sizeof(e));
+        uint32_t pfx = 0x0A000000u | ((uint32_t)i << 8);
+        e.stage       = TABLE_IPV4_LPM_STAGE;
+        e.table_id    = (uint16_t)i;
+        e.key.key_len = e.mask.key_len = 4;
+        e.key.bytes[0] = (uint8_t)(pfx >> 24); e.key.bytes[1] = (uint8_t)(pfx >> 16);
+        e.key.bytes[2] = (uint8_t)(pfx >> 8);
+        e.mask.bytes[0] = e.mask.bytes[1] = e.mask.bytes[2] = 0xFF;
+        e.action_id        = ACTION_FORWARD;
+        e.action_params[0] = (uint8_t)(i % 32);
+        hal_tcam_insert(&e);
+    }
+}
+
+static uint16_t build_udp(uint8_t *b, uint32_t src, uint32_t dst, uint8_t tos,
+                          uint16_t sport, uint16_t dport)
+{
+    memset(b, 0, 42);
+    b[0] = 0x02; b[5] = 0x01; b[6] = 0x02; b[11] = 0x02;
+    b[12] = 0x08; b[13] = 0x00;
+    b[14] = 0x45; b[15] = tos; b[17] = 28; b[22] = 64; b[23] = 17;
+    for (int k = 0; k < 4; k++) {
+        b[26 + k] = (uint8_t)(src >> (24 - 8 * k));
+        b[30 + k] = (uint8_t)(dst >> (24 - 8 * k));
+    }
+    b[34] = (uint8_t)(sport >> 8); b[35] = (uint8_t)sport;
+    b[36] = (uint8_t)(dport >> 8); b[37] = (uint8_t)dport;
+    return 42;
+}
+
+// Zipf(s) 采样：累积分布 + 二分查找
+static int zipf_pick(const double *cdf, int n)
+{
+    double u = (double)rng() / 4294967296.0;
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else              hi = mid;
+    }
+    return lo;
+}
+
+// ─────────────────────────────────────────────
+// 测量
+// ─────────────────────────────────────────────
+typedef struct {
+    double   mpps;
+    uint64_t updates;
+} run_t;
+
+static int      churn_every;
+static uint32_t churn_i;
+
+// 192.168.x.0/24 经 route_add 写入 [CHURN_TID_BASE, +CHURN_TID_SLOTS)，--routes 限制在 CHURN_TID_BASE 以内
+#define CHURN_TID_BASE  0xA800
+#define CHURN_TID_SLOTS 512
+
+static void churn_step(void)
+{
+    uint32_t pfx = 0xC0A80000u | ((churn_i & 0xFF) << 8);     // 192.168.x.0/24
+    if (churn_i & 0x100) route_del(pfx, 24);
+    else                 route_add(pfx, 24, (uint8_t)(churn_i % 32), 0x020000000000ULL);
+    churn_i++;
+}
+
+// fc = NULL：直接 pkt_process
+static run_t run(pkt_flow_t *fc, const pkt_desc_t *desc, int n, double secs)
+{
+    run_t r = { 0, 0 };
+    fwd_result_t res;
+    uint64_t done = 0;
+    int until_churn = churn_every;
+    double t0 = now_s();
+    while (now_s() - t0 < secs) {
+        for (int i = 0; i < n; i++) {
+            if (fc) pkt_flow_process(fc, desc[i].data, desc[i].len, desc[i].ig_port, &res);
+            else    pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &res);
+            if (churn_every && --until_churn == 0) {
+                churn_step();
+                r.updates++;
+                until_churn = churn_every;
+            }
+        }
+        done += (uint64_t)n;
+    }
+    r.mpps = (double)done / (now_s() - t0) / 1e6;
+    return r;
+}
+
+// ─────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────
+int main(int argc, char **argv)
+{
+    int    n_routes = 16384;
+    int    n_flows  = 65536;
+    double zipf_s   = 1.0;
+    int    n_pkts   = 262144;
+    double secs     = 1.0;
+    int    cache_n  = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--routes") && i + 1 < argc) n_routes    = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--flows")  && i + 1 < argc) n_flows     = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--zipf")   && i + 1 < argc) zipf_s      = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--pkts")   && i + 1 < argc) n_pkts      = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--secs")   && i + 1 < argc) secs        = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--cache")  && i + 1 < argc) cache_n     = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--churn")  && i + 1 < argc) churn_every = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--routes N] [--flows N] [--zipf S] [--pkts N] "
+                            "[--secs S] [--cache N] [--churn N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n_routes < 1) n_routes = 1;
+    if (n_routes > CHURN_TID_BASE) n_routes = CHURN_TID_BASE;
+    if (n_flows < 1) n_flows = 1;
+    if (n_pkts < 1) n_pkts = 1;
+    if (churn_every < 0) churn_every = 0;
+
+    sim_hal_reset();
+    route_init();
+    route_tcam_region(CHURN_TID_BASE, CHURN_TID_SLOTS);
+    acl_init();
+    qos_init();
+    load_rib(n_routes);
+    for (int i = 0; i < 64; i++)
+        acl_add_deny(0x0B000000u | ((uint32_t)i << 8), 0xFFFFFF00u, 0, 0, (uint16_t)(7000 + i));
+
+    // 流表：随机五元组，目的地址落在已装路由内
+    typedef struct { uint32_t src, dst; uint16_t sport, dport; uint8_t tos, port; } flow_t;
+    flow_t *flows = (flow_t *)malloc((size_t)n_flows * sizeof(flow_t));
+    double *cdf   = (double *)malloc((size_t)n_flows * sizeof(double));
+    uint8_t      *buf  = (uint8_t *)malloc((size_t)n_pkts * 64);
+    pkt_desc_t   *desc = (pkt_desc_t *)malloc((size_t)n_pkts * sizeof(pkt_desc_t));
+    if (!flows || !cdf || !buf || !desc) return 1;
+
+    double sum = 0;
+    for (int f = 0; f < n_flows; f++) {
+        flows[f].src   = rng();
+        flows[f].dst   = 0x0A000000u | ((rng() % (uint32_t)n_routes) << 8) | (rng() & 0xFF);
+        flows[f].sport = (uint16_t)rng();
+        flows[f].dport = (uint16_t)(rng() % 1024);
+        flows[f].tos   = (uint8_t)((rng() % 64) << 2);
+        flows[f].port  = (uint8_t)(rng() % 32);
+        sum += 1.0 / pow((double)(f + 1), zipf_s);
+        cdf[f] = sum;
+    }
+    for (int f = 0; f < n_flows; f++) cdf[f] /= sum;
+
+    for (int i = 0; i < n_pkts; i++) {
+        const flow_t *fl = &flows[zipf_pick(cdf, n_flows)];
+        desc[i].data    = buf + (size_t)i * 64;
+        desc[i].len     = build_udp(buf + (size_t)i * 64, fl->src, fl->dst, fl->tos,
+                                    fl->sport, fl->dport);
+        desc[i].ig_port = fl->port;
+    }
+
+    printf("bench_flow: %d routes, %d flows, zipf %.2f, %d pkt pool, %.1f s/step, "
+           "churn every %d pkts\n\n", n_routes, n_flows, zipf_s, n_pkts, secs, churn_every);
+
+    run_t base = run(NULL, desc, n_pkts, secs);
+    printf("  %-12s %9s %10s %10s %9s %10s\n",
+           "cache", "hit rate", "Mpps", "ns/pkt", "speedup", "updates");
+    printf("  %-12s %9s %10.2f %10.1f %8.2fx %10llu\n", "none", "-",
+           base.mpps, 1e3 / base.mpps, 1.0, (unsigned long long)base.updates);
+
+    static const int sizes[] = { 1024, 4096, 16384, 65536 };
+    int n_sizes = cache_n > 0 ? 1 : (int)(sizeof(sizes) / sizeof(sizes[0]));
+    for (int k = 0; k < n_sizes; k++) {
+        int entries = cache_n > 0 ? cache_n : sizes[k];
+        pkt_flow_t *fc = pkt_flow_create(entries);
+        if (!fc) { fprintf(stderr, "pkt_flow_create(%d) failed\n", entries); return 1; }
+        run(fc, desc, n_pkts, secs * 0.2);                  // 预热
+        pkt_flow_clear_stats(fc);
+
+        run_t r = run(fc, desc, n_pkts, secs);
+        pkt_flow_stats_t st;
+        pkt_flow_get_stats(fc, &st);
+        char label[16];
+        snprintf(label, sizeof(label), "%d", entries);
+        printf("  %-12s %8.1f%% %10.2f %10.1f %8.2fx %10llu\n", label,
+               st.lookups ? 100.0 * (double)st.hits / (double)st.lookups : 0.0,
+               r.mpps, 1e3 / r.mpps, r.mpps / base.mpps, (unsigned long long)r.updates);
+        pkt_flow_destroy(fc);
+    }
+
+    free(flows);
+    free(cdf);
+    free(buf);
+    free(desc);
+    return 0;
+}
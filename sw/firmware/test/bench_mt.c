@@ -0,0 +1,223 @@
+// bench_mt.c
+// 多线程数据面模型扩展性测试：1..N 工作线程，控制面并发更新 + 快照发布
+//
+// 用法：./bench_mt [--threads N] [--routes N] [--pkts N] [--secs S] [--churn-ms MS]
+//   --threads   最大工作线程数（默认 = 在线 CPU 数，上限 PKT_MT_MAX_WORKERS）
+//   --routes    Stage 0 预装 /24 路由条数（默认 16384）
+//   --pkts      报文池大小（默认 65536，循环使用）
+//   --secs      每个线程数档位的测量时长（默认 1.0 s）
+//   --churn-ms  控制面线程 route_add/route_del + sim_tcam_publish 的周期（0 = 不更新）
+//
+// 每档输出 Mpps、相对单线程加速比，以及测量期间的发布次数 / 平均发布耗时。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "sim_hal.h"
+#include "pkt_model.h"
+#include "pkt_mt.h"
+#include "table_map.h"
+#include "route.h"
+#include "acl.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// ─────────────────────────────────────────────
+// 表项与流量
+// ─────────────────────────────────────────────
+
+// Stage 0：10.(i>>8).(i&0xFF).0/24 → port i%32，table_id = i
+static void load_rib(int n)
+{
+    for (int i = 0; i < n; i++) {
+        tcam_entry_t e;
+        memset(&e, 0, sizeof(e));
+        uint32_t pfx = 0x0A000000u | ((uint32_t)i << 8);
+        e.stage       = TABLE_IPV4_LPM_STAGE;
+        e.table_id    = (uint16_t)i;
+        e.key.key_len = e.mask.key_len = 4;
+        e.key.bytes[0] = (uint8_t)(pfx >> 24); e.key.bytes[1] = (uint8_t)(pfx >> 16);
+        e.key.bytes[2] = (uint8_t)(pfx >> 8);
+        e.mask.bytes[0] = e.mask.bytes[1] = e.mask.bytes[2] = 0xFF;
+        e.action_id        = ACTION_FORWARD;
+        e.action_params[0] = (uint8_t)(i % 32);
+        hal_tcam_insert(&e);
+    }
+}
+
+static uint16_t build_udp(uint8_t *b, uint32_t src, uint32_t dst, uint16_t dport)
+{
+    memset(b, 0, 42);
+    b[0] = 0x02; b[5] = 0x01; b[6] = 0x02; b[11] = 0x02;
+    b[12] = 0x08; b[13] = 0x00;
+    b[14] = 0x45; b[17] = 28; b[22] = 64; b[23] = 17;
+    for (int k = 0; k < 4; k++) {
+        b[26 + k] = (uint8_t)(src >> (24 - 8 * k));
+        b[30 + k] = (uint8_t)(dst >> (24 - 8 * k));
+    }
+    b[34] = 0x30; b[35] = 0x39;
+    b[36] = (uint8_t)(dport >> 8); b[37] = (uint8_t)dport;
+    return 42;
+}
+
+// ─────────────────────────────────────────────
+// 控制面更新线程
+// ─────────────────────────────────────────────
+
+// 192.168.x.0/24 经 route_add 写入 [CHURN_TID_BASE, +CHURN_TID_SLOTS)，--routes 限制在 CHURN_TID_BASE 以内
+#define CHURN_TID_BASE  0xA800
+#define CHURN_TID_SLOTS 512
+
+typedef struct {
+    int      period_ms;
+    int      stop;
+    uint64_t publishes;     // 统计字段由主线程并发读取，用原子访问
+    uint64_t publish_ns;
+} churn_t;
+
+static void *churn_main(void *arg)
+{
+    churn_t *c = (churn_t *)arg;
+    uint32_t i = 0;
+    while (!__atomic_load_n(&c->stop, __ATOMIC_ACQUIRE)) {
+        uint32_t pfx = 0xC0A80000u | ((i & 0xFF) << 8);     // 192.168.x.0/24
+        if (i & 0x100) route_del(pfx, 24);
+        else           route_add(pfx, 24, (uint8_t)(i % 32), 0x020000000000ULL | i);
+        acl_add_deny(0x01010100u | (i & 0xFF), 0xFFFFFFFFu, 0, 0, (uint16_t)(1000 + (i & 0xFF)));
+        i++;
+
+        double t0 = now_s();
+        sim_tcam_publish();
+        __atomic_fetch_add(&c->publish_ns, (uint64_t)((now_s() - t0) * 1e9), __ATOMIC_RELAXED);
+        __atomic_fetch_add(&c->publishes, 1, __ATOMIC_RELAXED);
+
+        struct timespec ts = { 0, (long)c->period_ms * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+// ─────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────
+int main(int argc, char **argv)
+{
+    int    max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int    n_routes    = 16384;
+    int    n_pkts      = 65536;
+    double secs        = 1.0;
+    int    churn_ms    = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--threads")  && i + 1 < argc) max_threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--routes")   && i + 1 < argc) n_routes    = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--pkts")     && i + 1 < argc) n_pkts      = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--secs")     && i + 1 < argc) secs        = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--churn-ms") && i + 1 < argc) churn_ms    = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--threads N] [--routes N] [--pkts N] "
+                            "[--secs S] [--churn-ms MS]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > PKT_MT_MAX_WORKERS) max_threads = PKT_MT_MAX_WORKERS;
+    if (n_routes > CHURN_TID_BASE) n_routes = CHURN_TID_BASE;
+    if (n_pkts < PKT_BURST_MAX) n_pkts = PKT_BURST_MAX;
+
+    sim_hal_reset();
+    route_init();
+    route_tcam_region(CHURN_TID_BASE, CHURN_TID_SLOTS);
+    acl_init();
+    load_rib(n_routes);
+    for (int i = 0; i < 64; i++)
+        acl_add_deny(0x0B000000u | ((uint32_t)i << 8), 0xFFFFFF00u, 0, 0, (uint16_t)(7000 + i));
+    sim_tcam_publish();
+
+    uint8_t      *buf  = (uint8_t *)malloc((size_t)n_pkts * 64);
+    pkt_desc_t   *desc = (pkt_desc_t *)malloc((size_t)n_pkts * sizeof(pkt_desc_t));
+    fwd_result_t *res  = (fwd_result_t *)malloc((size_t)n_pkts * sizeof(fwd_result_t));
+    if (!buf || !desc || !res) return 1;
+    for (int i = 0; i < n_pkts; i++) {
+        uint32_t r   = rng() % (uint32_t)n_routes;
+        uint32_t dst = 0x0A000000u | (r << 8) | (rng() & 0xFF);
+        desc[i].data    = buf + (size_t)i * 64;
+        desc[i].len     = build_udp(buf + (size_t)i * 64, rng(), dst, (uint16_t)rng());
+        desc[i].ig_port = (uint8_t)(i % 32);
+    }
+
+    printf("bench_mt: %d routes, %d ACL, %d pkt pool, %.1f s/step, churn %d ms\n\n",
+           n_routes, sim_tcam_count_stage(TABLE_ACL_INGRESS_STAGE), n_pkts, secs, churn_ms);
+
+    // 单线程 live 基线（此时无并发写者）
+    double t0 = now_s();
+    uint64_t done = 0;
+    while (now_s() - t0 < secs) {
+        pkt_process_burst(desc, n_pkts, res);
+        done += (uint64_t)n_pkts;
+    }
+    double base_mpps = (double)done / (now_s() - t0) / 1e6;
+    printf("  %-10s %8.2f Mpps  %7.1f ns/pkt\n", "live/1T", base_mpps, 1e3 / base_mpps);
+
+    churn_t   churn;
+    pthread_t churn_tid;
+    memset(&churn, 0, sizeof(churn));
+    churn.period_ms = churn_ms;
+    if (churn_ms > 0) pthread_create(&churn_tid, NULL, churn_main, &churn);
+
+    printf("\n  %-8s %10s %10s %9s %11s %14s\n",
+           "threads", "Mpps", "ns/pkt", "speedup", "publishes", "avg publish");
+    double one_mpps = 0;
+    for (int t = 1; t <= max_threads; t = (t == max_threads) ? t + 1
+                                          : (t * 2 > max_threads ? max_threads : t * 2)) {
+        pkt_mt_t *mt = pkt_mt_create(t);
+        if (!mt) { fprintf(stderr, "pkt_mt_create(%d) failed\n", t); return 1; }
+        pkt_mt_process(mt, desc, n_pkts, res);              // 预热
+
+        uint64_t pub0  = __atomic_load_n(&churn.publishes, __ATOMIC_RELAXED);
+        uint64_t pns0  = __atomic_load_n(&churn.publish_ns, __ATOMIC_RELAXED);
+        done = 0;
+        t0 = now_s();
+        while (now_s() - t0 < secs) {
+            pkt_mt_process(mt, desc, n_pkts, res);
+            done += (uint64_t)n_pkts;
+        }
+        double el   = now_s() - t0;
+        double mpps = (double)done / el / 1e6;
+        if (t == 1) one_mpps = mpps;
+        uint64_t pubs = __atomic_load_n(&churn.publishes, __ATOMIC_RELAXED) - pub0;
+        uint64_t pns  = __atomic_load_n(&churn.publish_ns, __ATOMIC_RELAXED) - pns0;
+        printf("  %-8d %10.2f %10.1f %8.2fx %11llu %11.3f ms\n",
+               t, mpps, 1e3 / mpps, one_mpps > 0 ? mpps / one_mpps : 0.0,
+               (unsigned long long)pubs,
+               pubs ? (double)pns / (double)pubs * 1e-6 : 0.0);
+        pkt_mt_destroy(mt);
+    }
+
+    if (churn_ms > 0) {
+        __atomic_store_n(&churn.stop, 1, __ATOMIC_RELEASE);
+        pthread_join(churn_tid, NULL);
+    }
+    free(buf);
+    free(desc);
+    free(res);
+    return 0;
+}
@@ -0,0 +1,224 @@
+// bench_punt.c
+// 慢路径压力测试：数据面模型线程 punt ARP → SPSC 环 → cp_main 主循环线程
+//
+// 用法：./bench_punt [--secs S] [--burst N] [--senders N] [--mix P]
+//   --secs     每档测量时长（默认 1.0 s）
+//   --burst    数据面每批帧数 / 注入批大小（默认依次测 1 / 8 / 32）
+//   --senders  ARP 发送方个数（默认 64，被动学习，不触发应答打印）
+//   --mix      报文中 ARP 所占百分比，其余为命中路由的 IPv4（默认 100）
+//
+// 数据面线程在已发布快照上跑流水线，punt 结果写入 Punt RX 环；环满即丢
+// （与硬件环满行为一致）。固件线程以 CP_NO_MAIN 编译的 cp_main.c 为主体：
+// cp_punt_poll() 收包处理，TCAM 变化后发布快照，每 100 ms 调用 cp_tick_100ms()。
+// 输出每档的数据面 Mpps、punt 速率、环满丢包与固件处理速率。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "sim_hal.h"
+#include "pkt_model.h"
+#include "cp_main.h"
+#include "table_map.h"
+#include "route.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ─────────────────────────────────────────────
+// 报文
+// ─────────────────────────────────────────────
+
+#define POOL    4096
+
+static uint8_t    pool[POOL][64];
+static pkt_desc_t pool_desc[POOL];
+
+// 端口 0-7 属于 VLAN 10（cp_init 默认配置）；tpa 不是本机接口地址
+static uint16_t build_arp(uint8_t *b, int sender)
+{
+    memset(b, 0, 42);
+    memset(b, 0xFF, 6);
+    b[6] = 0x02; b[10] = (uint8_t)(sender >> 8); b[11] = (uint8_t)sender;
+    b[12] = 0x08; b[13] = 0x06;
+    b[14] = 0x00; b[15] = 0x01; b[16] = 0x08; b[17] = 0x00;
+    b[18] = 6; b[19] = 4; b[20] = 0x00; b[21] = 0x01;
+    memcpy(b + 22, b + 6, 6);
+    b[28] = 10; b[29] = 10; b[30] = (uint8_t)(1 + (sender >> 8)); b[31] = (uint8_t)sender;
+    b[38] = 10; b[39] = 10; b[40] = 0; b[41] = 0xFE;
+    return 42;
+}
+
+static uint16_t build_ipv4(uint8_t *b, uint32_t dst)
+{
+    memset(b, 0, 34);
+    b[0] = 0x02; b[5] = 0x01; b[6] = 0x02; b[11] = 0x02;
+    b[12] = 0x08; b[13] = 0x00;
+    b[14] = 0x45; b[17] = 20; b[22] = 64; b[23] = 17;
+    b[26] = 1; b[27] = 2; b[28] = 3; b[29] = 4;
+    for (int k = 0; k < 4; k++) b[30 + k] = (uint8_t)(dst >> (24 - 8 * k));
+    return 34;
+}
+
+// ─────────────────────────────────────────────
+// 线程
+// ─────────────────────────────────────────────
+
+typedef struct {
+    volatile int run;
+    int          burst;
+    int          reader;
+    // 数据面线程
+    uint64_t     dp_pkts, punted, ring_full;
+    // 固件线程
+    uint64_t     fw_pkts, publishes;
+} bench_t;
+
+static void *dp_thread(void *arg)
+{
+    bench_t     *b = (bench_t *)arg;
+    fwd_result_t res[64];
+    punt_pkt_t   out[64], tx[64];
+    int          pos = 0;
+
+    while (__atomic_load_n(&b->run, __ATOMIC_ACQUIRE)) {
+        const pkt_desc_t *d = &pool_desc[pos];
+        int n = b->burst;
+        if (pos + n > POOL) n = POOL - pos;
+        pos = (pos + n) % POOL;
+
+        const sim_tcam_snap_t *snap = sim_tcam_read_begin(b->reader);
+        pkt_process_burst_snap(snap, d, n, res);
+        sim_tcam_read_end(b->reader);
+
+        int m = 0;
+        for (int i = 0; i < n; i++) {
+            if (!res[i].punt) continue;
+            out[m].ing_port = d[i].ig_port;
+            out[m].eg_port  = 0;
+            out[m].vlan_id  = res[i].vlan_id;
+            out[m].reason   = PUNT_REASON_ARP;
+            out[m].pkt_len  = d[i].len;
+            memcpy(out[m].data, d[i].data, d[i].len);
+            m++;
+        }
+        int done = m ? sim_punt_rx_inject_burst(out, m) : 0;
+        b->dp_pkts   += (uint64_t)n;
+        b->punted    += (uint64_t)done;
+        b->ring_full += (uint64_t)(m - done);
+
+        sim_punt_tx_pop_burst(tx, 64);      // 固件发出的包（ARP 应答 / 探测）直接丢弃
+    }
+    return NULL;
+}
+
+static void *fw_thread(void *arg)
+{
+    bench_t *b    = (bench_t *)arg;
+    uint64_t gen  = sim_tcam_generation();
+    double   next = now_s() + 0.1;
+
+    while (__atomic_load_n(&b->run, __ATOMIC_ACQUIRE)) {
+        int n = cp_punt_poll();
+        b->fw_pkts += (uint64_t)n;
+        if (sim_tcam_generation() != gen) {
+            sim_tcam_publish();
+            gen = sim_tcam_generation();
+            b->publishes++;
+        }
+        if (!n) {
+            double t = now_s();
+            if (t >= next) { cp_tick_100ms(); next += 0.1; }
+            sched_yield();
+        }
+    }
+    cp_punt_poll();                         // 收尾：取空 RX 环
+    return NULL;
+}
+
+// ─────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────
+int main(int argc, char **argv)
+{
+    double secs    = 1.0;
+    int    burst   = 0;
+    int    senders = 64;
+    int    mix     = 100;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--secs")    && i + 1 < argc) secs    = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--burst")   && i + 1 < argc) burst   = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--senders") && i + 1 < argc) senders = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--mix")     && i + 1 < argc) mix     = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--secs S] [--burst N] [--senders N] [--mix P]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (burst > 64) burst = 64;
+    if (senders < 1) senders = 1;
+    if (senders > 4096) senders = 4096;
+    if (mix < 0) mix = 0;
+    if (mix > 100) mix = 100;
+
+    if (cp_init() != HAL_OK) return 1;
+    // 功能模型对非 IPv4 帧同样查 Stage 0，cp_init 的默认 drop 路由会在
+    // Stage 3 之前丢掉 ARP；压测慢路径时去掉它
+    hal_tcam_delete(TABLE_IPV4_LPM_STAGE, TABLE_IPV4_LPM_BASE + 0xFFFF);
+    route_add(0x0B000000u, 8, 3, 0x020000000003ULL);
+    if (sim_tcam_publish() != HAL_OK) return 1;
+
+    for (int i = 0; i < POOL; i++) {
+        pool_desc[i].data    = pool[i];
+        pool_desc[i].ig_port = (uint8_t)(i % 8);
+        if ((i * 37) % 100 < mix) pool_desc[i].len = build_arp(pool[i], i % senders);
+        else                      pool_desc[i].len = build_ipv4(pool[i], 0x0B000000u | (uint32_t)i);
+    }
+
+    printf("\nbench_punt: %d ARP senders, %d%% ARP, SPSC ring %d slots, %.1f s/step\n\n",
+           senders, mix, SIM_PUNT_MAX, secs);
+    printf("  %-6s %10s %12s %12s %12s %10s %10s\n",
+           "burst", "dp Mpps", "punt Mpps", "ring full", "fw Mpps", "ns/punt", "publishes");
+
+    static const int bursts[] = { 1, 8, 32 };
+    int n_steps = burst > 0 ? 1 : (int)(sizeof(bursts) / sizeof(bursts[0]));
+    for (int k = 0; k < n_steps; k++) {
+        bench_t b;
+        memset(&b, 0, sizeof(b));
+        b.run    = 1;
+        b.burst  = burst > 0 ? burst : bursts[k];
+        b.reader = sim_tcam_reader_register();
+        if (b.reader < 0) return 1;
+
+        pthread_t dp, fw;
+        double t0 = now_s();
+        pthread_create(&fw, NULL, fw_thread, &b);
+        pthread_create(&dp, NULL, dp_thread, &b);
+        while (now_s() - t0 < secs) {
+            struct timespec ts = { 0, 10000000 };
+            nanosleep(&ts, NULL);
+        }
+        __atomic_store_n(&b.run, 0, __ATOMIC_RELEASE);
+        pthread_join(dp, NULL);
+        pthread_join(fw, NULL);
+        double dt = now_s() - t0;
+        sim_tcam_reader_unregister(b.reader);
+
+        printf("  %-6d %10.2f %12.3f %12llu %12.3f %10.1f %10llu\n", b.burst,
+               (double)b.dp_pkts / dt / 1e6,
+               (double)b.punted / dt / 1e6,
+               (unsigned long long)b.ring_full,
+               (double)b.fw_pkts / dt / 1e6,
+               b.fw_pkts ? dt * 1e9 / (double)b.fw_pkts : 0.0,
+               (unsigned long long)b.publishes);
+    }
+    return 0;
+}
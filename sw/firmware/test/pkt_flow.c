@@ -0,0 +1,299 @@
+// pkt_flow.c
+// 精确匹配流缓存（见 pkt_flow.h）
+
+#include "pkt_flow.h"
+#include "pkt_prog.h"
+#include "sim_tcam.h"
+#include "table_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FLOW_HDR_SPAN   PHV_OFF_IG_PORT     // 报头区 [0, 256)，其上为元数据
+
+// 组标签：一条缓存行，探测时只读这一行
+typedef struct {
+    uint32_t hash[PKT_FLOW_WAYS];
+    uint32_t tick[PKT_FLOW_WAYS];   // 最近使用时间（组内 LRU）
+    uint64_t gen[PKT_FLOW_WAYS];    // 写入时的代数（0 = 空）
+} flow_set_t;
+
+typedef struct {
+    uint8_t      key[PKT_FLOW_KEY_MAX];
+    uint8_t      rw[PKT_FLOW_RW_MAX];
+    fwd_result_t result;
+    uint8_t      pad[64 - PKT_FLOW_KEY_MAX - PKT_FLOW_RW_MAX - sizeof(fwd_result_t)];
+} flow_ent_t;                       // 64B
+
+struct pkt_flow {
+    flow_set_t      *set;
+    flow_ent_t      *ent;
+    uint32_t         set_mask;
+    uint32_t         tick;
+
+    // 由当前程序推导的流键 / 改写布局
+    uint32_t         prog_gen;
+    int              plan_ok;
+    uint8_t          key_len;       // 含入端口 1 字节
+    uint8_t          rw_len;
+    uint8_t          n_key, n_rw;
+    pkt_seg_t        key_seg[PKT_FLOW_SEGS_MAX];
+    pkt_seg_t        rw_seg[PKT_FLOW_SEGS_MAX];
+
+    pkt_flow_stats_t st;
+};
+
+// ─────────────────────────────────────────────
+// 流键 / 改写布局推导
+// ─────────────────────────────────────────────
+
+static void mark(uint8_t *bm, uint16_t off, int len)
+{
+    for (int k = 0; k < len && off + k < FLOW_HDR_SPAN; k++) bm[off + k] = 1;
+}
+
+// 把字节位图转成连续片段；片段数或总长度超限返回 -1
+static int bm_to_segs(const uint8_t *bm, pkt_seg_t *seg, uint8_t *n_seg,
+                      uint8_t *total, int max_len)
+{
+    int n = 0, sum = 0;
+    for (int i = 0; i < FLOW_HDR_SPAN; ) {
+        if (!bm[i]) { i++; continue; }
+        int j = i;
+        while (j < FLOW_HDR_SPAN && bm[j]) j++;
+        if (n == PKT_FLOW_SEGS_MAX) return -1;
+        seg[n].off = (uint16_t)i;
+        seg[n].len = (uint8_t)(j - i);
+        sum += j - i;
+        n++;
+        i = j;
+    }
+    if (sum > max_len) return -1;
+    *n_seg = (uint8_t)n;
+    *total = (uint8_t)sum;
+    return 0;
+}
+
+static void plan_build(pkt_flow_t *fc, const pkt_prog_t *pg)
+{
+    uint8_t rd[FLOW_HDR_SPAN], wr[FLOW_HDR_SPAN];
+    memset(rd, 0, sizeof(rd));
+    memset(wr, 0, sizeof(wr));
+
+    // pkt_parse 由 TCI 派生 vlan_id，TCI 总是参与流键
+    mark(rd, PHV_OFF_VLAN_TCI, 2);
+
+    for (int s = 0; s < pg->n_stages; s++) {
+        for (int i = 0; i < pg->stage[s].n_seg; i++)
+            mark(rd, pg->stage[s].seg[i].off, pg->stage[s].seg[i].len);
+        for (int i = 0; i < pg->stage[s].n_hseg; i++)       // HASH_SET 的输入
+            mark(rd, pg->stage[s].hseg[i].off, pg->stage[s].hseg[i].len);
+    }
+
+    for (int a = 0; a < pg->n_actions; a++) {
+        const pkt_action_t *act = &pg->action[a];
+        for (int i = 0; i < act->n_prim; i++) {
+            const pkt_prim_t *pr = &act->prim[i];
+            switch (pr->op) {
+            case PKT_OP_COPY:
+                mark(rd, pr->src_off, pr->fwidth);
+                mark(wr, pr->dst_off, pr->fwidth);
+                break;
+            case PKT_OP_ADD: case PKT_OP_SUB:
+            case PKT_OP_AND: case PKT_OP_OR: case PKT_OP_XOR:
+                mark(rd, pr->dst_off, pr->fwidth);
+                mark(wr, pr->dst_off, pr->fwidth);
+                break;
+            case PKT_OP_SET: case PKT_OP_SET_META: case PKT_OP_COND_SET:
+            case PKT_OP_HASH_SET:
+                mark(wr, pr->dst_off, pr->fwidth);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    uint8_t klen = 0;
+    fc->plan_ok =
+        bm_to_segs(rd, fc->key_seg, &fc->n_key, &klen, PKT_FLOW_KEY_MAX - 1) == 0 &&
+        bm_to_segs(wr, fc->rw_seg,  &fc->n_rw,  &fc->rw_len, PKT_FLOW_RW_MAX) == 0;
+    fc->key_len = (uint8_t)(klen + 1);
+}
+
+// ─────────────────────────────────────────────
+// 条目访问
+// ─────────────────────────────────────────────
+
+// key 缓冲区须已清零（哈希按 8 字节字读取尾部）
+static void flow_key(const pkt_flow_t *fc, const phv_t *phv, uint8_t *key)
+{
+    key[0] = phv->ig_port;
+    uint8_t o = 1;
+    for (int i = 0; i < fc->n_key; i++) {
+        memcpy(key + o, &phv->hdr[fc->key_seg[i].off], fc->key_seg[i].len);
+        o = (uint8_t)(o + fc->key_seg[i].len);
+    }
+}
+
+// 按 8 字节字乘法混合（key 末尾补零到 8 字节倍数）
+static uint32_t flow_hash(const uint8_t *key, int len)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)len;
+    for (int i = 0; i < len; i += 8) {
+        uint64_t w;
+        memcpy(&w, key + i, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    return (uint32_t)(h ^ (h >> 29));
+}
+
+static void rw_save(const pkt_flow_t *fc, const phv_t *phv, uint8_t *rw)
+{
+    uint8_t o = 0;
+    for (int i = 0; i < fc->n_rw; i++) {
+        memcpy(rw + o, &phv->hdr[fc->rw_seg[i].off], fc->rw_seg[i].len);
+        o = (uint8_t)(o + fc->rw_seg[i].len);
+    }
+}
+
+static void rw_apply(const pkt_flow_t *fc, phv_t *phv, const uint8_t *rw)
+{
+    uint8_t o = 0;
+    for (int i = 0; i < fc->n_rw; i++) {
+        memcpy(&phv->hdr[fc->rw_seg[i].off], rw + o, fc->rw_seg[i].len);
+        o = (uint8_t)(o + fc->rw_seg[i].len);
+    }
+}
+
+// ─────────────────────────────────────────────
+// 公共 API
+// ─────────────────────────────────────────────
+
+pkt_flow_t *pkt_flow_create(int n_entries)
+{
+    if (n_entries <= 0) return NULL;
+    uint32_t sets = 1;
+    while (sets * PKT_FLOW_WAYS < (uint32_t)n_entries) sets <<= 1;
+
+    pkt_flow_t *fc = (pkt_flow_t *)calloc(1, sizeof(*fc));
+    if (!fc) return NULL;
+    fc->set = (flow_set_t *)aligned_alloc(64, (size_t)sets * sizeof(flow_set_t));
+    fc->ent = (flow_ent_t *)aligned_alloc(64, (size_t)sets * PKT_FLOW_WAYS * sizeof(flow_ent_t));
+    if (!fc->set || !fc->ent) {
+        free(fc->set);
+        free(fc->ent);
+        free(fc);
+        return NULL;
+    }
+    fc->set_mask = sets - 1;
+    pkt_flow_flush(fc);
+    return fc;
+}
+
+void pkt_flow_destroy(pkt_flow_t *fc)
+{
+    if (!fc) return;
+    free(fc->set);
+    free(fc->ent);
+    free(fc);
+}
+
+void pkt_flow_flush(pkt_flow_t *fc)
+{
+    if (!fc) return;
+    memset(fc->set, 0, (size_t)(fc->set_mask + 1) * sizeof(flow_set_t));
+}
+
+int pkt_flow_forward(pkt_flow_t *fc, phv_t *phv, fwd_result_t *result)
+{
+    if (!fc || !phv || !result) return -1;
+
+    const pkt_prog_t *pg = pkt_prog_current();
+    uint32_t pgen = pkt_prog_generation();
+    if (pgen != fc->prog_gen) {
+        plan_build(fc, pg);
+        fc->prog_gen = pgen;
+    }
+
+    fc->st.lookups++;
+    if (!fc->plan_ok) {
+        fc->st.bypass++;
+        return pkt_forward(phv, result);
+    }
+
+    // 两个计数器都单调递增且 pgen >= 1，和也单调递增且非 0
+    uint64_t gen = sim_tcam_generation() + pgen;
+    uint8_t  key[PKT_FLOW_KEY_MAX + 8];
+    memset(key, 0, sizeof(key));
+    flow_key(fc, phv, key);
+    uint32_t h = flow_hash(key, fc->key_len);
+
+    uint32_t    si  = h & fc->set_mask;
+    flow_set_t *set = &fc->set[si];
+    flow_ent_t *ent = &fc->ent[(size_t)si * PKT_FLOW_WAYS];
+    int victim = -1;
+    for (int w = 0; w < PKT_FLOW_WAYS; w++) {
+        if (!set->gen[w] || set->hash[w] != h || memcmp(ent[w].key, key, fc->key_len))
+            continue;
+        if (set->gen[w] == gen) {
+            const flow_ent_t *e = &ent[w];
+            rw_apply(fc, phv, e->rw);
+            *result          = e->result;
+            phv->eg_port     = result->eg_port;
+            phv->drop        = result->drop;
+            phv->punt        = result->punt;
+            phv->vlan_id     = result->vlan_id;
+            phv->qos_prio    = result->qos_prio;
+            phv->vlan_action = result->vlan_action;
+            set->tick[w] = ++fc->tick;
+            fc->st.hits++;
+            return 0;
+        }
+        fc->st.stale++;
+        victim = w;             // 同一条流的过期条目：原位刷新
+        break;
+    }
+
+    fc->st.misses++;
+    int rc = pkt_forward(phv, result);
+    if (rc != 0) return rc;
+
+    if (victim < 0) {
+        // 优先用空槽 / 过期槽，否则替换组内最久未用的条目
+        for (int w = 0; w < PKT_FLOW_WAYS && victim < 0; w++)
+            if (set->gen[w] != gen) victim = w;
+        if (victim < 0) {
+            victim = 0;
+            for (int w = 1; w < PKT_FLOW_WAYS; w++)
+                if ((int32_t)(set->tick[w] - set->tick[victim]) < 0) victim = w;
+            fc->st.evictions++;
+        }
+    }
+    set->gen[victim]  = gen;
+    set->hash[victim] = h;
+    set->tick[victim] = ++fc->tick;
+    ent[victim].result = *result;
+    memcpy(ent[victim].key, key, fc->key_len);
+    rw_save(fc, phv, ent[victim].rw);
+    return 0;
+}
+
+int pkt_flow_process(pkt_flow_t *fc, const uint8_t *raw, uint16_t raw_len,
+                     uint8_t ing_port, fwd_result_t *result)
+{
+    phv_t phv;
+    int rc = pkt_parse(raw, raw_len, ing_port, &phv);
+    if (rc != 0) return rc;
+    return pkt_flow_forward(fc, &phv, result);
+}
+
+void pkt_flow_get_stats(const pkt_flow_t *fc, pkt_flow_stats_t *st)
+{
+    if (fc && st) *st = fc->st;
+}
+
+void pkt_flow_clear_stats(pkt_flow_t *fc)
+{
+    if (fc) memset(&fc->st, 0, sizeof(fc->st));
+}
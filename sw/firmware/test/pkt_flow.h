@@ -0,0 +1,69 @@
+// pkt_flow.h
+// 精确匹配流缓存 — 放在 pkt_forward() 前面的快速路径模型
+//
+// 对应计划中 RISC-V 核上处理 Punt 流量的软件快速路径：同一条流的后续报文
+// 不再逐级查 TCAM，而是一次精确匹配直接得到转发决策。
+//
+//   - 流键：当前流水线程序实际读取的报头字节（各级键片段 + Action 的
+//     COPY 源 / 算术操作数）+ 入端口 + VLAN TCI（解析时派生 vlan_id），
+//     程序变化时从 pkt_prog 推导，因此与程序无关的字段不会拆分流；
+//   - 条目：最终 fwd_result_t + 程序会改写的报头字节（如 eth_dst）；
+//   - 失效：条目记录写入时的代数（sim_tcam_generation + pkt_prog_generation），
+//     任何 hal_tcam_insert / delete / modify / flush 或程序重载之后旧条目
+//     自然失效，无需遍历清除；
+//   - 组织：4 路组相联，组内按最近使用替换；每组的哈希 / 代数 / LRU 标签
+//     放在一条 64B 缓存行内，条目本身也是 64B，命中只触及两条缓存行。
+//
+// 非线程安全：每个调用线程使用独立的 pkt_flow_t，且只配合 live 数据库
+// （pkt_forward 路径）使用。
+
+#ifndef PKT_FLOW_H
+#define PKT_FLOW_H
+
+#include <stdint.h>
+#include "pkt_model.h"
+
+#define PKT_FLOW_WAYS       4
+#define PKT_FLOW_KEY_MAX    32      // 流键字节上限（含入端口）
+#define PKT_FLOW_RW_MAX     16      // 缓存的报头改写字节上限
+#define PKT_FLOW_SEGS_MAX   16      // 流键 / 改写片段数上限
+
+typedef struct pkt_flow pkt_flow_t;
+
+typedef struct {
+    uint64_t lookups;       // 总报文数（= hits + misses + bypass）
+    uint64_t hits;
+    uint64_t misses;        // 含 stale
+    uint64_t stale;         // 流键命中但代数过期（表项或程序已更新）
+    uint64_t evictions;     // 替换仍然有效的条目
+    uint64_t bypass;        // 程序的流键 / 改写超出上限，直接走流水线
+} pkt_flow_stats_t;
+
+/**
+ * pkt_flow_create - 创建流缓存
+ * @n_entries: 条目数，向上取整为 2 的幂（至少 PKT_FLOW_WAYS）
+ * 失败返回 NULL。
+ */
+pkt_flow_t *pkt_flow_create(int n_entries);
+
+void pkt_flow_destroy(pkt_flow_t *fc);
+
+/** 清空全部条目（统计保留） */
+void pkt_flow_flush(pkt_flow_t *fc);
+
+/**
+ * pkt_flow_forward - 带缓存的 pkt_forward
+ * 命中时把缓存的改写字节写回 phv->hdr、元数据写回 phv，输出与
+ * pkt_forward 相同的结果；未命中时执行 pkt_forward 并填充缓存。
+ * 返回 0；参数非法返回 -1。
+ */
+int pkt_flow_forward(pkt_flow_t *fc, phv_t *phv, fwd_result_t *result);
+
+/** pkt_parse + pkt_flow_forward（语义同 pkt_process） */
+int pkt_flow_process(pkt_flow_t *fc, const uint8_t *raw, uint16_t raw_len,
+                     uint8_t ing_port, fwd_result_t *result);
+
+void pkt_flow_get_stats(const pkt_flow_t *fc, pkt_flow_stats_t *st);
+void pkt_flow_clear_stats(pkt_flow_t *fc);
+
+#endif /* PKT_FLOW_H */
@@ -1,209 +1,236 @@
 // pkt_model.c
 // 数据面功能模型实现
 //
-// PISA 流水线仿真：7 个 MAU Stage（0-6），使用 sim_hal.c 的 TCAM 数据库。
+// PISA 流水线仿真：最多 24 个 MAU Stage，使用 sim_tcam.c 的 TCAM 数据库。
+// 解析由 pkt_parser 按 Parser TCAM 程序执行；每级的键提取与 Action 语义
+// 来自 pkt_prog（内置程序或编译器产物）。
 // 三值匹配规则：(pkt_key[i] & mask[i]) == (entry_key[i] & mask[i])
 
 #include "pkt_model.h"
-#include "sim_hal.h"
+#include "pkt_prog.h"
+#include "pkt_parser.h"
+#include "sim_tcam.h"
 #include <string.h>
 
 // ─────────────────────────────────────────────
-// 内部：三值 TCAM 查找
+// 内部：元数据访问
 // ─────────────────────────────────────────────
-// 在 sim_tcam_db 中对指定 stage 做三值匹配（first-match，与 sim_hal 扫描顺序一致）。
-// 匹配条件：对每个字节 i（i < cmp_len）：
-//   (pkt_key[i] & entry.mask[i]) == (entry.key[i] & entry.mask[i])
-// 返回第一个命中的条目指针；无命中返回 NULL。
-
-static sim_tcam_rec_t *tcam_ternary_lookup(uint8_t stage,
-                                            const uint8_t *key,
-                                            uint8_t key_len)
+// 元数据与报头共用 PHV 偏移空间（>= PHV_OFF_IG_PORT），
+// 读写时映射到 phv_t 的元数据字段。
+
+static uint8_t phv_get(const phv_t *phv, uint16_t off)
 {
-    for (int i = 0; i < sim_tcam_n; i++) {
-        sim_tcam_rec_t *r = &sim_tcam_db[i];
-        if (!r->valid || r->deleted)          continue;
-        if (r->entry.stage != stage)          continue;
-
-        uint8_t match    = 1;
-        uint8_t cmp_len  = r->entry.key.key_len;
-        if (cmp_len > key_len) cmp_len = key_len;
-
-        for (uint8_t b = 0; b < cmp_len; b++) {
-            if ((key[b] & r->entry.mask.bytes[b]) !=
-                (r->entry.key.bytes[b] & r->entry.mask.bytes[b])) {
-                match = 0;
-                break;
-            }
-        }
-        if (match) return r;
+    switch (off) {
+    case PHV_OFF_IG_PORT:       return phv->ig_port;
+    case PHV_OFF_EG_PORT:       return phv->eg_port;
+    case PHV_OFF_DROP:          return phv->drop;
+    case PHV_OFF_VLAN_ID:       return (uint8_t)(phv->vlan_id >> 8);
+    case PHV_OFF_VLAN_ID + 1:   return (uint8_t)(phv->vlan_id & 0xFF);
+    case PHV_OFF_QOS_PRIO:      return phv->qos_prio;
+    case PKT_META_OFF_PUNT:     return phv->punt;
+    case PKT_META_OFF_VLAN_ACT: return phv->vlan_action;
+    default:                    return phv->hdr[off];
     }
-    return NULL;
 }
 
-// ─────────────────────────────────────────────
-// 内部：每级 PHV 关键字提取函数
-// ─────────────────────────────────────────────
-// 各 Stage 按固件约定从 PHV 中提取匹配键；与各 firmware 模块中 key 编码严格对应。
-
-// Stage 0 — IPv4 LPM：匹配 ipv4_dst（4 字节，PHV offset 34）
-static void extract_s0(const phv_t *phv, uint8_t *key, uint8_t *klen)
+static void phv_put(phv_t *phv, uint16_t off, uint8_t b)
 {
-    memcpy(key, &phv->hdr[PHV_OFF_IPV4_DST], 4);
-    *klen = 4;
+    switch (off) {
+    case PHV_OFF_IG_PORT:       phv->ig_port     = b; break;
+    case PHV_OFF_EG_PORT:       phv->eg_port     = b; break;
+    case PHV_OFF_DROP:          phv->drop        = b; break;
+    case PHV_OFF_VLAN_ID:       phv->vlan_id = (uint16_t)((b << 8) | (phv->vlan_id & 0xFF)); break;
+    case PHV_OFF_VLAN_ID + 1:   phv->vlan_id = (uint16_t)((phv->vlan_id & 0xFF00) | b);     break;
+    case PHV_OFF_QOS_PRIO:      phv->qos_prio    = b; break;
+    case PKT_META_OFF_PUNT:     phv->punt        = b; break;
+    case PKT_META_OFF_VLAN_ACT: phv->vlan_action = b; break;
+    default:                    phv->hdr[off]    = b; break;
+    }
 }
 
-// Stage 1 — ACL：匹配 ipv4_src(4B) + ipv4_dst(4B) + tcp/udp_dport(2B)
-static void extract_s1(const phv_t *phv, uint8_t *key, uint8_t *klen)
+// 把元数据字段写入 hdr 的元数据区，使键提取只需按偏移 memcpy
+static void meta_sync(phv_t *phv)
 {
-    memcpy(key,   &phv->hdr[PHV_OFF_IPV4_SRC],  4);
-    memcpy(key+4, &phv->hdr[PHV_OFF_IPV4_DST],  4);
-    memcpy(key+8, &phv->hdr[PHV_OFF_TCP_DPORT], 2);
-    *klen = 10;
+    phv->hdr[PHV_OFF_IG_PORT]       = phv->ig_port;
+    phv->hdr[PHV_OFF_EG_PORT]       = phv->eg_port;
+    phv->hdr[PHV_OFF_DROP]          = phv->drop;
+    phv->hdr[PHV_OFF_VLAN_ID]       = (uint8_t)(phv->vlan_id >> 8);
+    phv->hdr[PHV_OFF_VLAN_ID + 1]   = (uint8_t)(phv->vlan_id & 0xFF);
+    phv->hdr[PHV_OFF_QOS_PRIO]      = phv->qos_prio;
+    phv->hdr[PKT_META_OFF_PUNT]     = phv->punt;
+    phv->hdr[PKT_META_OFF_VLAN_ACT] = phv->vlan_action;
 }
 
-// Stage 2 — L2 FDB：匹配 eth_dst（6 字节，PHV offset 0）
-static void extract_s2(const phv_t *phv, uint8_t *key, uint8_t *klen)
-{
-    memcpy(key, &phv->hdr[PHV_OFF_ETH_DST], 6);
-    *klen = 6;
-}
+// ─────────────────────────────────────────────
+// 内部：按提取计划生成匹配键
+// ─────────────────────────────────────────────
 
-// Stage 3 — ARP Punt：匹配 eth_type（2 字节，PHV offset 12）
-static void extract_s3(const phv_t *phv, uint8_t *key, uint8_t *klen)
+static void extract_key(const pkt_stage_plan_t *pl, phv_t *phv, uint8_t *key)
 {
-    memcpy(key, &phv->hdr[PHV_OFF_ETH_TYPE], 2);
-    *klen = 2;
+    if (pl->uses_meta) meta_sync(phv);
+    uint8_t o = 0;
+    for (int i = 0; i < pl->n_seg; i++) {
+        memcpy(key + o, &phv->hdr[pl->seg[i].off], pl->seg[i].len);
+        o = (uint8_t)(o + pl->seg[i].len);
+    }
 }
 
-// Stage 4 — VLAN 入口：匹配 [ing_port(1B)] [vlan_tci(2B)]
-// vlan_tci 在无标签帧中为 0x0000；TCAM 掩码全 0 表示通配。
-static void extract_s4(const phv_t *phv, uint8_t *key, uint8_t *klen)
-{
-    key[0] = phv->ig_port;
-    key[1] = phv->hdr[PHV_OFF_VLAN_TCI];
-    key[2] = phv->hdr[PHV_OFF_VLAN_TCI + 1];
-    *klen = 3;
-}
+// ─────────────────────────────────────────────
+// Flow hash（mau_hash.sv CRC32：IEEE 802.3 反射多项式，初值 / 结果取反）
+// ─────────────────────────────────────────────
+
+static const uint32_t crc32_nib[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
 
-// Stage 5 — DSCP QoS：匹配 ipv4_dscp 字节（高 6 位 = DSCP，低 2 位 = ECN）
-// TCAM key = dscp << 2，mask = 0xFC（只比较高 6 位）
-static void extract_s5(const phv_t *phv, uint8_t *key, uint8_t *klen)
+uint32_t pkt_hash_crc32(const uint8_t *buf, int len)
 {
-    key[0] = phv->hdr[PHV_OFF_IPV4_DSCP];
-    *klen = 1;
+    uint32_t c = 0xFFFFFFFFu;
+    for (int i = 0; i < len; i++) {
+        c ^= buf[i];
+        c = (c >> 4) ^ crc32_nib[c & 0xF];
+        c = (c >> 4) ^ crc32_nib[c & 0xF];
+    }
+    return ~c;
 }
 
-// Stage 6 — VLAN 出口：匹配 [eg_port(1B)] [vlan_id 低字节(1B)]
-static void extract_s6(const phv_t *phv, uint8_t *key, uint8_t *klen)
+// 本级 hash 输入：hash_fields，缺省为匹配键
+static uint32_t stage_hash(const pkt_stage_plan_t *pl, phv_t *phv)
 {
-    key[0] = phv->eg_port;
-    key[1] = (uint8_t)(phv->vlan_id & 0xFF);
-    *klen = 2;
+    uint8_t buf[64];
+    if (!pl->n_hseg) {
+        extract_key(pl, phv, buf);
+        return pkt_hash_crc32(buf, pl->key_len);
+    }
+    if (pl->uses_meta) meta_sync(phv);
+    uint8_t o = 0;
+    for (int i = 0; i < pl->n_hseg; i++) {
+        memcpy(buf + o, &phv->hdr[pl->hseg[i].off], pl->hseg[i].len);
+        o = (uint8_t)(o + pl->hseg[i].len);
+    }
+    return pkt_hash_crc32(buf, pl->hash_len);
 }
 
-typedef void (*extract_fn_t)(const phv_t *, uint8_t *, uint8_t *);
-
-static const extract_fn_t stage_extract[PKT_NUM_STAGES] = {
-    extract_s0,   // Stage 0: IPv4 LPM
-    extract_s1,   // Stage 1: ACL
-    extract_s2,   // Stage 2: L2 FDB
-    extract_s3,   // Stage 3: ARP Punt
-    extract_s4,   // Stage 4: VLAN 入口
-    extract_s5,   // Stage 5: DSCP QoS
-    extract_s6,   // Stage 6: VLAN 出口
-};
-
 // ─────────────────────────────────────────────
 // 内部：Action 执行
 // ─────────────────────────────────────────────
-// 将命中 TCAM 条目的 action_id + action_params 应用到 PHV 上。
+// 按 pkt_prog 中的原语序列修改 PHV（语义同 mau_alu.sv；
+// 值取自 action_params[param..] 或立即数，均按大端 fwidth 字节）。
 
-static void apply_action(phv_t *phv, const sim_tcam_rec_t *r)
+static void prim_value(const pkt_prim_t *pr, const tcam_entry_t *e, uint8_t *v)
 {
-    const tcam_entry_t *e = &r->entry;
-
-    switch (e->action_id) {
-
-    // ── IPv4 路由转发 ─────────────────────────
-    case ACTION_FORWARD:
-        // 设置出端口，并改写 PHV 中的目标 MAC
-        phv->eg_port = e->action_params[0];
-        memcpy(&phv->hdr[PHV_OFF_ETH_DST], &e->action_params[1], 6);
-        break;
-
-    case ACTION_DROP:
-        phv->drop = 1;
-        break;
-
-    // ── ACL ───────────────────────────────────
-    case ACTION_PERMIT:
-        // 显式放行：无操作，继续后续 Stage
-        break;
-
-    case ACTION_DENY:
-        phv->drop = 1;
-        break;
+    int w = pr->fwidth;
+    if (pr->param >= 0) {
+        memcpy(v, &e->action_params[pr->param], (size_t)w);
+        return;
+    }
+    for (int k = 0; k < w; k++) {
+        int sh = 8 * (w - 1 - k);
+        v[k] = (sh < 32) ? (uint8_t)(pr->imm >> sh) : 0;
+    }
+}
 
-    // ── L2 FDB ────────────────────────────────
-    case ACTION_L2_FORWARD:
-        phv->eg_port = e->action_params[0];
-        break;
+static uint32_t be_get(const uint8_t *v, int w)
+{
+    uint32_t x = 0;
+    for (int k = 0; k < w && k < 4; k++) x = (x << 8) | v[k];
+    return x;
+}
 
-    case ACTION_FLOOD:
-        phv->eg_port = 0xFF;   // 0xFF 表示广播/泛洪
+static void apply_prim(const pkt_stage_plan_t *pl, phv_t *phv, const pkt_prim_t *pr,
+                       const tcam_entry_t *e)
+{
+    uint8_t v[8], cur[8];
+    int     w = pr->fwidth;
+
+    switch (pr->op) {
+    case PKT_OP_SET:
+    case PKT_OP_SET_META:
+        prim_value(pr, e, v);
+        for (int k = 0; k < w; k++) phv_put(phv, (uint16_t)(pr->dst_off + k), v[k]);
         break;
 
-    // ── ARP Punt ──────────────────────────────
-    case ACTION_PUNT_CPU:
-        phv->punt = 1;
+    case PKT_OP_COND_SET: {
+        prim_value(pr, e, v);
+        uint8_t any = 0;
+        for (int k = 0; k < w; k++) any |= v[k];
+        if (any)
+            for (int k = 0; k < w; k++) phv_put(phv, (uint16_t)(pr->dst_off + k), v[k]);
         break;
+    }
 
-    // ── VLAN 入口 ─────────────────────────────
-    case ACTION_VLAN_ASSIGN_PVID:
-        // action_params[0:1] = PVID（大端 2 字节）
-        phv->vlan_id = ((uint16_t)e->action_params[0] << 8)
-                     |  (uint16_t)e->action_params[1];
+    case PKT_OP_COPY:
+        for (int k = 0; k < w; k++) cur[k] = phv_get(phv, (uint16_t)(pr->src_off + k));
+        for (int k = 0; k < w; k++) phv_put(phv, (uint16_t)(pr->dst_off + k), cur[k]);
         break;
 
-    case ACTION_VLAN_ACCEPT_TAGGED:
-        if (e->action_params[0] == 0 && e->action_params[1] == 0) {
-            // Trunk 模式：从 vlan_tci 中直接提取 VID（低 12 位）
-            phv->vlan_id = ((uint16_t)(phv->hdr[PHV_OFF_VLAN_TCI] & 0x0F) << 8)
-                         |  (uint16_t) phv->hdr[PHV_OFF_VLAN_TCI + 1];
-        } else {
-            phv->vlan_id = ((uint16_t)e->action_params[0] << 8)
-                         |  (uint16_t)e->action_params[1];
+    case PKT_OP_ADD: case PKT_OP_SUB:
+    case PKT_OP_AND: case PKT_OP_OR: case PKT_OP_XOR: {
+        if (w > 4) break;                           // ALU 算术宽度上限 32b
+        prim_value(pr, e, v);
+        for (int k = 0; k < w; k++) cur[k] = phv_get(phv, (uint16_t)(pr->dst_off + k));
+        uint32_t a = be_get(cur, w), b = be_get(v, w), r;
+        switch (pr->op) {
+        case PKT_OP_ADD: r = a + b; break;
+        case PKT_OP_SUB: r = a - b; break;
+        case PKT_OP_AND: r = a & b; break;
+        case PKT_OP_OR:  r = a | b; break;
+        default:         r = a ^ b; break;
         }
+        for (int k = 0; k < w; k++)
+            phv_put(phv, (uint16_t)(pr->dst_off + k), (uint8_t)(r >> (8 * (w - 1 - k))));
         break;
+    }
 
-    case ACTION_VLAN_DROP:
+    case PKT_OP_DROP:
         phv->drop = 1;
         break;
 
-    // ── VLAN 出口 ─────────────────────────────
-    case ACTION_VLAN_STRIP_TAG:
-        phv->vlan_action = VLAN_ACT_STRIP;
-        // 清除 PHV 中的 vlan_tci（模拟出口剥离标签）
-        phv->hdr[PHV_OFF_VLAN_TCI]     = 0;
-        phv->hdr[PHV_OFF_VLAN_TCI + 1] = 0;
+    case PKT_OP_SET_PORT:
+        prim_value(pr, e, v);
+        phv->eg_port = v[w - 1];
         break;
 
-    case ACTION_VLAN_KEEP_TAG:
-        phv->vlan_action = VLAN_ACT_KEEP;
+    case PKT_OP_SET_PRIO:
+        prim_value(pr, e, v);
+        phv->qos_prio = v[w - 1];
         break;
 
-    // ── DSCP QoS ──────────────────────────────
-    case ACTION_SET_PRIO:
-        phv->qos_prio = e->action_params[0];
+    case PKT_OP_HASH_SET: {
+        // 写 hash 低 fwidth 字节（fwidth > 4 时同 ALU 写 32b）
+        uint32_t h = stage_hash(pl, phv);
+        if (w > 4) w = 4;
+        for (int k = 0; k < w; k++)
+            phv_put(phv, (uint16_t)(pr->dst_off + k), (uint8_t)(h >> (8 * (w - 1 - k))));
         break;
+    }
 
     default:
-        // 未知 Action：忽略（保守策略）
+        // NOP：忽略
         break;
     }
 }
 
+static void apply_action(const pkt_prog_t *pg, phv_t *phv, const sim_tcam_rec_t *r)
+{
+    const pkt_action_t *a = pkt_prog_action(pg, r->entry.action_id);
+    if (!a) return;     // 未知 Action：忽略（保守策略）
+    const pkt_stage_plan_t *pl = &pg->stage[r->entry.stage];
+    for (int i = 0; i < a->n_prim; i++)
+        apply_prim(pl, phv, &a->prim[i], &r->entry);
+}
+
+static void phv_to_result(const phv_t *phv, fwd_result_t *result)
+{
+    result->eg_port     = phv->eg_port;
+    result->drop        = phv->drop;
+    result->punt        = phv->punt;
+    result->vlan_id     = phv->vlan_id;
+    result->qos_prio    = phv->qos_prio;
+    result->vlan_action = phv->vlan_action;
+}
+
 // ─────────────────────────────────────────────
 // 公共 API 实现
 // ─────────────────────────────────────────────
@@ -216,81 +243,56 @@ int pkt_parse(const uint8_t *raw, uint16_t raw_len,
     memset(phv, 0, sizeof(*phv));
     phv->ig_port = ing_port;
 
-    // ── 以太网头（固定 14 字节）────────────────
-    memcpy(&phv->hdr[PHV_OFF_ETH_DST], raw,     6);   // dst MAC
-    memcpy(&phv->hdr[PHV_OFF_ETH_SRC], raw + 6, 6);   // src MAC
-    phv->hdr[PHV_OFF_ETH_TYPE]     = raw[12];
-    phv->hdr[PHV_OFF_ETH_TYPE + 1] = raw[13];
-
-    uint16_t eth_type = ((uint16_t)raw[12] << 8) | raw[13];
-    int      ip_start = 14;
-
-    // ── 802.1Q VLAN 标签（可选）──────────────
-    if (eth_type == 0x8100 && raw_len >= 18) {
-        phv->hdr[PHV_OFF_VLAN_TCI]     = raw[14];
-        phv->hdr[PHV_OFF_VLAN_TCI + 1] = raw[15];
-        phv->vlan_id = ((uint16_t)(raw[14] & 0x0F) << 8) | raw[15];
-        eth_type  = ((uint16_t)raw[16] << 8) | raw[17];
-        ip_start  = 18;
-    }
+    // Parser TCAM 未命中：与 p4_parser.sv 相同，置 drop 后照常进入流水线
+    if (pkt_parser_run(pkt_parser_current(), raw, raw_len, phv->hdr) != 0)
+        phv->drop = 1;
 
-    // ── IPv4 报头（可选）─────────────────────
-    if (eth_type == 0x0800 && raw_len >= (uint16_t)(ip_start + 20)) {
-        const uint8_t *ip = raw + ip_start;
-
-        phv->hdr[PHV_OFF_IPV4_VER_IHL]     = ip[0];
-        phv->hdr[PHV_OFF_IPV4_DSCP]        = ip[1];   // TOS（DSCP + ECN）
-        phv->hdr[PHV_OFF_IPV4_TOT_LEN]     = ip[2];
-        phv->hdr[PHV_OFF_IPV4_TOT_LEN + 1] = ip[3];
-        phv->hdr[PHV_OFF_IPV4_TTL]         = ip[8];
-        phv->hdr[PHV_OFF_IPV4_PROTO]       = ip[9];
-        memcpy(&phv->hdr[PHV_OFF_IPV4_SRC], ip + 12, 4);
-        memcpy(&phv->hdr[PHV_OFF_IPV4_DST], ip + 16, 4);
-
-        // ── TCP/UDP 端口（可选）──────────────
-        int ihl = (ip[0] & 0x0F) * 4;
-        uint8_t proto = ip[9];
-        if ((proto == 6 || proto == 17) &&
-            raw_len >= (uint16_t)(ip_start + ihl + 4)) {
-            const uint8_t *l4 = ip + ihl;
-            phv->hdr[PHV_OFF_TCP_SPORT]     = l4[0];
-            phv->hdr[PHV_OFF_TCP_SPORT + 1] = l4[1];
-            phv->hdr[PHV_OFF_TCP_DPORT]     = l4[2];
-            phv->hdr[PHV_OFF_TCP_DPORT + 1] = l4[3];
-        }
-    }
+    // 无标签帧 TCI 为 0 → vlan_id = 0（由 Stage 4 赋 PVID）
+    phv->vlan_id = ((uint16_t)(phv->hdr[PHV_OFF_VLAN_TCI] & 0x0F) << 8) |
+                   phv->hdr[PHV_OFF_VLAN_TCI + 1];
 
     return 0;
 }
 
+#ifdef PKT_MODEL_TRACE
+static pkt_key_trace_fn key_trace;
+static void            *key_trace_ctx;
+
+void pkt_model_set_key_trace(pkt_key_trace_fn fn, void *ctx)
+{
+    key_trace     = fn;
+    key_trace_ctx = ctx;
+}
+#endif
+
 int pkt_forward(phv_t *phv, fwd_result_t *result)
 {
     if (!phv || !result) return -1;
 
-    for (int stage = 0; stage < PKT_NUM_STAGES; stage++) {
+    const pkt_prog_t *pg = pkt_prog_current();
+    uint8_t key[SIM_TCAM_KEY_STRIDE];
+    memset(key, 0, sizeof(key));
+
+    for (int stage = 0; stage < pg->n_stages; stage++) {
+        const pkt_stage_plan_t *pl = &pg->stage[stage];
+        if (!pl->n_seg) continue;   // 未配置的级：透传
+
         // 一旦确定丢弃或上送 CPU，退出流水线
         if (phv->drop || phv->punt) break;
 
-        // 提取本级匹配键
-        uint8_t key[64];
-        uint8_t key_len = 0;
-        memset(key, 0, sizeof(key));
-        stage_extract[stage](phv, key, &key_len);
-
-        // 三值 TCAM 查找
-        sim_tcam_rec_t *m = tcam_ternary_lookup((uint8_t)stage, key, key_len);
+        // 提取本级匹配键，三值 TCAM 查找（sim_tcam.c 按掩码分组哈希，table_id 最小者优先）
+        extract_key(pl, phv, key);
+#ifdef PKT_MODEL_TRACE
+        if (key_trace) key_trace(stage, key, pl->key_len, key_trace_ctx);
+#endif
+        const sim_tcam_rec_t *m = sim_tcam_lookup((uint8_t)stage, key, pl->key_len);
         if (!m) continue;   // 未命中：本级透传，PHV 不变
 
         // 执行 Action
-        apply_action(phv, m);
+        apply_action(pg, phv, m);
     }
 
-    result->eg_port     = phv->eg_port;
-    result->drop        = phv->drop;
-    result->punt        = phv->punt;
-    result->vlan_id     = phv->vlan_id;
-    result->qos_prio    = phv->qos_prio;
-    result->vlan_action = phv->vlan_action;
+    phv_to_result(phv, result);
     return 0;
 }
 
@@ -302,3 +304,85 @@ int pkt_process(const uint8_t *raw, uint16_t raw_len,
     if (rc != 0) return rc;
     return pkt_forward(&phv, result);
 }
+
+// ─────────────────────────────────────────────
+// 批量处理
+// ─────────────────────────────────────────────
+// 以 Stage 为外层循环：同一 Stage 的掩码组哈希表与 Action 代码对整批报文
+// 保持热缓存；已 drop/punt 的报文在每级开始前从活动列表中剔除。
+
+// use_snap = 1 时查只读快照 snap（多线程路径），否则查 live 数据库
+static int burst_chunk(const pkt_desc_t *pkts, int n, fwd_result_t *results,
+                       const sim_tcam_snap_t *snap, int use_snap)
+{
+    phv_t   phv[PKT_BURST_MAX];
+    uint8_t keys[PKT_BURST_MAX * SIM_TCAM_KEY_STRIDE];
+    uint8_t klen[PKT_BURST_MAX];
+    int     parsed[PKT_BURST_MAX], live[PKT_BURST_MAX];
+    const sim_tcam_rec_t *hit[PKT_BURST_MAX];
+    int     n_parsed = 0;
+    const pkt_prog_t *pg = pkt_prog_current();
+
+    for (int i = 0; i < n; i++) {
+        if (pkt_parse(pkts[i].data, pkts[i].len, pkts[i].ig_port, &phv[i]) == 0) {
+            parsed[n_parsed++] = i;
+        } else {
+            memset(&results[i], 0, sizeof(results[i]));
+            results[i].drop = 1;
+        }
+    }
+    memcpy(live, parsed, sizeof(int) * (size_t)n_parsed);
+    int n_live = n_parsed;
+    memset(keys, 0, sizeof(keys));
+
+    for (int stage = 0; stage < pg->n_stages && n_live > 0; stage++) {
+        const pkt_stage_plan_t *pl = &pg->stage[stage];
+        if (!pl->n_seg) continue;
+
+        int m = 0;
+        for (int j = 0; j < n_live; j++) {
+            const phv_t *p = &phv[live[j]];
+            if (!p->drop && !p->punt) live[m++] = live[j];
+        }
+        n_live = m;
+
+        for (int j = 0; j < n_live; j++) {
+            extract_key(pl, &phv[live[j]], keys + j * SIM_TCAM_KEY_STRIDE);
+            klen[j] = pl->key_len;
+        }
+        if (use_snap)
+            sim_tcam_snap_lookup_burst(snap, (uint8_t)stage, keys, klen, n_live, hit);
+        else
+            sim_tcam_lookup_burst((uint8_t)stage, keys, klen, n_live, hit);
+        for (int j = 0; j < n_live; j++)
+            if (hit[j]) apply_action(pg, &phv[live[j]], hit[j]);
+    }
+
+    for (int j = 0; j < n_parsed; j++)
+        phv_to_result(&phv[parsed[j]], &results[parsed[j]]);
+    return n_parsed;
+}
+
+static int burst_run(const pkt_desc_t *pkts, int n, fwd_result_t *results,
+                     const sim_tcam_snap_t *snap, int use_snap)
+{
+    if (!pkts || !results || n < 0) return -1;
+
+    int ok = 0;
+    for (int base = 0; base < n; base += PKT_BURST_MAX) {
+        int cnt = n - base < PKT_BURST_MAX ? n - base : PKT_BURST_MAX;
+        ok += burst_chunk(pkts + base, cnt, results + base, snap, use_snap);
+    }
+    return ok;
+}
+
+int pkt_process_burst(const pkt_desc_t *pkts, int n, fwd_result_t *results)
+{
+    return burst_run(pkts, n, results, NULL, 0);
+}
+
+int pkt_process_burst_snap(const sim_tcam_snap_t *snap, const pkt_desc_t *pkts,
+                           int n, fwd_result_t *results)
+{
+    return burst_run(pkts, n, results, snap, 1);
+}
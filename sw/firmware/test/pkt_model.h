@@ -1,13 +1,15 @@
 // pkt_model.h
 // 数据面功能模型 — 用于控制面 + 数据面联合测试
 //
-// 实现一个纯软件的 PISA 流水线仿真器，与 sim_hal.c 的 TCAM 数据库对接：
-//   1. 将原始以太帧解析为 PHV（Packet Header Vector）
+// 实现一个纯软件的 PISA 流水线仿真器，与 sim_tcam.c 的 TCAM 数据库对接：
+//   1. 按 Parser TCAM 程序（pkt_parser.h）将原始以太帧解析为 PHV（Packet Header Vector）
 //   2. 对每个 MAU Stage 执行三值 TCAM 查找（key & mask 匹配）
 //   3. 执行命中的 Action，更新 PHV 元数据（egress port、drop、vlan_id 等）
 //   4. 返回最终转发决策
 //
-// 注意：仅覆盖当前固件使用的 7 个 Stage（Stage 0-6），不模拟 Stage 7-23。
+// 各级的键提取计划与 Action 语义由 pkt_prog.h 描述：默认内置程序覆盖固件的
+// 8 张表（Stage 0-7）；pkt_prog_load_dir() 可载入 rvp4cc.py 的编译产物，
+// 按其描述执行全部 24 级（16 入口 + 8 出口），未配置的级直接透传。
 
 #ifndef PKT_MODEL_H
 #define PKT_MODEL_H
@@ -15,13 +17,16 @@
 #include <stdint.h>
 #include "table_map.h"
 #include "rv_p4_hal.h"
+#include "sim_tcam.h"
 
 // ─────────────────────────────────────────────
 // 常量
 // ─────────────────────────────────────────────
 
 #define PKT_PHV_HDR_SIZE  512   // PHV 报头区（与 rv_p4_pkg.sv PHV_BYTES 一致）
-#define PKT_NUM_STAGES    7     // 固件使用的 MAU 级数（0-6）
+#define PKT_NUM_STAGES    24    // MAU 级数（与 rv_p4_pkg.sv NUM_MAU_STAGES 一致）
+#define PKT_INGRESS_STAGES 16   // 其中入口级数（其余为出口级）
+#define PKT_BURST_MAX     32    // pkt_process_burst 内部每批处理的帧数
 
 // VLAN 出口动作（存入 phv.vlan_action）
 #define VLAN_ACT_NONE   0
@@ -40,7 +45,7 @@ typedef struct {
     uint8_t  punt;          // 1 = 上送 CPU
     uint16_t vlan_id;       // 当前报文的 VLAN ID（由 Stage 4 写入）
     uint8_t  qos_prio;      // QoS 优先级队列（由 Stage 5 写入）
-    uint8_t  vlan_action;   // VLAN 出口动作（由 Stage 6 写入，VLAN_ACT_*）
+    uint8_t  vlan_action;   // VLAN 出口动作（由 Stage 7 写入，VLAN_ACT_*）
 } phv_t;
 
 // ─────────────────────────────────────────────
@@ -55,23 +60,33 @@ typedef struct {
     uint8_t  vlan_action;   // 出口 VLAN 动作（VLAN_ACT_*）
 } fwd_result_t;
 
+// ─────────────────────────────────────────────
+// 批量处理描述符（pkt_process_burst 的输入）
+// ─────────────────────────────────────────────
+typedef struct {
+    const uint8_t *data;    // 原始以太帧
+    uint16_t       len;     // 帧长
+    uint8_t        ig_port; // 入端口
+} pkt_desc_t;
+
 // ─────────────────────────────────────────────
 // 公共 API
 // ─────────────────────────────────────────────
 
 /**
- * pkt_parse - 将原始以太帧解析为 PHV
+ * pkt_parse - 按当前 Parser TCAM 程序将原始以太帧解析为 PHV
  * @raw:      原始报文字节数组（含以太网头）
  * @raw_len:  报文字节数（至少 14 字节）
  * @ing_port: 入端口号（0-31）
  * @phv:      输出的 PHV（调用者分配）
+ * Parser TCAM 未命中时 phv->drop = 1；vlan_id 由 PHV 中的 VLAN TCI 派生。
  * 返回 0 表示成功，-1 表示报文过短
  */
 int pkt_parse(const uint8_t *raw, uint16_t raw_len,
               uint8_t ing_port, phv_t *phv);
 
 /**
- * pkt_forward - 对已解析的 PHV 执行 7 级 MAU 流水线仿真
+ * pkt_forward - 对已解析的 PHV 执行 MAU 流水线仿真（按当前 pkt_prog 程序）
  * @phv:    入/出参数：输入已解析的 PHV，输出经 Action 修改后的 PHV
  * @result: 最终转发决策
  * 返回 0（始终成功；drop/punt 通过 result 字段表示）
@@ -84,4 +99,45 @@ int pkt_forward(phv_t *phv, fwd_result_t *result);
 int pkt_process(const uint8_t *raw, uint16_t raw_len,
                 uint8_t ing_port, fwd_result_t *result);
 
+/**
+ * pkt_process_burst - 批量解析 + 转发
+ * @pkts:    n 个报文描述符
+ * @n:       报文数（内部按 PKT_BURST_MAX 分批）
+ * @results: 输出，与 pkts 一一对应
+ * 每批先全部解析，再逐 Stage 对整批提取键并调用 sim_tcam_lookup_burst，
+ * 结果与逐帧调用 pkt_process 完全一致。过短无法解析的帧结果为 drop=1。
+ * 返回成功解析的帧数；参数非法返回 -1。
+ */
+int pkt_process_burst(const pkt_desc_t *pkts, int n, fwd_result_t *results);
+
+/**
+ * pkt_process_burst_snap - 同 pkt_process_burst，但查找只读快照 snap
+ * 必须在 sim_tcam_read_begin/read_end 临界区内调用；snap 为 NULL（从未发布）
+ * 时所有 Stage 未命中。只读访问，可由多个线程并发调用。
+ */
+int pkt_process_burst_snap(const sim_tcam_snap_t *snap, const pkt_desc_t *pkts,
+                           int n, fwd_result_t *results);
+
+/**
+ * pkt_hash_crc32 - 与 mau_hash.sv 相同的 CRC32（HASH_SET 原语的 flow hash）
+ * 测试 / 控制面可据此预测 ECMP 成员选择。
+ */
+uint32_t pkt_hash_crc32(const uint8_t *buf, int len);
+
+#ifdef PKT_MODEL_TRACE
+// ─────────────────────────────────────────────
+// 逐级键跟踪（性能测试用，-DPKT_MODEL_TRACE 时编译）
+// ─────────────────────────────────────────────
+
+/** 跟踪回调：pkt_forward 每级提取键之后、TCAM 查找之前调用 */
+typedef void (*pkt_key_trace_fn)(int stage, const uint8_t *key, uint8_t key_len, void *ctx);
+
+/**
+ * pkt_model_set_key_trace - 设置跟踪回调（NULL 关闭）
+ * 只作用于 pkt_forward / pkt_process（批量路径不跟踪）；非线程安全。
+ * key 缓冲区可读 SIM_TCAM_KEY_STRIDE 字节，可直接用于 sim_tcam_lookup 回放。
+ */
+void pkt_model_set_key_trace(pkt_key_trace_fn fn, void *ctx);
+#endif
+
 #endif /* PKT_MODEL_H */
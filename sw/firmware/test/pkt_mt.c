@@ -0,0 +1,153 @@
+// pkt_mt.c
+// 多线程数据面功能模型实现（见 pkt_mt.h）
+
+#include "pkt_mt.h"
+#include "pkt_prog.h"
+#include "pkt_parser.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    pkt_mt_t      *mt;
+    pthread_t      tid;
+    int            reader;      // sim_tcam 读者槽
+    pkt_mt_stats_t st;
+    uint8_t        pad[64];     // 统计字段与相邻线程隔开
+} mt_worker_t;
+
+struct pkt_mt {
+    int              n_workers;
+    mt_worker_t      w[PKT_MT_MAX_WORKERS];
+
+    pthread_mutex_t  lock;
+    pthread_cond_t   go;        // 新任务 / 退出
+    pthread_cond_t   done;      // 所有线程完成当前任务
+    uint64_t         gen;       // 任务代号
+    int              busy;      // 仍在处理当前任务的线程数
+    int              quit;
+
+    // 当前任务
+    const pkt_desc_t *pkts;
+    fwd_result_t     *results;
+    int               n;
+    int               next_chunk;   // 原子领取
+    int               parsed;       // 原子累加
+};
+
+static void *mt_worker_main(void *arg)
+{
+    mt_worker_t *w  = (mt_worker_t *)arg;
+    pkt_mt_t    *mt = w->mt;
+    uint64_t     seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&mt->lock);
+        while (!mt->quit && mt->gen == seen)
+            pthread_cond_wait(&mt->go, &mt->lock);
+        if (mt->quit) {
+            pthread_mutex_unlock(&mt->lock);
+            break;
+        }
+        seen = mt->gen;
+        pthread_mutex_unlock(&mt->lock);
+
+        int n_chunks = (mt->n + PKT_BURST_MAX - 1) / PKT_BURST_MAX;
+        int parsed   = 0;
+        for (;;) {
+            int c = __atomic_fetch_add(&mt->next_chunk, 1, __ATOMIC_RELAXED);
+            if (c >= n_chunks) break;
+            int base = c * PKT_BURST_MAX;
+            int cnt  = mt->n - base < PKT_BURST_MAX ? mt->n - base : PKT_BURST_MAX;
+
+            // 每个分片一个读临界区：分片之间允许控制面发布新版本并回收旧版本
+            const sim_tcam_snap_t *snap = sim_tcam_read_begin(w->reader);
+            parsed += pkt_process_burst_snap(snap, mt->pkts + base, cnt,
+                                             mt->results + base);
+            sim_tcam_read_end(w->reader);
+
+            w->st.pkts   += (uint64_t)cnt;
+            w->st.chunks += 1;
+        }
+        __atomic_fetch_add(&mt->parsed, parsed, __ATOMIC_RELAXED);
+
+        pthread_mutex_lock(&mt->lock);
+        if (--mt->busy == 0) pthread_cond_signal(&mt->done);
+        pthread_mutex_unlock(&mt->lock);
+    }
+    return NULL;
+}
+
+pkt_mt_t *pkt_mt_create(int n_workers)
+{
+    if (n_workers < 1 || n_workers > PKT_MT_MAX_WORKERS) return NULL;
+
+    pkt_mt_t *mt = (pkt_mt_t *)calloc(1, sizeof(*mt));
+    if (!mt) return NULL;
+    pkt_prog_current();     // 工作线程启动前完成内置程序的惰性初始化
+    pkt_parser_current();
+    pthread_mutex_init(&mt->lock, NULL);
+    pthread_cond_init(&mt->go, NULL);
+    pthread_cond_init(&mt->done, NULL);
+
+    for (int i = 0; i < n_workers; i++) {
+        mt_worker_t *w = &mt->w[i];
+        w->mt     = mt;
+        w->reader = sim_tcam_reader_register();
+        if (w->reader < 0) {
+            pkt_mt_destroy(mt);
+            return NULL;
+        }
+        if (pthread_create(&w->tid, NULL, mt_worker_main, w) != 0) {
+            sim_tcam_reader_unregister(w->reader);
+            pkt_mt_destroy(mt);
+            return NULL;
+        }
+        mt->n_workers = i + 1;
+    }
+    return mt;
+}
+
+void pkt_mt_destroy(pkt_mt_t *mt)
+{
+    if (!mt) return;
+    pthread_mutex_lock(&mt->lock);
+    mt->quit = 1;
+    pthread_cond_broadcast(&mt->go);
+    pthread_mutex_unlock(&mt->lock);
+    for (int i = 0; i < mt->n_workers; i++) {
+        pthread_join(mt->w[i].tid, NULL);
+        sim_tcam_reader_unregister(mt->w[i].reader);
+    }
+    pthread_cond_destroy(&mt->done);
+    pthread_cond_destroy(&mt->go);
+    pthread_mutex_destroy(&mt->lock);
+    free(mt);
+}
+
+int pkt_mt_process(pkt_mt_t *mt, const pkt_desc_t *pkts, int n,
+                   fwd_result_t *results)
+{
+    if (!mt || !pkts || !results || n < 0) return -1;
+
+    pthread_mutex_lock(&mt->lock);
+    mt->pkts       = pkts;
+    mt->results    = results;
+    mt->n          = n;
+    mt->next_chunk = 0;
+    mt->parsed     = 0;
+    mt->busy       = mt->n_workers;
+    mt->gen++;
+    pthread_cond_broadcast(&mt->go);
+    while (mt->busy > 0)
+        pthread_cond_wait(&mt->done, &mt->lock);
+    int parsed = mt->parsed;
+    pthread_mutex_unlock(&mt->lock);
+    return parsed;
+}
+
+void pkt_mt_get_stats(const pkt_mt_t *mt, int w, pkt_mt_stats_t *st)
+{
+    if (!mt || !st || w < 0 || w >= mt->n_workers) return;
+    *st = mt->w[w].st;
+}
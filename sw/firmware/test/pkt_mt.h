@@ -0,0 +1,50 @@
+// pkt_mt.h
+// 多线程数据面功能模型 — 工作线程并行处理报文批次
+//
+// 控制面线程照常通过固件模块（route_add / acl_add_deny / ...）写 TCAM，
+// 写完一批后调用 sim_tcam_publish() 发布新快照；工作线程每处理一个
+// PKT_BURST_MAX 分片都重新进入快照读临界区，因此：
+//   - 工作线程无锁读取，控制面更新不会暂停转发；
+//   - 每个分片内部使用同一版本的表（与硬件 TUE 的原子切换对应），
+//     不同分片可能跨越一次发布。
+//
+// 分片方式：输入报文按 PKT_BURST_MAX 切片，工作线程以原子计数器动态领取。
+
+#ifndef PKT_MT_H
+#define PKT_MT_H
+
+#include <stdint.h>
+#include "pkt_model.h"
+
+#define PKT_MT_MAX_WORKERS  32
+
+typedef struct pkt_mt pkt_mt_t;
+
+// 每工作线程统计
+typedef struct {
+    uint64_t pkts;      // 处理的报文数
+    uint64_t chunks;    // 处理的分片数
+} pkt_mt_stats_t;
+
+/**
+ * pkt_mt_create - 创建 n_workers 个工作线程（1..PKT_MT_MAX_WORKERS）
+ * 每个线程注册一个 sim_tcam 读者槽。失败返回 NULL。
+ */
+pkt_mt_t *pkt_mt_create(int n_workers);
+
+/** 停止并回收所有工作线程 */
+void pkt_mt_destroy(pkt_mt_t *mt);
+
+/**
+ * pkt_mt_process - 将 n 个报文分给工作线程处理，阻塞直到全部完成
+ * 结果与 pkt_process_burst_snap 逐片处理一致。
+ * 调用者（任意单个线程）不得并发调用同一 mt。
+ * 返回成功解析的帧数；参数非法返回 -1。
+ */
+int pkt_mt_process(pkt_mt_t *mt, const pkt_desc_t *pkts, int n,
+                   fwd_result_t *results);
+
+/** 读取工作线程 w 的累计统计 */
+void pkt_mt_get_stats(const pkt_mt_t *mt, int w, pkt_mt_stats_t *st);
+
+#endif /* PKT_MT_H */
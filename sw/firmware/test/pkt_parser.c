@@ -0,0 +1,520 @@
+// pkt_parser.c
+// 可编程解析器模型：Parser TCAM 条目存储、按状态编译与执行（见 pkt_parser.h）
+
+#include "pkt_parser.h"
+#include "table_map.h"
+#include <string.h>
+
+// 编译后的规则：8 字节窗口按内存顺序装入 uint64_t，key 已与 mask 相与
+typedef struct {
+    uint64_t key;
+    uint64_t mask;
+    uint16_t dst;
+    uint8_t  next;
+    uint8_t  ext_off;
+    uint8_t  ext_len;
+    uint8_t  adv;
+} pp_rule_t;
+
+typedef struct {
+    uint16_t first;     // rule[first..first+n) 按条目索引升序
+    uint16_t n;
+    uint8_t  jt_shift;  // 按 (窗口 >> jt_shift) 的低字节查 jump[state]；PP_SCAN：顺序扫描
+} pp_state_t;
+
+#define PP_SCAN 0xFF
+
+struct pkt_parser {
+    fsm_entry_t ent[PKT_PARSER_ENTRIES];
+    uint8_t     valid[PKT_PARSER_ENTRIES];
+    int         n_valid;
+    pp_state_t  state[PKT_PARSER_STATES];
+    pp_rule_t   rule[PKT_PARSER_ENTRIES];
+    uint16_t    jump[PKT_PARSER_STATES][256];   // 规则下标 + 1（0 = 未命中）
+};
+
+static pkt_parser_t pp;
+static int          pp_ready;
+
+// ─────────────────────────────────────────────
+// 编译
+// ─────────────────────────────────────────────
+
+// 掩码只覆盖一个完整字节时返回该字节位置，否则 -1
+static int mask_single_byte(const uint8_t *m)
+{
+    int pos = -1;
+    for (int i = 0; i < 8; i++) {
+        if (!m[i]) continue;
+        if (m[i] != 0xFF || pos >= 0) return -1;
+        pos = i;
+    }
+    return pos;
+}
+
+static void build_jump(pkt_parser_t *p, int s)
+{
+    pp_state_t *st = &p->state[s];
+    int b = -1;
+
+    st->jt_shift = PP_SCAN;
+    for (int i = 0; i < st->n; i++) {
+        const pp_rule_t *r = &p->rule[st->first + i];
+        if (!r->mask) continue;
+        uint8_t m[8];
+        memcpy(m, &r->mask, 8);
+        int pos = mask_single_byte(m);
+        if (pos < 0 || (b >= 0 && pos != b)) return;
+        b = pos;
+    }
+    if (b < 0) b = 0;                   // 全为通配条目
+
+    // 逆序填充，低索引规则最后写入即胜出
+    memset(p->jump[s], 0, sizeof(p->jump[s]));
+    for (int i = st->n - 1; i >= 0; i--) {
+        const pp_rule_t *r = &p->rule[st->first + i];
+        uint8_t k[8];
+        memcpy(k, &r->key, 8);
+        for (int v = 0; v < 256; v++)
+            if (!r->mask || k[b] == v)
+                p->jump[s][v] = (uint16_t)(st->first + i + 1);
+    }
+    st->jt_shift = (uint8_t)(8 * b);    // 窗口按 host 小端装载（x86 / RISC-V）
+}
+
+static void compile(pkt_parser_t *p)
+{
+    uint16_t cnt[PKT_PARSER_STATES] = { 0 };
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++)
+        if (p->valid[i]) cnt[p->ent[i].cur_state]++;
+
+    uint16_t pos = 0;
+    for (int s = 0; s < PKT_PARSER_STATES; s++) {
+        p->state[s].first = pos;
+        p->state[s].n     = 0;
+        pos = (uint16_t)(pos + cnt[s]);
+    }
+
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++) {
+        if (!p->valid[i]) continue;
+        const fsm_entry_t *e  = &p->ent[i];
+        pp_state_t        *st = &p->state[e->cur_state];
+        pp_rule_t         *r  = &p->rule[st->first + st->n++];
+        memcpy(&r->key,  e->key_window, 8);
+        memcpy(&r->mask, e->key_mask,   8);
+        r->key    &= r->mask;
+        r->dst     = e->phv_dst_offset;
+        r->next    = e->next_state;
+        r->ext_off = e->extract_offset;
+        r->ext_len = e->extract_len;
+        r->adv     = e->hdr_advance;
+    }
+
+    for (int s = 0; s < PKT_PARSER_STATES; s++)
+        build_jump(p, s);
+}
+
+// ─────────────────────────────────────────────
+// 内置程序
+// ─────────────────────────────────────────────
+
+// 在 idx 写入条目：窗口 kpos 处 klen（0-2）字节等于 kval
+static void bi_entry(pkt_parser_t *p, int idx, uint8_t st,
+                     uint8_t kpos, uint8_t klen, uint16_t kval,
+                     uint8_t next, uint8_t eoff, uint8_t elen, uint16_t dst,
+                     uint8_t adv)
+{
+    fsm_entry_t *e = &p->ent[idx];
+    memset(e, 0, sizeof(*e));
+    e->cur_state = st;
+    for (int i = 0; i < klen; i++) {
+        e->key_window[kpos + i] = (uint8_t)(kval >> (8 * (klen - 1 - i)));
+        e->key_mask[kpos + i]   = 0xFF;
+    }
+    e->next_state     = next;
+    e->extract_offset = eoff;
+    e->extract_len    = elen;
+    e->phv_dst_offset = dst;
+    e->hdr_advance    = adv;
+    p->valid[idx] = 1;
+    p->n_valid++;
+}
+
+static void parser_builtin(pkt_parser_t *p)
+{
+    int lo = 0, hi = PKT_PARSER_ENTRIES - 1;
+
+    memset(p->valid, 0, sizeof(p->valid));
+    p->n_valid = 0;
+
+    // Ethernet：dst / src / type 共 14 字节，hdr_ptr 停在 EtherType
+    bi_entry(p, hi--, PKT_PARSER_START, 0, 0, 0,
+             PKT_PARSER_ST_ETHERTYPE, 0, 14, PHV_OFF_ETH_DST, 12);
+
+    // EtherType：IPv4 / 802.1Q（TCI → PHV_OFF_VLAN_TCI），其余 ACCEPT
+    bi_entry(p, lo++, PKT_PARSER_ST_ETHERTYPE, 0, 2, 0x0800,
+             PKT_PARSER_ST_IPV4, 0, 0, 0, 2);
+    bi_entry(p, lo++, PKT_PARSER_ST_ETHERTYPE, 0, 2, 0x8100,
+             PKT_PARSER_ST_VLAN_TYPE, 2, 2, PHV_OFF_VLAN_TCI, 4);
+    bi_entry(p, hi--, PKT_PARSER_ST_ETHERTYPE, 0, 0, 0, PKT_PARSER_ACCEPT, 0, 0, 0, 0);
+
+    bi_entry(p, lo++, PKT_PARSER_ST_VLAN_TYPE, 0, 2, 0x0800,
+             PKT_PARSER_ST_IPV4, 0, 0, 0, 2);
+    bi_entry(p, hi--, PKT_PARSER_ST_VLAN_TYPE, 0, 0, 0, PKT_PARSER_ACCEPT, 0, 0, 0, 0);
+
+    // IPv4：按 Ver/IHL 分到各 IHL 状态（hdr_ptr 前移 8，窗口第 1 字节为协议号），
+    // 再按协议号跳过选项进入 L4；其它 Ver/IHL 只提取固定头
+    for (int ihl = 5; ihl <= 15; ihl++) {
+        uint8_t st_ihl = (uint8_t)(PKT_PARSER_ST_IPV4_IHL + ihl - 5);
+        bi_entry(p, lo++, PKT_PARSER_ST_IPV4, 0, 1, (uint16_t)(0x40 | ihl),
+                 st_ihl, 0, 20, PHV_OFF_IPV4_VER_IHL, 8);
+        bi_entry(p, lo++, st_ihl, 1, 1, 6,  PKT_PARSER_ST_L4, 0, 0, 0, (uint8_t)(ihl * 4 - 8));
+        bi_entry(p, lo++, st_ihl, 1, 1, 17, PKT_PARSER_ST_L4, 0, 0, 0, (uint8_t)(ihl * 4 - 8));
+        bi_entry(p, hi--, st_ihl, 0, 0, 0, PKT_PARSER_ACCEPT, 0, 0, 0, 0);
+    }
+    bi_entry(p, hi--, PKT_PARSER_ST_IPV4, 0, 0, 0,
+             PKT_PARSER_ACCEPT, 0, 20, PHV_OFF_IPV4_VER_IHL, 0);
+
+    // TCP / UDP：源 / 目的端口
+    bi_entry(p, hi--, PKT_PARSER_ST_L4, 0, 0, 0,
+             PKT_PARSER_ACCEPT, 0, 4, PHV_OFF_TCP_SPORT, 0);
+}
+
+// ─────────────────────────────────────────────
+// 程序管理
+// ─────────────────────────────────────────────
+
+const pkt_parser_t *pkt_parser_current(void)
+{
+    if (!pp_ready) pkt_parser_reset();
+    return &pp;
+}
+
+void pkt_parser_reset(void)
+{
+    parser_builtin(&pp);
+    compile(&pp);
+    pp_ready = 1;
+}
+
+void pkt_parser_clear(void)
+{
+    memset(pp.valid, 0, sizeof(pp.valid));
+    pp.n_valid = 0;
+    compile(&pp);
+    pp_ready = 1;
+}
+
+static int entry_ok(const fsm_entry_t *e)
+{
+    return e && e->cur_state < PKT_PARSER_STATES && e->next_state < PKT_PARSER_STATES &&
+           e->phv_dst_offset + e->extract_len <= PHV_OFF_IG_PORT;
+}
+
+int pkt_parser_write(int idx, const fsm_entry_t *e)
+{
+    if (idx < 0 || idx >= PKT_PARSER_ENTRIES || !entry_ok(e)) return -1;
+    pkt_parser_current();
+    if (!pp.valid[idx]) pp.n_valid++;
+    pp.ent[idx]   = *e;
+    pp.valid[idx] = 1;
+    compile(&pp);
+    return 0;
+}
+
+int pkt_parser_add(const fsm_entry_t *e)
+{
+    if (!entry_ok(e)) return -1;
+    pkt_parser_current();
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++)
+        if (!pp.valid[i]) return pkt_parser_write(i, e) == 0 ? i : -1;
+    return -1;
+}
+
+int pkt_parser_del(int idx)
+{
+    if (idx < 0 || idx >= PKT_PARSER_ENTRIES) return -1;
+    pkt_parser_current();
+    if (!pp.valid[idx]) return -1;
+    pp.valid[idx] = 0;
+    pp.n_valid--;
+    compile(&pp);
+    return 0;
+}
+
+int pkt_parser_del_state(uint8_t state)
+{
+    int n = 0;
+    pkt_parser_current();
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++) {
+        if (pp.valid[i] && pp.ent[i].cur_state == state) {
+            pp.valid[i] = 0;
+            n++;
+        }
+    }
+    if (n) {
+        pp.n_valid -= n;
+        compile(&pp);
+    }
+    return n;
+}
+
+int pkt_parser_count(void)
+{
+    return pkt_parser_current()->n_valid;
+}
+
+int pkt_parser_read(int idx, fsm_entry_t *e)
+{
+    if (idx < 0 || idx >= PKT_PARSER_ENTRIES || !e) return -1;
+    pkt_parser_current();
+    if (!pp.valid[idx]) return -1;
+    *e = pp.ent[idx];
+    return 0;
+}
+
+// ─────────────────────────────────────────────
+// 执行
+// ─────────────────────────────────────────────
+
+// 提取通常只有几到几十字节：用定长 8 / 4 字节拷贝（首尾重叠）代替变长 memcpy
+static inline void copy_field(uint8_t *d, const uint8_t *s, uint32_t n)
+{
+    if (n >= 8) {
+        for (uint32_t i = 0; i + 8 <= n; i += 8) memcpy(d + i, s + i, 8);
+        memcpy(d + n - 8, s + n - 8, 8);
+    } else if (n >= 4) {
+        memcpy(d, s, 4);
+        memcpy(d + n - 4, s + n - 4, 4);
+    } else {
+        d[0]         = s[0];
+        d[n / 2]     = s[n / 2];
+        d[n - 1]     = s[n - 1];
+    }
+}
+
+int pkt_parser_run(const pkt_parser_t *p, const uint8_t *raw, uint16_t raw_len,
+                   uint8_t *hdr)
+{
+    uint8_t  st  = PKT_PARSER_START;
+    uint32_t ptr = 0;
+
+    for (int step = 0; step < PKT_PARSER_MAX_STEPS; step++) {
+        uint64_t w = 0;
+        if (ptr + 8 <= raw_len)  memcpy(&w, raw + ptr, 8);
+        else if (ptr < raw_len)  memcpy(&w, raw + ptr, raw_len - ptr);
+
+        const pp_state_t *s = &p->state[st];
+        const pp_rule_t  *r = NULL;
+        if (s->jt_shift != PP_SCAN) {
+            uint16_t k = p->jump[st][(uint8_t)(w >> s->jt_shift)];
+            if (k) r = &p->rule[k - 1];
+        } else {
+            for (int i = 0; i < s->n; i++) {
+                const pp_rule_t *c = &p->rule[s->first + i];
+                if ((w & c->mask) == c->key) { r = c; break; }
+            }
+        }
+        if (!r) return -1;                              // 未命中 → 丢弃
+
+        if (r->ext_len) {
+            uint32_t off = ptr + r->ext_off;
+            if (off + r->ext_len > raw_len) return 0;   // 截断：保留已提取字段
+            copy_field(hdr + r->dst, raw + off, r->ext_len);
+        }
+        if (r->next == PKT_PARSER_ACCEPT) return 0;
+        ptr += r->adv;
+        st   = r->next;
+    }
+    return -1;
+}
+
+// ─────────────────────────────────────────────
+// parser_tcam.sv 条目格式
+// ─────────────────────────────────────────────
+
+// 640b 条目位域（parser_tcam.sv）：字段最低位
+#define RTL_KEY_STATE       634     // [639:634]
+#define RTL_KEY_WINDOW      570     // [633:570]
+#define RTL_MASK_STATE      564     // [569:564]，1 = don't care
+#define RTL_MASK_WINDOW     442     // [505:442]，1 = don't care
+#define RTL_NEXT_STATE      436     // [441:436]
+#define RTL_EXTRACT_OFF     428     // [435:428]，cell 内绝对偏移
+#define RTL_EXTRACT_LEN     420     // [427:420]
+#define RTL_PHV_DST         410     // [419:410]
+#define RTL_HDR_ADV         402     // [409:402]
+#define RTL_VALID           401
+
+#define RTL_STATES_MAX      (PKT_PARSER_ACCEPT - 1)     // RTL 状态 1..62
+
+static void rtl_set(pkt_parser_rtl_entry_t *e, int lo, int width, uint64_t v)
+{
+    for (int i = 0; i < width; i++) {
+        int bit = lo + i;
+        if ((v >> i) & 1) e->w[bit / 32] |=  (1u << (bit % 32));
+        else              e->w[bit / 32] &= ~(1u << (bit % 32));
+    }
+}
+
+static uint64_t rtl_get(const pkt_parser_rtl_entry_t *e, int lo, int width)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < width; i++) {
+        int bit = lo + i;
+        v |= (uint64_t)((e->w[bit / 32] >> (bit % 32)) & 1) << i;
+    }
+    return v;
+}
+
+// 窗口第 k 字节位于 bit [8k+7:8k]（p4_parser.sv：cell_latch[off*8 +: 64]，报文字节 b 在 bit 8b）
+static uint64_t window_pack(const uint8_t *b)
+{
+    uint64_t v = 0;
+    for (int k = 0; k < 8; k++) v |= (uint64_t)b[k] << (8 * k);
+    return v;
+}
+
+typedef struct {
+    const fsm_entry_t      *prog;
+    int                     n;
+    pkt_parser_rtl_entry_t *out;
+    int                     max;
+    int                     n_out;
+    int                     n_states;
+    uint8_t id[PKT_PARSER_STATES][PKT_PARSER_RTL_CELL];      // (状态, hdr_ptr) → RTL 状态，0 = 未分配
+    uint8_t busy[PKT_PARSER_STATES][PKT_PARSER_RTL_CELL];    // 在当前遍历路径上（判环）
+    uint8_t steps[PKT_PARSER_STATES][PKT_PARSER_RTL_CELL];   // 由此出发的最长查找次数
+} rtl_conv_t;
+
+static int conv_new_state(rtl_conv_t *c)
+{
+    return c->n_states < RTL_STATES_MAX ? ++c->n_states : -1;
+}
+
+static int conv_emit(rtl_conv_t *c, uint8_t st, uint64_t key, uint64_t care,
+                     uint8_t next, uint8_t ext_off, uint16_t dst, uint8_t adv)
+{
+    if (c->n_out >= c->max) return -1;
+    pkt_parser_rtl_entry_t *e = &c->out[c->n_out++];
+    memset(e, 0, sizeof(*e));
+    rtl_set(e, RTL_KEY_STATE,   6,  st);
+    rtl_set(e, RTL_KEY_WINDOW,  64, key & care);
+    rtl_set(e, RTL_MASK_STATE,  6,  0);                 // 状态精确匹配
+    rtl_set(e, RTL_MASK_WINDOW, 64, ~care);
+    rtl_set(e, RTL_NEXT_STATE,  6,  next);
+    rtl_set(e, RTL_EXTRACT_OFF, 8,  ext_off);
+    rtl_set(e, RTL_EXTRACT_LEN, 8,  1);
+    rtl_set(e, RTL_PHV_DST,     10, dst);
+    rtl_set(e, RTL_HDR_ADV,     8,  adv);
+    rtl_set(e, RTL_VALID,       1,  1);
+    return 0;
+}
+
+// 条目 e 在 RTL 状态 st、hdr_ptr = ptr 处：首条目比较窗口并推进 hdr_ptr，
+// 其余字节各占一个通配状态，最后一条转到 next
+static int conv_extract(rtl_conv_t *c, const fsm_entry_t *e, uint8_t st, uint32_t ptr,
+                        uint8_t next)
+{
+    uint32_t abs = ptr + e->extract_offset;
+    int      len = e->extract_len;
+    if (len && abs + len > PKT_PARSER_RTL_CELL) return -1;
+
+    uint64_t key  = window_pack(e->key_window);
+    uint64_t care = window_pack(e->key_mask);
+    for (int i = 0; i < (len ? len : 1); i++) {
+        int nx = (i == len - 1 || !len) ? next : conv_new_state(c);
+        if (nx < 0) return -1;
+        int rc = len ? conv_emit(c, st, key, care, (uint8_t)nx, (uint8_t)(abs + i),
+                                 (uint16_t)(e->phv_dst_offset + i), i ? 0 : e->hdr_advance)
+                     : conv_emit(c, st, key, care, (uint8_t)nx, 0,
+                                 PKT_PARSER_RTL_SCRATCH, e->hdr_advance);
+        if (rc != 0) return -1;
+        st   = (uint8_t)nx;
+        key  = care = 0;
+    }
+    return 0;
+}
+
+// (状态 s, hdr_ptr) 的 RTL 状态；不可表示返回 -1
+static int conv_node(rtl_conv_t *c, uint8_t s, uint32_t ptr)
+{
+    if (ptr >= PKT_PARSER_RTL_CELL || c->busy[s][ptr]) return -1;   // 越出首个 cell / 环路
+    if (c->id[s][ptr]) return c->id[s][ptr];
+
+    int id = conv_new_state(c);
+    if (id < 0) return -1;
+    c->id[s][ptr]   = (uint8_t)id;
+    c->busy[s][ptr] = 1;
+
+    int steps = 1;
+    for (int i = 0; i < c->n; i++) {
+        const fsm_entry_t *e = &c->prog[i];
+        if (e->cur_state != s) continue;
+        for (int k = 0; k < 8; k++)
+            if (e->key_mask[k] && ptr + k >= PKT_PARSER_RTL_CELL) return -1;
+
+        int next = PKT_PARSER_ACCEPT;
+        if (e->next_state != PKT_PARSER_ACCEPT) {
+            uint32_t nptr = ptr + e->hdr_advance;
+            next = conv_node(c, e->next_state, nptr);
+            if (next < 0) return -1;
+            if (1 + c->steps[e->next_state][nptr] > steps)
+                steps = 1 + c->steps[e->next_state][nptr];
+        }
+        if (conv_extract(c, e, (uint8_t)id, ptr, (uint8_t)next) != 0) return -1;
+    }
+    c->busy[s][ptr]  = 0;
+    c->steps[s][ptr] = (uint8_t)(steps > 255 ? 255 : steps);
+    return id;
+}
+
+int pkt_parser_to_rtl(const fsm_entry_t *prog, int n, pkt_parser_rtl_entry_t *out, int max)
+{
+    static rtl_conv_t c;
+
+    if (!prog || n < 0 || !out || max < 0) return -1;
+    for (int i = 0; i < n; i++)
+        if (!entry_ok(&prog[i])) return -1;
+    memset(&c, 0, sizeof(c));
+    c.prog = prog;
+    c.n    = n;
+    c.out  = out;
+    c.max  = max < PKT_PARSER_ENTRIES ? max : PKT_PARSER_ENTRIES;
+    if (conv_node(&c, PKT_PARSER_START, 0) != PKT_PARSER_START) return -1;
+    if (c.steps[PKT_PARSER_START][0] > PKT_PARSER_MAX_STEPS) return -1;
+    return c.n_out;
+}
+
+int pkt_parser_rtl_run(const pkt_parser_rtl_entry_t *ent, int n,
+                       const uint8_t *raw, uint16_t raw_len, uint8_t *phv)
+{
+    uint8_t  cell[PKT_PARSER_RTL_CELL + 8] = { 0 };     // 越出 cell 的窗口字节按 0
+    uint8_t  st  = PKT_PARSER_START;
+    uint16_t ptr = 0;                                   // 14 bit hdr_ptr
+
+    memcpy(cell, raw, raw_len < PKT_PARSER_RTL_CELL ? raw_len : PKT_PARSER_RTL_CELL);
+    for (int step = 0; step <= n; step++) {
+        uint64_t w = window_pack(&cell[ptr & 0x3F]);
+        const pkt_parser_rtl_entry_t *hit = NULL;
+        for (int i = 0; i < n && !hit; i++) {           // 最低索引优先
+            const pkt_parser_rtl_entry_t *e = &ent[i];
+            uint8_t  ks = (uint8_t)rtl_get(e, RTL_KEY_STATE, 6);
+            uint8_t  ms = (uint8_t)rtl_get(e, RTL_MASK_STATE, 6);
+            uint64_t kw = rtl_get(e, RTL_KEY_WINDOW, 64);
+            uint64_t mw = rtl_get(e, RTL_MASK_WINDOW, 64);
+            if (rtl_get(e, RTL_VALID, 1) &&
+                (((uint8_t)~(st ^ ks) | ms) & 0x3F) == 0x3F && (~(w ^ kw) | mw) == ~0ULL)
+                hit = e;
+        }
+        if (!hit) return -1;                            // 未命中 → 丢弃
+
+        uint8_t  off = (uint8_t)rtl_get(hit, RTL_EXTRACT_OFF, 8);
+        uint16_t dst = (uint16_t)rtl_get(hit, RTL_PHV_DST, 10);
+        if (dst <= PKT_PARSER_RTL_SCRATCH)              // phv_buf 为 512 字节
+            phv[dst] = off < PKT_PARSER_RTL_CELL ? cell[off] : 0;
+        st  = (uint8_t)rtl_get(hit, RTL_NEXT_STATE, 6);
+        ptr = (uint16_t)((ptr + rtl_get(hit, RTL_HDR_ADV, 8)) & 0x3FFF);
+        if (st == PKT_PARSER_ACCEPT) return 0;
+    }
+    return -1;
+}
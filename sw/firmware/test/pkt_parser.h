@@ -0,0 +1,136 @@
+// pkt_parser.h
+// 可编程解析器模型 — 按 HAL fsm_entry_t 约定执行 Parser TCAM 程序（RTL 格式见下方转换器）
+//
+// 64 个状态、256 条 fsm_entry_t（rv_p4_hal.h）。从状态 1（ST_ETHERNET）、
+// hdr_ptr = 0 开始，每步：
+//   1. 取 hdr_ptr 处 8 字节窗口（越过帧尾的字节按 0），与当前状态的条目
+//      做三值匹配，最低索引优先；未命中 → 丢弃（drop = 1）；
+//   2. 把 hdr_ptr + extract_offset 处 extract_len 字节复制到 PHV 的
+//      phv_dst_offset；提取越过帧尾时解析在此结束（已提取字段保留）；
+//   3. next_state = 0x3F → ACCEPT；否则 hdr_ptr += hdr_advance，进入 next_state。
+//
+// 条目格式沿用 fsm_entry_t / HAL 的约定，与 parser_tcam.sv 的存储格式不同：
+//   - key_mask 位为 1 表示参与比较（与 tcam_entry_t、rvp4cc 同向；
+//     parser_tcam.sv 存储的是 don't-care 掩码，位为 1 表示忽略）；
+//   - extract_offset 相对 hdr_ptr（p4_parser.sv 按 cell 绝对偏移取），
+//     同一状态因此可用于可选报头（如 802.1Q 标签）之后；
+//   - extract_len 可大于 1（p4_parser.sv 每步只提取 1 字节）；
+//   - 只能提取到报头区（phv_dst_offset + extract_len <= PHV_OFF_IG_PORT），
+//     vlan_id 元数据仍由 pkt_parse 从 PHV 中的 TCI 派生。
+// pkt_parser_to_rtl() 把程序转换成 parser_tcam.sv 条目；pkt_parser_rtl_run()
+// 按 parser_tcam.sv + p4_parser.sv 的语义执行转换结果，CS-16 与
+// cosim --lockstep parser 校验两者与本模型逐字节一致。
+
+// 修改条目时把程序编译成按状态分组的规则表：状态内所有非通配条目只比较
+// 同一个字节（IHL、协议号等）时编译为 256 项跳转表，每步一次查表；其余
+// 状态只按索引顺序扫描本状态的规则。
+//
+// 内置程序与原先硬编码的解析等价：Ethernet → [802.1Q] → IPv4 → TCP/UDP 端口，
+// IPv4 固定头 20 字节整段复制到 PHV_OFF_IPV4_VER_IHL。具体条目从索引 0 向上
+// 排列，各状态的兜底通配条目从索引 255 向下排列，hal_parser_add_state()
+// 追加的条目因此优先于兜底条目。
+//
+// 修改须在没有报文处理进行时调用（与 pkt_prog_load_json 相同）。
+
+#ifndef PKT_PARSER_H
+#define PKT_PARSER_H
+
+#include <stdint.h>
+#include "rv_p4_hal.h"
+
+#define PKT_PARSER_ENTRIES      256     // 与 parser_tcam.sv DEPTH 一致
+#define PKT_PARSER_STATES       64      // 6 bit 状态
+#define PKT_PARSER_START        1       // ST_ETHERNET
+#define PKT_PARSER_ACCEPT       0x3F
+#define PKT_PARSER_MAX_STEPS    32      // 超过视为环路，按未命中处理
+
+// 内置程序使用的状态（自定义程序可引用，如 MPLS 之后跳回 IPv4）
+#define PKT_PARSER_ST_ETHERTYPE 2       // 窗口首 2 字节为 EtherType
+#define PKT_PARSER_ST_VLAN_TYPE 3       // 802.1Q 标签之后的内层 EtherType
+#define PKT_PARSER_ST_IPV4      4       // 窗口起始于 IPv4 头
+#define PKT_PARSER_ST_L4        5       // TCP / UDP 头
+#define PKT_PARSER_ST_IPV4_IHL  16      // 16 + (IHL - 5)：IPv4 头第 8 字节起
+
+typedef struct pkt_parser pkt_parser_t;
+
+/**
+ * pkt_parser_current - 当前生效的解析程序（首次调用时安装内置程序）
+ * 多线程使用前须在单线程中至少调用一次（pkt_mt_create 已调用）。
+ */
+const pkt_parser_t *pkt_parser_current(void);
+
+/**
+ * pkt_parser_run - 按程序 p 解析 raw，提取结果写入 hdr（PHV 报头区）
+ * 返回 0 = ACCEPT（含截断）；-1 = TCAM 未命中或超过 PKT_PARSER_MAX_STEPS。
+ * 只读访问，可由多个线程并发调用。
+ */
+int pkt_parser_run(const pkt_parser_t *p, const uint8_t *raw, uint16_t raw_len,
+                   uint8_t *hdr);
+
+/** 恢复内置程序 */
+void pkt_parser_reset(void);
+
+/** 清空全部条目（此后所有报文在状态 1 未命中） */
+void pkt_parser_clear(void);
+
+/**
+ * pkt_parser_write - 写入 / 覆盖索引 idx 处的条目
+ * 返回 0；索引、状态号或提取范围非法返回 -1。
+ */
+int pkt_parser_write(int idx, const fsm_entry_t *e);
+
+/**
+ * pkt_parser_add - 写入最低空闲索引
+ * 返回索引；条目非法或已满返回 -1。
+ */
+int pkt_parser_add(const fsm_entry_t *e);
+
+/** 删除索引 idx 处的条目；原本为空返回 -1 */
+int pkt_parser_del(int idx);
+
+/** 删除状态 state 的全部条目，返回删除条数 */
+int pkt_parser_del_state(uint8_t state);
+
+/** 有效条目数 */
+int pkt_parser_count(void);
+
+/** 读出索引 idx 处的条目到 *e；原本为空或索引非法返回 -1 */
+int pkt_parser_read(int idx, fsm_entry_t *e);
+
+// ─────────────────────────────────────────────
+// parser_tcam.sv 条目格式（RTL 协同仿真 / 锁步校验）
+// ─────────────────────────────────────────────
+
+#define PKT_PARSER_RTL_WORDS    20      // 640 bit，w[0] = bit 31:0（与 Verilator VlWide 一致）
+#define PKT_PARSER_RTL_CELL     64      // p4_parser.sv 只解析首个 cell
+#define PKT_PARSER_RTL_SCRATCH  511     // 不提取的条目把 RTL 固有的 1 字节写到这里（报头区之外）
+
+typedef struct {
+    uint32_t w[PKT_PARSER_RTL_WORDS];
+} pkt_parser_rtl_entry_t;
+
+/**
+ * pkt_parser_to_rtl - 把程序 prog[0..n)（按条目索引升序）转换成 parser_tcam.sv 条目
+ *
+ * 从 (状态 1, hdr_ptr 0) 出发遍历程序，每个可达的 (状态, hdr_ptr) 分配一个
+ * RTL 状态，extract_offset 换算为 cell 绝对偏移；extract_len > 1 的提取拆成
+ * 逐字节的条目链（后续条目在新状态中通配匹配）；key_mask 取反为 don't-care 掩码。
+ * 报文不短于 PKT_PARSER_RTL_CELL 字节时，转换结果与 pkt_parser_run 的提取结果
+ * 逐字节一致（PKT_PARSER_RTL_SCRATCH 除外）。
+ *
+ * 返回写入 out 的条目数；以下情况返回 -1：可达状态有环；hdr_ptr、比较窗口或
+ * 提取越出首个 cell；RTL 状态（62 个）或条目（max）不够；最长路径超过
+ * PKT_PARSER_MAX_STEPS。内置程序（20 字节 IPv4 头整段提取）不可表示。
+ */
+int pkt_parser_to_rtl(const fsm_entry_t *prog, int n, pkt_parser_rtl_entry_t *out, int max);
+
+/**
+ * pkt_parser_rtl_run - 按 parser_tcam.sv 的查找与 p4_parser.sv 的 PS_PROCESS
+ * 执行 RTL 条目 ent[0..n)，提取结果写入 phv[0..PKT_PARSER_RTL_SCRATCH]
+ * （调用者预先清零，与 RTL 每帧清零 phv_buf 一致）
+ * 返回 0 = ACCEPT；-1 = 未命中（RTL 丢弃）或超过 RTL 条目数的步数（RTL 不会结束）。
+ */
+int pkt_parser_rtl_run(const pkt_parser_rtl_entry_t *ent, int n,
+                       const uint8_t *raw, uint16_t raw_len, uint8_t *phv);
+
+#endif /* PKT_PARSER_H */
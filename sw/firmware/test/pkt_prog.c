@@ -0,0 +1,511 @@
+// pkt_prog.c
+// 流水线程序：内置程序 + 编译器产物加载（见 pkt_prog.h）
+
+#include "pkt_prog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 双缓冲：加载时写入非当前缓冲区，成功后再切换指针
+static pkt_prog_t        prog_buf[2];
+static const pkt_prog_t *prog_cur;
+static char              prog_err[160];
+static uint32_t          prog_gen;
+
+// ─────────────────────────────────────────────
+// 程序构造工具
+// ─────────────────────────────────────────────
+
+// 追加片段 [off, off + len)，与上一片段相邻则合并；*total 为累计字节数（<= 64）
+static int seg_append(pkt_seg_t *seg, uint8_t *n_seg, uint8_t *total,
+                      uint16_t off, uint8_t len)
+{
+    if (len == 0 || off + len > PKT_PHV_HDR_SIZE || *total + len > 64)
+        return -1;
+    *total = (uint8_t)(*total + len);
+
+    if (*n_seg > 0) {
+        pkt_seg_t *last = &seg[*n_seg - 1];
+        if (last->off + last->len == off) {
+            last->len = (uint8_t)(last->len + len);
+            return 0;
+        }
+    }
+    if (*n_seg == PKT_PROG_MAX_SEGS) return -1;
+    seg[*n_seg].off = off;
+    seg[*n_seg].len = len;
+    (*n_seg)++;
+    return 0;
+}
+
+static int plan_add_seg(pkt_stage_plan_t *pl, uint16_t off, uint8_t len)
+{
+    if (off >= PHV_OFF_IG_PORT) pl->uses_meta = 1;
+    return seg_append(pl->seg, &pl->n_seg, &pl->key_len, off, len);
+}
+
+static int plan_add_hseg(pkt_stage_plan_t *pl, uint16_t off, uint8_t len)
+{
+    if (off >= PHV_OFF_IG_PORT) pl->uses_meta = 1;
+    return seg_append(pl->hseg, &pl->n_hseg, &pl->hash_len, off, len);
+}
+
+static uint32_t act_slot(uint16_t id)
+{
+    return ((uint32_t)id * 2654435761u) >> 23;     // 高 9 位 → 0..511
+}
+
+static int prog_add_action(pkt_prog_t *p, const pkt_action_t *a)
+{
+    if (p->n_actions == PKT_PROG_MAX_ACTIONS) return -1;
+    uint32_t h = act_slot(a->action_id);
+    while (p->act_hash[h]) {
+        if (p->action[p->act_hash[h] - 1].action_id == a->action_id) return -1;
+        h = (h + 1) & (PKT_PROG_ACT_HASH - 1);
+    }
+    p->action[p->n_actions] = *a;
+    p->act_hash[h] = (uint16_t)(++p->n_actions);
+    return 0;
+}
+
+const pkt_action_t *pkt_prog_action(const pkt_prog_t *p, uint16_t action_id)
+{
+    uint32_t h = act_slot(action_id);
+    while (p->act_hash[h]) {
+        const pkt_action_t *a = &p->action[p->act_hash[h] - 1];
+        if (a->action_id == action_id) return a;
+        h = (h + 1) & (PKT_PROG_ACT_HASH - 1);
+    }
+    return NULL;
+}
+
+// ─────────────────────────────────────────────
+// 内置程序：固件 8 张表（与各模块 key 编码 / Action 语义一致）
+// ─────────────────────────────────────────────
+
+#define PRIM(op, w, param, dst, src, imm)   { (op), (w), (param), (dst), (src), (imm) }
+
+static const struct {
+    uint8_t   stage;
+    pkt_seg_t seg[3];
+} builtin_keys[] = {
+    // Stage 0 — IPv4 LPM：ipv4_dst
+    { TABLE_IPV4_LPM_STAGE,     { { PHV_OFF_IPV4_DST, 4 } } },
+    // Stage 1 — ACL：ipv4_src + ipv4_dst + dport
+    { TABLE_ACL_INGRESS_STAGE,  { { PHV_OFF_IPV4_SRC, 4 }, { PHV_OFF_IPV4_DST, 4 },
+                                  { PHV_OFF_TCP_DPORT, 2 } } },
+    // Stage 2 — L2 FDB：eth_dst
+    { TABLE_L2_FDB_STAGE,       { { PHV_OFF_ETH_DST, 6 } } },
+    // Stage 3 — ARP Punt：eth_type
+    { TABLE_ARP_TRAP_STAGE,     { { PHV_OFF_ETH_TYPE, 2 } } },
+    // Stage 4 — VLAN 入口：ig_port + vlan_tci
+    { TABLE_VLAN_INGRESS_STAGE, { { PHV_OFF_IG_PORT, 1 }, { PHV_OFF_VLAN_TCI, 2 } } },
+    // Stage 5 — DSCP QoS：TOS 字节
+    { TABLE_DSCP_MAP_STAGE,     { { PHV_OFF_IPV4_DSCP, 1 } } },
+    // Stage 6 — ECMP 成员：ecmp_idx
+    { TABLE_ECMP_MEMBER_STAGE,  { { PHV_OFF_ECMP_IDX, 2 } } },
+    // Stage 7 — VLAN 出口：eg_port + vlan_id 低字节
+    { TABLE_VLAN_EGRESS_STAGE,  { { PHV_OFF_EG_PORT, 1 }, { PHV_OFF_VLAN_ID + 1, 1 } } },
+};
+
+// hash 输入（未列出的级以匹配键为 hash 输入）
+static const struct {
+    uint8_t   stage;
+    pkt_seg_t seg[4];
+} builtin_hash[] = {
+    // Stage 0 — ECMP 选路：五元组 src + dst + proto + sport/dport（非 TCP/UDP 端口为 0）
+    { TABLE_IPV4_LPM_STAGE,     { { PHV_OFF_IPV4_SRC, 4 }, { PHV_OFF_IPV4_DST, 4 },
+                                  { PHV_OFF_IPV4_PROTO, 1 }, { PHV_OFF_TCP_SPORT, 4 } } },
+};
+
+static const pkt_action_t builtin_actions[] = {
+    // forward(port, dmac[6])：出端口 + 改写 eth_dst
+    { ACTION_FORWARD, 2, { PRIM(PKT_OP_SET_PORT, 1, 0, 0, 0, 0),
+                           PRIM(PKT_OP_SET, 6, 1, PHV_OFF_ETH_DST, 0, 0) } },
+    { ACTION_DROP,    1, { PRIM(PKT_OP_DROP, 1, -1, 0, 0, 0) } },
+    // ecmp_group(base[2], mask[2])：ecmp_idx = base + (flow_hash & mask)，由 Stage 6 选成员
+    { ACTION_ECMP_GROUP, 3, { PRIM(PKT_OP_HASH_SET, 2, -1, PHV_OFF_ECMP_IDX, 0, 0),
+                              PRIM(PKT_OP_AND, 2, 2, PHV_OFF_ECMP_IDX, 0, 0),
+                              PRIM(PKT_OP_ADD, 2, 0, PHV_OFF_ECMP_IDX, 0, 0) } },
+    { ACTION_PERMIT,  0, { PRIM(0, 0, 0, 0, 0, 0) } },
+    { ACTION_DENY,    1, { PRIM(PKT_OP_DROP, 1, -1, 0, 0, 0) } },
+    { ACTION_L2_FORWARD, 1, { PRIM(PKT_OP_SET_PORT, 1, 0, 0, 0, 0) } },
+    { ACTION_FLOOD,   1, { PRIM(PKT_OP_SET_PORT, 1, -1, 0, 0, 0xFF) } },     // 0xFF = 泛洪
+    { ACTION_PUNT_CPU, 1, { PRIM(PKT_OP_SET_META, 1, -1, PKT_META_OFF_PUNT, 0, 1) } },
+    // 赋 PVID：vlan_id = params[0:1]
+    { ACTION_VLAN_ASSIGN_PVID, 1, { PRIM(PKT_OP_SET_META, 2, 0, PHV_OFF_VLAN_ID, 0, 0) } },
+    // 接受带标签帧：vlan_id = tci & 0xFFF；params[0:1] 非 0 时改用参数
+    { ACTION_VLAN_ACCEPT_TAGGED, 3, { PRIM(PKT_OP_COPY, 2, -1, PHV_OFF_VLAN_ID, PHV_OFF_VLAN_TCI, 0),
+                                      PRIM(PKT_OP_AND, 2, -1, PHV_OFF_VLAN_ID, 0, 0x0FFF),
+                                      PRIM(PKT_OP_COND_SET, 2, 0, PHV_OFF_VLAN_ID, 0, 0) } },
+    { ACTION_VLAN_DROP, 1, { PRIM(PKT_OP_DROP, 1, -1, 0, 0, 0) } },
+    // 剥离标签：vlan_action = STRIP，清除 PHV 中的 vlan_tci
+    { ACTION_VLAN_STRIP_TAG, 2, { PRIM(PKT_OP_SET_META, 1, -1, PKT_META_OFF_VLAN_ACT, 0, VLAN_ACT_STRIP),
+                                  PRIM(PKT_OP_SET, 2, -1, PHV_OFF_VLAN_TCI, 0, 0) } },
+    { ACTION_VLAN_KEEP_TAG, 1, { PRIM(PKT_OP_SET_META, 1, -1, PKT_META_OFF_VLAN_ACT, 0, VLAN_ACT_KEEP) } },
+    { ACTION_SET_PRIO, 1, { PRIM(PKT_OP_SET_PRIO, 1, 0, 0, 0, 0) } },
+};
+
+static void prog_builtin(pkt_prog_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->n_stages       = PKT_NUM_STAGES;
+    p->ingress_stages = PKT_INGRESS_STAGES;
+    for (size_t i = 0; i < sizeof(builtin_keys) / sizeof(builtin_keys[0]); i++)
+        for (int k = 0; k < 3 && builtin_keys[i].seg[k].len; k++)
+            plan_add_seg(&p->stage[builtin_keys[i].stage],
+                         builtin_keys[i].seg[k].off, builtin_keys[i].seg[k].len);
+    for (size_t i = 0; i < sizeof(builtin_hash) / sizeof(builtin_hash[0]); i++)
+        for (int k = 0; k < 4 && builtin_hash[i].seg[k].len; k++)
+            plan_add_hseg(&p->stage[builtin_hash[i].stage],
+                          builtin_hash[i].seg[k].off, builtin_hash[i].seg[k].len);
+    for (size_t i = 0; i < sizeof(builtin_actions) / sizeof(builtin_actions[0]); i++)
+        prog_add_action(p, &builtin_actions[i]);
+}
+
+const pkt_prog_t *pkt_prog_current(void)
+{
+    if (!prog_cur) pkt_prog_reset();
+    return prog_cur;
+}
+
+void pkt_prog_reset(void)
+{
+    pkt_prog_t *p = (prog_cur == &prog_buf[0]) ? &prog_buf[1] : &prog_buf[0];
+    prog_builtin(p);
+    prog_cur = p;
+    prog_gen++;
+}
+
+uint32_t pkt_prog_generation(void)
+{
+    return prog_gen;
+}
+
+const char *pkt_prog_error(void)
+{
+    return prog_err;
+}
+
+// ─────────────────────────────────────────────
+// 最小 JSON 解析（对象 / 数组 / 字符串 / 数字 / true / false / null）
+// ─────────────────────────────────────────────
+
+typedef enum { JV_NULL, JV_BOOL, JV_NUM, JV_STR, JV_ARR, JV_OBJ } jv_type_t;
+
+typedef struct jv {
+    jv_type_t  type;
+    double     num;
+    char      *str;     // JV_STR 的值
+    char      *key;     // 作为对象成员时的键
+    struct jv *child;   // 数组元素 / 对象成员链表
+    struct jv *next;
+} jv_t;
+
+typedef struct {
+    const char *s;
+    int         depth;
+} jp_t;
+
+static void jv_free(jv_t *v)
+{
+    while (v) {
+        jv_t *n = v->next;
+        jv_free(v->child);
+        free(v->str);
+        free(v->key);
+        free(v);
+        v = n;
+    }
+}
+
+static void jp_ws(jp_t *p)
+{
+    while (*p->s == ' ' || *p->s == '\t' || *p->s == '\n' || *p->s == '\r') p->s++;
+}
+
+static char *jp_string(jp_t *p)
+{
+    if (*p->s != '"') return NULL;
+    p->s++;
+    size_t cap = 16, n = 0;
+    char  *out = (char *)malloc(cap);
+    if (!out) return NULL;
+    while (*p->s && *p->s != '"') {
+        char c = *p->s++;
+        if (c == '\\') {
+            c = *p->s++;
+            switch (c) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'u':                       // 字段名均为 ASCII：\uXXXX 以 '?' 代替
+                for (int k = 0; k < 4 && *p->s; k++) p->s++;
+                c = '?';
+                break;
+            case '\0': free(out); return NULL;
+            default: break;                 // \" \\ \/
+            }
+        }
+        if (n + 1 >= cap) {
+            char *o = (char *)realloc(out, cap *= 2);
+            if (!o) { free(out); return NULL; }
+            out = o;
+        }
+        out[n++] = c;
+    }
+    if (*p->s != '"') { free(out); return NULL; }
+    p->s++;
+    out[n] = '\0';
+    return out;
+}
+
+static jv_t *jp_value(jp_t *p)
+{
+    jp_ws(p);
+    if (++p->depth > 32) return NULL;
+    jv_t *v = (jv_t *)calloc(1, sizeof(*v));
+    if (!v) return NULL;
+
+    if (*p->s == '{' || *p->s == '[') {
+        int   obj  = (*p->s == '{');
+        jv_t **tail = &v->child;
+        v->type = obj ? JV_OBJ : JV_ARR;
+        p->s++;
+        jp_ws(p);
+        if (*p->s == (obj ? '}' : ']')) {
+            p->s++;
+            p->depth--;
+            return v;
+        }
+        for (;;) {
+            char *key = NULL;
+            if (obj) {
+                jp_ws(p);
+                key = jp_string(p);
+                jp_ws(p);
+                if (!key || *p->s != ':') { free(key); jv_free(v); return NULL; }
+                p->s++;
+            }
+            jv_t *c = jp_value(p);
+            if (!c) { free(key); jv_free(v); return NULL; }
+            c->key = key;
+            *tail  = c;
+            tail   = &c->next;
+            jp_ws(p);
+            if (*p->s == ',') { p->s++; continue; }
+            if (*p->s == (obj ? '}' : ']')) { p->s++; break; }
+            jv_free(v);
+            return NULL;
+        }
+    } else if (*p->s == '"') {
+        v->type = JV_STR;
+        v->str  = jp_string(p);
+        if (!v->str) { jv_free(v); return NULL; }
+    } else if (!strncmp(p->s, "true", 4) || !strncmp(p->s, "false", 5)) {
+        v->type = JV_BOOL;
+        v->num  = (*p->s == 't');
+        p->s   += (*p->s == 't') ? 4 : 5;
+    } else if (!strncmp(p->s, "null", 4)) {
+        v->type = JV_NULL;
+        p->s   += 4;
+    } else {
+        char *end;
+        v->type = JV_NUM;
+        v->num  = strtod(p->s, &end);
+        if (end == p->s) { jv_free(v); return NULL; }
+        p->s = end;
+    }
+    p->depth--;
+    return v;
+}
+
+static jv_t *jv_parse(const char *text, const char *what)
+{
+    jp_t  p = { text, 0 };
+    jv_t *v = text ? jp_value(&p) : NULL;
+    if (v) {
+        jp_ws(&p);
+        if (*p.s == '\0' && v->type == JV_OBJ) return v;
+        jv_free(v);
+    }
+    snprintf(prog_err, sizeof(prog_err), "%s: malformed JSON (expected an object)", what);
+    return NULL;
+}
+
+static const jv_t *jv_get(const jv_t *obj, const char *key)
+{
+    for (const jv_t *c = obj ? obj->child : NULL; c; c = c->next)
+        if (c->key && !strcmp(c->key, key)) return c;
+    return NULL;
+}
+
+static int jv_int(const jv_t *obj, const char *key, long dflt)
+{
+    const jv_t *v = jv_get(obj, key);
+    return (int)((v && v->type == JV_NUM) ? (long)v->num : dflt);
+}
+
+// ─────────────────────────────────────────────
+// 编译器产物加载
+// ─────────────────────────────────────────────
+
+static int load_tables(pkt_prog_t *p, const jv_t *phv, const jv_t *tables)
+{
+    const jv_t *pipe = jv_get(tables, "_pipeline");
+    p->n_stages       = (uint8_t)jv_int(pipe, "num_stages", PKT_NUM_STAGES);
+    p->ingress_stages = (uint8_t)jv_int(pipe, "ingress_stages", PKT_INGRESS_STAGES);
+    if (p->n_stages == 0 || p->n_stages > PKT_NUM_STAGES ||
+        p->ingress_stages > p->n_stages) {
+        snprintf(prog_err, sizeof(prog_err),
+                 "table_info: _pipeline num_stages=%d ingress_stages=%d out of range (max %d)",
+                 p->n_stages, p->ingress_stages, PKT_NUM_STAGES);
+        return -1;
+    }
+
+    for (const jv_t *t = tables->child; t; t = t->next) {
+        if (t->key[0] == '_') continue;                 // 保留项（_pipeline 等）
+        int stage = jv_int(t, "stage", -1);
+        if (t->type != JV_OBJ || stage < 0 || stage >= p->n_stages) {
+            snprintf(prog_err, sizeof(prog_err),
+                     "table '%s': stage %d out of range", t->key, stage);
+            return -1;
+        }
+        pkt_stage_plan_t *pl = &p->stage[stage];
+        if (pl->n_seg) {
+            snprintf(prog_err, sizeof(prog_err),
+                     "table '%s': stage %d already has a table", t->key, stage);
+            return -1;
+        }
+        const jv_t *keys = jv_get(t, "key_fields");
+        if (!keys || keys->type != JV_ARR || !keys->child) {
+            snprintf(prog_err, sizeof(prog_err), "table '%s': no key_fields", t->key);
+            return -1;
+        }
+        for (const jv_t *k = keys->child; k; k = k->next) {
+            const jv_t *f = (k->type == JV_STR) ? jv_get(phv, k->str) : NULL;
+            int off = jv_int(f, "offset", -1), w = jv_int(f, "width", 0);
+            if (!f || off < 0 || w <= 0 || plan_add_seg(pl, (uint16_t)off, (uint8_t)w) != 0) {
+                snprintf(prog_err, sizeof(prog_err), "table '%s': bad key field '%s'",
+                         t->key, k->type == JV_STR ? k->str : "?");
+                return -1;
+            }
+        }
+        // 可选：HASH_SET 的 hash 输入（缺省为匹配键）
+        const jv_t *hf = jv_get(t, "hash_fields");
+        for (const jv_t *k = (hf && hf->type == JV_ARR) ? hf->child : NULL; k; k = k->next) {
+            const jv_t *f = (k->type == JV_STR) ? jv_get(phv, k->str) : NULL;
+            int off = jv_int(f, "offset", -1), w = jv_int(f, "width", 0);
+            if (!f || off < 0 || w <= 0 || plan_add_hseg(pl, (uint16_t)off, (uint8_t)w) != 0) {
+                snprintf(prog_err, sizeof(prog_err), "table '%s': bad hash field '%s'",
+                         t->key, k->type == JV_STR ? k->str : "?");
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int load_actions(pkt_prog_t *p, const jv_t *actions)
+{
+    for (const jv_t *a = actions->child; a; a = a->next) {
+        pkt_action_t act;
+        memset(&act, 0, sizeof(act));
+        int id = jv_int(a, "action_id", -1);
+        if (a->type != JV_OBJ || id < 0 || id > 0xFFFF) {
+            snprintf(prog_err, sizeof(prog_err), "action '%s': bad action_id", a->key);
+            return -1;
+        }
+        act.action_id = (uint16_t)id;
+        const jv_t *prims = jv_get(a, "primitives");
+        for (const jv_t *pr = prims ? prims->child : NULL; pr; pr = pr->next) {
+            if (act.n_prim == PKT_PROG_MAX_PRIMS) {
+                snprintf(prog_err, sizeof(prog_err), "action '%s': more than %d primitives",
+                         a->key, PKT_PROG_MAX_PRIMS);
+                return -1;
+            }
+            pkt_prim_t *x = &act.prim[act.n_prim++];
+            const jv_t *imm = jv_get(pr, "imm_val");
+            int param = jv_int(pr, "param", -1);
+            x->op      = (uint8_t)jv_int(pr, "op", PKT_OP_NOP);
+            x->fwidth  = (uint8_t)jv_int(pr, "fwidth", 4);
+            x->dst_off = (uint16_t)jv_int(pr, "dst_off", 0);
+            x->src_off = (uint16_t)jv_int(pr, "src_off", 0);
+            x->imm     = (imm && imm->type == JV_NUM) ? (uint32_t)(unsigned long long)imm->num : 0;
+            x->param   = (int8_t)param;
+            if (x->fwidth == 0 || x->fwidth > 8 ||
+                x->dst_off + x->fwidth > PKT_PHV_HDR_SIZE ||
+                x->src_off + x->fwidth > PKT_PHV_HDR_SIZE ||
+                param + x->fwidth > 12) {           // tcam_entry_t.action_params[12]
+                snprintf(prog_err, sizeof(prog_err), "action '%s': primitive out of range",
+                         a->key);
+                return -1;
+            }
+        }
+        if (prog_add_action(p, &act) != 0) {
+            snprintf(prog_err, sizeof(prog_err), "action '%s': duplicate action_id 0x%04X",
+                     a->key, id);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int pkt_prog_load_json(const char *phv_map, const char *table_info,
+                       const char *action_info)
+{
+    pkt_prog_t *p = (prog_cur == &prog_buf[0]) ? &prog_buf[1] : &prog_buf[0];
+    memset(p, 0, sizeof(*p));
+
+    jv_t *phv = jv_parse(phv_map, "phv_map");
+    jv_t *tbl = phv ? jv_parse(table_info, "table_info") : NULL;
+    jv_t *act = tbl ? jv_parse(action_info, "action_info") : NULL;
+    int rc = -1;
+    if (act && load_tables(p, phv, tbl) == 0 && load_actions(p, act) == 0) {
+        prog_cur = p;
+        prog_gen++;
+        rc = 0;
+    }
+    jv_free(phv);
+    jv_free(tbl);
+    jv_free(act);
+    return rc;
+}
+
+static char *read_file(const char *dir, const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(prog_err, sizeof(prog_err), "cannot open %.120s", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = (n >= 0) ? (char *)malloc((size_t)n + 1) : NULL;
+    if (buf && fread(buf, 1, (size_t)n, f) == (size_t)n) {
+        buf[n] = '\0';
+    } else {
+        free(buf);
+        buf = NULL;
+        snprintf(prog_err, sizeof(prog_err), "cannot read %.120s", path);
+    }
+    fclose(f);
+    return buf;
+}
+
+int pkt_prog_load_dir(const char *dir)
+{
+    char *phv = read_file(dir, "phv_map.json");
+    char *tbl = phv ? read_file(dir, "table_info.json") : NULL;
+    char *act = tbl ? read_file(dir, "action_info.json") : NULL;
+    int rc = act ? pkt_prog_load_json(phv, tbl, act) : -1;
+    free(phv);
+    free(tbl);
+    free(act);
+    return rc;
+}
@@ -0,0 +1,123 @@
+// pkt_prog.h
+// 流水线程序 — pkt_model.c 的表驱动配置
+//
+// 描述每个 MAU Stage 的匹配键提取计划与每个 Action 的原语序列：
+//   - 内置程序：与固件 8 张表（table_map.h）的 key 编码和 Action 语义一致，
+//     Stage 8-23 不配置（不执行）；
+//   - 编译器产物：pkt_prog_load_dir() 读取 rvp4cc.py 生成的
+//     phv_map.json / table_info.json / action_info.json，替换内置程序。
+//
+// 加载时把字段名解析为 PHV 偏移并合并相邻片段，每包的提取只剩若干 memcpy；
+// Action 按 action_id 经开放寻址哈希定位。
+//
+// 元数据与 PHV 同一地址空间（偏移 >= 256，与 table_map.h PHV_OFF_* 一致）：
+//   256 ig_port   257 eg_port   258 drop   261-262 vlan_id(BE)   263 qos_prio
+//   264 punt      265 vlan_action（后两项为模型私有，见 PKT_META_OFF_*）
+//   266-267 ecmp_idx(BE)
+//
+// HASH_SET 与 mau_hash.sv 相同：对本级 hash 输入做 CRC32（见 pkt_hash_crc32），
+// 写入低 fwidth 字节。hash 输入默认为本级匹配键；内置程序 Stage 0 为五元组，
+// 编译器产物可用 table_info 的 "hash_fields" 指定。
+
+#ifndef PKT_PROG_H
+#define PKT_PROG_H
+
+#include <stdint.h>
+#include "pkt_model.h"
+
+#define PKT_PROG_MAX_SEGS       8       // 每级键片段上限
+#define PKT_PROG_MAX_PRIMS      4       // 每个 Action 原语上限
+#define PKT_PROG_MAX_ACTIONS    255
+#define PKT_PROG_ACT_HASH       512     // action_id 哈希槽数（2 的幂）
+
+#define PKT_META_OFF_PUNT       264
+#define PKT_META_OFF_VLAN_ACT   265
+
+// ALU 操作码（与 mau_alu.sv / rvp4cc.py 一致）
+#define PKT_OP_NOP       0x0
+#define PKT_OP_SET       0x1    // dst = value
+#define PKT_OP_COPY      0x2    // dst = phv[src]
+#define PKT_OP_ADD       0x3    // dst += value
+#define PKT_OP_SUB       0x4    // dst -= value
+#define PKT_OP_AND       0x5
+#define PKT_OP_OR        0x6
+#define PKT_OP_XOR       0x7
+#define PKT_OP_SET_META  0x8    // 同 SET（dst 位于元数据区）
+#define PKT_OP_DROP      0x9    // drop = 1
+#define PKT_OP_SET_PORT  0xA    // eg_port = value
+#define PKT_OP_SET_PRIO  0xB    // qos_prio = value
+#define PKT_OP_HASH_SET  0xC    // dst = CRC32(hash 输入) 低 fwidth 字节
+#define PKT_OP_COND_SET  0xD    // value != 0 时 dst = value
+
+// 键片段：从 PHV 偏移 off 复制 len 字节
+typedef struct {
+    uint16_t off;
+    uint8_t  len;
+} pkt_seg_t;
+
+// 每级提取计划（n_seg = 0 表示该级未配置，不执行）
+typedef struct {
+    uint8_t   n_seg;
+    uint8_t   key_len;
+    uint8_t   uses_meta;    // 1 = 键或 hash 输入含元数据字段，提取前需同步元数据
+    uint8_t   n_hseg;       // hash 输入片段数（0 = 以匹配键为 hash 输入）
+    uint8_t   hash_len;
+    pkt_seg_t seg[PKT_PROG_MAX_SEGS];
+    pkt_seg_t hseg[PKT_PROG_MAX_SEGS];
+} pkt_stage_plan_t;
+
+// Action 原语；value 来自 action_params[param..]（param >= 0）或 imm
+typedef struct {
+    uint8_t  op;
+    uint8_t  fwidth;
+    int8_t   param;
+    uint16_t dst_off;
+    uint16_t src_off;
+    uint32_t imm;
+} pkt_prim_t;
+
+typedef struct {
+    uint16_t   action_id;
+    uint8_t    n_prim;
+    pkt_prim_t prim[PKT_PROG_MAX_PRIMS];
+} pkt_action_t;
+
+typedef struct {
+    uint8_t          n_stages;          // 执行的级数（<= PKT_NUM_STAGES）
+    uint8_t          ingress_stages;    // 其中入口级数
+    pkt_stage_plan_t stage[PKT_NUM_STAGES];
+    int              n_actions;
+    pkt_action_t     action[PKT_PROG_MAX_ACTIONS];
+    uint16_t         act_hash[PKT_PROG_ACT_HASH];   // 下标 + 1（0 = 空）
+} pkt_prog_t;
+
+/**
+ * pkt_prog_current - 当前生效的程序（首次调用时安装内置程序）
+ * 多线程使用前须在单线程中至少调用一次（pkt_mt_create 已调用）。
+ */
+const pkt_prog_t *pkt_prog_current(void);
+
+/** 按 action_id 查找 Action，未定义返回 NULL */
+const pkt_action_t *pkt_prog_action(const pkt_prog_t *p, uint16_t action_id);
+
+/** 程序代数：每次 reset / 成功加载后递增（流缓存据此失效） */
+uint32_t pkt_prog_generation(void);
+
+/** 恢复内置程序 */
+void pkt_prog_reset(void);
+
+/**
+ * pkt_prog_load_json - 从三份 JSON 文本加载程序（成功后替换当前程序）
+ * 返回 0；失败返回 -1，原程序保持不变，原因见 pkt_prog_error()。
+ * 须在没有报文处理进行时调用。
+ */
+int pkt_prog_load_json(const char *phv_map, const char *table_info,
+                       const char *action_info);
+
+/** 从目录读取 phv_map.json / table_info.json / action_info.json 并加载 */
+int pkt_prog_load_dir(const char *dir);
+
+/** 最近一次加载失败的原因 */
+const char *pkt_prog_error(void);
+
+#endif /* PKT_PROG_H */
@@ -1,8 +1,9 @@
 // sim_hal.c
 // 模拟 HAL 实现
-// 提供所有 rv_p4_hal.h 声明的函数（TCAM/VLAN/QoS/Punt/UART）
+// 提供所有 rv_p4_hal.h 声明的函数（TCAM/Parser/VLAN/QoS/Punt/UART）
 
 #include "sim_hal.h"
+#include "pkt_parser.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -11,9 +12,6 @@
 // 全局模拟状态定义
 // ─────────────────────────────────────────────
 
-sim_tcam_rec_t sim_tcam_db[SIM_TCAM_MAX];
-int            sim_tcam_n;
-
 uint16_t  sim_vlan_pvid[32];
 uint8_t   sim_vlan_mode[32];
 uint32_t  sim_vlan_member[256];
@@ -26,21 +24,88 @@ uint8_t   sim_qos_dscp_map[64];
 
 uint32_t  sim_port_enable;
 
-sim_punt_rec_t sim_punt_rx_ring[SIM_PUNT_MAX];
-int            sim_punt_rx_head;
-int            sim_punt_rx_tail;
+uint32_t  sim_tue_drains;
+int       sim_tue_fail_cmd = -1;
+int       sim_tue_fail_skip;
+
+spsc_ring_t sim_punt_rx;
+spsc_ring_t sim_punt_tx;
+
+static punt_pkt_t sim_punt_rx_slots[SIM_PUNT_MAX];
+static punt_pkt_t sim_punt_tx_slots[SIM_PUNT_MAX];
+
+// ─────────────────────────────────────────────
+// TUE 批量暂存（与 tue.sv 的暂存 FIFO 相同：提交时按入队顺序生效）
+// ─────────────────────────────────────────────
+
+typedef struct {
+    uint8_t      cmd;       // TUE_CMD_*
+    uint8_t      stage;
+    uint16_t     table_id;
+    tcam_entry_t entry;     // INSERT / MODIFY
+} sim_tue_op_t;
+
+static sim_tue_op_t sim_tue_q[HAL_TCAM_BATCH_MAX];
+static int          sim_tue_n;
+static int          sim_tue_open;
+
+static void sim_tue_reset(void) {
+    sim_tue_drains    = 0;
+    sim_tue_n         = 0;
+    sim_tue_open      = 0;
+    sim_tue_fail_cmd  = -1;
+    sim_tue_fail_skip = 0;
+}
+
+static int sim_tue_exec(const sim_tue_op_t *op) {
+    if (op->cmd == sim_tue_fail_cmd) {
+        if (sim_tue_fail_skip > 0) {
+            sim_tue_fail_skip--;
+        } else {
+            sim_tue_fail_cmd = -1;               // 单次故障
+            return HAL_ERR_TIMEOUT;
+        }
+    }
+    switch (op->cmd) {
+    case TUE_CMD_INSERT: return sim_tcam_insert(&op->entry);
+    case TUE_CMD_DELETE: return sim_tcam_delete(op->stage, op->table_id);
+    case TUE_CMD_MODIFY: return sim_tcam_modify(&op->entry);
+    default:             return sim_tcam_flush(op->stage);
+    }
+}
+
+// 一次排空，按顺序执行暂存的全部操作；返回第一个错误（其余照常执行）
+static int sim_tue_drain(void) {
+    int ret = HAL_OK;
+    if (sim_tue_n == 0) return HAL_OK;
+    sim_tue_drains++;
+    for (int i = 0; i < sim_tue_n; i++) {
+        int r = sim_tue_exec(&sim_tue_q[i]);
+        if (r != HAL_OK && ret == HAL_OK) ret = r;
+    }
+    sim_tue_n = 0;
+    return ret;
+}
 
-sim_punt_rec_t sim_punt_tx_ring[SIM_PUNT_MAX];
-int            sim_punt_tx_head;
-int            sim_punt_tx_tail;
+// 非批量：立即执行（一次排空）；批量：入队，队列满先提交当前批
+static int sim_tue_submit(const sim_tue_op_t *op) {
+    if (!sim_tue_open) {
+        sim_tue_drains++;
+        return sim_tue_exec(op);
+    }
+    int ret = HAL_OK;
+    if (sim_tue_n == HAL_TCAM_BATCH_MAX) ret = sim_tue_drain();
+    sim_tue_q[sim_tue_n++] = *op;
+    return ret;
+}
 
 // ─────────────────────────────────────────────
 // sim_hal_reset
 // ─────────────────────────────────────────────
 
 void sim_hal_reset(void) {
-    memset(sim_tcam_db,     0, sizeof(sim_tcam_db));
-    sim_tcam_n = 0;
+    sim_tcam_reset();
+    pkt_parser_reset();
 
     memset(sim_vlan_pvid,   0, sizeof(sim_vlan_pvid));
     memset(sim_vlan_mode,   0, sizeof(sim_vlan_mode));
@@ -54,79 +119,66 @@ void sim_hal_reset(void) {
 
     sim_port_enable = 0;
 
-    memset(sim_punt_rx_ring, 0, sizeof(sim_punt_rx_ring));
-    memset(sim_punt_tx_ring, 0, sizeof(sim_punt_tx_ring));
-    sim_punt_rx_head = sim_punt_rx_tail = 0;
-    sim_punt_tx_head = sim_punt_tx_tail = 0;
-}
+    sim_tue_reset();
 
-// ─────────────────────────────────────────────
-// TCAM 辅助
-// ─────────────────────────────────────────────
-
-sim_tcam_rec_t *sim_tcam_find(uint8_t stage, uint16_t table_id) {
-    for (int i = 0; i < sim_tcam_n; i++) {
-        sim_tcam_rec_t *r = &sim_tcam_db[i];
-        if (r->valid && !r->deleted &&
-            r->entry.stage    == stage &&
-            r->entry.table_id == table_id)
-            return r;
-    }
-    return NULL;
-}
-
-int sim_tcam_count_stage(uint8_t stage) {
-    int cnt = 0;
-    for (int i = 0; i < sim_tcam_n; i++) {
-        sim_tcam_rec_t *r = &sim_tcam_db[i];
-        if (r->valid && !r->deleted && r->entry.stage == stage)
-            cnt++;
-    }
-    return cnt;
+    spsc_ring_init(&sim_punt_rx, sim_punt_rx_slots, SIM_PUNT_MAX, sizeof(punt_pkt_t));
+    spsc_ring_init(&sim_punt_tx, sim_punt_tx_slots, SIM_PUNT_MAX, sizeof(punt_pkt_t));
 }
 
 // ─────────────────────────────────────────────
-// HAL: TCAM 操作
+// HAL: TCAM 操作（存储在 sim_tcam.c）
 // ─────────────────────────────────────────────
 
 int hal_tcam_insert(const tcam_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
-
-    // 已存在则更新
-    sim_tcam_rec_t *ex = sim_tcam_find(entry->stage, entry->table_id);
-    if (ex) {
-        ex->entry   = *entry;
-        ex->deleted = 0;
-        return HAL_OK;
-    }
-    // 新条目
-    if (sim_tcam_n >= SIM_TCAM_MAX) return HAL_ERR_FULL;
-    sim_tcam_db[sim_tcam_n].entry   = *entry;
-    sim_tcam_db[sim_tcam_n].valid   = 1;
-    sim_tcam_db[sim_tcam_n].deleted = 0;
-    sim_tcam_n++;
-    return HAL_OK;
+    sim_tue_op_t op = { .cmd = TUE_CMD_INSERT, .entry = *entry };
+    return sim_tue_submit(&op);
 }
 
 int hal_tcam_delete(uint8_t stage, uint16_t table_id) {
-    sim_tcam_rec_t *e = sim_tcam_find(stage, table_id);
-    if (!e) return HAL_ERR_INVAL;
-    e->deleted = 1;
-    return HAL_OK;
+    sim_tue_op_t op = { .cmd = TUE_CMD_DELETE, .stage = stage, .table_id = table_id };
+    return sim_tue_submit(&op);
 }
 
 int hal_tcam_modify(const tcam_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
-    sim_tcam_rec_t *e = sim_tcam_find(entry->stage, entry->table_id);
-    if (!e) return HAL_ERR_INVAL;
-    e->entry = *entry;
-    return HAL_OK;
+    sim_tue_op_t op = { .cmd = TUE_CMD_MODIFY, .entry = *entry };
+    return sim_tue_submit(&op);
 }
 
 int hal_tcam_flush(uint8_t stage) {
-    for (int i = 0; i < sim_tcam_n; i++)
-        if (sim_tcam_db[i].valid && sim_tcam_db[i].entry.stage == stage)
-            sim_tcam_db[i].deleted = 1;
+    sim_tue_op_t op = { .cmd = TUE_CMD_FLUSH, .stage = stage };
+    return sim_tue_submit(&op);
+}
+
+int hal_tcam_batch_begin(void) {
+    if (sim_tue_open) return HAL_ERR_BUSY;
+    sim_tue_open = 1;
+    sim_tue_n    = 0;
+    return HAL_OK;
+}
+
+int hal_tcam_batch_commit(void) {
+    if (!sim_tue_open) return HAL_ERR_INVAL;
+    sim_tue_open = 0;
+    return sim_tue_drain();
+}
+
+// ─────────────────────────────────────────────
+// HAL: Parser TCAM（存储在 pkt_parser.c）
+// 条目写入最低空闲索引，优先于内置程序的兜底通配条目
+// ─────────────────────────────────────────────
+
+int hal_parser_add_state(const fsm_entry_t *entry) {
+    if (!entry || entry->cur_state >= PKT_PARSER_STATES ||
+        entry->next_state >= PKT_PARSER_STATES) return HAL_ERR_INVAL;
+    if (pkt_parser_count() == PKT_PARSER_ENTRIES) return HAL_ERR_FULL;
+    return pkt_parser_add(entry) < 0 ? HAL_ERR_INVAL : HAL_OK;
+}
+
+int hal_parser_del_state(uint8_t state_id) {
+    if (state_id >= PKT_PARSER_STATES) return HAL_ERR_INVAL;
+    pkt_parser_del_state(state_id);
     return HAL_OK;
 }
 
@@ -217,32 +269,34 @@ int hal_port_stats_clear(port_id_t port) {
 // HAL: Punt 环
 // ─────────────────────────────────────────────
 
-void sim_punt_rx_inject(const punt_pkt_t *pkt) {
-    int slot = sim_punt_rx_head % SIM_PUNT_MAX;
-    sim_punt_rx_ring[slot].pkt   = *pkt;
-    sim_punt_rx_ring[slot].valid = 1;
-    sim_punt_rx_head++;
+int sim_punt_rx_inject(const punt_pkt_t *pkt) {
+    if (!pkt) return HAL_ERR_INVAL;
+    return spsc_ring_enqueue(&sim_punt_rx, pkt) == 0 ? HAL_OK : HAL_ERR_FULL;
+}
+
+int sim_punt_rx_inject_burst(const punt_pkt_t *pkts, int n) {
+    if (!pkts || n <= 0) return 0;
+    return (int)spsc_ring_enqueue_burst(&sim_punt_rx, pkts, (uint32_t)n);
+}
+
+int sim_punt_tx_pop_burst(punt_pkt_t *pkts, int n) {
+    if (!pkts || n <= 0) return 0;
+    return (int)spsc_ring_dequeue_burst(&sim_punt_tx, pkts, (uint32_t)n);
 }
 
 int hal_punt_rx_poll(punt_pkt_t *pkt) {
-    if (sim_punt_rx_tail >= sim_punt_rx_head) return -1;
-    int slot = sim_punt_rx_tail % SIM_PUNT_MAX;
-    if (!sim_punt_rx_ring[slot].valid)        return -1;
-    *pkt = sim_punt_rx_ring[slot].pkt;
-    sim_punt_rx_ring[slot].valid = 0;
-    sim_punt_rx_tail++;
-    return HAL_OK;
+    if (!pkt) return HAL_ERR_INVAL;
+    return spsc_ring_dequeue(&sim_punt_rx, pkt) == 0 ? HAL_OK : -1;
+}
+
+int hal_punt_rx_poll_burst(punt_pkt_t *pkts, int max) {
+    if (!pkts || max <= 0) return 0;
+    return (int)spsc_ring_dequeue_burst(&sim_punt_rx, pkts, (uint32_t)max);
 }
 
 int hal_punt_tx_send(const punt_pkt_t *pkt) {
     if (!pkt) return HAL_ERR_INVAL;
-    if (sim_punt_tx_head - sim_punt_tx_tail >= SIM_PUNT_MAX)
-        return HAL_ERR_FULL;
-    int slot = sim_punt_tx_head % SIM_PUNT_MAX;
-    sim_punt_tx_ring[slot].pkt   = *pkt;
-    sim_punt_tx_ring[slot].valid = 1;
-    sim_punt_tx_head++;
-    return HAL_OK;
+    return spsc_ring_enqueue(&sim_punt_tx, pkt) == 0 ? HAL_OK : HAL_ERR_FULL;
 }
 
 // ─────────────────────────────────────────────
@@ -258,8 +312,6 @@ int hal_counter_read(counter_id_t id, uint64_t *b, uint64_t *p) {
 
 int hal_counter_reset(counter_id_t id)            { (void)id;         return HAL_OK; }
 int hal_meter_config(meter_id_t id, const meter_cfg_t *c) { (void)id; (void)c; return HAL_OK; }
-int hal_parser_add_state(const fsm_entry_t *e)    { (void)e;          return HAL_OK; }
-int hal_parser_del_state(uint8_t s)               { (void)s;          return HAL_OK; }
 
 int hal_init(void) {
     sim_hal_reset();
@@ -6,22 +6,16 @@
 #define SIM_HAL_H
 
 #include "rv_p4_hal.h"
+#include "sim_tcam.h"
+#include "spsc_ring.h"
 #include <stdint.h>
 
 // ─────────────────────────────────────────────
 // 容量
 // ─────────────────────────────────────────────
-#define SIM_TCAM_MAX    512     // TCAM 记录总槽数
-#define SIM_PUNT_MAX    32      // Punt 环槽数
+#define SIM_PUNT_MAX    1024    // Punt 环槽数（2 的幂）
 
-// ─────────────────────────────────────────────
-// TCAM 记录
-// ─────────────────────────────────────────────
-typedef struct {
-    tcam_entry_t entry;
-    uint8_t      valid;     // 1 = 槽已占用
-    uint8_t      deleted;   // 1 = 已通过 delete 标记删除
-} sim_tcam_rec_t;
+// TCAM 记录 / 数据库见 sim_tcam.h
 
 // ─────────────────────────────────────────────
 // Punt 包记录
@@ -35,10 +29,6 @@ typedef struct {
 // 模拟状态（extern 声明，在 sim_hal.c 中定义）
 // ─────────────────────────────────────────────
 
-/* TCAM 数据库 */
-extern sim_tcam_rec_t sim_tcam_db[SIM_TCAM_MAX];
-extern int            sim_tcam_n;   // 已分配槽数（含已删除）
-
 /* VLAN CSR */
 extern uint16_t  sim_vlan_pvid[32];
 extern uint8_t   sim_vlan_mode[32];
@@ -54,15 +44,24 @@ extern uint8_t   sim_qos_dscp_map[64];
 /* 端口使能寄存器 */
 extern uint32_t  sim_port_enable;
 
-/* Punt RX 环（test→firmware）*/
-extern sim_punt_rec_t sim_punt_rx_ring[SIM_PUNT_MAX];
-extern int            sim_punt_rx_head;   /* test 注入指针 */
-extern int            sim_punt_rx_tail;   /* firmware 消费指针 */
-
-/* Punt TX 环（firmware→test）*/
-extern sim_punt_rec_t sim_punt_tx_ring[SIM_PUNT_MAX];
-extern int            sim_punt_tx_head;   /* firmware 写入指针 */
-extern int            sim_punt_tx_tail;   /* test 读取指针 */
+/* TUE 排空次数：逐条 hal_tcam_* 每次一次，批量每次提交（及队列满时的
+ * 自动提交）一次 */
+extern uint32_t  sim_tue_drains;
+
+/* TUE 故障注入：跳过 sim_tue_fail_skip 条命令码为 sim_tue_fail_cmd（TUE_CMD_*）
+ * 的写入后，令下一条失败一次（返回 HAL_ERR_TIMEOUT，TCAM 不变）；
+ * -1 = 关闭。sim_hal_reset 时关闭 */
+extern int       sim_tue_fail_cmd;
+extern int       sim_tue_fail_skip;
+
+/* Punt 环：无锁 SPSC（spsc_ring.h），元素为 punt_pkt_t
+ *   RX（数据面→firmware）：生产者 = 注入线程（sim_punt_rx_inject*），
+ *                          消费者 = 固件线程（hal_punt_rx_poll*）
+ *   TX（firmware→数据面）：生产者 = 固件线程（hal_punt_tx_send），
+ *                          消费者 = 数据面 / 测试线程（sim_punt_tx_pop*）
+ * 两个方向各自只允许一个生产者线程和一个消费者线程。 */
+extern spsc_ring_t sim_punt_rx;
+extern spsc_ring_t sim_punt_tx;
 
 // ─────────────────────────────────────────────
 // 控制函数
@@ -71,28 +70,29 @@ extern int            sim_punt_tx_tail;   /* test 读取指针 */
 /** 重置所有模拟状态（每个测试用例前调用） */
 void sim_hal_reset(void);
 
-/** 注入一个包到 Punt RX 环（模拟数据面 punt 行为） */
-void sim_punt_rx_inject(const punt_pkt_t *pkt);
+/** 注入一个包到 Punt RX 环（模拟数据面 punt 行为）；环满返回 HAL_ERR_FULL */
+int sim_punt_rx_inject(const punt_pkt_t *pkt);
 
-/** 查找 TCAM 条目（跳过已删除项），找不到返回 NULL */
-sim_tcam_rec_t *sim_tcam_find(uint8_t stage, uint16_t table_id);
+/** 批量注入，返回实际写入个数（环满时少于 n） */
+int sim_punt_rx_inject_burst(const punt_pkt_t *pkts, int n);
 
-/** 统计某 stage 的有效（未删除）TCAM 条目数 */
-int sim_tcam_count_stage(uint8_t stage);
+/** 批量取出固件发送的包，返回个数（0 = 空） */
+int sim_punt_tx_pop_burst(punt_pkt_t *pkts, int n);
 
 // ─────────────────────────────────────────────
 // 内联辅助（供 test_*.c 使用）
 // ─────────────────────────────────────────────
 
 static inline int sim_punt_tx_pending(void) {
-    return sim_punt_tx_head - sim_punt_tx_tail;
+    return (int)spsc_ring_count(&sim_punt_tx);
 }
 
+/* 返回的记录在下一次调用前有效（单线程测试用） */
 static inline sim_punt_rec_t *sim_punt_tx_pop(void) {
-    if (sim_punt_tx_tail >= sim_punt_tx_head) return NULL;
-    int slot = sim_punt_tx_tail % SIM_PUNT_MAX;
-    sim_punt_tx_tail++;
-    return &sim_punt_tx_ring[slot];
+    static sim_punt_rec_t rec;
+    if (spsc_ring_dequeue(&sim_punt_tx, &rec.pkt) != 0) return NULL;
+    rec.valid = 1;
+    return &rec;
 }
 
 #endif /* SIM_HAL_H */
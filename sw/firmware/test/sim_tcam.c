@@ -0,0 +1,605 @@
+// sim_tcam.c
+// 模拟 TCAM 存储实现（见 sim_tcam.h）
+
+#include "sim_tcam.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define PAGE_SHIFT  9
+#define PAGE_RECS   (1 << PAGE_SHIFT)       // 每页 512 条记录
+
+// 掩码组：同一 (key_len, mask[0:key_len]) 的条目
+typedef struct {
+    uint8_t   key_len;
+    uint8_t   mask[64];
+    int       n;            // 成员数（0 = 空组，保留以复用）
+    uint32_t  min_prio;     // 成员中最小 table_id（最高优先级）
+    uint8_t   min_dirty;    // 1 = min_prio 需重算
+    int32_t   head;         // 成员链表头
+    int32_t  *bkt;          // 哈希桶（槽号，-1 空）
+    int       n_bkt;        // 桶数（2 的幂）
+} tcam_group_t;
+
+typedef struct {
+    sim_tcam_rec_t **pages;
+    int              n_pages;
+    int              hw;            // 已使用过的最高槽号 + 1
+    int32_t         *free_slots;
+    int              n_free;
+    int              n_live;
+    uint32_t        *by_tid;        // table_id → 槽号 + 1（0 = 不存在）
+    tcam_group_t    *groups;
+    int              n_groups;
+    int              cap_groups;
+    int             *order;         // 按 min_prio 升序的组下标
+    uint8_t          order_dirty;
+    uint32_t         version;       // 每次写操作递增（快照据此判断是否需重新复制）
+    sim_tcam_rec_t  *flat;          // 快照副本：全部页位于同一块连续内存
+    int              refs;          // 快照副本：被多少个快照共享
+} tcam_stage_t;
+
+static tcam_stage_t tcam_st[SIM_TCAM_STAGES];
+static uint64_t     tcam_gen;       // 数据库代数（reset 不清零）
+
+// 只读快照（RCU 风格发布，见 sim_tcam_publish）
+struct sim_tcam_snap {
+    tcam_stage_t         *stage[SIM_TCAM_STAGES];  // NULL = 该 stage 无条目
+    uint64_t              retire;   // 被替换时的全局 epoch
+    struct sim_tcam_snap *next;     // 待回收链表
+};
+
+// 读者 epoch 槽，按 cache line 隔开避免伪共享（0 = 静止态）
+typedef struct {
+    uint64_t epoch;
+    uint32_t used;
+    uint8_t  pad[52];
+} snap_reader_t;
+
+static sim_tcam_snap_t *snap_cur;
+static sim_tcam_snap_t *snap_retired;
+static uint64_t         snap_epoch = 1;
+static snap_reader_t    snap_readers[SIM_TCAM_READERS_MAX];
+static int              snap_n_readers;
+
+// ─────────────────────────────────────────────
+// 内部工具
+// ─────────────────────────────────────────────
+
+static inline sim_tcam_rec_t *slot_rec(tcam_stage_t *st, int32_t s) {
+    return &st->pages[s >> PAGE_SHIFT][s & (PAGE_RECS - 1)];
+}
+
+static uint32_t key_hash(const uint8_t *key, const uint8_t *mask, int len) {
+    uint32_t h = 2166136261U;                       // FNV-1a
+    for (int b = 0; b < len; b++) {
+        h ^= (uint8_t)(key[b] & mask[b]);
+        h *= 16777619U;
+    }
+    return h;
+}
+
+// 三值比较核：前 len 字节满足 ((key ^ ent) & mask) == 0 则命中。
+// 三个缓冲区均按 64 字节整通道读取，超出 len 的字节由 movemask 屏蔽。
+// 编译时按目标指令集选择 AVX2（32B）/ SSE2（16B）/ 标量实现。
+static inline int ternary_eq(const uint8_t *key, const uint8_t *ent,
+                             const uint8_t *mask, int len)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for (int o = 0; o < len; o += 32) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(key + o)),
+                                     _mm256_loadu_si256((const __m256i *)(ent + o)));
+        x = _mm256_and_si256(x, _mm256_loadu_si256((const __m256i *)(mask + o)));
+        uint32_t ne = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, zero));
+        if (len - o < 32) ne &= (1u << (len - o)) - 1u;
+        if (ne) return 0;
+    }
+    return 1;
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (int o = 0; o < len; o += 16) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(key + o)),
+                                  _mm_loadu_si128((const __m128i *)(ent + o)));
+        x = _mm_and_si128(x, _mm_loadu_si128((const __m128i *)(mask + o)));
+        uint32_t ne = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)) & 0xFFFFu;
+        if (len - o < 16) ne &= (1u << (len - o)) - 1u;
+        if (ne) return 0;
+    }
+    return 1;
+#else
+    for (int b = 0; b < len; b++)
+        if ((key[b] ^ ent[b]) & mask[b]) return 0;
+    return 1;
+#endif
+}
+
+// 空闲链表须始终能容纳全部已分配页的槽（rec_free 不检查容量），
+// 所以先扩空闲链表，再分配页；页分配中途失败时只计入已分配成功的页。
+static int32_t slot_alloc(tcam_stage_t *st) {
+    if (st->n_free > 0) return st->free_slots[--st->n_free];
+    if (st->hw == st->n_pages * PAGE_RECS) {
+        int np = st->n_pages ? st->n_pages * 2 : SIM_TCAM_MAX / PAGE_RECS;
+        if (np < 1) np = 1;
+        int32_t *f = (int32_t *)realloc(st->free_slots, (size_t)np * PAGE_RECS * sizeof(*f));
+        if (!f) return -1;
+        st->free_slots = f;
+        sim_tcam_rec_t **p = (sim_tcam_rec_t **)realloc(st->pages, (size_t)np * sizeof(*p));
+        if (!p) return -1;
+        st->pages = p;
+        for (int i = st->n_pages; i < np; i++) {
+            st->pages[i] = (sim_tcam_rec_t *)calloc(PAGE_RECS, sizeof(sim_tcam_rec_t));
+            if (!st->pages[i]) break;
+            st->n_pages = i + 1;
+        }
+        if (st->hw == st->n_pages * PAGE_RECS) return -1;
+    }
+    return st->hw++;
+}
+
+static int group_get(tcam_stage_t *st, const tcam_entry_t *e) {
+    uint8_t len = e->key.key_len > 64 ? 64 : e->key.key_len;
+    for (int g = 0; g < st->n_groups; g++) {
+        tcam_group_t *gr = &st->groups[g];
+        if (gr->key_len == len && memcmp(gr->mask, e->mask.bytes, len) == 0)
+            return g;
+    }
+    if (st->n_groups == st->cap_groups) {
+        int nc = st->cap_groups ? st->cap_groups * 2 : 8;
+        tcam_group_t *ng = (tcam_group_t *)realloc(st->groups, (size_t)nc * sizeof(*ng));
+        int *no = (int *)realloc(st->order, (size_t)nc * sizeof(*no));
+        if (ng) st->groups = ng;
+        if (no) st->order  = no;
+        if (!ng || !no) return -1;
+        st->cap_groups = nc;
+    }
+    tcam_group_t *gr = &st->groups[st->n_groups];
+    memset(gr, 0, sizeof(*gr));
+    gr->key_len = len;
+    memcpy(gr->mask, e->mask.bytes, len);
+    gr->min_prio = UINT32_MAX;
+    gr->head     = -1;
+    st->order[st->n_groups] = st->n_groups;
+    return st->n_groups++;
+}
+
+static int group_rehash(tcam_stage_t *st, tcam_group_t *gr, int n_bkt) {
+    int32_t *b = (int32_t *)malloc((size_t)n_bkt * sizeof(*b));
+    if (!b) return -1;
+    for (int i = 0; i < n_bkt; i++) b[i] = -1;
+    for (int32_t s = gr->head; s >= 0; s = slot_rec(st, s)->gnext) {
+        sim_tcam_rec_t *r = slot_rec(st, s);
+        int i = (int)(r->hash & (uint32_t)(n_bkt - 1));
+        r->hnext = b[i];
+        b[i]     = s;
+    }
+    free(gr->bkt);
+    gr->bkt   = b;
+    gr->n_bkt = n_bkt;
+    return 0;
+}
+
+static int rec_link(tcam_stage_t *st, int32_t s) {
+    sim_tcam_rec_t *r = slot_rec(st, s);
+    int g = group_get(st, &r->entry);
+    if (g < 0) return -1;
+    tcam_group_t *gr = &st->groups[g];
+    if (gr->n + 1 > gr->n_bkt &&
+        group_rehash(st, gr, gr->n_bkt ? gr->n_bkt * 2 : 16) != 0)
+        return -1;
+
+    r->group = g;
+    r->hash  = key_hash(r->entry.key.bytes, gr->mask, gr->key_len);
+    int i = (int)(r->hash & (uint32_t)(gr->n_bkt - 1));
+    r->hnext = gr->bkt[i];
+    gr->bkt[i] = s;
+    r->gprev = -1;
+    r->gnext = gr->head;
+    if (gr->head >= 0) slot_rec(st, gr->head)->gprev = s;
+    gr->head = s;
+    gr->n++;
+    if (r->prio < gr->min_prio) {
+        gr->min_prio    = r->prio;
+        st->order_dirty = 1;
+    }
+    return 0;
+}
+
+static void rec_unlink(tcam_stage_t *st, int32_t s) {
+    sim_tcam_rec_t *r  = slot_rec(st, s);
+    tcam_group_t   *gr = &st->groups[r->group];
+    int32_t *pp = &gr->bkt[r->hash & (uint32_t)(gr->n_bkt - 1)];
+    while (*pp != s) pp = &slot_rec(st, *pp)->hnext;
+    *pp = r->hnext;
+    if (r->gprev >= 0) slot_rec(st, r->gprev)->gnext = r->gnext;
+    else               gr->head = r->gnext;
+    if (r->gnext >= 0) slot_rec(st, r->gnext)->gprev = r->gprev;
+    gr->n--;
+    if (r->prio == gr->min_prio) {
+        gr->min_dirty   = 1;
+        st->order_dirty = 1;
+    }
+}
+
+static tcam_stage_t *stage_get(uint8_t stage) {
+    if (stage >= SIM_TCAM_STAGES) return NULL;
+    tcam_stage_t *st = &tcam_st[stage];
+    if (!st->by_tid) st->by_tid = (uint32_t *)calloc(SIM_TCAM_STAGE_MAX, sizeof(uint32_t));
+    return st->by_tid ? st : NULL;
+}
+
+static tcam_stage_t *stage_peek(uint8_t stage) {
+    if (stage >= SIM_TCAM_STAGES || !tcam_st[stage].by_tid) return NULL;
+    return &tcam_st[stage];
+}
+
+static tcam_stage_t *order_st;
+static int order_cmp(const void *a, const void *b) {
+    uint32_t x = order_st->groups[*(const int *)a].min_prio;
+    uint32_t y = order_st->groups[*(const int *)b].min_prio;
+    return (x > y) - (x < y);
+}
+
+// 重算脏组的 min_prio，并按 min_prio 对组排序（查找时提前结束用）。
+// 只有删除组内最高优先级条目才会置脏，重算限于该组成员。
+static void order_refresh(tcam_stage_t *st) {
+    for (int g = 0; g < st->n_groups; g++) {
+        tcam_group_t *gr = &st->groups[g];
+        if (!gr->min_dirty) continue;
+        gr->min_prio = UINT32_MAX;
+        for (int32_t s = gr->head; s >= 0; s = slot_rec(st, s)->gnext)
+            if (slot_rec(st, s)->prio < gr->min_prio) gr->min_prio = slot_rec(st, s)->prio;
+        gr->min_dirty = 0;
+    }
+    order_st = st;
+    qsort(st->order, (size_t)st->n_groups, sizeof(int), order_cmp);
+    st->order_dirty = 0;
+}
+
+static void stage_release(tcam_stage_t *st) {
+    if (st->flat) free(st->flat);
+    else for (int p = 0; p < st->n_pages; p++) free(st->pages[p]);
+    for (int g = 0; g < st->n_groups; g++) free(st->groups[g].bkt);
+    free(st->pages);
+    free(st->free_slots);
+    free(st->by_tid);
+    free(st->groups);
+    free(st->order);
+}
+
+// ─────────────────────────────────────────────
+// 快照：复制 / 释放 / 回收
+// ─────────────────────────────────────────────
+
+// 复制一个 stage 的查找所需部分（记录、掩码组、哈希桶、组顺序）；
+// 不复制 table_id 索引与空闲链表 —— 快照只读，仅用于查找。
+static tcam_stage_t *stage_clone(tcam_stage_t *src) {
+    if (src->order_dirty) order_refresh(src);
+
+    tcam_stage_t *dst = (tcam_stage_t *)calloc(1, sizeof(*dst));
+    if (!dst) return NULL;
+    int np = (src->hw + PAGE_RECS - 1) / PAGE_RECS;
+    dst->hw      = src->hw;
+    dst->n_live  = src->n_live;
+    dst->version = src->version;
+    dst->refs    = 1;
+    dst->flat    = (sim_tcam_rec_t *)malloc((size_t)(np ? np : 1) * PAGE_RECS * sizeof(sim_tcam_rec_t));
+    dst->pages   = (sim_tcam_rec_t **)malloc((size_t)(np ? np : 1) * sizeof(sim_tcam_rec_t *));
+    dst->groups  = (tcam_group_t *)malloc((size_t)(src->n_groups ? src->n_groups : 1) * sizeof(tcam_group_t));
+    dst->order   = (int *)malloc((size_t)(src->n_groups ? src->n_groups : 1) * sizeof(int));
+    if (!dst->flat || !dst->pages || !dst->groups || !dst->order) {
+        stage_release(dst);
+        free(dst);
+        return NULL;
+    }
+    dst->n_pages = np;
+    for (int p = 0; p < np; p++) {
+        dst->pages[p] = dst->flat + (size_t)p * PAGE_RECS;
+        memcpy(dst->pages[p], src->pages[p], PAGE_RECS * sizeof(sim_tcam_rec_t));
+    }
+    for (int g = 0; g < src->n_groups; g++) {
+        tcam_group_t *gd = &dst->groups[g];
+        *gd = src->groups[g];
+        gd->bkt = NULL;
+        if (gd->n_bkt) {
+            gd->bkt = (int32_t *)malloc((size_t)gd->n_bkt * sizeof(int32_t));
+            if (!gd->bkt) {
+                dst->n_groups = g;
+                stage_release(dst);
+                free(dst);
+                return NULL;
+            }
+            memcpy(gd->bkt, src->groups[g].bkt, (size_t)gd->n_bkt * sizeof(int32_t));
+        }
+    }
+    dst->n_groups = src->n_groups;
+    memcpy(dst->order, src->order, (size_t)src->n_groups * sizeof(int));
+    return dst;
+}
+
+static void snap_free(sim_tcam_snap_t *sn) {
+    for (int i = 0; i < SIM_TCAM_STAGES; i++) {
+        tcam_stage_t *st = sn->stage[i];
+        if (st && --st->refs == 0) {
+            stage_release(st);
+            free(st);
+        }
+    }
+    free(sn);
+}
+
+// 释放所有读者都已越过的旧快照：
+// 读者 epoch >= retire 说明它在指针替换之后才进入，不可能持有旧快照。
+static void snap_reclaim(void) {
+    uint64_t min_active = UINT64_MAX;
+    int nr = __atomic_load_n(&snap_n_readers, __ATOMIC_ACQUIRE);
+    for (int r = 0; r < nr; r++) {
+        uint64_t e = __atomic_load_n(&snap_readers[r].epoch, __ATOMIC_SEQ_CST);
+        if (e && e < min_active) min_active = e;
+    }
+    sim_tcam_snap_t **pp = &snap_retired;
+    while (*pp) {
+        sim_tcam_snap_t *sn = *pp;
+        if (sn->retire <= min_active) {
+            *pp = sn->next;
+            snap_free(sn);
+        } else {
+            pp = &sn->next;
+        }
+    }
+}
+
+// ─────────────────────────────────────────────
+// 公共 API
+// ─────────────────────────────────────────────
+
+void sim_tcam_reset(void) {
+    for (int i = 0; i < SIM_TCAM_STAGES; i++) stage_release(&tcam_st[i]);
+    memset(tcam_st, 0, sizeof(tcam_st));
+    tcam_gen++;
+
+    // 调用者保证此时没有读者在快照临界区内
+    if (snap_cur) snap_free(snap_cur);
+    while (snap_retired) {
+        sim_tcam_snap_t *sn = snap_retired;
+        snap_retired = sn->next;
+        snap_free(sn);
+    }
+    __atomic_store_n(&snap_cur, (sim_tcam_snap_t *)NULL, __ATOMIC_SEQ_CST);
+}
+
+sim_tcam_rec_t *sim_tcam_find(uint8_t stage, uint16_t table_id) {
+    tcam_stage_t *st = stage_peek(stage);
+    if (!st || !st->by_tid[table_id]) return NULL;
+    return slot_rec(st, (int32_t)st->by_tid[table_id] - 1);
+}
+
+int sim_tcam_count_stage(uint8_t stage) {
+    tcam_stage_t *st = stage_peek(stage);
+    return st ? st->n_live : 0;
+}
+
+// 在单个掩码组内探测 key，返回比 best 更优的命中（否则返回 best）
+static const sim_tcam_rec_t *group_probe(tcam_stage_t *st, const tcam_group_t *gr,
+                                         const uint8_t *key, uint8_t key_len,
+                                         const sim_tcam_rec_t *best)
+{
+    if (gr->key_len > key_len) {
+        // 条目比查找键长：只比较前 key_len 字节，无法用组哈希，逐个比较
+        for (int32_t s = gr->head; s >= 0; s = slot_rec(st, s)->gnext) {
+            const sim_tcam_rec_t *r = slot_rec(st, s);
+            if (best && r->prio >= best->prio) continue;
+            if (ternary_eq(key, r->entry.key.bytes, gr->mask, key_len)) best = r;
+        }
+        return best;
+    }
+
+    uint32_t h = key_hash(key, gr->mask, gr->key_len);
+    for (int32_t s = gr->bkt[h & (uint32_t)(gr->n_bkt - 1)]; s >= 0;
+         s = slot_rec(st, s)->hnext) {
+        const sim_tcam_rec_t *r = slot_rec(st, s);
+        if (r->hash != h || (best && r->prio >= best->prio)) continue;
+        if (ternary_eq(key, r->entry.key.bytes, gr->mask, gr->key_len)) best = r;
+    }
+    return best;
+}
+
+// 组顺序须已是最新（live stage 由调用者刷新，快照副本在复制时已刷新）
+static void stage_lookup_burst(tcam_stage_t *st, const uint8_t *keys,
+                               const uint8_t *key_lens, int n,
+                               const sim_tcam_rec_t **hits)
+{
+    for (int i = 0; i < n; i++) hits[i] = NULL;
+    for (int k = 0; k < st->n_groups; k++) {
+        const tcam_group_t *gr = &st->groups[st->order[k]];
+        if (gr->n == 0) continue;
+        int pending = 0;
+        for (int i = 0; i < n; i++) {
+            if (hits[i] && gr->min_prio >= hits[i]->prio) continue;  // 本组及后续组不可能更优
+            pending = 1;
+            hits[i] = group_probe(st, gr, keys + (size_t)i * SIM_TCAM_KEY_STRIDE,
+                                  key_lens[i], hits[i]);
+        }
+        if (!pending) break;
+    }
+}
+
+void sim_tcam_lookup_burst(uint8_t stage, const uint8_t *keys, const uint8_t *key_lens,
+                           int n, const sim_tcam_rec_t **hits)
+{
+    for (int i = 0; i < n; i++) hits[i] = NULL;
+    tcam_stage_t *st = stage_peek(stage);
+    if (!st || st->n_live == 0) return;
+    if (st->order_dirty) order_refresh(st);
+    stage_lookup_burst(st, keys, key_lens, n, hits);
+}
+
+const sim_tcam_rec_t *sim_tcam_lookup(uint8_t stage, const uint8_t *key, uint8_t key_len)
+{
+    const sim_tcam_rec_t *hit;
+    sim_tcam_lookup_burst(stage, key, &key_len, 1, &hit);
+    return hit;
+}
+
+int sim_tcam_insert(const tcam_entry_t *entry) {
+    if (!entry) return HAL_ERR_INVAL;
+    tcam_stage_t *st = stage_get(entry->stage);
+    if (!st) return HAL_ERR_INVAL;
+
+    st->version++;
+    tcam_gen++;
+
+    // 已存在则原位更新（table_id 不变，优先级不变）。
+    // 新掩码组分配失败时恢复原条目并挂回原组：原组保留且桶容量足够，不会失败；
+    // 否则记录 valid 却不在任何链上，之后的 rec_unlink 会在桶链上死循环。
+    uint32_t ix = st->by_tid[entry->table_id];
+    if (ix) {
+        int32_t s = (int32_t)ix - 1;
+        sim_tcam_rec_t *r = slot_rec(st, s);
+        tcam_entry_t old = r->entry;
+        rec_unlink(st, s);
+        r->entry = *entry;
+        if (rec_link(st, s) == 0) return HAL_OK;
+        r->entry = old;
+        rec_link(st, s);
+        return HAL_ERR_FULL;
+    }
+    // 新条目
+    int32_t s = slot_alloc(st);
+    if (s < 0) return HAL_ERR_FULL;
+    sim_tcam_rec_t *r = slot_rec(st, s);
+    memset(r, 0, sizeof(*r));
+    r->entry = *entry;
+    r->valid = 1;
+    r->prio  = entry->table_id;
+    if (rec_link(st, s) != 0) {
+        r->valid = 0;
+        st->free_slots[st->n_free++] = s;
+        return HAL_ERR_FULL;
+    }
+    st->by_tid[entry->table_id] = (uint32_t)s + 1;
+    st->n_live++;
+    return HAL_OK;
+}
+
+static void rec_free(tcam_stage_t *st, int32_t s) {
+    sim_tcam_rec_t *r = slot_rec(st, s);
+    rec_unlink(st, s);
+    st->by_tid[r->entry.table_id] = 0;
+    r->valid   = 0;
+    r->deleted = 1;
+    st->free_slots[st->n_free++] = s;
+    st->n_live--;
+}
+
+int sim_tcam_delete(uint8_t stage, uint16_t table_id) {
+    tcam_stage_t *st = stage_peek(stage);
+    if (!st || !st->by_tid[table_id]) return HAL_ERR_INVAL;
+    st->version++;
+    tcam_gen++;
+    rec_free(st, (int32_t)st->by_tid[table_id] - 1);
+    return HAL_OK;
+}
+
+int sim_tcam_modify(const tcam_entry_t *entry) {
+    if (!entry) return HAL_ERR_INVAL;
+    if (!sim_tcam_find(entry->stage, entry->table_id)) return HAL_ERR_INVAL;
+    return sim_tcam_insert(entry);
+}
+
+int sim_tcam_flush(uint8_t stage) {
+    tcam_stage_t *st = stage_peek(stage);
+    if (!st) return HAL_OK;
+    st->version++;
+    tcam_gen++;
+    for (int32_t s = 0; s < st->hw; s++)
+        if (slot_rec(st, s)->valid) rec_free(st, s);
+    return HAL_OK;
+}
+
+uint64_t sim_tcam_generation(void) {
+    return tcam_gen;
+}
+
+// ─────────────────────────────────────────────
+// 快照发布 / 读者
+// ─────────────────────────────────────────────
+
+int sim_tcam_publish(void) {
+    sim_tcam_snap_t *old = snap_cur;
+    sim_tcam_snap_t *sn  = (sim_tcam_snap_t *)calloc(1, sizeof(*sn));
+    if (!sn) return HAL_ERR_FULL;
+
+    for (int i = 0; i < SIM_TCAM_STAGES; i++) {
+        tcam_stage_t *st = &tcam_st[i];
+        if (!st->by_tid || st->n_live == 0) continue;
+        tcam_stage_t *prev = old ? old->stage[i] : NULL;
+        if (prev && prev->version == st->version) {
+            prev->refs++;                   // 未修改：与上一版本共享
+            sn->stage[i] = prev;
+            continue;
+        }
+        sn->stage[i] = stage_clone(st);
+        if (!sn->stage[i]) {
+            snap_free(sn);
+            return HAL_ERR_FULL;
+        }
+    }
+
+    // 先替换指针再推进 epoch：此后进入的读者必然看到新快照
+    __atomic_store_n(&snap_cur, sn, __ATOMIC_SEQ_CST);
+    uint64_t e = __atomic_add_fetch(&snap_epoch, 1, __ATOMIC_SEQ_CST);
+    if (old) {
+        old->retire  = e;
+        old->next    = snap_retired;
+        snap_retired = old;
+    }
+    snap_reclaim();
+    return HAL_OK;
+}
+
+int sim_tcam_reader_register(void) {
+    for (int r = 0; r < SIM_TCAM_READERS_MAX; r++) {
+        uint32_t expect = 0;
+        if (!__atomic_compare_exchange_n(&snap_readers[r].used, &expect, 1u, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            continue;
+        // snap_n_readers 为高水位：snap_reclaim 只扫描 [0, snap_n_readers)
+        int n = __atomic_load_n(&snap_n_readers, __ATOMIC_ACQUIRE);
+        while (n < r + 1 &&
+               !__atomic_compare_exchange_n(&snap_n_readers, &n, r + 1, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            ;
+        return r;
+    }
+    return -1;
+}
+
+void sim_tcam_reader_unregister(int reader) {
+    if (reader < 0 || reader >= SIM_TCAM_READERS_MAX) return;
+    __atomic_store_n(&snap_readers[reader].epoch, (uint64_t)0, __ATOMIC_RELEASE);
+    __atomic_store_n(&snap_readers[reader].used, 0u, __ATOMIC_RELEASE);
+}
+
+const sim_tcam_snap_t *sim_tcam_read_begin(int reader) {
+    uint64_t e = __atomic_load_n(&snap_epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&snap_readers[reader].epoch, e, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&snap_cur, __ATOMIC_SEQ_CST);
+}
+
+void sim_tcam_read_end(int reader) {
+    __atomic_store_n(&snap_readers[reader].epoch, (uint64_t)0, __ATOMIC_RELEASE);
+}
+
+void sim_tcam_snap_lookup_burst(const sim_tcam_snap_t *snap, uint8_t stage,
+                                const uint8_t *keys, const uint8_t *key_lens,
+                                int n, const sim_tcam_rec_t **hits)
+{
+    if (!snap || stage >= SIM_TCAM_STAGES || !snap->stage[stage]) {
+        for (int i = 0; i < n; i++) hits[i] = NULL;
+        return;
+    }
+    stage_lookup_burst(snap->stage[stage], keys, key_lens, n, hits);
+}
@@ -0,0 +1,124 @@
+// sim_tcam.h
+// 模拟 TCAM 存储 — sim_hal.c 与 pkt_model.c 共享的条目数据库
+//
+// 从 sim_hal.c 拆出，使 pkt_model.c 不依赖 sim_hal 的其余 HAL 实现，
+// 可单独链接进 RTL 联合仿真（tb/cosim），由 cosim HAL 镜像写入。
+//
+// 组织方式（每个 stage 独立）：
+//   - 记录存放在按页分配的槽数组中，容量按需增长，删除的槽进入空闲链表复用；
+//     记录地址在生命周期内不变（sim_tcam_find 返回的指针可长期持有）
+//   - table_id → 槽 的直接索引（table_id 为 16 位）
+//   - 查找按掩码分组（tuple space）：同一 (key_len, mask) 的条目组成一组，
+//     组内以 key & mask 做哈希，每组一次探测；
+//     优先级与 mau_tcam.sv 一致：多条命中时 table_id 最小者优先（与插入顺序无关）；
+//     各组记录成员最小 table_id，组按其升序探测，已命中更优条目后提前结束
+//   - 多线程读：控制面（单写者）修改后调用 sim_tcam_publish() 发布只读快照，
+//     数据面工作线程在 read_begin/read_end 之间查快照，无锁；
+//     旧快照在所有读者越过其 epoch 后回收，未修改的 stage 在版本间共享
+
+#ifndef SIM_TCAM_H
+#define SIM_TCAM_H
+
+#include "rv_p4_hal.h"
+#include <stdint.h>
+
+// ─────────────────────────────────────────────
+// 容量
+// ─────────────────────────────────────────────
+#define SIM_TCAM_MAX        512     // 每 stage 初始槽数（按需倍增）
+#define SIM_TCAM_STAGES     24      // MAU 级数（与 rv_p4_pkg.sv 一致）
+#define SIM_TCAM_STAGE_MAX  65536   // 每 stage 条目上限（table_id 空间）
+#define SIM_TCAM_KEY_STRIDE 64      // 查找键缓冲区长度（SIMD 比较按整通道读取）
+#define SIM_TCAM_READERS_MAX 64     // 快照读者（工作线程）上限
+
+// ─────────────────────────────────────────────
+// TCAM 记录
+// ─────────────────────────────────────────────
+typedef struct {
+    tcam_entry_t entry;
+    uint8_t      valid;     // 1 = 槽已占用
+    uint8_t      deleted;   // 1 = 已删除（槽待复用）
+
+    // 以下为 sim_tcam.c 内部索引字段
+    uint32_t     prio;      // 优先级 = table_id，越小越优先
+    uint32_t     hash;      // key & mask 的哈希
+    int32_t      group;     // 所属掩码组
+    int32_t      hnext;     // 同哈希桶下一槽（-1 结束）
+    int32_t      gprev;     // 组成员双向链表
+    int32_t      gnext;
+} sim_tcam_rec_t;
+
+typedef struct sim_tcam_snap sim_tcam_snap_t;
+
+/** 清空 TCAM 数据库（释放全部内存，含快照；调用时不得有读者在临界区内） */
+void sim_tcam_reset(void);
+
+/** 按 table_id 查找 TCAM 条目，找不到返回 NULL */
+sim_tcam_rec_t *sim_tcam_find(uint8_t stage, uint16_t table_id);
+
+/** 统计某 stage 的有效 TCAM 条目数 */
+int sim_tcam_count_stage(uint8_t stage);
+
+/**
+ * sim_tcam_lookup - 三值匹配查找（数据面模型使用）
+ * 对每字节 b < min(entry.key_len, key_len)：
+ *   (key[b] & mask[b]) == (entry.key[b] & mask[b])
+ * 返回优先级最高的命中条目；无命中返回 NULL。
+ * key 缓冲区须可读 SIM_TCAM_KEY_STRIDE 字节（超出 key_len 的内容不参与比较）。
+ */
+const sim_tcam_rec_t *sim_tcam_lookup(uint8_t stage, const uint8_t *key, uint8_t key_len);
+
+/**
+ * sim_tcam_lookup_burst - 批量三值查找
+ * @keys:     n 个查找键，第 i 个位于 keys + i * SIM_TCAM_KEY_STRIDE
+ * @key_lens: 各键长度
+ * @hits:     输出，各键命中的条目（无命中为 NULL）
+ * 按掩码组为外层循环，同一组的哈希表对整批报文连续探测。
+ */
+void sim_tcam_lookup_burst(uint8_t stage, const uint8_t *keys, const uint8_t *key_lens,
+                           int n, const sim_tcam_rec_t **hits);
+
+/** 条目操作（语义与 hal_tcam_* 相同，返回 HAL_OK / HAL_ERR_*） */
+int sim_tcam_insert(const tcam_entry_t *entry);
+int sim_tcam_delete(uint8_t stage, uint16_t table_id);
+int sim_tcam_modify(const tcam_entry_t *entry);
+int sim_tcam_flush(uint8_t stage);
+
+/**
+ * sim_tcam_generation - 数据库代数
+ * 每次 insert / delete / modify / flush / reset 递增（从不回绕到旧值），
+ * 供流缓存等派生状态判断是否失效。
+ */
+uint64_t sim_tcam_generation(void);
+
+// ─────────────────────────────────────────────
+// 只读快照（多线程数据面模型）
+// ─────────────────────────────────────────────
+
+/**
+ * sim_tcam_publish - 以当前数据库内容发布新快照（仅写者线程调用）
+ * 只复制自上次发布以来被修改过的 stage；随后回收已无读者引用的旧快照。
+ * 返回 HAL_OK / HAL_ERR_FULL（内存不足，原快照保持不变）
+ */
+int sim_tcam_publish(void);
+
+/** 注册一个读者槽（每个工作线程一次），返回槽号；超出上限返回 -1 */
+int sim_tcam_reader_register(void);
+
+/** 释放读者槽（线程退出前调用，须处于临界区之外） */
+void sim_tcam_reader_unregister(int reader);
+
+/**
+ * sim_tcam_read_begin / sim_tcam_read_end - 快照读临界区
+ * begin 返回当前快照（从未发布时为 NULL），在 end 之前保持有效；
+ * 通过快照查到的记录指针同样只在临界区内有效。
+ */
+const sim_tcam_snap_t *sim_tcam_read_begin(int reader);
+void sim_tcam_read_end(int reader);
+
+/** 在快照上执行批量查找（语义同 sim_tcam_lookup_burst；snap 为 NULL 时全部未命中） */
+void sim_tcam_snap_lookup_burst(const sim_tcam_snap_t *snap, uint8_t stage,
+                                const uint8_t *keys, const uint8_t *key_lens,
+                                int n, const sim_tcam_rec_t **hits);
+
+#endif /* SIM_TCAM_H */
@@ -0,0 +1,134 @@
+// spsc_ring.h
+// 无锁单生产者 / 单消费者环（host 仿真用，头文件实现）
+//
+//   - 生产者只写 head，消费者只写 tail，两个索引各占一条 64B 缓存行，
+//     互不造成伪共享；
+//   - 每端缓存对方索引的最近值，只有按缓存值看起来满 / 空时才重新读取
+//     （acquire），批量操作每批只做一次 release 发布；
+//   - 槽数为 2 的幂，索引为自由递增的 uint32_t，head - tail 即元素个数；
+//   - 元素按值拷贝（elem_size 字节），存储区由调用者提供。
+//
+// 一个环同一时刻只能有一个生产者线程和一个消费者线程（可以是同一线程）。
+// 使用 GCC __atomic 内建函数，C / C++ 均可包含。
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define SPSC_CACHELINE  64
+
+typedef struct {
+    // 生产者侧
+    uint32_t head       __attribute__((aligned(SPSC_CACHELINE)));
+    uint32_t tail_cache;
+    // 消费者侧
+    uint32_t tail       __attribute__((aligned(SPSC_CACHELINE)));
+    uint32_t head_cache;
+    // 初始化后只读
+    uint8_t *buf        __attribute__((aligned(SPSC_CACHELINE)));
+    uint32_t mask;
+    uint32_t elem_size;
+} spsc_ring_t;
+
+/**
+ * spsc_ring_init - 初始化环（不可与生产者 / 消费者并发调用）
+ * @storage: slots * elem_size 字节
+ * @slots:   2 的幂
+ * 返回 0；参数非法返回 -1。
+ */
+static inline int spsc_ring_init(spsc_ring_t *r, void *storage,
+                                 uint32_t slots, uint32_t elem_size)
+{
+    if (!r || !storage || !slots || (slots & (slots - 1)) || !elem_size) return -1;
+    r->head = r->tail_cache = 0;
+    r->tail = r->head_cache = 0;
+    r->buf       = (uint8_t *)storage;
+    r->mask      = slots - 1;
+    r->elem_size = elem_size;
+    return 0;
+}
+
+static inline uint32_t spsc_ring_capacity(const spsc_ring_t *r)
+{
+    return r->mask + 1;
+}
+
+/** 当前元素个数（任意线程可调用，并发时为近似值） */
+static inline uint32_t spsc_ring_count(const spsc_ring_t *r)
+{
+    uint32_t t = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    uint32_t h = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    return h - t;
+}
+
+/**
+ * spsc_ring_enqueue_burst - 生产者写入最多 n 个元素
+ * 返回实际写入个数（环满时可能少于 n，0 = 满）。
+ */
+static inline uint32_t spsc_ring_enqueue_burst(spsc_ring_t *r, const void *objs, uint32_t n)
+{
+    const uint32_t cap  = r->mask + 1;
+    const uint32_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+    uint32_t room = cap - (head - r->tail_cache);
+    if (room < n) {
+        r->tail_cache = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        room = cap - (head - r->tail_cache);
+    }
+    if (n > room) n = room;
+    if (!n) return 0;
+
+    const uint32_t es    = r->elem_size;
+    const uint32_t idx   = head & r->mask;
+    const uint32_t first = n < cap - idx ? n : cap - idx;
+    memcpy(r->buf + (size_t)idx * es, objs, (size_t)first * es);
+    if (n > first)
+        memcpy(r->buf, (const uint8_t *)objs + (size_t)first * es, (size_t)(n - first) * es);
+
+    __atomic_store_n(&r->head, head + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/**
+ * spsc_ring_dequeue_burst - 消费者取出最多 n 个元素
+ * 返回实际取出个数（0 = 空）。
+ */
+static inline uint32_t spsc_ring_dequeue_burst(spsc_ring_t *r, void *objs, uint32_t n)
+{
+    const uint32_t cap  = r->mask + 1;
+    const uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+
+    uint32_t avail = r->head_cache - tail;
+    if (avail < n) {
+        r->head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        avail = r->head_cache - tail;
+    }
+    if (n > avail) n = avail;
+    if (!n) return 0;
+
+    const uint32_t es    = r->elem_size;
+    const uint32_t idx   = tail & r->mask;
+    const uint32_t first = n < cap - idx ? n : cap - idx;
+    memcpy(objs, r->buf + (size_t)idx * es, (size_t)first * es);
+    if (n > first)
+        memcpy((uint8_t *)objs + (size_t)first * es, r->buf, (size_t)(n - first) * es);
+
+    __atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/** 单元素写入：成功返回 0，满返回 -1 */
+static inline int spsc_ring_enqueue(spsc_ring_t *r, const void *obj)
+{
+    return spsc_ring_enqueue_burst(r, obj, 1) ? 0 : -1;
+}
+
+/** 单元素取出：成功返回 0，空返回 -1 */
+static inline int spsc_ring_dequeue(spsc_ring_t *r, void *obj)
+{
+    return spsc_ring_dequeue_burst(r, obj, 1) ? 0 : -1;
+}
+
+#endif /* SPSC_RING_H */
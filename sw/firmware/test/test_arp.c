@@ -14,6 +14,7 @@
 #include "test_framework.h"
 #include "sim_hal.h"
 #include "arp.h"
+#include "fdb.h"
 #include "table_map.h"
 
 // ─────────────────────────────────────────────
@@ -109,6 +110,7 @@ void test_arp_add_lookup_hit(void) {
 
     sim_hal_reset();
     arp_init();
+    fdb_init();
 
     const uint8_t mac[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
     TEST_ASSERT_OK(arp_add(0x0A000001, mac, 2, 10));
@@ -120,9 +122,10 @@ void test_arp_add_lookup_hit(void) {
     TEST_ASSERT_MEM_EQ(out_mac, mac, 6);
 
     /* arp_add 联动 fdb_learn → Stage 2 TCAM 中有该 MAC 的转发条目 */
-    /* mac = {0x00,0x11,0x22,0x33,0x44,0x55}，dmac & 0xFFF = 0x455 */
-    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE,
-                                           TABLE_L2_FDB_BASE + 0x455u);
+    /* table_id 由 FDB 哈希表按 (MAC, VLAN) 分配 */
+    int fdb_tid = fdb_tcam_slot(0x001122334455ULL, 10);
+    TEST_ASSERT(fdb_tid >= 0);
+    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)fdb_tid);
     TEST_ASSERT_NOTNULL(fdb_r);
     TEST_ASSERT_EQ(fdb_r->entry.action_params[0], 2);   /* port=2 */
 
@@ -237,6 +240,7 @@ void test_arp_process_reply(void) {
 
     sim_hal_reset();
     arp_init();
+    fdb_init();
 
     const uint8_t reply_mac[6] = {0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE};
     const uint32_t reply_ip    = 0xC0A80102;  /* 192.168.1.2 */
@@ -260,9 +264,10 @@ void test_arp_process_reply(void) {
     TEST_ASSERT_EQ(op, 5);
 
     /* fdb_learn 被调用 → Stage 2 TCAM 中有该 MAC 的转发条目 */
-    /* reply_mac = {0x00,0xAA,0xBB,0xCC,0xDD,0xEE}, dmac & 0xFFF = 0xDEE */
-    sim_tcam_rec_t *fdb_r2 = sim_tcam_find(TABLE_L2_FDB_STAGE,
-                                            TABLE_L2_FDB_BASE + 0xDEEu);
+    /* 学习到的 VLAN = 报文的 vlan_id（20） */
+    int fdb_tid2 = fdb_tcam_slot(0x00AABBCCDDEEULL, 20);
+    TEST_ASSERT(fdb_tid2 >= 0);
+    sim_tcam_rec_t *fdb_r2 = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)fdb_tid2);
     TEST_ASSERT_NOTNULL(fdb_r2);
     TEST_ASSERT_EQ(fdb_r2->entry.action_params[0], 5);   /* port=5 */
 
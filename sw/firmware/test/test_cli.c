@@ -60,8 +60,10 @@ void test_cli_route_add(void) {
     char *argv[] = {"route", "add", "10.0.0.0/8", "2", "aa:bb:cc:dd:ee:ff"};
     TEST_ASSERT_EQ(cli_exec_cmd(5, argv), 1);
 
-    /* 10.0.0.0/8 → table_id = TABLE_IPV4_LPM_BASE + (0x0A000000 >> 24) = 10 */
-    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u);
+    /* 10.0.0.0/8 → table_id 由 route 模块的 TCAM 布局分配 */
+    int tid = route_tcam_slot(0x0A000000u, 8);
+    TEST_ASSERT(tid >= 0);
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
     TEST_ASSERT_NOTNULL(r);
     TEST_ASSERT_EQ(r->entry.action_id,         ACTION_FORWARD);
     TEST_ASSERT_EQ(r->entry.action_params[0],  2);      /* port */
@@ -84,13 +86,16 @@ void test_cli_route_del(void) {
     cli_exec_cmd(5, add_argv);
 
     /* 确认存在 */
-    TEST_ASSERT_NOTNULL(sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u));
+    int tid = route_tcam_slot(0x0A000000u, 8);
+    TEST_ASSERT(tid >= 0);
+    TEST_ASSERT_NOTNULL(sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid));
 
     char *del_argv[] = {"route", "del", "10.0.0.0/8"};
     TEST_ASSERT_EQ(cli_exec_cmd(3, del_argv), 1);
 
     /* 应已删除 */
-    TEST_ASSERT(sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u) == NULL);
+    TEST_ASSERT(sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid) == NULL);
+    TEST_ASSERT_EQ(route_tcam_slot(0x0A000000u, 8), -1);
 
     TEST_END();
 }
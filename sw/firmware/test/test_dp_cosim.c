@@ -1,5 +1,5 @@
 // test_dp_cosim.c
-// 数据面 + 控制面联合测试（Co-Simulation，7 个场景）
+// 数据面 + 控制面联合测试（Co-Simulation，16 个场景）
 //
 // 测试思路：
 //   通过控制面 API（route_add/acl_add_deny/fdb_add_static/arp_init/qos_init/vlan_*）
@@ -14,12 +14,29 @@
 //   CS-5: DSCP QoS 优先级映射 → qos_prio 正确
 //   CS-6: VLAN 入口 PVID 分配 → vlan_id 正确赋值
 //   CS-7: 全流水线 (路由 + VLAN 入口 + VLAN 出口) → 端口 + 标签剥离
+//   CS-8: 批量处理 pkt_process_burst → 与逐帧 pkt_process 结果一致
+//   CS-9: 多线程模型 pkt_mt → 与单线程一致；控制面更新在发布快照后才可见
+//   CS-10: 加载编译器产物 → 与内置程序一致；内联 JSON 配置出口 Stage 20
+//   CS-11: 流缓存 pkt_flow → 与流水线一致；TCAM 更新 / 程序重载后失效
+//   CS-12: Punt SPSC 环 → 数据面线程 punt ARP 给固件线程，无丢失、保序
+//   CS-13: TCAM 优先级 → 多条命中时 table_id 最小者胜出（与 mau_tcam.sv 一致）
+//   CS-14: 可编程解析器 → 内置程序与原解析等价；hal_parser_add_state 增加 MPLS
+//   CS-15: ECMP → 按五元组 CRC32 选成员，流内一致、各成员均衡；增删成员只迁移必要的流；
+//          VLAN 出口按选出的成员端口处理标签
+//   CS-16: 解析器 RTL 格式 → pkt_parser_to_rtl 转换后按 parser_tcam.sv 语义执行，
+//          随机程序与模型逐字节一致；内置程序不可表示
 
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
 #include "test_framework.h"
 #include "sim_hal.h"
 #include "pkt_model.h"
+#include "pkt_mt.h"
+#include "pkt_prog.h"
+#include "pkt_flow.h"
+#include "pkt_parser.h"
 #include "table_map.h"
 
 // 固件模块
@@ -125,6 +142,14 @@ static uint16_t build_arp_pkt(uint8_t *buf,
     return (uint16_t)off;   /* = 42 */
 }
 
+// 逐字段比较转发决策（结构体含填充字节，不能直接 memcmp）
+static int fwd_eq(const fwd_result_t *a, const fwd_result_t *b)
+{
+    return a->eg_port  == b->eg_port  && a->drop    == b->drop    &&
+           a->punt     == b->punt     && a->vlan_id == b->vlan_id &&
+           a->qos_prio == b->qos_prio && a->vlan_action == b->vlan_action;
+}
+
 // ─────────────────────────────────────────────
 // CS-1: IPv4 LPM 路由命中 → 正确出端口 + dst MAC 改写
 // ─────────────────────────────────────────────
@@ -338,7 +363,7 @@ void test_dp_cosim_vlan_ingress(void)
 
     sim_hal_reset();
     vlan_init();
-    // vlan_init() 只安装出口规则（Stage 6）；入口规则由 vlan_install_port_rules()
+    // vlan_init() 只安装出口规则（Stage 7）；入口规则由 vlan_install_port_rules()
     // 在 vlan_port_set_pvid / vlan_port_set_mode 中按需安装。
     // 此处为 port 1 显式安装入口规则（PVID=1，access 模式）。
     vlan_install_port_rules(1);   // port 1 → PVID=1（默认值不变，触发规则写入）
@@ -374,10 +399,10 @@ void test_dp_cosim_vlan_ingress(void)
 // ─────────────────────────────────────────────
 void test_dp_cosim_full_pipeline(void)
 {
-    TEST_BEGIN("CS-7 : 全流水线 路由(S0)+VLAN入口(S4)+VLAN出口剥离(S6)");
+    TEST_BEGIN("CS-7 : 全流水线 路由(S0)+VLAN入口(S4)+VLAN出口剥离(S7)");
 
     sim_hal_reset();
-    // vlan_init() 安装出口规则（Stage 6，所有端口 VLAN 1 STRIP）；
+    // vlan_init() 安装出口规则（Stage 7，所有端口 VLAN 1 STRIP）；
     // 同时初始化软件状态（port_cfg[*].pvid=1, mode=ACCESS）。
     vlan_init();
     // 为 port 0 显式安装入口规则（PVID=1，access），使 Stage 4 生效。
@@ -412,7 +437,7 @@ void test_dp_cosim_full_pipeline(void)
     // Stage 4: VLAN 入口，port 0 PVID=1，无标签帧 → vlan_id = 1
     TEST_ASSERT_EQ(res.vlan_id, 1);
 
-    // Stage 6: VLAN 出口，(eg_port=4, vlan_id=1) → STRIP_TAG（port 4 在 VLAN 1 access）
+    // Stage 7: VLAN 出口，(eg_port=4, vlan_id=1) → STRIP_TAG（port 4 在 VLAN 1 access）
     TEST_ASSERT_EQ(res.vlan_action, VLAN_ACT_STRIP);
 
     // dst MAC 改写验证
@@ -422,3 +447,1106 @@ void test_dp_cosim_full_pipeline(void)
 
     TEST_END();
 }
+
+// ─────────────────────────────────────────────
+// CS-8: 批量处理 — pkt_process_burst 与逐帧 pkt_process 结果一致
+// ─────────────────────────────────────────────
+void test_dp_cosim_burst(void)
+{
+    TEST_BEGIN("CS-8 : pkt_process_burst(40 帧) 与逐帧 pkt_process 一致");
+
+    sim_hal_reset();
+    vlan_init();
+    vlan_install_port_rules(0);
+    vlan_install_port_rules(1);
+    route_init();
+    acl_init();
+    fdb_init();
+    arp_init();
+    qos_init();
+
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 4, 0xDEADBEEF00FFULL));
+    TEST_ASSERT_OK(route_add(0x0A0A0000u, 16, 3, 0xAABBCCDDEEFFULL));
+    TEST_ASSERT(acl_add_deny(0x01020300u, 0xFFFFFF00u, 0, 0, 23) >= 0);
+    TEST_ASSERT_OK(fdb_add_static(0x001122334455ULL, 7, 1));
+
+    static const uint8_t d[6]   = {0x00,0x11,0x22,0x33,0x44,0x55};
+    static const uint8_t s[6]   = {0xAA,0xBB,0xCC,0xDD,0xEE,0xFF};
+    static const uint8_t sha[6] = {0x02,0x00,0x00,0x00,0x00,0x01};
+
+    // 40 帧（> PKT_BURST_MAX，覆盖分批）：路由/ACL/ARP/L2/QoS 混合，另含 1 个过短帧
+    enum { N = 40 };
+    uint8_t    buf[N][64];
+    pkt_desc_t desc[N];
+    for (int i = 0; i < N; i++) {
+        uint16_t len;
+        switch (i % 5) {
+        case 0:  len = build_ipv4_pkt(buf[i], d, s, (uint8_t)((i & 0x3F) << 2),
+                                       0x01020304u, 0x0A0A0000u | (uint32_t)i, 17, 53);
+                 break;
+        case 1:  len = build_ipv4_pkt(buf[i], d, s, 0xB8,
+                                       0x01020300u | (uint32_t)i, 0x0A010203u, 6,
+                                       (uint16_t)(i & 1 ? 23 : 80));
+                 break;
+        case 2:  len = build_arp_pkt(buf[i], sha, 0x0A000001u, 0x0A000002u); break;
+        case 3:  len = build_l2_pkt(buf[i], d, s, 0x9999);                    break;
+        default: len = build_ipv4_pkt(buf[i], s, d, 0x00,
+                                       0x01020304u, 0xC0A80001u, 0, 0);
+                 break;
+        }
+        desc[i].data    = buf[i];
+        desc[i].len     = (i == 37) ? 10 : len;   // 第 37 帧截断为 10 字节
+        desc[i].ig_port = (uint8_t)(i & 1);
+    }
+
+    fwd_result_t res[N];
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, res), N - 1);
+
+    int mismatch = 0;
+    for (int i = 0; i < N; i++) {
+        fwd_result_t ref;
+        if (pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &ref) != 0) {
+            TEST_ASSERT_EQ(res[i].drop, 1);
+            continue;
+        }
+        if (!fwd_eq(&ref, &res[i])) mismatch++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+
+    // 抽查：i=1 命中 ACL deny（dport 23）；i=6 dport 80 走路由 10/8
+    TEST_ASSERT_EQ(res[1].drop,    1);
+    TEST_ASSERT_EQ(res[6].eg_port, 4);
+    TEST_ASSERT_EQ(res[2].punt,    1);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-9: 多线程模型 — 快照发布语义
+// ─────────────────────────────────────────────
+void test_dp_cosim_mt_snapshot(void)
+{
+    TEST_BEGIN("CS-9 : pkt_mt(4 线程) 与单线程一致；route_add 发布后才生效");
+
+    sim_hal_reset();
+    route_init();
+    acl_init();
+    qos_init();
+
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 4, 0xDEADBEEF00FFULL));
+    TEST_ASSERT(acl_add_deny(0, 0, 0, 0, 23) >= 0);
+    TEST_ASSERT_OK(sim_tcam_publish());
+
+    static const uint8_t d[6] = {0x00,0x11,0x22,0x33,0x44,0x55};
+    static const uint8_t s[6] = {0xAA,0xBB,0xCC,0xDD,0xEE,0xFF};
+
+    // 200 帧：dst 在 10/8 与 20/8 之间交替，dport 23/80 交替，DSCP 轮换
+    enum { N = 200 };
+    static uint8_t buf[N][64];
+    pkt_desc_t     desc[N];
+    for (int i = 0; i < N; i++) {
+        uint32_t dst = ((i & 1) ? 0x14000000u : 0x0A000000u) | (uint32_t)i;
+        desc[i].len     = build_ipv4_pkt(buf[i], d, s, (uint8_t)((i % 64) << 2),
+                                         0x01020304u, dst, 17,
+                                         (uint16_t)((i % 3) ? 80 : 23));
+        desc[i].data    = buf[i];
+        desc[i].ig_port = (uint8_t)(i % 4);
+    }
+
+    pkt_mt_t *mt = pkt_mt_create(4);
+    TEST_ASSERT_NOTNULL(mt);
+
+    static fwd_result_t ref[N], res[N];
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, ref), N);
+    TEST_ASSERT_EQ(pkt_mt_process(mt, desc, N, res), N);
+    int mismatch = 0;
+    for (int i = 0; i < N; i++)
+        if (!fwd_eq(&ref[i], &res[i])) mismatch++;
+    TEST_ASSERT_EQ(mismatch, 0);
+
+    // 控制面更新但未发布：工作线程仍使用旧快照（20/8 无路由）
+    TEST_ASSERT_OK(route_add(0x14000000u, 8, 6, 0x020000000006ULL));
+    TEST_ASSERT_EQ(pkt_mt_process(mt, desc, N, res), N);
+    TEST_ASSERT_EQ(res[1].eg_port, 0);
+
+    // 发布后生效，且与单线程 live 查找一致
+    TEST_ASSERT_OK(sim_tcam_publish());
+    TEST_ASSERT_EQ(pkt_mt_process(mt, desc, N, res), N);
+    TEST_ASSERT_EQ(res[1].eg_port, 6);
+    TEST_ASSERT_EQ(res[2].eg_port, 4);
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, ref), N);
+    mismatch = 0;
+    for (int i = 0; i < N; i++)
+        if (!fwd_eq(&ref[i], &res[i])) mismatch++;
+    TEST_ASSERT_EQ(mismatch, 0);
+
+    // 所有分片都已被处理
+    uint64_t total = 0;
+    for (int w = 0; w < 4; w++) {
+        pkt_mt_stats_t st;
+        pkt_mt_get_stats(mt, w, &st);
+        total += st.pkts;
+    }
+    TEST_ASSERT_EQ(total, 3u * N);
+
+    pkt_mt_destroy(mt);
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-10: 表驱动流水线 — 编译器产物加载
+// ─────────────────────────────────────────────
+
+// rvp4cc.py 编译 firmware_dataplane.c 的产物（make -C sw/compiler fw-pipeline）
+#ifndef FW_PIPELINE_DIR
+#define FW_PIPELINE_DIR "../../compiler/fw_pipeline"
+#endif
+
+// 内联程序：Stage 0 路由 + Stage 20（出口）按 eg_port 设优先级，其余级不配置
+static const char cs10_phv[] =
+    "{ \"ipv4_dst\": {\"offset\": 34, \"width\": 4},"
+    "  \"meta_eg_port\": {\"offset\": 257, \"width\": 1} }";
+static const char cs10_tables[] =
+    "{ \"_pipeline\": {\"num_stages\": 24, \"ingress_stages\": 16},"
+    "  \"t_route\":  {\"stage\": 0,  \"key_fields\": [\"ipv4_dst\"]},"
+    "  \"t_eg_mark\": {\"stage\": 20, \"key_fields\": [\"meta_eg_port\"]} }";
+static const char cs10_actions[] =
+    "{ \"forward\": {\"action_id\": 4097, \"primitives\": ["
+    "     {\"op\": 10, \"fwidth\": 1, \"param\": 0},"
+    "     {\"op\": 1, \"dst_off\": 0, \"fwidth\": 6, \"param\": 1}]},"
+    "  \"eg_mark\": {\"action_id\": 32768, \"primitives\": ["
+    "     {\"op\": 11, \"fwidth\": 1, \"imm_val\": 3}]} }";
+
+void test_dp_cosim_prog_load(void)
+{
+    TEST_BEGIN("CS-10: 编译器产物加载 — 与内置程序一致；Stage 20 出口表生效");
+
+    sim_hal_reset();
+    pkt_prog_reset();
+    vlan_init();
+    TEST_ASSERT_OK(vlan_create(10));
+    TEST_ASSERT_OK(vlan_port_add(10, 0, /*tagged=*/0));
+    TEST_ASSERT_OK(vlan_port_add(10, 4, /*tagged=*/1));
+    vlan_install_port_rules(0);
+    vlan_install_port_rules(1);
+    route_init();
+    acl_init();
+    fdb_init();
+    arp_init();
+    qos_init();
+
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 4, 0xDEADBEEF00FFULL));
+    TEST_ASSERT(acl_add_deny(0, 0, 0, 0, 23) >= 0);
+    TEST_ASSERT_OK(fdb_add_static(0x001122334455ULL, 7, 1));
+    // 20.0.0.0/8 → ECMP 组 1（3 成员），覆盖 Stage 0 hash + Stage 6 成员表
+    for (uint8_t p = 1; p <= 3; p++)
+        TEST_ASSERT_OK(route_ecmp_member_add(1, p, 0x020000000000ULL | p));
+    TEST_ASSERT_OK(route_ecmp_add(0x14000000u, 8, 1));
+
+    static const uint8_t d[6]   = {0x00,0x11,0x22,0x33,0x44,0x55};
+    static const uint8_t s[6]   = {0xAA,0xBB,0xCC,0xDD,0xEE,0xFF};
+    static const uint8_t sha[6] = {0x02,0x00,0x00,0x00,0x00,0x01};
+
+    // 48 帧：路由 / ACL / ARP / L2 / ECMP 混合，覆盖 Stage 0-7
+    enum { N = 48 };
+    uint8_t    buf[N][64];
+    pkt_desc_t desc[N];
+    for (int i = 0; i < N; i++) {
+        uint16_t len;
+        switch (i % 4) {
+        case 0:  len = build_ipv4_pkt(buf[i], d, s, (uint8_t)((i & 0x3F) << 2),
+                                       0x01020304u, 0x0A000000u | (uint32_t)i, 6,
+                                       (uint16_t)(i & 4 ? 23 : 80));
+                 break;
+        case 1:  len = build_arp_pkt(buf[i], sha, 0x0A000001u, 0x0A000002u); break;
+        case 2:  len = build_l2_pkt(buf[i], d, s, 0x9999);                    break;
+        default: len = build_ipv4_pkt(buf[i], s, d, 0xB8,
+                                       0x01020300u | (uint32_t)i, 0x14000001u, 17, 53);
+                 break;
+        }
+        desc[i].data    = buf[i];
+        desc[i].len     = len;
+        desc[i].ig_port = (uint8_t)(i & 1);
+    }
+
+    fwd_result_t ref[N], res[N];
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, ref), N);
+
+    // 1) 编译器产物与内置程序等价
+    TEST_ASSERT_EQ(pkt_prog_load_dir(FW_PIPELINE_DIR), 0);
+    TEST_ASSERT_EQ(pkt_prog_current()->n_stages, PKT_NUM_STAGES);
+    TEST_ASSERT_EQ(pkt_prog_current()->ingress_stages, PKT_INGRESS_STAGES);
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, res), N);
+    int mismatch = 0;
+    for (int i = 0; i < N; i++) {
+        fwd_result_t one;
+        TEST_ASSERT_EQ(pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &one), 0);
+        if (!fwd_eq(&ref[i], &res[i]) || !fwd_eq(&ref[i], &one)) mismatch++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    TEST_ASSERT_EQ(res[4].drop, 1);             // dport 23 → ACL deny
+    TEST_ASSERT_EQ(res[1].punt, 1);             // ARP
+    int ecmp_port[4] = {0};
+    for (int i = 3; i < N; i += 4)
+        if (res[i].eg_port >= 1 && res[i].eg_port <= 3) ecmp_port[res[i].eg_port]++;
+    TEST_ASSERT_EQ(ecmp_port[1] + ecmp_port[2] + ecmp_port[3], N / 4);  // 全部经 Stage 6 选成员
+    TEST_ASSERT(ecmp_port[1] && ecmp_port[2] && ecmp_port[3]);
+
+    // 2) 加载失败（未知键字段）：返回 -1，当前程序不变
+    const pkt_prog_t *before = pkt_prog_current();
+    TEST_ASSERT_EQ(pkt_prog_load_json(cs10_phv,
+                   "{ \"t\": {\"stage\": 0, \"key_fields\": [\"no_such_field\"]} }",
+                   cs10_actions), -1);
+    TEST_ASSERT(strstr(pkt_prog_error(), "no_such_field") != NULL);
+    TEST_ASSERT(pkt_prog_current() == before);
+    TEST_ASSERT_EQ(pkt_prog_load_json(cs10_phv, "{ \"t\": ", cs10_actions), -1);
+    TEST_ASSERT(pkt_prog_current() == before);
+
+    // 3) 内联程序：Stage 20 出口表按 eg_port=4 设 qos_prio=3
+    TEST_ASSERT_EQ(pkt_prog_load_json(cs10_phv, cs10_tables, cs10_actions), 0);
+    TEST_ASSERT(pkt_prog_action(pkt_prog_current(), 0x8000) != NULL);
+    TEST_ASSERT(pkt_prog_action(pkt_prog_current(), ACTION_DENY) == NULL);
+
+    tcam_entry_t e;
+    memset(&e, 0, sizeof(e));
+    e.stage          = 20;
+    e.key.bytes[0]   = 4;
+    e.key.key_len    = 1;
+    e.mask.bytes[0]  = 0xFF;
+    e.mask.key_len   = 1;
+    e.action_id      = 0x8000;
+    TEST_ASSERT_OK(hal_tcam_insert(&e));
+
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, res), N);
+    TEST_ASSERT_EQ(res[4].eg_port,  4);
+    TEST_ASSERT_EQ(res[4].drop,     0);         // Stage 1 未配置，ACL 不生效
+    TEST_ASSERT_EQ(res[4].qos_prio, 3);
+    TEST_ASSERT_EQ(res[3].eg_port,  0);         // 20/8 无路由
+    TEST_ASSERT_EQ(res[3].qos_prio, 0);
+    TEST_ASSERT_EQ(res[1].punt,     0);         // Stage 3 未配置
+
+    pkt_prog_reset();
+    TEST_ASSERT_EQ(pkt_process_burst(desc, N, res), N);
+    TEST_ASSERT_EQ(res[4].drop, 1);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-11: 流缓存 — 结果一致、报头改写、代数失效
+// ─────────────────────────────────────────────
+void test_dp_cosim_flow_cache(void)
+{
+    TEST_BEGIN("CS-11: 流缓存命中与流水线一致；TCAM 更新 / 程序重载后失效");
+
+    sim_hal_reset();
+    pkt_prog_reset();
+    vlan_init();
+    vlan_install_port_rules(0);
+    vlan_install_port_rules(1);
+    vlan_install_port_rules(2);
+    route_init();
+    acl_init();
+    fdb_init();
+    arp_init();
+    qos_init();
+
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 4, 0xDEADBEEF00FFULL));
+    TEST_ASSERT(acl_add_deny(0, 0, 0, 0, 23) >= 0);
+    TEST_ASSERT_OK(fdb_add_static(0x001122334455ULL, 7, 1));
+
+    static const uint8_t d[6]   = {0x00,0x11,0x22,0x33,0x44,0x55};
+    static const uint8_t s[6]   = {0xAA,0xBB,0xCC,0xDD,0xEE,0xFF};
+    static const uint8_t s2[6]  = {0xAA,0xBB,0xCC,0xDD,0xEE,0x01};
+    static const uint8_t sha[6] = {0x02,0x00,0x00,0x00,0x00,0x01};
+
+    // 12 条不同的流，每条 4 帧
+    enum { F = 12, N = 48 };
+    uint8_t    buf[F][64];
+    pkt_desc_t desc[N];
+    for (int f = 0; f < F; f++) {
+        uint16_t len;
+        switch (f % 4) {
+        case 0:  len = build_ipv4_pkt(buf[f], d, s, (uint8_t)(f << 2), 0x01020304u,
+                                       0x0A000000u | (uint32_t)f, 6,
+                                       (uint16_t)(f & 4 ? 23 : 80));
+                 break;
+        case 1:  len = build_arp_pkt(buf[f], sha, 0x0A000001u, 0x0A000002u); break;
+        case 2:  len = build_l2_pkt(buf[f], d, s, (uint16_t)(0x9000 + f));   break;
+        default: len = build_ipv4_pkt(buf[f], s, d, 0xB8, 0x01020304u,
+                                       0x14000000u | (uint32_t)f, 17, 53);
+                 break;
+        }
+        for (int r = 0; r < N / F; r++) {
+            desc[r * F + f].data    = buf[f];
+            desc[r * F + f].len     = len;
+            desc[r * F + f].ig_port = (uint8_t)(f % 3);    // ARP 流仅靠入端口区分
+        }
+    }
+
+    pkt_flow_t *fc = pkt_flow_create(256);
+    TEST_ASSERT_NOTNULL(fc);
+
+    // 1) 首轮每条流未命中一次，其余命中；结果与无缓存一致
+    fwd_result_t ref, res;
+    int mismatch = 0;
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQ(pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &ref), 0);
+        TEST_ASSERT_EQ(pkt_flow_process(fc, desc[i].data, desc[i].len, desc[i].ig_port, &res), 0);
+        if (!fwd_eq(&ref, &res)) mismatch++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    pkt_flow_stats_t st;
+    pkt_flow_get_stats(fc, &st);
+    TEST_ASSERT_EQ(st.misses, F);
+    TEST_ASSERT_EQ(st.hits,   N - F);
+    TEST_ASSERT_EQ(st.bypass, 0);
+
+    // 2) 命中时重放报头改写（dst MAC）；流键不含 eth_src，换源 MAC 仍命中
+    uint8_t  pkt[64];
+    uint16_t len = build_ipv4_pkt(pkt, d, s2, 0, 0x01020304u, 0x0A000000u, 6, 80);
+    phv_t    phv;
+    TEST_ASSERT_EQ(pkt_parse(pkt, len, 0, &phv), 0);
+    TEST_ASSERT_EQ(pkt_flow_forward(fc, &phv, &res), 0);
+    TEST_ASSERT_EQ(res.eg_port, 4);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_ETH_DST + 0], 0xDE);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_ETH_DST + 5], 0xFF);
+    TEST_ASSERT_EQ(phv.eg_port, 4);
+    pkt_flow_get_stats(fc, &st);
+    TEST_ASSERT_EQ(st.hits, N - F + 1);
+
+    // 3) route_add 后全部条目过期：20/8 的流改走 port 6
+    TEST_ASSERT_OK(route_add(0x14000000u, 8, 6, 0x020000000006ULL));
+    pkt_flow_clear_stats(fc);
+    mismatch = 0;
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQ(pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &ref), 0);
+        TEST_ASSERT_EQ(pkt_flow_process(fc, desc[i].data, desc[i].len, desc[i].ig_port, &res), 0);
+        if (!fwd_eq(&ref, &res)) mismatch++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    pkt_flow_get_stats(fc, &st);
+    TEST_ASSERT_EQ(st.stale, F);
+    TEST_ASSERT_EQ(st.hits,  N - F);
+    TEST_ASSERT_EQ(pkt_flow_process(fc, buf[3], desc[3].len, desc[3].ig_port, &res), 0);
+    TEST_ASSERT_EQ(res.eg_port, 6);
+
+    // 4) hal_tcam_flush 清空 ACL：dport 23 的流不再被丢弃
+    TEST_ASSERT_EQ(pkt_flow_process(fc, buf[4], desc[4].len, desc[4].ig_port, &res), 0);
+    TEST_ASSERT_EQ(res.drop, 1);
+    TEST_ASSERT_OK(hal_tcam_flush(TABLE_ACL_INGRESS_STAGE));
+    TEST_ASSERT_EQ(pkt_flow_process(fc, buf[4], desc[4].len, desc[4].ig_port, &res), 0);
+    TEST_ASSERT_EQ(res.drop,    0);
+    TEST_ASSERT_EQ(res.eg_port, 4);
+
+    // 5) 程序重载同样使条目失效
+    pkt_flow_clear_stats(fc);
+    pkt_prog_reset();
+    TEST_ASSERT_EQ(pkt_flow_process(fc, buf[4], desc[4].len, desc[4].ig_port, &res), 0);
+    pkt_flow_get_stats(fc, &st);
+    TEST_ASSERT_EQ(st.stale, 1);
+    pkt_flow_destroy(fc);
+
+    // 6) 容量不足（4 条目 / 12 条流）：发生替换，结果仍一致
+    fc = pkt_flow_create(4);
+    TEST_ASSERT_NOTNULL(fc);
+    mismatch = 0;
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQ(pkt_process(desc[i].data, desc[i].len, desc[i].ig_port, &ref), 0);
+        TEST_ASSERT_EQ(pkt_flow_process(fc, desc[i].data, desc[i].len, desc[i].ig_port, &res), 0);
+        if (!fwd_eq(&ref, &res)) mismatch++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    pkt_flow_get_stats(fc, &st);
+    TEST_ASSERT(st.evictions > 0);
+    TEST_ASSERT_EQ(st.hits + st.misses, N);
+    pkt_flow_destroy(fc);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-12: Punt SPSC 环 — 数据面线程 ↔ 固件线程
+// ─────────────────────────────────────────────
+
+#define CS12_N      20000
+#define CS12_BURST  32
+
+typedef struct {
+    int reader;
+    int tx_got;             // 收到的回送包数
+    int tx_misorder;
+    int fw_got;             // 固件线程处理的包数
+    int fw_misorder;
+    int publishes;
+} cs12_ctx_t;
+
+// 序号放在 ARP 请求的 THA 字段（请求中无意义，arp_process_pkt 不读取）
+static uint32_t cs12_seq(const uint8_t *frame)
+{
+    return ((uint32_t)frame[32] << 24) | ((uint32_t)frame[33] << 16) |
+           ((uint32_t)frame[34] <<  8) |  (uint32_t)frame[35];
+}
+
+// 数据面线程：在快照上跑流水线，punt 结果批量写入 RX 环，同时收 TX 环
+static void *cs12_dp_thread(void *arg)
+{
+    cs12_ctx_t *c = (cs12_ctx_t *)arg;
+    static uint8_t buf[CS12_BURST][64];
+    pkt_desc_t     desc[CS12_BURST];
+    fwd_result_t   res[CS12_BURST];
+    punt_pkt_t     out[CS12_BURST], in[CS12_BURST];
+
+    int sent = 0;
+    while (c->tx_got < CS12_N) {
+        int n = 0;
+        if (sent < CS12_N) {
+            n = CS12_N - sent < CS12_BURST ? CS12_N - sent : CS12_BURST;
+            for (int i = 0; i < n; i++) {
+                uint32_t seq = (uint32_t)(sent + i);
+                uint8_t  sha[6] = {0x02, 0x00, 0x00, 0x00, 0x00, (uint8_t)(seq % 8)};
+                // tpa 不是本机接口地址：固件只做被动学习，不打印
+                desc[i].len = build_arp_pkt(buf[i], sha, 0x0A0A0010u + seq % 8, 0x0A0A00FEu);
+                buf[i][32] = (uint8_t)(seq >> 24); buf[i][33] = (uint8_t)(seq >> 16);
+                buf[i][34] = (uint8_t)(seq >> 8);  buf[i][35] = (uint8_t)seq;
+                desc[i].data    = buf[i];
+                desc[i].ig_port = 0;
+            }
+            const sim_tcam_snap_t *snap = sim_tcam_read_begin(c->reader);
+            pkt_process_burst_snap(snap, desc, n, res);
+            sim_tcam_read_end(c->reader);
+
+            int m = 0;
+            for (int i = 0; i < n; i++) {
+                if (!res[i].punt) continue;
+                memset(&out[m], 0, sizeof(out[m]));
+                out[m].ing_port = desc[i].ig_port;
+                out[m].vlan_id  = res[i].vlan_id;
+                out[m].reason   = PUNT_REASON_ARP;
+                out[m].pkt_len  = desc[i].len;
+                memcpy(out[m].data, desc[i].data, desc[i].len);
+                m++;
+            }
+            // RX 满时先收 TX，避免与固件线程互等
+            for (int done = 0; done < m; ) {
+                done += sim_punt_rx_inject_burst(out + done, m - done);
+                int k = sim_punt_tx_pop_burst(in, CS12_BURST);
+                for (int i = 0; i < k; i++, c->tx_got++)
+                    if (cs12_seq(in[i].data) != (uint32_t)c->tx_got) c->tx_misorder++;
+                if (done < m && !k) sched_yield();
+            }
+            sent += n;
+        }
+        int k = sim_punt_tx_pop_burst(in, CS12_BURST);
+        for (int i = 0; i < k; i++, c->tx_got++)
+            if (cs12_seq(in[i].data) != (uint32_t)c->tx_got) c->tx_misorder++;
+        if (!k && sent >= CS12_N) sched_yield();
+    }
+    return NULL;
+}
+
+// 固件线程：cp_main 慢路径（批量收包 → arp_process_pkt），处理完回送，
+// TCAM 有变化时发布快照
+static void *cs12_fw_thread(void *arg)
+{
+    cs12_ctx_t *c = (cs12_ctx_t *)arg;
+    punt_pkt_t  pkts[16];
+    uint64_t    gen = sim_tcam_generation();
+
+    while (c->fw_got < CS12_N) {
+        int n = hal_punt_rx_poll_burst(pkts, 16);
+        if (!n) { sched_yield(); continue; }
+        for (int i = 0; i < n; i++, c->fw_got++) {
+            if (cs12_seq(pkts[i].data) != (uint32_t)c->fw_got) c->fw_misorder++;
+            arp_process_pkt(&pkts[i]);
+            pkts[i].eg_port = pkts[i].ing_port;
+            while (hal_punt_tx_send(&pkts[i]) == HAL_ERR_FULL) sched_yield();
+        }
+        if (sim_tcam_generation() != gen) {
+            sim_tcam_publish();
+            gen = sim_tcam_generation();
+            c->publishes++;
+        }
+    }
+    return NULL;
+}
+
+void test_dp_cosim_punt_spsc(void)
+{
+    TEST_BEGIN("CS-12: Punt SPSC 环 — 批量 / 回绕 / 满；跨线程 ARP punt 无丢失且保序");
+
+    sim_hal_reset();
+    fdb_init();
+    arp_init();
+    static const uint8_t my_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xF0};
+    arp_set_port_intf(0, 0x0A0A0001u, my_mac);
+
+    // 1) 单线程语义：批量写入 / 取出，回绕后保序，TX 环满返回 HAL_ERR_FULL
+    static punt_pkt_t p[SIM_PUNT_MAX + 1];
+    for (int i = 0; i <= SIM_PUNT_MAX; i++) {
+        memset(&p[i], 0, sizeof(p[i]));
+        p[i].pkt_len = (uint16_t)i;
+    }
+    int bad = 0;
+    for (int round = 0; round < 3; round++) {       // 700 x 3 > 1024：跨越回绕点
+        TEST_ASSERT_EQ(sim_punt_rx_inject_burst(p, 700), 700);
+        punt_pkt_t q[100];
+        for (int got = 0; got < 700; ) {
+            int k = hal_punt_rx_poll_burst(q, 100);
+            TEST_ASSERT(k > 0);
+            if (k <= 0) break;
+            for (int i = 0; i < k; i++) if (q[i].pkt_len != got + i) bad++;
+            got += k;
+        }
+    }
+    TEST_ASSERT_EQ(bad, 0);
+    TEST_ASSERT_EQ(sim_punt_rx_inject_burst(p, SIM_PUNT_MAX + 1), SIM_PUNT_MAX);
+    TEST_ASSERT_EQ(sim_punt_rx_inject(&p[0]), HAL_ERR_FULL);
+    punt_pkt_t one;
+    int drained = 0;
+    while (hal_punt_rx_poll(&one) == HAL_OK) drained++;
+    TEST_ASSERT_EQ(drained, SIM_PUNT_MAX);
+    for (int i = 0; i < SIM_PUNT_MAX; i++) TEST_ASSERT_OK(hal_punt_tx_send(&p[i]));
+    TEST_ASSERT_EQ(hal_punt_tx_send(&p[0]), HAL_ERR_FULL);
+    TEST_ASSERT_EQ(sim_punt_tx_pending(), SIM_PUNT_MAX);
+    TEST_ASSERT_EQ(sim_punt_tx_pop_burst(p, SIM_PUNT_MAX + 1), SIM_PUNT_MAX);
+    TEST_ASSERT_NULL(sim_punt_tx_pop());
+
+    // 2) 跨线程：数据面线程 → RX 环 → 固件线程 → TX 环 → 数据面线程
+    TEST_ASSERT_OK(sim_tcam_publish());
+    cs12_ctx_t c;
+    memset(&c, 0, sizeof(c));
+    c.reader = sim_tcam_reader_register();
+    TEST_ASSERT(c.reader >= 0);
+
+    pthread_t dp, fw;
+    pthread_create(&fw, NULL, cs12_fw_thread, &c);
+    pthread_create(&dp, NULL, cs12_dp_thread, &c);
+    pthread_join(dp, NULL);
+    pthread_join(fw, NULL);
+    sim_tcam_reader_unregister(c.reader);
+
+    TEST_ASSERT_EQ(c.fw_got, CS12_N);
+    TEST_ASSERT_EQ(c.tx_got, CS12_N);
+    TEST_ASSERT_EQ(c.fw_misorder, 0);
+    TEST_ASSERT_EQ(c.tx_misorder, 0);
+    TEST_ASSERT(c.publishes >= 1);          // 被动学习写 FDB 后发布过快照
+
+    // 8 个发送方都已被动学习
+    for (uint32_t k = 0; k < 8; k++) {
+        uint8_t   mac[6];
+        port_id_t port;
+        TEST_ASSERT_OK(arp_lookup(0x0A0A0010u + k, mac, &port));
+        TEST_ASSERT_EQ(mac[5], k);
+    }
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-13: TCAM 优先级 = 最小 table_id
+// ─────────────────────────────────────────────
+
+static int cs13_route(uint16_t tid, uint32_t pfx, uint8_t len, uint8_t port)
+{
+    tcam_entry_t e;
+    memset(&e, 0, sizeof(e));
+    e.stage    = TABLE_IPV4_LPM_STAGE;
+    e.table_id = tid;
+    e.key.key_len = e.mask.key_len = 4;
+    for (int k = 0; k < 4; k++) {
+        uint32_t m = len ? 0xFFFFFFFFu << (32 - len) : 0;
+        e.key.bytes[k]  = (uint8_t)(pfx >> (24 - 8 * k));
+        e.mask.bytes[k] = (uint8_t)(m   >> (24 - 8 * k));
+    }
+    e.action_id        = ACTION_FORWARD;
+    e.action_params[0] = port;
+    return hal_tcam_insert(&e);
+}
+
+static uint8_t cs13_port(uint32_t dst)
+{
+    static const uint8_t dmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    uint8_t pkt[64];
+    fwd_result_t r;
+    uint16_t len = build_ipv4_pkt(pkt, dmac, smac, 0, 0x01010101u, dst, 17, 0);
+    pkt_process(pkt, len, 0, &r);
+    return r.eg_port;
+}
+
+void test_dp_cosim_tcam_priority(void)
+{
+    TEST_BEGIN("CS-13: TCAM 优先级 — 最小 table_id 胜出，与插入顺序无关");
+
+    sim_hal_reset();
+
+    // 插入顺序与优先级相反；/24 的 table_id 大于 /16，按硬件语义 /16 胜出
+    TEST_ASSERT_OK(cs13_route(0x0300, 0x0A000000u,  8, 3));     // 10.0.0.0/8
+    TEST_ASSERT_OK(cs13_route(0x0200, 0x0A010200u, 24, 2));     // 10.1.2.0/24
+    TEST_ASSERT_OK(cs13_route(0x0100, 0x0A010000u, 16, 1));     // 10.1.0.0/16
+    TEST_ASSERT_OK(cs13_route(0x0050, 0x0A090909u, 32, 5));     // 10.9.9.9/32（最后插入，最高优先级）
+
+    TEST_ASSERT_EQ(cs13_port(0x0A010203u), 1);
+    TEST_ASSERT_EQ(cs13_port(0x0A090909u), 5);
+    TEST_ASSERT_EQ(cs13_port(0x0A070001u), 3);
+
+    // 删除组内最高优先级条目 → 次优条目接替
+    TEST_ASSERT_OK(hal_tcam_delete(TABLE_IPV4_LPM_STAGE, 0x0100));
+    TEST_ASSERT_EQ(cs13_port(0x0A010203u), 2);
+
+    // 原位修改不改变优先级
+    TEST_ASSERT_OK(cs13_route(0x0300, 0x0A000000u, 8, 7));
+    TEST_ASSERT_EQ(cs13_port(0x0A070001u), 7);
+    TEST_ASSERT_EQ(cs13_port(0x0A010203u), 2);
+
+    // 同一掩码组、同一键：table_id 小者胜出
+    TEST_ASSERT_OK(cs13_route(0x0010, 0x0A000000u, 8, 9));
+    TEST_ASSERT_EQ(cs13_port(0x0A070001u), 9);
+    TEST_ASSERT_EQ(cs13_port(0x0A010203u), 9);
+    TEST_ASSERT_EQ(cs13_port(0x0A090909u), 9);
+
+    // 批量路径与快照路径同一语义
+    static const uint8_t dmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    static const uint32_t dst[4] = { 0x0A010203u, 0x0A090909u, 0x0A070001u, 0x0B000001u };
+    uint8_t      pkt[4][64];
+    pkt_desc_t   d[4];
+    fwd_result_t one[4], burst[4], snap[4];
+    for (int i = 0; i < 4; i++) {
+        d[i].data    = pkt[i];
+        d[i].len     = build_ipv4_pkt(pkt[i], dmac, smac, 0, 0x01010101u, dst[i], 17, 0);
+        d[i].ig_port = 0;
+        pkt_process(d[i].data, d[i].len, 0, &one[i]);
+    }
+    TEST_ASSERT_EQ(pkt_process_burst(d, 4, burst), 4);
+    TEST_ASSERT_OK(sim_tcam_publish());
+    int reader = sim_tcam_reader_register();
+    TEST_ASSERT(reader >= 0);
+    const sim_tcam_snap_t *sn = sim_tcam_read_begin(reader);
+    TEST_ASSERT_EQ(pkt_process_burst_snap(sn, d, 4, snap), 4);
+    sim_tcam_read_end(reader);
+    sim_tcam_reader_unregister(reader);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT(fwd_eq(&one[i], &burst[i]));
+        TEST_ASSERT(fwd_eq(&one[i], &snap[i]));
+    }
+    TEST_ASSERT_EQ(one[3].eg_port, 0);          // 无匹配路由：默认出端口 0
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-14: 可编程解析器 — 内置程序 + hal_parser_add_state 增加 MPLS
+// ─────────────────────────────────────────────
+
+#define CS14_ST_MPLS  40
+
+// Ethernet + n 层 MPLS 标签 + IPv4（无 L4）
+static uint16_t cs14_mpls_pkt(uint8_t *buf, int n_labels, uint32_t dst_ip)
+{
+    static const uint8_t dmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    uint8_t ip[64];
+    uint16_t ip_len = build_ipv4_pkt(ip, dmac, smac, 0, 0x01010101u, dst_ip, 17, 0);
+
+    memcpy(buf, ip, 12);
+    buf[12] = 0x88; buf[13] = 0x47;
+    int off = 14;
+    for (int i = 0; i < n_labels; i++) {
+        uint32_t lse = ((uint32_t)(100 + i) << 12) | (i == n_labels - 1 ? 0x100u : 0) | 64;
+        for (int k = 0; k < 4; k++) buf[off++] = (uint8_t)(lse >> (24 - 8 * k));
+    }
+    memcpy(buf + off, ip + 14, ip_len - 14);
+    return (uint16_t)(off + ip_len - 14);
+}
+
+void test_dp_cosim_parser_prog(void)
+{
+    TEST_BEGIN("CS-14: 可编程解析器 — 内置程序等价；hal_parser_add_state 增加 MPLS");
+
+    sim_hal_reset();
+    route_init();
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 4, 0x020000000004ULL));
+
+    // 内置程序：802.1Q + IPv4（IHL=6，带 4 字节选项）+ TCP
+    static const uint8_t tagged[] = {
+        0x02,0,0,0,0,0x01, 0x02,0,0,0,0,0x02, 0x81,0x00, 0x20,0x64, 0x08,0x00,
+        0x46,0x00,0x00,0x1C, 0,1,0,0, 64,6,0,0, 1,1,1,1, 10,2,3,4, 1,1,0,0,
+        0x12,0x34,0x00,0x50,
+    };
+    phv_t phv;
+    TEST_ASSERT_EQ(pkt_parse(tagged, sizeof(tagged), 3, &phv), 0);
+    TEST_ASSERT_EQ(phv.drop, 0);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_ETH_TYPE], 0x81);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_VLAN_TCI], 0x20);
+    TEST_ASSERT_EQ(phv.vlan_id, 100);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_IPV4_VER_IHL], 0x46);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_IPV4_PROTO], 6);
+    TEST_ASSERT(memcmp(&phv.hdr[PHV_OFF_IPV4_DST], tagged + 34, 4) == 0);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_TCP_SPORT], 0x12);       // 跳过 IPv4 选项
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_TCP_DPORT + 1], 0x50);
+
+    // 截断：IPv4 之后没有 L4 字节 → 端口保持 0；ARP 不提取 IPv4
+    static const uint8_t dmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    uint8_t pkt[96];
+    uint16_t len = build_ipv4_pkt(pkt, dmac, smac, 0, 0x01010101u, 0x0A000001u, 17, 0);
+    TEST_ASSERT_EQ(pkt_parse(pkt, len, 0, &phv), 0);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_IPV4_DST], 10);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_UDP_SPORT] | phv.hdr[PHV_OFF_UDP_DPORT + 1], 0);
+    len = build_arp_pkt(pkt, smac, 0x0A000001u, 0x0A000002u);
+    TEST_ASSERT_EQ(pkt_parse(pkt, len, 0, &phv), 0);
+    TEST_ASSERT_EQ(phv.drop, 0);
+    TEST_ASSERT_EQ(phv.hdr[PHV_OFF_IPV4_VER_IHL], 0);
+
+    // 未编程时 MPLS 帧只解析到以太网头，路由不命中
+    fwd_result_t r;
+    len = cs14_mpls_pkt(pkt, 2, 0x0A010101u);
+    TEST_ASSERT_EQ(pkt_process(pkt, len, 0, &r), 0);
+    TEST_ASSERT_EQ(r.eg_port, 0);
+    TEST_ASSERT_EQ(r.drop, 0);
+
+    // EtherType 0x8847 → MPLS；栈底（S 位）→ IPv4，否则继续弹出下一层标签
+    fsm_entry_t e;
+    memset(&e, 0, sizeof(e));
+    e.cur_state = PKT_PARSER_ST_ETHERTYPE;
+    e.key_window[0] = 0x88; e.key_window[1] = 0x47;
+    e.key_mask[0]   = 0xFF; e.key_mask[1]   = 0xFF;
+    e.next_state  = CS14_ST_MPLS;
+    e.hdr_advance = 2;
+    TEST_ASSERT_OK(hal_parser_add_state(&e));
+    memset(&e, 0, sizeof(e));
+    e.cur_state = CS14_ST_MPLS;
+    e.key_window[2] = 0x01;
+    e.key_mask[2]   = 0x01;
+    e.next_state  = PKT_PARSER_ST_IPV4;
+    e.hdr_advance = 4;
+    TEST_ASSERT_OK(hal_parser_add_state(&e));
+    e.key_window[2] = e.key_mask[2] = 0;
+    e.next_state  = CS14_ST_MPLS;
+    TEST_ASSERT_OK(hal_parser_add_state(&e));
+
+    for (int n = 1; n <= 3; n++) {
+        len = cs14_mpls_pkt(pkt, n, 0x0A010101u);
+        TEST_ASSERT_EQ(pkt_process(pkt, len, 0, &r), 0);
+        TEST_ASSERT_EQ(r.eg_port, 4);
+    }
+    pkt_desc_t d = { pkt, len, 0 };
+    fwd_result_t b;
+    TEST_ASSERT_EQ(pkt_process_burst(&d, 1, &b), 1);
+    TEST_ASSERT(fwd_eq(&r, &b));
+
+    // 非法条目：状态号越界 / 提取到元数据区
+    e.cur_state = PKT_PARSER_STATES;
+    TEST_ASSERT_EQ(hal_parser_add_state(&e), HAL_ERR_INVAL);
+    e.cur_state      = CS14_ST_MPLS;
+    e.phv_dst_offset = PHV_OFF_IG_PORT;
+    e.extract_len    = 1;
+    TEST_ASSERT_EQ(hal_parser_add_state(&e), HAL_ERR_INVAL);
+
+    // 删除 MPLS 状态：0x8847 转移仍在，新状态无条目 → TCAM 未命中丢弃
+    TEST_ASSERT_OK(hal_parser_del_state(CS14_ST_MPLS));
+    TEST_ASSERT_EQ(pkt_process(pkt, len, 0, &r), 0);
+    TEST_ASSERT_EQ(r.drop, 1);
+
+    // sim_hal_reset 恢复内置程序
+    sim_hal_reset();
+    TEST_ASSERT_EQ(pkt_process(pkt, len, 0, &r), 0);
+    TEST_ASSERT_EQ(r.drop, 0);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-15: ECMP —— Stage 0 ecmp_group 取 flow hash，Stage 6 成员表选出端口，Stage 7 VLAN 出口
+// ─────────────────────────────────────────────
+#define CS15_FLOWS  2048
+#define CS15_GRP    1
+
+// 第 i 条流：src = 172.16.x.y，dst = 10.1.0.0 + i，TCP dport 1024 + i（sport 固定 80）
+static uint16_t cs15_pkt(uint8_t *buf, int i, uint32_t *hash)
+{
+    static const uint8_t rmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xFE};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x10};
+    uint32_t src = 0xAC100000u | (uint32_t)(i * 7919 & 0xFFFF);
+    uint32_t dst = 0x0A010000u | (uint32_t)(i & 0xFF);
+    uint16_t dport = (uint16_t)(1024 + i);
+    uint16_t len = build_ipv4_pkt(buf, rmac, smac, 0, src, dst, 6, dport);
+    // hash 输入与内置程序一致：src + dst + proto + sport + dport
+    uint8_t k[13] = {
+        (uint8_t)(src >> 24), (uint8_t)(src >> 16), (uint8_t)(src >> 8), (uint8_t)src,
+        (uint8_t)(dst >> 24), (uint8_t)(dst >> 16), (uint8_t)(dst >> 8), (uint8_t)dst,
+        6, 0x00, 0x50, (uint8_t)(dport >> 8), (uint8_t)dport,
+    };
+    *hash = pkt_hash_crc32(k, 13);
+    return len;
+}
+
+static int cs15_port(int i, uint8_t *dmac_lo)
+{
+    uint8_t  pkt[64];
+    uint32_t h;
+    uint16_t len = cs15_pkt(pkt, i, &h);
+    phv_t        phv;
+    fwd_result_t r;
+    if (pkt_parse(pkt, len, 0, &phv) != 0) return -1;
+    pkt_forward(&phv, &r);
+    if (dmac_lo) *dmac_lo = phv.hdr[PHV_OFF_ETH_DST + 5];
+    return r.drop ? -1 : r.eg_port;
+}
+
+void test_dp_cosim_ecmp(void)
+{
+    TEST_BEGIN("CS-15: ECMP — 流按 CRC32 选成员，均衡；删/加成员只迁移必要的流");
+
+    sim_hal_reset();
+    vlan_init();                    // VLAN 1：全部端口 access（出口 STRIP）
+    vlan_install_port_rules(0);     // port 0 入口 PVID = 1
+    TEST_ASSERT_OK(vlan_port_add(1, 3, /*tagged=*/1));   // port 3 出口 KEEP
+    route_init();
+
+    // mau_hash.sv CRC32 = IEEE 802.3 CRC32
+    TEST_ASSERT_EQ(pkt_hash_crc32((const uint8_t *)"123456789", 9), 0xCBF43926u);
+
+    // 组 1：端口 1-4；10.1.0.0/16 → 组 1；20.0.0.0/8 普通路由 → port 9
+    for (uint8_t p = 1; p <= 4; p++)
+        TEST_ASSERT_OK(route_ecmp_member_add(CS15_GRP, p, 0x020000000000ULL | p));
+    TEST_ASSERT_OK(route_ecmp_add(0x0A010000u, 16, CS15_GRP));
+    TEST_ASSERT_OK(route_add(0x14000000u, 8, 9, 0x020000000009ULL));
+
+    // 每条流的出端口 / 下一跳 MAC 与控制面按同一 hash 选出的成员一致
+    static int port0[CS15_FLOWS];
+    int per_port[8] = {0}, mismatch = 0;
+    for (int i = 0; i < CS15_FLOWS; i++) {
+        uint8_t  pkt[64], lo;
+        uint32_t h;
+        port_id_t sel;
+        cs15_pkt(pkt, i, &h);
+        port0[i] = cs15_port(i, &lo);
+        TEST_ASSERT_OK(route_ecmp_select(CS15_GRP, h, &sel, NULL));
+        if (port0[i] != sel || lo != sel) mismatch++;
+        if (port0[i] >= 0 && port0[i] < 8) per_port[port0[i]]++;
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    for (int p = 1; p <= 4; p++)
+        TEST_ASSERT(per_port[p] > CS15_FLOWS / 4 * 3 / 4 && per_port[p] < CS15_FLOWS / 4 * 5 / 4);
+
+    // 成员表在 VLAN 出口之前：出口标签按 ECMP 选出的端口处理（只有 port 3 保留标签）
+    int vbad = 0;
+    for (int i = 0; i < 256; i++) {
+        uint8_t      vp[64];
+        uint32_t     h;
+        fwd_result_t vr;
+        uint16_t     vlen = cs15_pkt(vp, i, &h);
+        if (pkt_process(vp, vlen, 0, &vr) != 0 || vr.eg_port != port0[i]) { vbad++; continue; }
+        if (vr.vlan_action != (vr.eg_port == 3 ? VLAN_ACT_KEEP : VLAN_ACT_STRIP)) vbad++;
+    }
+    TEST_ASSERT_EQ(vbad, 0);
+
+    // 普通路由不经过成员表（ecmp_idx = 0 不命中）
+    static const uint8_t rmac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xFE};
+    static const uint8_t smac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x10};
+    uint8_t  pkt[64];
+    fwd_result_t r;
+    uint16_t len = build_ipv4_pkt(pkt, rmac, smac, 0, 0x01020304u, 0x14010101u, 6, 80);
+    TEST_ASSERT_EQ(pkt_process(pkt, len, 0, &r), 0);
+    TEST_ASSERT_EQ(r.eg_port, 9);
+
+    // 流缓存与流水线一致
+    pkt_flow_t *fc = pkt_flow_create(4096);
+    TEST_ASSERT_NOTNULL(fc);
+    int fc_err = 0;
+    for (int pass = 0; pass < 2; pass++)
+        for (int i = 0; i < 256; i++) {
+            uint32_t h;
+            len = cs15_pkt(pkt, i, &h);
+            if (pkt_flow_process(fc, pkt, len, 0, &r) != 0 || r.eg_port != port0[i]) fc_err++;
+        }
+    pkt_flow_stats_t fst;
+    pkt_flow_get_stats(fc, &fst);
+    pkt_flow_destroy(fc);
+    TEST_ASSERT_EQ(fc_err, 0);
+    TEST_ASSERT_EQ(fst.bypass, 0);
+    TEST_ASSERT(fst.hits >= 256);
+
+    // 删除端口 2：只有原先走端口 2 的流迁移
+    static int port1[CS15_FLOWS];
+    TEST_ASSERT_OK(route_ecmp_member_del(CS15_GRP, 2, 0x020000000002ULL));
+    int bad = 0;
+    for (int i = 0; i < CS15_FLOWS; i++) {
+        port1[i] = cs15_port(i, NULL);
+        if (port1[i] == 2 || port1[i] < 1 || port1[i] > 4) bad++;
+        else if (port0[i] != 2 && port1[i] != port0[i]) bad++;
+    }
+    TEST_ASSERT_EQ(bad, 0);
+
+    // 加入端口 5：迁移的流只去往端口 5，约占 1/4
+    TEST_ASSERT_OK(route_ecmp_member_add(CS15_GRP, 5, 0x020000000005ULL));
+    int moved = 0;
+    for (int i = 0; i < CS15_FLOWS; i++) {
+        int p = cs15_port(i, NULL);
+        if (p == port1[i]) continue;
+        moved++;
+        if (p != 5) bad++;
+    }
+    TEST_ASSERT_EQ(bad, 0);
+    TEST_ASSERT(moved > CS15_FLOWS / 8 && moved < CS15_FLOWS * 3 / 8);
+
+    // 撤销 ECMP 路由：ecmp_idx 保持 0，成员表不命中
+    TEST_ASSERT_OK(route_del(0x0A010000u, 16));
+    TEST_ASSERT_EQ(cs15_port(0, NULL), 0);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// CS-16: 解析器 RTL 格式 —— pkt_parser_to_rtl 转换后按 parser_tcam.sv / p4_parser.sv
+//        语义执行（pkt_parser_rtl_run），与模型 pkt_parser_run 逐字节一致
+// ─────────────────────────────────────────────
+
+#define CS16_PROGS  300
+#define CS16_PKTS   64
+
+static uint32_t cs16_seed;
+static uint32_t cs16_rand(void) {
+    cs16_seed = cs16_seed * 1103515245u + 12345u;
+    return cs16_seed >> 8;
+}
+
+// 窗口比较与报文字节取自同一小字母表，使条目有机会命中
+static uint8_t cs16_byte(void) {
+    static const uint8_t alpha[4] = { 0x00, 0x11, 0xA5, 0xFF };
+    uint32_t r = cs16_rand();
+    return (r & 3) ? alpha[(r >> 2) & 3] : (uint8_t)(r >> 4);
+}
+
+// 随机无环程序：状态 1..n_st，每状态 1-3 条，只转移到更大的状态或 ACCEPT
+static int cs16_gen_prog(fsm_entry_t *prog)
+{
+    int n = 0, n_st = 2 + (int)(cs16_rand() % 5);
+    for (int s = 1; s <= n_st; s++) {
+        int k = 1 + (int)(cs16_rand() % 3);
+        for (int j = 0; j < k; j++) {
+            fsm_entry_t *e = &prog[n++];
+            memset(e, 0, sizeof(*e));
+            e->cur_state = (uint8_t)s;
+            if (j < k - 1 || (cs16_rand() & 1)) {       // 末条有一半为通配兜底
+                int pos = (int)(cs16_rand() % 8);
+                e->key_window[pos] = cs16_byte();
+                e->key_mask[pos]   = (cs16_rand() & 1) ? 0xFF : 0xF0;
+            }
+            uint32_t r = cs16_rand();
+            e->next_state = (s == n_st || (r & 3) == 0)
+                          ? PKT_PARSER_ACCEPT
+                          : (uint8_t)(s + 1 + (int)((r >> 2) % (uint32_t)(n_st - s)));
+            e->extract_offset = (uint8_t)((r >> 8) % 8);
+            e->extract_len    = (uint8_t)((r >> 12) % 4);
+            e->hdr_advance    = (uint8_t)((r >> 16) % 9);
+            e->phv_dst_offset = (uint16_t)(cs16_rand() % 240);
+        }
+    }
+    return n;
+}
+
+static uint64_t cs16_bits(const pkt_parser_rtl_entry_t *e, int lo, int width)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < width; i++)
+        v |= (uint64_t)((e->w[(lo + i) / 32] >> ((lo + i) % 32)) & 1) << i;
+    return v;
+}
+
+void test_dp_cosim_parser_rtl(void)
+{
+    TEST_BEGIN("CS-16: 解析器 RTL 格式 — 掩码取反、绝对偏移、逐字节提取；随机程序与模型一致");
+
+    static pkt_parser_rtl_entry_t rtl[PKT_PARSER_ENTRIES];
+    static fsm_entry_t            prog[PKT_PARSER_ENTRIES];
+
+    // 1) 格式转换：状态 1 比较窗口第 1 字节高 4 位，前移 4；状态 2 提取相对偏移 2 起 3 字节
+    memset(prog, 0, 2 * sizeof(prog[0]));
+    prog[0].cur_state     = PKT_PARSER_START;
+    prog[0].key_window[1] = 0xA0;
+    prog[0].key_mask[1]   = 0xF0;
+    prog[0].next_state    = 2;
+    prog[0].hdr_advance   = 4;
+    prog[1].cur_state      = 2;
+    prog[1].next_state     = PKT_PARSER_ACCEPT;
+    prog[1].extract_offset = 2;
+    prog[1].extract_len    = 3;
+    prog[1].phv_dst_offset = 10;
+    int n = pkt_parser_to_rtl(prog, 2, rtl, PKT_PARSER_ENTRIES);
+    TEST_ASSERT_EQ(n, 4);                                   // 1 + 3 字节链
+    int first = -1, seen = 0;
+    for (int i = 0; i < n; i++) {
+        if (cs16_bits(&rtl[i], 634, 6) == PKT_PARSER_START) {
+            TEST_ASSERT_EQ(cs16_bits(&rtl[i], 442, 64), ~0xF000ULL);   // don't-care 掩码
+            TEST_ASSERT_EQ(cs16_bits(&rtl[i], 570, 64), 0xA000ULL);
+            TEST_ASSERT_EQ(cs16_bits(&rtl[i], 410, 10), PKT_PARSER_RTL_SCRATCH);
+            TEST_ASSERT_EQ(cs16_bits(&rtl[i], 402, 8), 4);
+        }
+        if (cs16_bits(&rtl[i], 410, 10) == 10) first = i;
+        if (cs16_bits(&rtl[i], 410, 10) >= 10 && cs16_bits(&rtl[i], 410, 10) <= 12)
+            seen |= 1 << (int)(cs16_bits(&rtl[i], 428, 8) - 6);   // 绝对偏移 4 + 2 起
+        TEST_ASSERT_EQ(cs16_bits(&rtl[i], 401, 1), 1);
+    }
+    TEST_ASSERT(first >= 0);
+    TEST_ASSERT_EQ(seen, 7);
+
+    uint8_t pkt[PKT_PARSER_RTL_CELL], hdr[PHV_OFF_IG_PORT];
+    uint8_t phv[PKT_PARSER_RTL_SCRATCH + 1];
+    for (int i = 0; i < PKT_PARSER_RTL_CELL; i++) pkt[i] = (uint8_t)(0x30 + i);
+    pkt[1] = 0xA7;
+    memset(phv, 0, sizeof(phv));
+    TEST_ASSERT_EQ(pkt_parser_rtl_run(rtl, n, pkt, sizeof(pkt), phv), 0);
+    TEST_ASSERT_EQ(phv[10], 0x36);
+    TEST_ASSERT_EQ(phv[12], 0x38);
+    pkt[1] = 0x57;                                          // 高 4 位不等 → 未命中
+    TEST_ASSERT_EQ(pkt_parser_rtl_run(rtl, n, pkt, sizeof(pkt), phv), -1);
+
+    // 2) 不可表示：环路；比较窗口越出首个 cell；
+    //    内置程序（20 字节 IPv4 头逐字节拆开超出 62 个 RTL 状态）
+    prog[1].next_state = 2;
+    TEST_ASSERT_EQ(pkt_parser_to_rtl(prog, 2, rtl, PKT_PARSER_ENTRIES), -1);
+    prog[0].hdr_advance = 60;
+    prog[1].next_state  = PKT_PARSER_ACCEPT;
+    prog[1].extract_len = 0;
+    TEST_ASSERT_EQ(pkt_parser_to_rtl(prog, 2, rtl, PKT_PARSER_ENTRIES), 2);
+    prog[1].key_mask[4] = 0xFF;                             // 60 + 4 = 64
+    TEST_ASSERT_EQ(pkt_parser_to_rtl(prog, 2, rtl, PKT_PARSER_ENTRIES), -1);
+    pkt_parser_reset();
+    n = 0;
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++)
+        if (pkt_parser_read(i, &prog[n]) == 0) n++;
+    TEST_ASSERT_EQ(n, pkt_parser_count());
+    TEST_ASSERT_EQ(pkt_parser_to_rtl(prog, n, rtl, PKT_PARSER_ENTRIES), -1);
+
+    // 3) 随机程序：同一程序装入模型并转换，随机 64 字节帧逐字节比较
+    cs16_seed = 16;
+    int conv = 0, bad = 0, accepted = 0;
+    for (int t = 0; t < CS16_PROGS; t++) {
+        int np = cs16_gen_prog(prog);
+        int nr = pkt_parser_to_rtl(prog, np, rtl, PKT_PARSER_ENTRIES);
+        if (nr < 0) continue;
+        conv++;
+        pkt_parser_clear();
+        for (int i = 0; i < np; i++) TEST_ASSERT_OK(pkt_parser_write(i, &prog[i]));
+        for (int k = 0; k < CS16_PKTS; k++) {
+            for (int i = 0; i < PKT_PARSER_RTL_CELL; i++) pkt[i] = cs16_byte();
+            memset(hdr, 0, sizeof(hdr));
+            memset(phv, 0, sizeof(phv));
+            int rm = pkt_parser_run(pkt_parser_current(), pkt, sizeof(pkt), hdr);
+            int rr = pkt_parser_rtl_run(rtl, nr, pkt, sizeof(pkt), phv);
+            if (rm != rr || (rm == 0 && memcmp(hdr, phv, sizeof(hdr)) != 0)) bad++;
+            if (rm == 0) accepted++;
+        }
+    }
+    pkt_parser_reset();
+    TEST_ASSERT_EQ(bad, 0);
+    TEST_ASSERT(conv > CS16_PROGS / 2);
+    TEST_ASSERT(accepted > conv * CS16_PKTS / 8);           // 命中与未命中都有覆盖
+    TEST_ASSERT(accepted < conv * CS16_PKTS);
+
+    TEST_END();
+}
@@ -1,5 +1,5 @@
 // test_integration.c
-// 集成测试 / 系统测试（6 个场景）
+// 集成测试 / 系统测试（7 个场景）
 //
 //   IT-SYS-1: 全量初始化 — 所有模块同时初始化，Stage 分配正确，无 TCAM 溢出
 //   IT-SYS-2: ARP Request Punt → arp_process_pkt → Reply 内容 + ARP表 + FDB 联动
@@ -7,6 +7,7 @@
 //   IT-SYS-4: arp_delete → FDB TCAM 联动清理        【已知缺陷，预期 FAIL】
 //   IT-SYS-5: Route(Stage0) + ACL(Stage1) + FDB(Stage2) 三模块共存互不干扰
 //   IT-SYS-6: CLI 多命令序列 → 三个 Stage TCAM 同时生效
+//   IT-SYS-7: FDB (MAC, VLAN) 哈希表 — 无槽位混叠、95% 装载、满表拒绝不改表
 
 #include <string.h>
 #include "test_framework.h"
@@ -91,7 +92,7 @@ void test_sys_full_init(void)
      * 预期 TCAM 布局（全量初始化后，未执行任何 cp_main 业务配置）：
      *   Stage 3（ARP Punt）:  1 条（install_arp_punt_rule）
      *   Stage 5（DSCP 映射）: 64 条（qos_init → qos_apply_dscp_rules）
-     *   Stage 6（VLAN 出口）: 32 条（vlan_init → 对 VLAN 1 的 32 端口各一条出口规则）
+     *   Stage 7（VLAN 出口）: 32 条（vlan_init → 对 VLAN 1 的 32 端口各一条出口规则）
      *   Stage 0/1/2（路由/ACL/FDB）: 0 条（尚未写入任何规则）
      */
     TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_ARP_TRAP_STAGE),     1);
@@ -187,10 +188,10 @@ void test_sys_arp_request_flow(void)
     TEST_ASSERT_EQ(learned_port,   0);
 
     /* ── 验证 FDB TCAM 学习到请求方（跨模块：arp → fdb → TCAM） */
-    /* req_mac = 0xAABBCCDDEEFF；低 12 位 = 0xEFF                 */
-    uint16_t fdb_tid = TABLE_L2_FDB_BASE
-                     + (uint16_t)(0xAABBCCDDEEFFULL & 0xFFF);
-    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE, fdb_tid);
+    /* req_mac = 0xAABBCCDDEEFF，VLAN 10；table_id 由 FDB 哈希表分配  */
+    int fdb_tid = fdb_tcam_slot(0xAABBCCDDEEFFULL, 10);
+    TEST_ASSERT(fdb_tid >= 0);
+    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)fdb_tid);
     TEST_ASSERT_NOTNULL(fdb_r);
     TEST_ASSERT_EQ(fdb_r->entry.action_id,          ACTION_L2_FORWARD);
     TEST_ASSERT_EQ(fdb_r->entry.action_params[0],   0);  /* 出端口 = 0 */
@@ -241,10 +242,10 @@ void test_sys_arp_fdb_correlation(void)
     TEST_ASSERT_EQ(out_port,   5);
 
     /* ── FDB TCAM 验证 ──────────────────────────────────────────── */
-    /* peer_mac = 0xCCDDEEFF0011；低 12 位 = 0x011               */
-    uint16_t fdb_tid = TABLE_L2_FDB_BASE
-                     + (uint16_t)(0xCCDDEEFF0011ULL & 0xFFF);
-    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE, fdb_tid);
+    /* peer_mac = 0xCCDDEEFF0011，VLAN 20；table_id 由 FDB 哈希表分配  */
+    int fdb_tid = fdb_tcam_slot(0xCCDDEEFF0011ULL, 20);
+    TEST_ASSERT(fdb_tid >= 0);
+    sim_tcam_rec_t *fdb_r = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)fdb_tid);
     TEST_ASSERT_NOTNULL(fdb_r);
     TEST_ASSERT_EQ(fdb_r->entry.action_id,          ACTION_L2_FORWARD);
     TEST_ASSERT_EQ(fdb_r->entry.action_params[0],   5);  /* 出端口 = 5 */
@@ -285,8 +286,10 @@ void test_sys_arp_delete_fdb_cleanup(void)
     /* 前置确认：ARP 表可查 */
     TEST_ASSERT_EQ(arp_lookup(ip_a, NULL, NULL), HAL_OK);
 
-    /* 前置确认：FDB TCAM 存在（0x001122334455 & 0xFFF = 0x455） */
-    uint16_t fdb_tid = TABLE_L2_FDB_BASE + 0x455u;
+    /* 前置确认：FDB TCAM 存在（(0x001122334455, VLAN 10) 所在槽） */
+    int fdb_slot = fdb_tcam_slot(0x001122334455ULL, 10);
+    TEST_ASSERT(fdb_slot >= 0);
+    uint16_t fdb_tid = (uint16_t)fdb_slot;
     TEST_ASSERT_NOTNULL(sim_tcam_find(TABLE_L2_FDB_STAGE, fdb_tid));
 
     /* 删除 ARP 条目 */
@@ -337,8 +340,10 @@ void test_sys_multimodule_coexist(void)
 
     /* ── 各 Stage 内容正确性 ─────────────────────────────────── */
 
-    /* Route：table_id = LPM_BASE + (0x0A000000 >> 24) = 10 */
-    sim_tcam_rec_t *r_r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u);
+    /* Route：table_id 由 route 模块的 TCAM 布局分配 */
+    int route_tid = route_tcam_slot(0x0A000000u, 8);
+    TEST_ASSERT(route_tid >= 0);
+    sim_tcam_rec_t *r_r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)route_tid);
     TEST_ASSERT_NOTNULL(r_r);
     TEST_ASSERT_EQ(r_r->entry.action_id,          ACTION_FORWARD);
     TEST_ASSERT_EQ(r_r->entry.action_params[0],   2);     /* 出端口 = 2 */
@@ -356,9 +361,10 @@ void test_sys_multimodule_coexist(void)
     /* dport = 80 = 0x0050；bytes[9] = 0x50 */
     TEST_ASSERT_EQ(r_a->entry.key.bytes[9], 80);
 
-    /* FDB：table_id = FDB_BASE + (0x001122334455 & 0xFFF) = 0x455 */
-    sim_tcam_rec_t *r_f = sim_tcam_find(TABLE_L2_FDB_STAGE,
-                                         TABLE_L2_FDB_BASE + 0x455u);
+    /* FDB：table_id 由 FDB 哈希表按 (MAC, VLAN) 分配 */
+    int fdb_tid = fdb_tcam_slot(0x001122334455ULL, 10);
+    TEST_ASSERT(fdb_tid >= 0);
+    sim_tcam_rec_t *r_f = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)fdb_tid);
     TEST_ASSERT_NOTNULL(r_f);
     TEST_ASSERT_EQ(r_f->entry.action_id,          ACTION_L2_FORWARD);
     TEST_ASSERT_EQ(r_f->entry.action_params[0],   0);     /* 出端口 = 0 */
@@ -405,10 +411,10 @@ void test_sys_cli_sequence(void)
     }
 
     /* ── Stage 0：192.168.0.0/16 路由 ───────────────────────── */
-    /* table_id = LPM_BASE + (0xC0A80000 >> 16) = 0xC0A8          */
-    uint16_t route_tid = (uint16_t)(TABLE_IPV4_LPM_BASE
-                                    + (0xC0A80000u >> 16));
-    sim_tcam_rec_t *r_r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, route_tid);
+    /* table_id 由 route 模块的 TCAM 布局分配                    */
+    int route_tid = route_tcam_slot(0xC0A80000u, 16);
+    TEST_ASSERT(route_tid >= 0);
+    sim_tcam_rec_t *r_r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)route_tid);
     TEST_ASSERT_NOTNULL(r_r);
     TEST_ASSERT_EQ(r_r->entry.action_id,          ACTION_FORWARD);
     TEST_ASSERT_EQ(r_r->entry.action_params[0],   1);     /* 出端口 = 1 */
@@ -425,7 +431,7 @@ void test_sys_cli_sequence(void)
     TEST_ASSERT_EQ(r_a->entry.key.bytes[8], 0x01);
     TEST_ASSERT_EQ(r_a->entry.key.bytes[9], 0xBB);
 
-    /* ── Stage 6：VLAN 200 port 7 tagged 出口规则 ───────────── */
+    /* ── Stage 7：VLAN 200 port 7 tagged 出口规则 ───────────── */
     /* table_id = VLAN_EGRESS_ENTRY(7, 200) = 7*256 + 200 = 1992   */
     uint16_t eg_tid = (uint16_t)(7u * 256u + 200u);
     sim_tcam_rec_t *r_v = sim_tcam_find(TABLE_VLAN_EGRESS_STAGE, eg_tid);
@@ -439,3 +445,114 @@ void test_sys_cli_sequence(void)
 
     TEST_END();
 }
+
+// ─────────────────────────────────────────────
+// IT-SYS-7: FDB (MAC, VLAN) 哈希表 — 低位相同的 MAC 不混叠、高装载率、满表不变
+// ─────────────────────────────────────────────
+static uint64_t sys7_rng = 0x2545F4914F6CDD1DULL;
+static uint64_t sys7_next(void)
+{
+    sys7_rng ^= sys7_rng >> 12;
+    sys7_rng ^= sys7_rng << 25;
+    sys7_rng ^= sys7_rng >> 27;
+    return sys7_rng * 0x2545F4914F6CDD1DULL;
+}
+
+/* 条目在软件表与其 TCAM 槽上一致（key = MAC，出端口 = port） */
+static int sys7_check(uint64_t mac, uint16_t vlan, uint8_t port)
+{
+    fdb_entry_t e;
+    int tid = fdb_tcam_slot(mac, vlan);
+    if (tid < 0 || fdb_lookup(mac, vlan, &e) != HAL_OK || e.port != port) return -1;
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_L2_FDB_STAGE, (uint16_t)tid);
+    if (!r || r->entry.action_params[0] != port) return -1;
+    for (int i = 0; i < 6; i++)
+        if (r->entry.key.bytes[i] != (uint8_t)(mac >> (40 - 8 * i))) return -1;
+    return 0;
+}
+
+void test_sys_fdb_hash(void)
+{
+    TEST_BEGIN("SYS-7 : FDB (MAC,VLAN) 哈希 — 无槽位混叠，95% 装载，满表不变");
+
+    static uint64_t macs[FDB_TABLE_SIZE];
+    static uint16_t vlans[FDB_TABLE_SIZE];
+    fdb_stats_t st;
+
+    sim_hal_reset();
+    fdb_init();
+
+    /* 低 12 位相同（旧实现同一 table_id）的两个 MAC 各占一个槽 */
+    TEST_ASSERT_OK(fdb_learn(0x001122334455ULL, 10, 3));
+    TEST_ASSERT_OK(fdb_learn(0x00AABBCC0455ULL, 10, 4));
+    TEST_ASSERT(fdb_tcam_slot(0x001122334455ULL, 10) != fdb_tcam_slot(0x00AABBCC0455ULL, 10));
+    TEST_ASSERT_EQ(sys7_check(0x001122334455ULL, 10, 3), 0);
+    TEST_ASSERT_EQ(sys7_check(0x00AABBCC0455ULL, 10, 4), 0);
+
+    /* 同一 MAC 在两个 VLAN 中是两条独立条目 */
+    TEST_ASSERT_OK(fdb_learn(0x001122334455ULL, 20, 5));
+    TEST_ASSERT_EQ(sys7_check(0x001122334455ULL, 10, 3), 0);
+    TEST_ASSERT_EQ(sys7_check(0x001122334455ULL, 20, 5), 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_L2_FDB_STAGE), 3);
+    TEST_ASSERT_OK(fdb_delete(0x001122334455ULL, 10));
+    TEST_ASSERT_EQ(fdb_lookup(0x001122334455ULL, 10, NULL), -1);
+    TEST_ASSERT_EQ(sys7_check(0x001122334455ULL, 20, 5), 0);
+    TEST_ASSERT_EQ(fdb_delete(0x001122334455ULL, 10), HAL_ERR_INVAL);
+
+    /* 随机 (MAC, VLAN) 装到 95%：全部成功，每条都在自己的 TCAM 槽上 */
+    sim_hal_reset();
+    fdb_init();
+    int n = 0, fail = 0;
+    while (n < FDB_TABLE_SIZE * 95 / 100) {
+        uint64_t r = sys7_next();
+        macs[n]  = r & 0xFFFFFFFFFFFFULL;
+        vlans[n] = (uint16_t)(1 + (r >> 48) % 8);
+        if (fdb_lookup(macs[n], vlans[n], NULL) == HAL_OK) continue;
+        fail += fdb_learn(macs[n], vlans[n], (uint8_t)(n % 32)) != HAL_OK;
+        n++;
+    }
+    TEST_ASSERT_EQ(fail, 0);
+    fdb_get_stats(&st);
+    TEST_ASSERT_EQ((int)st.entries, n);
+    TEST_ASSERT(st.moves > 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_L2_FDB_STAGE), n);
+    int bad = 0;
+    for (int i = 0; i < n; i++)
+        bad += sys7_check(macs[i], vlans[i], (uint8_t)(i % 32)) != 0;
+    TEST_ASSERT_EQ(bad, 0);
+
+    /* 继续装直到 HAL_ERR_FULL：拒绝时软件表与 TCAM 都不变 */
+    int rc = HAL_OK;
+    while (n < FDB_TABLE_SIZE) {
+        uint64_t r = sys7_next();
+        macs[n]  = r & 0xFFFFFFFFFFFFULL;
+        vlans[n] = (uint16_t)(1 + (r >> 48) % 8);
+        if (fdb_lookup(macs[n], vlans[n], NULL) == HAL_OK) continue;
+        fdb_get_stats(&st);
+        rc = fdb_learn(macs[n], vlans[n], (uint8_t)(n % 32));
+        if (rc != HAL_OK) break;
+        n++;
+    }
+    if (rc != HAL_OK) {
+        fdb_stats_t st2;
+        fdb_get_stats(&st2);
+        TEST_ASSERT_EQ(rc, HAL_ERR_FULL);
+        TEST_ASSERT_EQ(st2.entries, st.entries);
+        TEST_ASSERT_EQ(st2.moves,   st.moves);
+        TEST_ASSERT_EQ(st2.full,    1u);
+        TEST_ASSERT_EQ(fdb_lookup(macs[n], vlans[n], NULL), -1);
+    }
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_L2_FDB_STAGE), n);
+    bad = 0;
+    for (int i = 0; i < n; i++)
+        bad += sys7_check(macs[i], vlans[i], (uint8_t)(i % 32)) != 0;
+    TEST_ASSERT_EQ(bad, 0);
+
+    /* 全部删除后 Stage 2 为空 */
+    for (int i = 0; i < n; i++)
+        bad += fdb_delete(macs[i], vlans[i]) != HAL_OK;
+    TEST_ASSERT_EQ(bad, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_L2_FDB_STAGE), 0);
+
+    TEST_END();
+}
@@ -42,6 +42,12 @@ void test_qos_port_pir_mode(void);
 void test_route_add_del(void);
 void test_route_host(void);
 void test_route_default(void);
+void test_route_lookup(void);
+void test_route_trie_random(void);
+void test_route_tcam_layout(void);
+void test_route_ecmp(void);
+void test_route_bulk(void);
+void test_route_del_fail(void);
 
 /* ACL */
 void test_acl_deny(void);
@@ -64,6 +70,12 @@ void test_sys_arp_fdb_correlation(void);
 void test_sys_arp_delete_fdb_cleanup(void);
 void test_sys_multimodule_coexist(void);
 void test_sys_cli_sequence(void);
+void test_sys_fdb_hash(void);
+
+/* 模拟 TCAM 存储 */
+void test_sim_tcam_slot_reuse(void);
+void test_sim_tcam_growth(void);
+void test_sim_tcam_ref_lookup(void);
 
 /* 数据面 + 控制面联合测试 (Co-Simulation) */
 void test_dp_cosim_route_forward(void);
@@ -73,6 +85,21 @@ void test_dp_cosim_arp_punt(void);
 void test_dp_cosim_dscp_qos(void);
 void test_dp_cosim_vlan_ingress(void);
 void test_dp_cosim_full_pipeline(void);
+void test_dp_cosim_burst(void);
+void test_dp_cosim_mt_snapshot(void);
+void test_dp_cosim_prog_load(void);
+void test_dp_cosim_flow_cache(void);
+void test_dp_cosim_punt_spsc(void);
+void test_dp_cosim_tcam_priority(void);
+void test_dp_cosim_parser_prog(void);
+void test_dp_cosim_ecmp(void);
+void test_dp_cosim_parser_rtl(void);
+
+/* 流量管理器排队模型 */
+void test_tm_dwrr_share(void);
+void test_tm_sp_priority(void);
+void test_tm_pir_buffer(void);
+void test_tm_fwd_result(void);
 
 // ─────────────────────────────────────────────
 // main
@@ -110,10 +137,16 @@ int main(void) {
     test_qos_port_pir_mode();
 
     // ── Route 测试套件 ────────────────────────
-    TEST_SUITE("IPv4 Routing (3 cases)");
+    TEST_SUITE("IPv4 Routing (9 cases)");
     test_route_add_del();
     test_route_host();
     test_route_default();
+    test_route_lookup();
+    test_route_trie_random();
+    test_route_tcam_layout();
+    test_route_ecmp();
+    test_route_bulk();
+    test_route_del_fail();
 
     // ── ACL 测试套件 ──────────────────────────
     TEST_SUITE("ACL Rules (4 cases)");
@@ -132,16 +165,23 @@ int main(void) {
     test_cli_vlan_port();
 
     // ── 集成 / 系统测试套件 ──────────────────
-    TEST_SUITE("Integration / System (6 cases)");
+    TEST_SUITE("Integration / System (7 cases)");
     test_sys_full_init();
     test_sys_arp_request_flow();
     test_sys_arp_fdb_correlation();
     test_sys_arp_delete_fdb_cleanup();   /* 已知缺陷：预期 FAIL */
     test_sys_multimodule_coexist();
     test_sys_cli_sequence();
+    test_sys_fdb_hash();
+
+    // ── 模拟 TCAM 存储 ────────────────────────
+    TEST_SUITE("Sim TCAM Store (3 cases)");
+    test_sim_tcam_slot_reuse();
+    test_sim_tcam_growth();
+    test_sim_tcam_ref_lookup();
 
     // ── 数据面 + 控制面联合测试 ──────────────
-    TEST_SUITE("Data-Plane Co-Sim (7 cases)");
+    TEST_SUITE("Data-Plane Co-Sim (16 cases)");
     test_dp_cosim_route_forward();
     test_dp_cosim_acl_deny();
     test_dp_cosim_fdb_forward();
@@ -149,6 +189,22 @@ int main(void) {
     test_dp_cosim_dscp_qos();
     test_dp_cosim_vlan_ingress();
     test_dp_cosim_full_pipeline();
+    test_dp_cosim_burst();
+    test_dp_cosim_mt_snapshot();
+    test_dp_cosim_prog_load();
+    test_dp_cosim_flow_cache();
+    test_dp_cosim_punt_spsc();
+    test_dp_cosim_tcam_priority();
+    test_dp_cosim_parser_prog();
+    test_dp_cosim_ecmp();
+    test_dp_cosim_parser_rtl();
+
+    // ── 流量管理器排队模型 ────────────────────
+    TEST_SUITE("Traffic Manager Model (4 cases)");
+    test_tm_dwrr_share();
+    test_tm_sp_priority();
+    test_tm_pir_buffer();
+    test_tm_fwd_result();
 
     // ── 汇总 ─────────────────────────────────
     int total = g_pass + g_fail;
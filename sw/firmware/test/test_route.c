@@ -1,13 +1,21 @@
 // test_route.c
-// 路由表模块测试用例（3 个）
+// 路由表模块测试用例（9 个）
 //
-//   1. test_route_add_del     — add 安装 TCAM 规则，del 撤销
-//   2. test_route_host        — /32 主机路由编码正确
+//   1. test_route_add_del     — add 安装 TCAM 规则，del 撤销；不同前缀不共用条目
+//   2. test_route_host        — /32 主机路由编码正确，排在覆盖它的短前缀之前
 //   3. test_route_default     — /0 默认路由（0.0.0.0/0）边界处理
+//   4. test_route_lookup      — 软件 LPM 查找、下一跳共享、主机位忽略
+//   5. test_route_trie_random — 随机增删与穷举参考一致，节点全部回收
+//   6. test_route_tcam_layout — 小 TCAM 区间内随机增删：按长度排序、挪动次数有界、
+//                               TCAM 查找结果与穷举 LPM 一致
+//   7. test_route_ecmp        — ECMP 组：成员表条目、桶均衡、增删成员只改写必要的桶
+//   8. test_route_bulk        — 批量增删：布局与逐条一致，每批只排空一次，提交前不生效
+//   9. test_route_del_fail    — TCAM 写入失败的删除保留路由、其余路由不受影响，可重试
 
 #include <string.h>
 #include "test_framework.h"
 #include "sim_hal.h"
+#include "sim_tcam.h"
 #include "route.h"
 #include "table_map.h"
 
@@ -24,8 +32,10 @@ void test_route_add_del(void) {
     uint64_t dmac = 0xAABBCCDDEEFFULL;
     TEST_ASSERT_OK(route_add(0x0A000000u, 8, 2, dmac));
 
-    /* TCAM 中的 table_id = TABLE_IPV4_LPM_BASE + (0x0A000000 >> 24) = 0x0A = 10 */
-    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u);
+    /* table_id 由布局管理器分配，落在默认区间内 */
+    int tid = route_tcam_slot(0x0A000000u, 8);
+    TEST_ASSERT(tid >= TABLE_IPV4_LPM_BASE && tid < TABLE_IPV4_LPM_BASE + ROUTE_TCAM_SLOTS);
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
     TEST_ASSERT_NOTNULL(r);
     TEST_ASSERT_EQ(r->entry.action_id,         ACTION_FORWARD);
     TEST_ASSERT_EQ(r->entry.action_params[0],  2);      /* port */
@@ -41,10 +51,21 @@ void test_route_add_del(void) {
     TEST_ASSERT_EQ(r->entry.mask.bytes[0], 0xFF);
     TEST_ASSERT_EQ(r->entry.mask.bytes[1], 0x00);
 
+    /* 0.10.0.0/16 按前缀推导 table_id 时与 10.0.0.0/8 冲突；现在各占一条，/16 在前 */
+    TEST_ASSERT_OK(route_add(0x000A0000u, 16, 4, dmac));
+    int tid16 = route_tcam_slot(0x000A0000u, 16);
+    TEST_ASSERT(tid16 >= 0 && tid16 < tid);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 2);
+    TEST_ASSERT_EQ(sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid)->entry.action_params[0], 2);
+
     /* 删除后条目被标记为 deleted */
+    TEST_ASSERT_OK(route_del(0x000A0000u, 16));
     TEST_ASSERT_OK(route_del(0x0A000000u, 8));
-    sim_tcam_rec_t *r2 = sim_tcam_find(TABLE_IPV4_LPM_STAGE, 10u);
+    sim_tcam_rec_t *r2 = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
     TEST_ASSERT(r2 == NULL);   /* deleted 后 find 返回 NULL */
+    TEST_ASSERT_EQ(route_tcam_slot(0x0A000000u, 8), -1);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 0);
+    TEST_ASSERT_NE(route_del(0x0A000000u, 8), HAL_OK);
 
     TEST_END();
 }
@@ -53,19 +74,20 @@ void test_route_add_del(void) {
 // TC-ROUTE-2: /32 主机路由
 // ─────────────────────────────────────────────
 void test_route_host(void) {
-    TEST_BEGIN("ROUTE-2: /32 host route has correct table_id and full mask");
+    TEST_BEGIN("ROUTE-2: /32 host route has full mask and precedes covering /24");
 
     sim_hal_reset();
     route_init();
 
-    /* 192.168.1.1/32 → port 5 */
+    /* 先装覆盖它的 /24，再装 192.168.1.1/32 → port 5 */
+    TEST_ASSERT_OK(route_add(0xC0A80100u, 24, 6, 0x001122334466ULL));
     TEST_ASSERT_OK(route_add(0xC0A80101u, 32, 5, 0x001122334455ULL));
 
-    /* table_id = TABLE_IPV4_LPM_BASE + (0xC0A80101 >> 0) = 0xC0A80101 的低 16 位 */
-    /* = 0xC0A80101 >> (32-32) = 0xC0A80101 */
-    /* 但 table_id 是 uint16_t，所以截断为 0x0101 */
-    uint16_t expected_tid = (uint16_t)(TABLE_IPV4_LPM_BASE + 0x0101u);
-    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, expected_tid);
+    /* 最小 table_id 优先：/32 必须排在 /24 之前 */
+    int tid   = route_tcam_slot(0xC0A80101u, 32);
+    int tid24 = route_tcam_slot(0xC0A80100u, 24);
+    TEST_ASSERT(tid >= 0 && tid < tid24);
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
     TEST_ASSERT_NOTNULL(r);
 
     /* mask = /32 → 全 0xFF */
@@ -73,6 +95,12 @@ void test_route_host(void) {
     TEST_ASSERT_EQ(r->entry.mask.bytes[3], 0xFF);
     TEST_ASSERT_EQ(r->entry.action_params[0], 5);
 
+    /* 0.0.1.1/32 的低 16 位与 192.168.1.1 相同，不再覆盖同一条目 */
+    TEST_ASSERT_OK(route_add(0x00000101u, 32, 1, 0x001122334411ULL));
+    TEST_ASSERT_NE(route_tcam_slot(0x00000101u, 32), tid);
+    TEST_ASSERT_EQ(sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid)->entry.action_params[0], 5);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 3);
+
     TEST_END();
 }
 
@@ -87,9 +115,13 @@ void test_route_default(void) {
 
     TEST_ASSERT_OK(route_add(0x00000000u, 0, 7, 0x0011223344FFull));
 
-    /* table_id = TABLE_IPV4_LPM_BASE + 0 = 0 */
-    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, TABLE_IPV4_LPM_BASE);
+    /* /0 组位于区间末尾，其他路由都排在它之前 */
+    int tid = route_tcam_slot(0x00000000u, 0);
+    TEST_ASSERT_EQ(tid, TABLE_IPV4_LPM_BASE + ROUTE_TCAM_SLOTS - 1);
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
     TEST_ASSERT_NOTNULL(r);
+    TEST_ASSERT_OK(route_add(0x80000000u, 1, 6, 0x0011223344FEull));
+    TEST_ASSERT(route_tcam_slot(0x80000000u, 1) < tid);
 
     /* mask = /0 → 全 0x00（通配） */
     TEST_ASSERT_EQ(r->entry.mask.bytes[0], 0x00);
@@ -100,3 +132,537 @@ void test_route_default(void) {
 
     TEST_END();
 }
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-4: route_lookup 最长前缀匹配 + 下一跳去重
+// ─────────────────────────────────────────────
+void test_route_lookup(void) {
+    TEST_BEGIN("ROUTE-4: route_lookup LPM, next-hop sharing, host bits ignored");
+
+    sim_hal_reset();
+    route_init();
+
+    route_info_t ri;
+    route_stats_t st;
+    TEST_ASSERT_EQ(route_lookup(0x0A010203u, &ri), -1);
+
+    TEST_ASSERT_OK(route_add(0x0A000000u,  8, 1, 0x0200000000A1ULL));
+    TEST_ASSERT_OK(route_add(0x0A010000u, 16, 1, 0x0200000000A1ULL));
+    TEST_ASSERT_OK(route_add(0x0A0102FFu, 24, 3, 0x0200000000A3ULL));   /* 主机位被忽略 */
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes,    3);
+    TEST_ASSERT_EQ(st.next_hops, 2);
+
+    TEST_ASSERT_OK(route_lookup(0x0A010203u, &ri));
+    TEST_ASSERT_EQ(ri.prefix, 0x0A010200u);
+    TEST_ASSERT_EQ(ri.len,    24);
+    TEST_ASSERT_EQ(ri.port,   3);
+    TEST_ASSERT_OK(route_lookup(0x0A01FF01u, &ri));
+    TEST_ASSERT_EQ(ri.len,    16);
+    TEST_ASSERT_OK(route_lookup(0x0A7F0001u, &ri));
+    TEST_ASSERT_EQ(ri.len,    8);
+    TEST_ASSERT_EQ(ri.dmac,   0x0200000000A1ULL);
+    TEST_ASSERT_EQ(route_lookup(0x0B000001u, &ri), -1);
+
+    /* 更新下一跳：原下一跳仍被 /8 引用 */
+    TEST_ASSERT_OK(route_add(0x0A010000u, 16, 2, 0x0200000000A2ULL));
+    TEST_ASSERT_OK(route_lookup(0x0A01FF01u, &ri));
+    TEST_ASSERT_EQ(ri.port, 2);
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes,    3);
+    TEST_ASSERT_EQ(st.next_hops, 3);
+
+    /* 默认路由兜底；删除 /24 后回落到 /16 */
+    TEST_ASSERT_OK(route_add(0x00000000u, 0, 7, 0x0200000000A7ULL));
+    TEST_ASSERT_OK(route_lookup(0x0B000001u, &ri));
+    TEST_ASSERT_EQ(ri.port, 7);
+    TEST_ASSERT_OK(route_del(0x0A0102AAu, 24));
+    TEST_ASSERT_OK(route_lookup(0x0A010203u, &ri));
+    TEST_ASSERT_EQ(ri.len, 16);
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes,    3);
+    TEST_ASSERT_EQ(st.next_hops, 3);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-5: 随机增删与穷举参考一致，节点全部回收
+// ─────────────────────────────────────────────
+
+#define RT5_MAX  512
+
+typedef struct { uint32_t pfx; uint8_t len; uint8_t port; } rt5_route_t;
+
+static uint32_t rt5_seed = 12345u;
+static uint32_t rt5_rand(void) {
+    rt5_seed = rt5_seed * 1103515245u + 12345u;
+    return rt5_seed >> 8;
+}
+
+static uint32_t rt5_mask(uint8_t len) {
+    return len ? 0xFFFFFFFFu << (32 - len) : 0;
+}
+
+/* 参考实现：线性扫描最长前缀 */
+static int rt5_ref(const rt5_route_t *t, int n, uint32_t addr) {
+    int best = -1;
+    for (int i = 0; i < n; i++)
+        if (((addr ^ t[i].pfx) & rt5_mask(t[i].len)) == 0 &&
+            (best < 0 || t[i].len > t[best].len))
+            best = i;
+    return best;
+}
+
+void test_route_trie_random(void) {
+    TEST_BEGIN("ROUTE-5: random add/del matches brute-force LPM; nodes reclaimed");
+
+    sim_hal_reset();
+    route_init();
+
+    static rt5_route_t tab[RT5_MAX];
+    int n = 0, mismatch = 0;
+
+    /* 前缀集中在 10.0.0.0/12 内，长度 4-32，制造大量嵌套与分叉 */
+    for (int op = 0; op < 6000; op++) {
+        if (n > 0 && (rt5_rand() % 3 == 0 || n == RT5_MAX)) {
+            int k = (int)(rt5_rand() % (uint32_t)n);
+            route_del(tab[k].pfx, tab[k].len);
+            tab[k] = tab[--n];
+            continue;
+        }
+        uint8_t  len = (uint8_t)(4 + rt5_rand() % 29);
+        uint32_t pfx = (0x0A000000u | (rt5_rand() & 0x000FFFFFu)) & rt5_mask(len);
+        uint8_t  port = (uint8_t)(rt5_rand() % 8);
+        int k;
+        for (k = 0; k < n; k++)
+            if (tab[k].pfx == pfx && tab[k].len == len) break;
+        if (k == n) n++;
+        tab[k].pfx = pfx; tab[k].len = len; tab[k].port = port;
+        route_add(pfx, len, port, 0x020000000000ULL | port);
+
+        if (op % 500 == 499) {
+            for (int q = 0; q < 400; q++) {
+                uint32_t addr = 0x0A000000u | (rt5_rand() & 0x001FFFFFu);
+                route_info_t ri;
+                int ref = rt5_ref(tab, n, addr);
+                int rc  = route_lookup(addr, &ri);
+                if (ref < 0 ? rc != -1
+                            : (rc != HAL_OK || ri.len != tab[ref].len ||
+                               ri.prefix != tab[ref].pfx || ri.port != tab[ref].port))
+                    mismatch++;
+            }
+        }
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+
+    route_stats_t st;
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes, (uint32_t)n);
+    TEST_ASSERT(st.nodes <= 2u * (uint32_t)n);          /* 路径压缩：最多 2n-1 个节点 + 根 */
+    TEST_ASSERT(st.next_hops <= 8);
+
+    while (n > 0) {
+        n--;
+        route_del(tab[n].pfx, tab[n].len);
+    }
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes,    0);
+    TEST_ASSERT_EQ(st.nodes,     1);
+    TEST_ASSERT_EQ(st.next_hops, 0);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-6: TCAM 布局 — 小区间内随机增删
+// ─────────────────────────────────────────────
+
+#define RT6_BASE   0x0100
+#define RT6_SLOTS  48
+
+/* 按 TCAM 最小 table_id 优先查 addr，返回出端口；未命中返回 -1 */
+static int rt6_tcam_port(uint32_t addr) {
+    uint8_t key[SIM_TCAM_KEY_STRIDE] = { (uint8_t)(addr >> 24), (uint8_t)(addr >> 16),
+                                         (uint8_t)(addr >> 8),  (uint8_t)addr };
+    const sim_tcam_rec_t *r = sim_tcam_lookup(TABLE_IPV4_LPM_STAGE, key, 4);
+    return r ? r->entry.action_params[0] : -1;
+}
+
+void test_route_tcam_layout(void) {
+    TEST_BEGIN("ROUTE-6: TCAM layout — length order, bounded moves, TCAM LPM == reference");
+
+    sim_hal_reset();
+    route_init();
+    TEST_ASSERT_OK(route_tcam_region(RT6_BASE, RT6_SLOTS));
+
+    static rt5_route_t tab[RT6_SLOTS];
+    int n = 0, mismatch = 0, order_err = 0, full_seen = 0;
+    uint32_t max_add_moves = 0, max_del_moves = 0;
+    route_stats_t st;
+
+    /* 前缀集中在 10.0.0.0/16 内，长度 8-32；区间经常被填满，迫使各组互相挤占 */
+    for (int op = 0; op < 4000; op++) {
+        route_get_stats(&st);
+        uint32_t moves0 = st.tcam_moves;
+
+        if (n > 0 && (rt5_rand() % 3 == 0)) {
+            int k = (int)(rt5_rand() % (uint32_t)n);
+            TEST_ASSERT_OK(route_del(tab[k].pfx, tab[k].len));
+            tab[k] = tab[--n];
+            route_get_stats(&st);
+            if (st.tcam_moves - moves0 > max_del_moves) max_del_moves = st.tcam_moves - moves0;
+        } else {
+            uint8_t  len  = (uint8_t)(8 + rt5_rand() % 25);
+            uint32_t pfx  = (0x0A000000u | (rt5_rand() & 0x0000FFFFu)) & rt5_mask(len);
+            uint8_t  port = (uint8_t)(1 + rt5_rand() % 8);
+            int k;
+            for (k = 0; k < n; k++)
+                if (tab[k].pfx == pfx && tab[k].len == len) break;
+            int rc = route_add(pfx, len, port, 0x020000000000ULL | port);
+            if (k == n && n == RT6_SLOTS) {
+                /* 区间已满：新路由被拒绝，RIB 不变 */
+                TEST_ASSERT_EQ(rc, HAL_ERR_FULL);
+                TEST_ASSERT_EQ(route_tcam_slot(pfx, len), -1);
+                full_seen++;
+                continue;
+            }
+            TEST_ASSERT_OK(rc);
+            if (k == n) n++;
+            tab[k].pfx = pfx; tab[k].len = len; tab[k].port = port;
+            route_get_stats(&st);
+            if (st.tcam_moves - moves0 > max_add_moves) max_add_moves = st.tcam_moves - moves0;
+        }
+
+        /* 每条路由都在区间内；长前缀的 table_id 一定更小 */
+        for (int i = 0; i < n; i++) {
+            int ti = route_tcam_slot(tab[i].pfx, tab[i].len);
+            if (ti < RT6_BASE || ti >= RT6_BASE + RT6_SLOTS) order_err++;
+            for (int j = 0; j < n; j++)
+                if (tab[i].len > tab[j].len && ti >= route_tcam_slot(tab[j].pfx, tab[j].len))
+                    order_err++;
+        }
+        for (int q = 0; q < 16; q++) {
+            uint32_t addr = 0x0A000000u | (rt5_rand() & 0x0001FFFFu);
+            int ref = rt5_ref(tab, n, addr);
+            if (rt6_tcam_port(addr) != (ref < 0 ? -1 : tab[ref].port)) mismatch++;
+        }
+    }
+    TEST_ASSERT_EQ(order_err, 0);
+    TEST_ASSERT_EQ(mismatch,  0);
+    TEST_ASSERT(full_seen > 0);
+    TEST_ASSERT(max_add_moves <= 32);
+    TEST_ASSERT(max_del_moves <= 1);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), n);
+    TEST_ASSERT_EQ(route_tcam_region(0, 16), HAL_ERR_BUSY);
+
+    while (n > 0) {
+        n--;
+        TEST_ASSERT_OK(route_del(tab[n].pfx, tab[n].len));
+    }
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 0);
+    TEST_ASSERT_OK(route_tcam_region(0, 16));
+    TEST_ASSERT_EQ(route_tcam_region(0xFFF0, 32), HAL_ERR_INVAL);
+    route_init();
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-7: ECMP 组 —— resilient hashing
+// ─────────────────────────────────────────────
+#define RT7_GRP     3
+#define RT7_B       ROUTE_ECMP_BUCKETS
+
+/* 各桶当前成员的端口（桶未分配为 -1） */
+static void rt7_owners(int *own) {
+    for (uint32_t b = 0; b < RT7_B; b++) {
+        port_id_t p;
+        own[b] = route_ecmp_select(RT7_GRP, b, &p, NULL) == HAL_OK ? p : -1;
+    }
+}
+
+/* 成员表条目与软件桶表一致的桶数 */
+static int rt7_tcam_agree(void) {
+    int ok = 0;
+    for (uint32_t b = 0; b < RT7_B; b++) {
+        uint16_t  tid = (uint16_t)(TABLE_ECMP_MEMBER_BASE + (RT7_GRP + 1) * RT7_B + b);
+        port_id_t p;
+        uint64_t  m;
+        sim_tcam_rec_t *r = sim_tcam_find(TABLE_ECMP_MEMBER_STAGE, tid);
+        if (!r || route_ecmp_select(RT7_GRP, b, &p, &m) != HAL_OK) continue;
+        ok += r->entry.action_id == ACTION_FORWARD && r->entry.action_params[0] == p &&
+              r->entry.action_params[6] == (uint8_t)m &&
+              r->entry.key.bytes[0] == (uint8_t)((tid - TABLE_ECMP_MEMBER_BASE) >> 8) &&
+              r->entry.key.bytes[1] == (uint8_t)(tid - TABLE_ECMP_MEMBER_BASE);
+    }
+    return ok;
+}
+
+void test_route_ecmp(void) {
+    TEST_BEGIN("ROUTE-7: ECMP group buckets balanced; member add/del rewrites only moved buckets");
+
+    sim_hal_reset();
+    route_init();
+
+    /* 空组不能被路由引用 */
+    TEST_ASSERT_EQ(route_ecmp_add(0x0A000000u, 8, RT7_GRP), HAL_ERR_INVAL);
+    TEST_ASSERT_EQ(route_ecmp_member_add(ROUTE_ECMP_GROUPS, 1, 0x020000000001ULL), HAL_ERR_INVAL);
+
+    /* 第一个成员占全部桶 */
+    TEST_ASSERT_OK(route_ecmp_member_add(RT7_GRP, 1, 0x020000000001ULL));
+    TEST_ASSERT_OK(route_ecmp_member_add(RT7_GRP, 1, 0x020000000001ULL));    /* 重复：无操作 */
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_ECMP_MEMBER_STAGE), RT7_B);
+    TEST_ASSERT_EQ(rt7_tcam_agree(), RT7_B);
+
+    /* Stage 0 条目：ecmp_group(base, mask) */
+    TEST_ASSERT_OK(route_ecmp_add(0x0A000000u, 8, RT7_GRP));
+    int tid = route_tcam_slot(0x0A000000u, 8);
+    TEST_ASSERT(tid >= 0);
+    sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)tid);
+    TEST_ASSERT_NOTNULL(r);
+    TEST_ASSERT_EQ(r->entry.action_id, ACTION_ECMP_GROUP);
+    TEST_ASSERT_EQ((r->entry.action_params[0] << 8) | r->entry.action_params[1], (RT7_GRP + 1) * RT7_B);
+    TEST_ASSERT_EQ((r->entry.action_params[2] << 8) | r->entry.action_params[3], RT7_B - 1);
+
+    route_info_t ri;
+    TEST_ASSERT_OK(route_lookup(0x0A010203u, &ri));
+    TEST_ASSERT_EQ(ri.group, RT7_GRP);
+
+    /* 逐个加到 8 个成员：只有 B/n 个桶改指新成员 */
+    int before[RT7_B], after[RT7_B];
+    for (int n = 2; n <= 8; n++) {
+        rt7_owners(before);
+        TEST_ASSERT_OK(route_ecmp_member_add(RT7_GRP, (uint8_t)n, 0x020000000000ULL | (uint64_t)n));
+        rt7_owners(after);
+        int moved = 0, wrong = 0;
+        for (int b = 0; b < RT7_B; b++) {
+            if (before[b] == after[b]) continue;
+            moved++;
+            if (after[b] != n) wrong++;
+        }
+        TEST_ASSERT_EQ(moved, RT7_B / n);
+        TEST_ASSERT_EQ(wrong, 0);
+    }
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_ECMP_MEMBER_STAGE), RT7_B);
+    TEST_ASSERT_EQ(rt7_tcam_agree(), RT7_B);
+
+    /* 随机增删成员：每次只改写必要的桶，桶数相差不超过 1 */
+    int present[9] = { 0, 1, 1, 1, 1, 1, 1, 1, 1 };
+    int n = 8, bad_move = 0, unbalanced = 0;
+    for (int i = 0; i < 300; i++) {
+        uint8_t p = (uint8_t)(1 + rt5_rand() % 8);
+        route_ecmp_info_t gi;
+        rt7_owners(before);
+        if (present[p]) {
+            if (n == 1) continue;
+            int own = 0;
+            for (int b = 0; b < RT7_B; b++) own += before[b] == p;
+            TEST_ASSERT_OK(route_ecmp_member_del(RT7_GRP, p, 0x020000000000ULL | p));
+            present[p] = 0; n--;
+            rt7_owners(after);
+            int moved = 0;
+            for (int b = 0; b < RT7_B; b++)
+                if (before[b] != after[b]) { moved++; if (before[b] != p) bad_move++; }
+            if (moved != own) bad_move++;
+        } else {
+            TEST_ASSERT_OK(route_ecmp_member_add(RT7_GRP, p, 0x020000000000ULL | p));
+            present[p] = 1; n++;
+            rt7_owners(after);
+            int moved = 0;
+            for (int b = 0; b < RT7_B; b++)
+                if (before[b] != after[b]) { moved++; if (after[b] != p) bad_move++; }
+            if (moved != RT7_B / n) bad_move++;
+        }
+        TEST_ASSERT_OK(route_ecmp_get(RT7_GRP, &gi));
+        TEST_ASSERT_EQ(gi.members, n);
+        int lo = RT7_B, hi = 0, sum = 0;
+        for (int m = 0; m < gi.members; m++) {
+            if (gi.buckets[m] < lo) lo = gi.buckets[m];
+            if (gi.buckets[m] > hi) hi = gi.buckets[m];
+            sum += gi.buckets[m];
+        }
+        if (hi - lo > 1 || sum != RT7_B) unbalanced++;
+    }
+    TEST_ASSERT_EQ(bad_move, 0);
+    TEST_ASSERT_EQ(unbalanced, 0);
+    TEST_ASSERT_EQ(rt7_tcam_agree(), RT7_B);
+
+    /* 仍有路由引用时不能删光成员；撤路由后删最后一个成员即撤销全部桶 */
+    for (uint8_t p = 1; p <= 8; p++) {
+        if (!present[p] || n == 1) continue;
+        TEST_ASSERT_OK(route_ecmp_member_del(RT7_GRP, p, 0x020000000000ULL | p));
+        present[p] = 0; n--;
+    }
+    uint8_t last = 1;
+    while (!present[last]) last++;
+    TEST_ASSERT_EQ(route_ecmp_member_del(RT7_GRP, last, 0x020000000000ULL | last), HAL_ERR_BUSY);
+    TEST_ASSERT_EQ(route_ecmp_member_del(RT7_GRP, last, 0x02AAAAAAAAAAULL), HAL_ERR_INVAL);
+    TEST_ASSERT_OK(route_del(0x0A000000u, 8));
+    TEST_ASSERT_OK(route_ecmp_member_del(RT7_GRP, last, 0x020000000000ULL | last));
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_ECMP_MEMBER_STAGE), 0);
+    TEST_ASSERT_EQ(route_ecmp_select(RT7_GRP, 0, NULL, NULL), HAL_ERR_INVAL);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-8: 批量增删 — 与逐条调用布局一致，每 HAL_TCAM_BATCH_MAX 次写入一次排空
+// ─────────────────────────────────────────────
+
+#define RT8_N      150
+#define RT8_SLOTS  200
+
+void test_route_bulk(void) {
+    TEST_BEGIN("ROUTE-8: route_add_bulk/del_bulk — same layout as single ops, one drain per batch");
+
+    static route_entry_t tab[RT8_N];
+    static int           slot[RT8_N];
+    route_stats_t st;
+
+    /* 不重复的前缀（10.0.0.0/16 内，长度 8-32） */
+    sim_hal_reset();
+    route_init();
+    TEST_ASSERT_OK(route_tcam_region(RT6_BASE, RT8_SLOTS));
+    for (int n = 0; n < RT8_N; ) {
+        uint8_t len = (uint8_t)(8 + rt5_rand() % 25);
+        route_entry_t e = { (0x0A000000u | (rt5_rand() & 0x0000FFFFu)) & rt5_mask(len), len,
+                            (uint8_t)(1 + n % 8), 0x020000000000ULL | (uint64_t)(1 + n % 8) };
+        if (route_tcam_slot(e.prefix, e.len) >= 0) continue;
+        TEST_ASSERT_OK(route_add(e.prefix, e.len, e.port, e.dmac));
+        tab[n++] = e;
+    }
+    for (int i = 0; i < RT8_N; i++) slot[i] = route_tcam_slot(tab[i].prefix, tab[i].len);
+    route_get_stats(&st);
+    uint32_t single_drains = sim_tue_drains;
+    TEST_ASSERT_EQ(single_drains, RT8_N + st.tcam_moves);    /* 逐条：每次 TCAM 写入一次排空 */
+
+    /* 批量装入同一序列：布局与逐条相同，排空次数 = ceil(写入次数 / 64) */
+    sim_hal_reset();
+    route_init();
+    TEST_ASSERT_OK(route_tcam_region(RT6_BASE, RT8_SLOTS));
+    TEST_ASSERT_EQ(route_add_bulk(tab, RT8_N), RT8_N);
+    int diff = 0;
+    for (int i = 0; i < RT8_N; i++) {
+        const sim_tcam_rec_t *r = sim_tcam_find(TABLE_IPV4_LPM_STAGE, (uint16_t)slot[i]);
+        if (route_tcam_slot(tab[i].prefix, tab[i].len) != slot[i] || !r ||
+            r->entry.key.bytes[0] != (uint8_t)(tab[i].prefix >> 24) ||
+            r->entry.action_params[0] != tab[i].port)
+            diff++;
+    }
+    TEST_ASSERT_EQ(diff, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), RT8_N);
+    TEST_ASSERT_EQ(sim_tue_drains, (single_drains + HAL_TCAM_BATCH_MAX - 1) / HAL_TCAM_BATCH_MAX);
+
+    /* 批内写入在提交前不生效；已在批内时不能再开批 */
+    TEST_ASSERT_OK(hal_tcam_batch_begin());
+    TEST_ASSERT_OK(route_add(0x0B000000u, 8, 1, 0x020000000001ULL));
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), RT8_N);
+    TEST_ASSERT_EQ(route_add_bulk(tab, RT8_N), HAL_ERR_BUSY);
+    TEST_ASSERT_OK(hal_tcam_batch_commit());
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), RT8_N + 1);
+    TEST_ASSERT_EQ(hal_tcam_batch_commit(), HAL_ERR_INVAL);
+    TEST_ASSERT_OK(route_del(0x0B000000u, 8));
+
+    /* 批量删除：不存在 / 非法的条目跳过，其余照常删除 */
+    TEST_ASSERT_EQ(route_add_bulk(NULL, 1), HAL_ERR_INVAL);
+    TEST_ASSERT_EQ(route_del_bulk(tab, -1), HAL_ERR_INVAL);
+    TEST_ASSERT_EQ(route_del_bulk(tab, 0), 0);
+    TEST_ASSERT_OK(route_del(tab[0].prefix, tab[0].len));
+    tab[1].len = 33;
+    uint32_t drains0 = sim_tue_drains;
+    TEST_ASSERT_EQ(route_del_bulk(tab, RT8_N), RT8_N - 2);
+    TEST_ASSERT(sim_tue_drains - drains0 <= (2u * RT8_N + HAL_TCAM_BATCH_MAX - 1) / HAL_TCAM_BATCH_MAX);
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes, 1);                            /* tab[1] 仍在 */
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 1);
+
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-ROUTE-9: TCAM 写入失败的删除保留路由，其余路由不受影响，可重试
+// ─────────────────────────────────────────────
+#define RT9_N  4
+
+/* 每条 /24 的 RIB / TCAM 结果与期望一致（不在的落到覆盖它的 /8） */
+static int rt9_mismatch(const uint32_t *pfx, const int *rib, const int *tc) {
+    int bad = 0;
+    for (int i = 0; i < RT9_N; i++) {
+        route_info_t ri;
+        if (rt6_tcam_port(pfx[i] | 1u) != (tc[i] ? 1 + i : 9)) bad++;
+        if (route_lookup(pfx[i] | 1u, &ri) != HAL_OK || ri.port != (rib[i] ? 1 + i : 9)) bad++;
+    }
+    return bad;
+}
+
+void test_route_del_fail(void) {
+    TEST_BEGIN("ROUTE-9: route_del with failed TCAM write keeps the route and can be retried");
+
+    sim_hal_reset();
+    route_init();
+    TEST_ASSERT_OK(route_tcam_region(RT6_BASE, RT6_SLOTS));
+
+    static const uint32_t pfx[RT9_N] = { 0x0A010000u, 0x0A020000u, 0x0A030000u, 0x0A040000u };
+    int rib[RT9_N] = { 1, 1, 1, 1 }, tc[RT9_N] = { 1, 1, 1, 1 };
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 9, 0x020000000009ULL));
+    for (int i = 0; i < RT9_N; i++)
+        TEST_ASSERT_OK(route_add(pfx[i], 24, (uint8_t)(1 + i), 0x020000000000ULL | (uint64_t)(1 + i)));
+
+    /* 组内首、中间（需末条补洞）两种位置 */
+    int lo = 0, mid = -1;
+    for (int i = 1; i < RT9_N; i++)
+        if (route_tcam_slot(pfx[i], 24) < route_tcam_slot(pfx[lo], 24)) lo = i;
+    int hi = lo;
+    for (int i = 0; i < RT9_N; i++)
+        if (route_tcam_slot(pfx[i], 24) > route_tcam_slot(pfx[hi], 24)) hi = i;
+    for (int i = 0; i < RT9_N && mid < 0; i++)
+        if (i != lo && i != hi) mid = i;
+    TEST_ASSERT(mid >= 0);
+
+    /* 中间位置：补洞写入失败 → TCAM 不变；补洞成功、删除末位失败 → 本路由的
+     * 条目已被覆盖（流量落到 /8），末位残留补洞条目的副本，其余路由不变 */
+    route_stats_t st;
+    sim_tue_fail_cmd = TUE_CMD_INSERT;
+    TEST_ASSERT_EQ(route_del(pfx[mid], 24), HAL_ERR_TIMEOUT);
+    TEST_ASSERT_EQ(sim_tue_fail_cmd, -1);                      /* 故障已触发 */
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+    sim_tue_fail_cmd = TUE_CMD_DELETE;
+    TEST_ASSERT_EQ(route_del(pfx[mid], 24), HAL_ERR_TIMEOUT);
+    tc[mid] = 0;
+    TEST_ASSERT(route_tcam_slot(pfx[mid], 24) >= 0);
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 1 + RT9_N);
+    sim_tue_fail_cmd = TUE_CMD_DELETE;                         /* 重试再失败一次 */
+    TEST_ASSERT_EQ(route_del(pfx[mid], 24), HAL_ERR_TIMEOUT);
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+    TEST_ASSERT_OK(route_del(pfx[mid], 24));
+    rib[mid] = 0;
+    TEST_ASSERT_EQ(route_tcam_slot(pfx[mid], 24), -1);
+    TEST_ASSERT_EQ(route_del(pfx[mid], 24), HAL_ERR_INVAL);
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+
+    /* 组首：删除失败 → TCAM 与 RIB 均不变 */
+    sim_tue_fail_cmd = TUE_CMD_DELETE;
+    TEST_ASSERT_EQ(route_del(pfx[lo], 24), HAL_ERR_TIMEOUT);
+    TEST_ASSERT(route_tcam_slot(pfx[lo], 24) >= 0);
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+    TEST_ASSERT_OK(route_del(pfx[lo], 24));
+    rib[lo] = tc[lo] = 0;
+    TEST_ASSERT_EQ(rt9_mismatch(pfx, rib, tc), 0);
+
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes, 1 + RT9_N - 2);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 1 + RT9_N - 2);
+
+    /* 其余路由删除后 RIB / TCAM / 下一跳全部回收 */
+    for (int i = 0; i < RT9_N; i++)
+        if (rib[i]) TEST_ASSERT_OK(route_del(pfx[i], 24));
+    TEST_ASSERT_OK(route_del(0x0A000000u, 8));
+    route_get_stats(&st);
+    TEST_ASSERT_EQ(st.routes,    0);
+    TEST_ASSERT_EQ(st.next_hops, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(TABLE_IPV4_LPM_STAGE), 0);
+
+    TEST_END();
+}
@@ -0,0 +1,232 @@
+// test_sim_tcam.c
+// 模拟 TCAM 存储测试用例（3 个）
+//
+// 用例列表：
+//   1. test_sim_tcam_slot_reuse — 删除的槽被下一次插入复用；原位更新不换槽
+//   2. test_sim_tcam_growth     — 超过 SIM_TCAM_MAX 后按页增长，已有记录地址与内容不变
+//   3. test_sim_tcam_ref_lookup — 随机增删改（含换掩码组）后，tuple space 查找
+//                                 （单条 / 批量）与逐条线性扫描参考一致
+
+#include <string.h>
+#include "test_framework.h"
+#include "sim_tcam.h"
+
+#define ST_STAGE  7
+
+static void st_entry(tcam_entry_t *e, uint16_t tid, uint32_t key, uint32_t mask, uint8_t len) {
+    memset(e, 0, sizeof(*e));
+    e->stage    = ST_STAGE;
+    e->table_id = tid;
+    e->key.key_len = e->mask.key_len = len;
+    for (int b = 0; b < 4 && b < len; b++) {
+        e->key.bytes[b]  = (uint8_t)(key  >> (24 - 8 * b));
+        e->mask.bytes[b] = (uint8_t)(mask >> (24 - 8 * b));
+    }
+    e->action_params[0] = (uint8_t)tid;
+}
+
+// ─────────────────────────────────────────────
+// TC-TCAM-1: 槽复用
+// ─────────────────────────────────────────────
+void test_sim_tcam_slot_reuse(void) {
+    TEST_BEGIN("TCAM-1: deleted slots are reused; in-place update keeps the slot");
+
+    sim_tcam_reset();
+    tcam_entry_t e;
+    for (uint16_t t = 0; t < 8; t++) {
+        st_entry(&e, t, 0x0A000000u | t, 0xFFFFFFFFu, 4);
+        TEST_ASSERT_OK(sim_tcam_insert(&e));
+    }
+    sim_tcam_rec_t *r3 = sim_tcam_find(ST_STAGE, 3);
+    sim_tcam_rec_t *r5 = sim_tcam_find(ST_STAGE, 5);
+    TEST_ASSERT_NOTNULL(r3);
+    TEST_ASSERT_NOTNULL(r5);
+
+    TEST_ASSERT_OK(sim_tcam_delete(ST_STAGE, 3));
+    TEST_ASSERT_OK(sim_tcam_delete(ST_STAGE, 5));
+    TEST_ASSERT_EQ(sim_tcam_delete(ST_STAGE, 5), HAL_ERR_INVAL);
+    TEST_ASSERT_NULL(sim_tcam_find(ST_STAGE, 3));
+    TEST_ASSERT_EQ(r3->valid, 0);
+    TEST_ASSERT_EQ(r3->deleted, 1);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), 6);
+
+    /* 空闲槽后进先出：先拿到 5 的槽，再拿到 3 的槽 */
+    st_entry(&e, 100, 0x0B000000u, 0xFF000000u, 4);
+    TEST_ASSERT_OK(sim_tcam_insert(&e));
+    st_entry(&e, 101, 0x0C000000u, 0xFF000000u, 4);
+    TEST_ASSERT_OK(sim_tcam_insert(&e));
+    TEST_ASSERT(sim_tcam_find(ST_STAGE, 100) == r5);
+    TEST_ASSERT(sim_tcam_find(ST_STAGE, 101) == r3);
+    TEST_ASSERT_EQ(r3->valid, 1);
+    TEST_ASSERT_EQ(r3->deleted, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), 8);
+
+    /* 复用的槽已按新掩码组挂链：旧键不再命中，新键命中 */
+    uint8_t key[SIM_TCAM_KEY_STRIDE] = { 0x0A, 0x00, 0x00, 0x03 };
+    TEST_ASSERT_NULL(sim_tcam_lookup(ST_STAGE, key, 4));
+    key[0] = 0x0C;
+    TEST_ASSERT(sim_tcam_lookup(ST_STAGE, key, 4) == r3);
+
+    /* 原位更新（换掩码组）不换槽 */
+    st_entry(&e, 101, 0x0D000000u, 0xFFFF0000u, 4);
+    TEST_ASSERT_OK(sim_tcam_modify(&e));
+    TEST_ASSERT(sim_tcam_find(ST_STAGE, 101) == r3);
+    TEST_ASSERT_NULL(sim_tcam_lookup(ST_STAGE, key, 4));
+    key[0] = 0x0D;
+    TEST_ASSERT(sim_tcam_lookup(ST_STAGE, key, 4) == r3);
+
+    /* flush 后全部槽进入空闲链表，重新插入不越过原高水位 */
+    TEST_ASSERT_OK(sim_tcam_flush(ST_STAGE));
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), 0);
+    int reused = 0;
+    for (uint16_t t = 0; t < 8; t++) {
+        st_entry(&e, (uint16_t)(200 + t), t, 0xFFFFFFFFu, 4);
+        TEST_ASSERT_OK(sim_tcam_insert(&e));
+        sim_tcam_rec_t *r = sim_tcam_find(ST_STAGE, (uint16_t)(200 + t));
+        reused += r == r3 || r == r5;
+    }
+    TEST_ASSERT_EQ(reused, 2);
+
+    sim_tcam_reset();
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-TCAM-2: 超过初始容量后增长
+// ─────────────────────────────────────────────
+#define ST2_N  (4 * SIM_TCAM_MAX + 7)
+
+void test_sim_tcam_growth(void) {
+    TEST_BEGIN("TCAM-2: growth past SIM_TCAM_MAX keeps record addresses and contents");
+
+    sim_tcam_reset();
+    tcam_entry_t e;
+    sim_tcam_rec_t *first[16];
+    for (int i = 0; i < ST2_N; i++) {
+        st_entry(&e, (uint16_t)i, 0x0A000000u | (uint32_t)i, 0xFFFFFFFFu, 4);
+        TEST_ASSERT_OK(sim_tcam_insert(&e));
+        if (i < 16) first[i] = sim_tcam_find(ST_STAGE, (uint16_t)i);
+    }
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), ST2_N);
+
+    int moved = 0, bad = 0;
+    for (int i = 0; i < 16; i++)
+        moved += sim_tcam_find(ST_STAGE, (uint16_t)i) != first[i];
+    for (int i = 0; i < ST2_N; i++) {
+        uint8_t key[SIM_TCAM_KEY_STRIDE] = { 0x0A, 0x00, (uint8_t)(i >> 8), (uint8_t)i };
+        const sim_tcam_rec_t *r = sim_tcam_lookup(ST_STAGE, key, 4);
+        bad += !r || r->entry.table_id != i || r->entry.action_params[0] != (uint8_t)i;
+    }
+    TEST_ASSERT_EQ(moved, 0);
+    TEST_ASSERT_EQ(bad, 0);
+
+    /* 删一半再装回：全部走空闲链表，记录地址集合不变 */
+    for (int i = 0; i < ST2_N; i += 2) TEST_ASSERT_OK(sim_tcam_delete(ST_STAGE, (uint16_t)i));
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), ST2_N / 2);
+    for (int i = 0; i < ST2_N; i += 2) {
+        st_entry(&e, (uint16_t)i, 0x0A000000u | (uint32_t)i, 0xFFFFFFFFu, 4);
+        TEST_ASSERT_OK(sim_tcam_insert(&e));
+    }
+    bad = 0;
+    for (int i = 0; i < ST2_N; i++) {
+        uint8_t key[SIM_TCAM_KEY_STRIDE] = { 0x0A, 0x00, (uint8_t)(i >> 8), (uint8_t)i };
+        const sim_tcam_rec_t *r = sim_tcam_lookup(ST_STAGE, key, 4);
+        bad += !r || r->entry.table_id != i;
+    }
+    TEST_ASSERT_EQ(bad, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), ST2_N);
+
+    sim_tcam_reset();
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-TCAM-3: tuple space 查找 vs 线性扫描参考
+// ─────────────────────────────────────────────
+#define ST3_TIDS  1024
+#define ST3_OPS   20000
+#define ST3_BURST 8
+
+static uint32_t st3_seed;
+static uint32_t st3_rand(void) {
+    st3_seed = st3_seed * 1103515245u + 12345u;
+    return st3_seed >> 8;
+}
+
+// 按 sim_tcam.h 的语义逐条比较：b < min(entry.key_len, key_len) 的字节掩码相等，
+// 命中中 table_id 最小者胜出；返回 table_id，无命中 -1
+static int st3_ref_lookup(const tcam_entry_t *ref, const uint8_t *live,
+                          const uint8_t *key, uint8_t key_len) {
+    for (int t = 0; t < ST3_TIDS; t++) {
+        if (!live[t]) continue;
+        int n = ref[t].key.key_len < key_len ? ref[t].key.key_len : key_len;
+        int hit = 1;
+        for (int b = 0; b < n && hit; b++)
+            hit = ((key[b] ^ ref[t].key.bytes[b]) & ref[t].mask.bytes[b]) == 0;
+        if (hit) return t;
+    }
+    return -1;
+}
+
+void test_sim_tcam_ref_lookup(void) {
+    TEST_BEGIN("TCAM-3: random insert/modify/delete — tuple-space lookup == linear scan");
+
+    static const uint32_t masks[] = {
+        0xFFFFFFFFu, 0xFFFFFF00u, 0xFFFF0000u, 0xFF000000u,
+        0x00000000u, 0x0F0F0F0Fu, 0xFF00FF00u, 0x03030303u,
+    };
+    static const uint8_t lens[] = { 2, 3, 4 };
+    static tcam_entry_t ref[ST3_TIDS];
+    static uint8_t      live[ST3_TIDS];
+    memset(live, 0, sizeof(live));
+    st3_seed = 0x7C3A11u;
+    sim_tcam_reset();
+
+    int n_live = 0, mismatch = 0, burst_mismatch = 0;
+    for (int op = 0; op < ST3_OPS; op++) {
+        uint16_t tid = (uint16_t)(st3_rand() % ST3_TIDS);
+        uint32_t r   = st3_rand();
+        tcam_entry_t e;
+        if (r % 4 == 0) {
+            int rc = sim_tcam_delete(ST_STAGE, tid);
+            if (live[tid]) { TEST_ASSERT_OK(rc); live[tid] = 0; n_live--; }
+            else           TEST_ASSERT_EQ(rc, HAL_ERR_INVAL);
+        } else {
+            /* 键字节取 0..3：不同条目间大量重叠命中 */
+            st_entry(&e, tid, st3_rand() & 0x03030303u, masks[(r >> 4) % 8], lens[(r >> 8) % 3]);
+            if (r % 4 == 1) {
+                int rc = sim_tcam_modify(&e);
+                if (!live[tid]) { TEST_ASSERT_EQ(rc, HAL_ERR_INVAL); continue; }
+                TEST_ASSERT_OK(rc);
+            } else {
+                TEST_ASSERT_OK(sim_tcam_insert(&e));
+                if (!live[tid]) { live[tid] = 1; n_live++; }
+            }
+            ref[tid] = e;
+        }
+
+        if (op % 16) continue;
+        uint8_t keys[ST3_BURST * SIM_TCAM_KEY_STRIDE], klen[ST3_BURST];
+        const sim_tcam_rec_t *hits[ST3_BURST];
+        memset(keys, 0, sizeof(keys));
+        for (int i = 0; i < ST3_BURST; i++) {
+            uint32_t k = st3_rand() & 0x03030303u;
+            klen[i] = lens[st3_rand() % 3];
+            for (int b = 0; b < 4; b++) keys[i * SIM_TCAM_KEY_STRIDE + b] = (uint8_t)(k >> (24 - 8 * b));
+        }
+        sim_tcam_lookup_burst(ST_STAGE, keys, klen, ST3_BURST, hits);
+        for (int i = 0; i < ST3_BURST; i++) {
+            const uint8_t *key = keys + i * SIM_TCAM_KEY_STRIDE;
+            int want = st3_ref_lookup(ref, live, key, klen[i]);
+            const sim_tcam_rec_t *one = sim_tcam_lookup(ST_STAGE, key, klen[i]);
+            mismatch       += (one ? one->entry.table_id : -1) != want;
+            burst_mismatch += (hits[i] ? hits[i]->entry.table_id : -1) != want;
+        }
+    }
+    TEST_ASSERT_EQ(mismatch, 0);
+    TEST_ASSERT_EQ(burst_mismatch, 0);
+    TEST_ASSERT_EQ(sim_tcam_count_stage(ST_STAGE), n_live);
+
+    sim_tcam_reset();
+    TEST_END();
+}
@@ -0,0 +1,230 @@
+// test_tm.c
+// 流量管理器排队模型测试用例（4 个）
+//
+// 用例列表：
+//   1. test_tm_dwrr_share      — DWRR 权重 3:1 → 拥塞时吞吐 3:1，总吞吐贴近线速
+//   2. test_tm_sp_priority     — SP：高优先级队列零丢包低时延；SP+DWRR 低队列均分
+//   3. test_tm_pir_buffer      — PIR 整形到 10G；共享缓冲动态门限限制单队列占用
+//   4. test_tm_fwd_result      — pkt_process 结果入队：DSCP EF 走 Q5，ACL 丢弃不入队
+
+#include <string.h>
+#include "test_framework.h"
+#include "sim_hal.h"
+#include "pkt_model.h"
+#include "tm_model.h"
+#include "qos.h"
+#include "route.h"
+#include "acl.h"
+
+// 100G 下 1500B 帧（含 20B 前导码 + IFG）的线上时间约 121.6 ns
+#define LINE_GAP_NS  122
+
+// ─────────────────────────────────────────────
+// TC-TM-1: DWRR 权重
+// ─────────────────────────────────────────────
+void test_tm_dwrr_share(void) {
+    TEST_BEGIN("TM-1  : DWRR weights 4500:1500 → 3:1 share at line rate");
+
+    sim_hal_reset();
+    qos_init();
+    uint32_t w[QOS_QUEUES_PER_PORT] = { 4500, 1500, 1500, 1500, 1500, 1500, 1500, 1500 };
+    TEST_ASSERT_OK(qos_port_set_weights(1, w));
+
+    tm_model_t *tm = tm_create(NULL);
+    TEST_ASSERT_NOTNULL(tm);
+    if (!tm) { TEST_END(); return; }
+
+    /* Q0、Q1 各按线速到达，端口 2 倍超订 */
+    uint64_t t = 0;
+    for (int i = 0; i < 8000; i++, t += LINE_GAP_NS) {
+        tm_enqueue(tm, t, 1, 0, 1500);
+        tm_enqueue(tm, t, 1, 1, 1500);
+    }
+    tm_advance(tm, t);
+
+    tm_qstats_t q0, q1;
+    tm_get_qstats(tm, 1, 0, &q0);
+    tm_get_qstats(tm, 1, 1, &q1);
+    TEST_ASSERT(q0.drop_pkts > 0 && q1.drop_pkts > 0);       /* 两队列都持续积压 */
+    TEST_ASSERT(q0.tx_bytes * 10 >= q1.tx_bytes * 28);
+    TEST_ASSERT(q0.tx_bytes * 10 <= q1.tx_bytes * 32);
+
+    /* 总吞吐 ≈ 100G × 1500/1520 */
+    double gbps = (double)(q0.tx_bytes + q1.tx_bytes) * 8 / (double)tm_now(tm);
+    TEST_ASSERT(gbps > 97.0 && gbps < 99.5);
+
+    tm_destroy(tm);
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-TM-2: Strict Priority / SP+DWRR
+// ─────────────────────────────────────────────
+void test_tm_sp_priority(void) {
+    TEST_BEGIN("TM-2  : SP → Q7 lossless + low delay; SP+DWRR splits rest evenly");
+
+    sim_hal_reset();
+    qos_init();
+    TEST_ASSERT_OK(qos_port_set_mode(2, QOS_SCHED_SP, 0));
+    TEST_ASSERT_OK(qos_port_set_mode(4, QOS_SCHED_SP_DWRR, 1));
+
+    tm_cfg_t cfg;
+    tm_cfg_default(&cfg);
+    cfg.sp_queues[4] = 1;
+    tm_model_t *tm = tm_create(&cfg);
+    TEST_ASSERT_NOTNULL(tm);
+    if (!tm) { TEST_END(); return; }
+
+    /* Q7 60% 负载，Q0（端口 4 另加 Q1）各按线速到达 */
+    uint64_t t = 0;
+    for (int i = 0; i < 4000; i++, t += LINE_GAP_NS) {
+        if (i % 5 < 3) {
+            tm_enqueue(tm, t, 2, 7, 1500);
+            tm_enqueue(tm, t, 4, 7, 1500);
+        }
+        tm_enqueue(tm, t, 2, 0, 1500);
+        tm_enqueue(tm, t, 4, 0, 1500);
+        tm_enqueue(tm, t, 4, 1, 1500);
+    }
+    tm_advance(tm, t);
+
+    tm_qstats_t hi, lo;
+    tm_get_qstats(tm, 2, 7, &hi);
+    tm_get_qstats(tm, 2, 0, &lo);
+    TEST_ASSERT_EQ(hi.drop_pkts, 0);
+    TEST_ASSERT(hi.tx_pkts + hi.qlen_pkts == hi.enq_pkts);
+    TEST_ASSERT(hi.delay_max_ns < 1000);                      /* 最多等一帧 + 一个时间步 */
+    TEST_ASSERT(lo.drop_pkts > 0);
+    TEST_ASSERT(lo.tx_bytes * 10 < hi.tx_bytes * 8);          /* 低队列只拿剩余 ~40% */
+
+    tm_qstats_t s7, d0, d1;
+    tm_get_qstats(tm, 4, 7, &s7);
+    tm_get_qstats(tm, 4, 0, &d0);
+    tm_get_qstats(tm, 4, 1, &d1);
+    TEST_ASSERT_EQ(s7.drop_pkts, 0);
+    TEST_ASSERT(s7.delay_max_ns < 1000);
+    TEST_ASSERT(d0.tx_bytes * 100 >= d1.tx_bytes * 95);       /* 等权重 DWRR */
+    TEST_ASSERT(d0.tx_bytes * 100 <= d1.tx_bytes * 105);
+
+    tm_destroy(tm);
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-TM-3: PIR 整形 + 共享缓冲动态门限
+// ─────────────────────────────────────────────
+void test_tm_pir_buffer(void) {
+    TEST_BEGIN("TM-3  : PIR 10G shapes 50G offer; DT caps queue at half buffer");
+
+    sim_hal_reset();
+    qos_init();
+    TEST_ASSERT_OK(qos_port_set_pir(3, 10000000000ULL));
+
+    tm_cfg_t cfg;
+    tm_cfg_default(&cfg);
+    cfg.buffer_cells = 4096;
+    tm_model_t *tm = tm_create(&cfg);
+    TEST_ASSERT_NOTNULL(tm);
+    if (!tm) { TEST_END(); return; }
+
+    /* 50G 到达 1.1 ms；跳过前 100 us（令牌桶初始突发）后测速 */
+    tm_qstats_t a, b;
+    uint64_t t = 0;
+    for (int i = 0; t < 1100000; i++, t += 240) {
+        if (t == 100080) tm_get_qstats(tm, 3, 0, &a);
+        tm_enqueue(tm, t, 3, 0, 1500);
+    }
+    tm_advance(tm, 1100080);
+    tm_get_qstats(tm, 3, 0, &b);
+
+    double gbps = (double)(b.tx_bytes - a.tx_bytes) * 8 / 1e6;
+    TEST_ASSERT(gbps > 9.7 && gbps < 10.3);
+    TEST_ASSERT(b.drop_pkts > 0);
+
+    /* alpha = 1：单队列占用 < 空闲 cell 数 → 最多约一半缓冲 */
+    TEST_ASSERT(b.peak_cells >= 2000);
+    TEST_ASSERT(b.peak_cells <= 2048 + 25);
+    TEST_ASSERT(tm_buffer_used(tm) <= 4096);
+    TEST_ASSERT(b.delay_max_ns > 80000);                      /* ~2048 cell @10G ≈ 98 us */
+
+    /* 排空后缓冲归零 */
+    tm_drain(tm);
+    TEST_ASSERT_EQ(tm_buffer_used(tm), 0);
+    tm_get_qstats(tm, 3, 0, &b);
+    TEST_ASSERT_EQ(b.qlen_pkts, 0);
+    TEST_ASSERT_EQ(b.tx_pkts + b.drop_pkts, b.enq_pkts);
+
+    tm_destroy(tm);
+    TEST_END();
+}
+
+// ─────────────────────────────────────────────
+// TC-TM-4: 转发结果驱动入队
+// ─────────────────────────────────────────────
+
+// 以太网 + IPv4 头（34B）；TM 按 wire_len 计长度
+static void build_ip(uint8_t *b, uint8_t tos, uint32_t src, uint32_t dst)
+{
+    memset(b, 0, 34);
+    b[0] = 0x02; b[5] = 0x01; b[6] = 0x02; b[11] = 0x02;
+    b[12] = 0x08; b[13] = 0x00;
+    b[14] = 0x45; b[15] = tos; b[17] = 20; b[22] = 64; b[23] = 17;
+    for (int k = 0; k < 4; k++) {
+        b[26 + k] = (uint8_t)(src >> (24 - 8 * k));
+        b[30 + k] = (uint8_t)(dst >> (24 - 8 * k));
+    }
+}
+
+void test_tm_fwd_result(void) {
+    TEST_BEGIN("TM-4  : pkt_process → TM: EF in Q5 ahead of BE; ACL drop skipped");
+
+    sim_hal_reset();
+    route_init();
+    acl_init();
+    qos_init();
+    TEST_ASSERT_OK(route_add(0x0A000000u, 8, 5, 0x020000000005ULL));
+    TEST_ASSERT(acl_add_deny(0x01010100u, 0xFFFFFF00u, 0, 0, 0) >= 0);
+    TEST_ASSERT_OK(qos_port_set_mode(5, QOS_SCHED_SP, 0));
+
+    /* 130% 负载 0.5 ms，缓冲取 8192 cell 以便 BE 队列溢出 */
+    tm_cfg_t cfg;
+    tm_cfg_default(&cfg);
+    cfg.buffer_cells = 8192;
+    tm_model_t *tm = tm_create(&cfg);
+    TEST_ASSERT_NOTNULL(tm);
+    if (!tm) { TEST_END(); return; }
+
+    uint8_t ef[34], be[34], deny[34];
+    build_ip(ef,   (uint8_t)(46u << 2), 0x02020202u, 0x0A000001u);
+    build_ip(be,   0x00,                0x03030303u, 0x0A000002u);
+    build_ip(deny, (uint8_t)(46u << 2), 0x01010105u, 0x0A000003u);
+
+    fwd_result_t r;
+    int skipped = 0;
+    uint64_t t = 0;
+    for (int i = 0; i < 4000; i++, t += LINE_GAP_NS) {
+        if (i % 10 < 3) {
+            TEST_ASSERT_EQ(pkt_process(ef, 34, 0, &r), 0);
+            tm_enqueue_result(tm, t, &r, 1500);
+        }
+        TEST_ASSERT_EQ(pkt_process(be, 34, 0, &r), 0);
+        tm_enqueue_result(tm, t, &r, 1500);
+        TEST_ASSERT_EQ(pkt_process(deny, 34, 0, &r), 0);
+        skipped += tm_enqueue_result(tm, t, &r, 1500) == TM_ENQ_SKIP;
+    }
+    tm_advance(tm, t);
+
+    TEST_ASSERT_EQ(skipped, 4000);
+
+    tm_qstats_t q5, q0;
+    tm_get_qstats(tm, 5, 5, &q5);
+    tm_get_qstats(tm, 5, 0, &q0);
+    TEST_ASSERT_EQ(q5.enq_pkts, 1200);
+    TEST_ASSERT_EQ(q0.enq_pkts, 4000);
+    TEST_ASSERT_EQ(q5.drop_pkts, 0);
+    TEST_ASSERT(q0.drop_pkts > 0);
+    TEST_ASSERT(q5.delay_max_ns * 10 < q0.delay_sum_ns / (q0.tx_pkts ? q0.tx_pkts : 1));
+
+    tm_destroy(tm);
+    TEST_END();
+}
@@ -169,7 +169,7 @@ void test_vlan_port_add_egress(void) {
     TEST_ASSERT_NE(sim_vlan_member[30]   & (1U << 7), 0U);
     TEST_ASSERT_NE(sim_vlan_untagged[30] & (1U << 7), 0U);
 
-    /* 出口规则：stage 6，key=[port=7, vlan=30]，action=STRIP_TAG */
+    /* 出口规则：stage 7，key=[port=7, vlan=30]，action=STRIP_TAG */
     sim_tcam_rec_t *r = sim_tcam_find(TABLE_VLAN_EGRESS_STAGE,
                                        (uint16_t)VLAN_EGRESS_ENTRY(7, 30));
     TEST_ASSERT_NOTNULL(r);
@@ -0,0 +1,386 @@
+// tm_model.c
+// 流量管理器排队模型（见 tm_model.h）
+
+#include "tm_model.h"
+#include "sim_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TM_PORT_FLOOD   0xFF
+
+typedef struct {
+    uint64_t t_enq;
+    uint16_t len;
+    uint16_t cells;
+} tm_pkt_t;
+
+typedef struct {
+    tm_pkt_t    *ring;          // 容量为 2 的幂，按需倍增
+    uint32_t     cap, head, cnt;
+    uint64_t     t_occ;         // occ_sum 上次累加的时刻
+    tm_qstats_t  st;
+} tm_queue_t;
+
+typedef struct {
+    double   link_cr;           // 线速信用（bytes，可为负 = 正在发送上一帧）
+    double   pir_tok;           // PIR 令牌（bytes，可为负）
+    uint64_t t_idle;            // 变空闲的时刻（重新变忙时补齐信用）
+    uint32_t backlog;           // 排队报文数
+    uint32_t deficit[TM_QUEUES];
+    uint8_t  rr;                // DWRR 当前队列
+    uint8_t  rr_fresh;          // 1 = 到达 rr 后尚未加量子
+} tm_port_t;
+
+struct tm_model {
+    tm_cfg_t   cfg;
+    uint64_t   now;             // 下一个时间步的起点
+    uint32_t   used_cells;
+    uint32_t   busy;            // 有积压的端口位图
+    uint32_t   stuck;           // 有积压但没有可调度队列的端口（DWRR 权重全 0）
+    tm_port_t  port[TM_PORTS];
+    tm_queue_t q[TM_PORTS][TM_QUEUES];
+};
+
+// ─────────────────────────────────────────────
+// 队列
+// ─────────────────────────────────────────────
+
+static void occ_touch(tm_model_t *tm, tm_queue_t *q)
+{
+    q->st.occ_sum += (uint64_t)q->st.qlen_cells * (tm->now - q->t_occ);
+    q->t_occ = tm->now;
+}
+
+static int q_push(tm_queue_t *q, const tm_pkt_t *pk)
+{
+    if (q->cnt == q->cap) {
+        uint32_t ncap = q->cap ? q->cap * 2 : 64;
+        tm_pkt_t *nr = (tm_pkt_t *)malloc((size_t)ncap * sizeof(tm_pkt_t));
+        if (!nr) return -1;
+        for (uint32_t i = 0; i < q->cnt; i++)
+            nr[i] = q->ring[(q->head + i) & (q->cap - 1)];
+        free(q->ring);
+        q->ring = nr;
+        q->cap  = ncap;
+        q->head = 0;
+    }
+    q->ring[(q->head + q->cnt) & (q->cap - 1)] = *pk;
+    q->cnt++;
+    return 0;
+}
+
+static inline const tm_pkt_t *q_head(const tm_queue_t *q)
+{
+    return &q->ring[q->head];
+}
+
+// ─────────────────────────────────────────────
+// 调度
+// ─────────────────────────────────────────────
+
+static inline int highest(uint32_t mask)
+{
+    return 31 - __builtin_clz(mask);
+}
+
+// DWRR：在 mask 内的非空队列间轮转；返回 -1 表示没有权重非 0 的队列
+static int dwrr_pick(tm_model_t *tm, int p, uint32_t mask)
+{
+    tm_port_t      *pt = &tm->port[p];
+    const uint32_t *w  = sim_qos_dwrr[p];
+
+    for (int pass = 0; pass < 2; pass++) {
+        // 2 整轮 + 1 次访问：每个候选队列至少加过一次量子
+        for (int n = 0; n <= 2 * TM_QUEUES; n++) {
+            int q = pt->rr;
+            if (((mask >> q) & 1) && w[q]) {
+                if (pt->rr_fresh) {
+                    pt->deficit[q] += w[q];
+                    pt->rr_fresh = 0;
+                }
+                if (q_head(&tm->q[p][q])->len <= pt->deficit[q]) return q;
+            }
+            pt->rr = (uint8_t)((q + 1) % TM_QUEUES);
+            pt->rr_fresh = 1;
+        }
+
+        // 量子远小于帧长：直接跳过 k-1 个谁都发不了的空转轮次
+        uint32_t k = UINT32_MAX;
+        for (int q = 0; q < TM_QUEUES; q++) {
+            if (!((mask >> q) & 1) || !w[q]) continue;
+            uint32_t need = (q_head(&tm->q[p][q])->len - pt->deficit[q] + w[q] - 1) / w[q];
+            if (need < k) k = need;
+        }
+        if (k == UINT32_MAX) return -1;
+        for (int q = 0; q < TM_QUEUES; q++)
+            if (((mask >> q) & 1) && w[q]) pt->deficit[q] += (k - 1) * w[q];
+    }
+    return -1;
+}
+
+// 按端口调度模式选出下一个发送队列；*by_dwrr 指示是否消耗亏额
+static int sched_pick(tm_model_t *tm, int p, int *by_dwrr)
+{
+    uint32_t mask = 0;
+    for (int q = 0; q < TM_QUEUES; q++)
+        if (tm->q[p][q].cnt) mask |= 1u << q;
+    if (!mask) return -1;
+
+    uint32_t sp_mask;
+    switch (sim_qos_mode[p]) {
+    case QOS_SCHED_SP:      sp_mask = (1u << TM_QUEUES) - 1; break;
+    case QOS_SCHED_SP_DWRR: {
+        uint8_t n = tm->cfg.sp_queues[p] < TM_QUEUES ? tm->cfg.sp_queues[p] : TM_QUEUES;
+        sp_mask = ((1u << n) - 1) << (TM_QUEUES - n);
+        break;
+    }
+    default:                sp_mask = 0; break;
+    }
+
+    if (mask & sp_mask) {
+        *by_dwrr = 0;
+        return highest(mask & sp_mask);
+    }
+    *by_dwrr = 1;
+    return dwrr_pick(tm, p, mask & ~sp_mask);
+}
+
+// 一个时间步：各有积压端口按线速 / PIR 信用发送
+static void tm_tick(tm_model_t *tm)
+{
+    const double tick = (double)tm->cfg.tick_ns;
+    const double line = (double)tm->cfg.port_bps * tick / 8e9;
+
+    for (uint32_t m = tm->busy; m; m &= m - 1) {
+        int p = __builtin_ctz(m);
+        tm_port_t *pt  = &tm->port[p];
+        uint64_t   pir = sim_qos_pir[p];
+
+        pt->link_cr += line;
+        if (pt->link_cr > line) pt->link_cr = line;      // 被 PIR / 调度阻塞时不囤积线速
+        if (pir) {
+            pt->pir_tok += (double)pir * tick / 8e9;
+            if (pt->pir_tok > (double)tm->cfg.pir_burst) pt->pir_tok = (double)tm->cfg.pir_burst;
+        }
+
+        tm->stuck &= ~(1u << p);
+        while (pt->backlog && pt->link_cr > 0 && (!pir || pt->pir_tok > 0)) {
+            int by_dwrr;
+            int qi = sched_pick(tm, p, &by_dwrr);
+            if (qi < 0) { tm->stuck |= 1u << p; break; }
+
+            tm_queue_t     *q  = &tm->q[p][qi];
+            const tm_pkt_t  pk = *q_head(q);
+            occ_touch(tm, q);
+            q->head = (q->head + 1) & (q->cap - 1);
+            q->cnt--;
+            pt->backlog--;
+            tm->used_cells -= pk.cells;
+
+            uint64_t delay = tm->now - pk.t_enq;
+            q->st.qlen_pkts--;
+            q->st.qlen_cells -= pk.cells;
+            q->st.tx_pkts++;
+            q->st.tx_bytes += pk.len;
+            q->st.delay_sum_ns += delay;
+            if (delay > q->st.delay_max_ns) q->st.delay_max_ns = delay;
+
+            pt->link_cr -= (double)(pk.len + tm->cfg.ifg_bytes);
+            if (pir) pt->pir_tok -= (double)pk.len;
+            if (by_dwrr) pt->deficit[qi] -= pk.len;
+            if (!q->cnt) pt->deficit[qi] = 0;
+        }
+
+        if (!pt->backlog) {
+            tm->busy &= ~(1u << p);
+            if (pt->link_cr > 0) pt->link_cr = 0;
+            pt->t_idle = tm->now + tm->cfg.tick_ns;
+        }
+    }
+}
+
+// ─────────────────────────────────────────────
+// 公共 API
+// ─────────────────────────────────────────────
+
+void tm_cfg_default(tm_cfg_t *cfg)
+{
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->port_bps     = 100000000000ULL;
+    cfg->tick_ns      = 100;
+    cfg->buffer_cells = 65536;
+    cfg->dt_alpha     = 1.0;
+    cfg->pir_burst    = 16384;
+    cfg->ifg_bytes    = 20;
+}
+
+tm_model_t *tm_create(const tm_cfg_t *cfg)
+{
+    tm_model_t *tm = (tm_model_t *)calloc(1, sizeof(*tm));
+    if (!tm) return NULL;
+    if (cfg) tm->cfg = *cfg;
+    else     tm_cfg_default(&tm->cfg);
+    if (!tm->cfg.tick_ns)  tm->cfg.tick_ns  = 1;
+    if (!tm->cfg.port_bps) tm->cfg.port_bps = 100000000000ULL;
+    tm_reset(tm);
+    return tm;
+}
+
+void tm_destroy(tm_model_t *tm)
+{
+    if (!tm) return;
+    for (int p = 0; p < TM_PORTS; p++)
+        for (int q = 0; q < TM_QUEUES; q++)
+            free(tm->q[p][q].ring);
+    free(tm);
+}
+
+void tm_reset(tm_model_t *tm)
+{
+    if (!tm) return;
+    for (int p = 0; p < TM_PORTS; p++) {
+        for (int q = 0; q < TM_QUEUES; q++) {
+            tm_queue_t *qq = &tm->q[p][q];
+            qq->head = qq->cnt = 0;
+            qq->t_occ = 0;
+            memset(&qq->st, 0, sizeof(qq->st));
+        }
+        memset(&tm->port[p], 0, sizeof(tm->port[p]));
+        tm->port[p].rr_fresh = 1;
+        tm->port[p].pir_tok  = (double)tm->cfg.pir_burst;
+    }
+    tm->now        = 0;
+    tm->used_cells = 0;
+    tm->busy       = 0;
+    tm->stuck      = 0;
+}
+
+void tm_advance(tm_model_t *tm, uint64_t t_ns)
+{
+    if (!tm) return;
+    while (tm->now < t_ns) {
+        if (!tm->busy) {
+            // 全部空闲：直接跳到 t_ns 之后的第一个时间步
+            uint64_t steps = (t_ns - tm->now + tm->cfg.tick_ns - 1) / tm->cfg.tick_ns;
+            tm->now += steps * tm->cfg.tick_ns;
+            break;
+        }
+        tm_tick(tm);
+        tm->now += tm->cfg.tick_ns;
+    }
+}
+
+uint64_t tm_drain(tm_model_t *tm)
+{
+    if (!tm) return 0;
+    while (tm->busy & ~tm->stuck) {
+        tm_tick(tm);
+        tm->now += tm->cfg.tick_ns;
+    }
+    return tm->now;
+}
+
+int tm_enqueue(tm_model_t *tm, uint64_t t_ns, uint8_t port, uint8_t queue, uint16_t len)
+{
+    if (!tm || port >= TM_PORTS || queue >= TM_QUEUES || !len) return -1;
+    tm_advance(tm, t_ns);
+
+    tm_queue_t *q  = &tm->q[port][queue];
+    tm_pkt_t    pk = { tm->now, len, (uint16_t)((len + TM_CELL_DATA_BYTES - 1) / TM_CELL_DATA_BYTES) };
+    q->st.enq_pkts++;
+    q->st.enq_bytes += len;
+
+    // 共享缓冲准入：总容量 + 动态门限
+    uint32_t free_cells = tm->cfg.buffer_cells - tm->used_cells;
+    if (pk.cells > free_cells ||
+        (tm->cfg.dt_alpha > 0 &&
+         (double)q->st.qlen_cells >= tm->cfg.dt_alpha * (double)free_cells) ||
+        q_push(q, &pk) != 0) {
+        q->st.drop_pkts++;
+        q->st.drop_bytes += len;
+        return TM_ENQ_DROP;
+    }
+
+    occ_touch(tm, q);
+    q->st.qlen_pkts++;
+    q->st.qlen_cells += pk.cells;
+    if (q->st.qlen_cells > q->st.peak_cells) q->st.peak_cells = q->st.qlen_cells;
+    tm->used_cells += pk.cells;
+
+    tm_port_t *pt = &tm->port[port];
+    if (!pt->backlog++) {
+        // 空闲期间补齐 PIR 令牌；线速信用只还清上一帧的发送时间，不囤积
+        double idle = tm->now > pt->t_idle ? (double)(tm->now - pt->t_idle) : 0.0;
+        pt->link_cr += (double)tm->cfg.port_bps * idle / 8e9;
+        if (pt->link_cr > 0) pt->link_cr = 0;
+        pt->pir_tok += (double)sim_qos_pir[port] * idle / 8e9;
+        if (pt->pir_tok > (double)tm->cfg.pir_burst) pt->pir_tok = (double)tm->cfg.pir_burst;
+        tm->busy |= 1u << port;
+    }
+    tm->stuck &= ~(1u << port);
+    return TM_ENQ_OK;
+}
+
+int tm_enqueue_result(tm_model_t *tm, uint64_t t_ns, const fwd_result_t *result, uint16_t len)
+{
+    if (!tm || !result) return -1;
+    if (result->drop || result->punt || result->eg_port == TM_PORT_FLOOD) {
+        tm_advance(tm, t_ns);
+        return TM_ENQ_SKIP;
+    }
+    return tm_enqueue(tm, t_ns, result->eg_port, result->qos_prio, len);
+}
+
+uint64_t tm_now(const tm_model_t *tm)
+{
+    return tm ? tm->now : 0;
+}
+
+uint32_t tm_buffer_used(const tm_model_t *tm)
+{
+    return tm ? tm->used_cells : 0;
+}
+
+int tm_get_qstats(const tm_model_t *tm, uint8_t port, uint8_t queue, tm_qstats_t *st)
+{
+    if (!tm || !st || port >= TM_PORTS || queue >= TM_QUEUES) return -1;
+    const tm_queue_t *q = &tm->q[port][queue];
+    *st = q->st;
+    st->occ_sum += (uint64_t)q->st.qlen_cells * (tm->now - q->t_occ);
+    return 0;
+}
+
+void tm_report(const tm_model_t *tm, int port)
+{
+    if (!tm) return;
+    double secs = (double)tm->now * 1e-9;
+    printf("TM @ %.3f us  buffer %u/%u cells\n",
+           (double)tm->now * 1e-3, tm->used_cells, tm->cfg.buffer_cells);
+    for (int p = 0; p < TM_PORTS; p++) {
+        if (port >= 0 && port < TM_PORTS && p != port) continue;
+        int active = 0;
+        for (int q = 0; q < TM_QUEUES; q++) active |= tm->q[p][q].st.enq_pkts != 0;
+        if (!active) continue;
+
+        static const char *modes[] = {"DWRR", "SP", "SP+DWRR"};
+        printf("Port%2d  mode=%-8s  PIR=%llu bps\n", p,
+               modes[sim_qos_mode[p] < 3 ? sim_qos_mode[p] : 0],
+               (unsigned long long)sim_qos_pir[p]);
+        printf("  Q   tx_pkts      Gbps    drops  occ_avg  occ_peak  delay_avg_us  delay_max_us\n");
+        for (int q = 0; q < TM_QUEUES; q++) {
+            tm_qstats_t st;
+            tm_get_qstats(tm, (uint8_t)p, (uint8_t)q, &st);
+            if (!st.enq_pkts) continue;
+            printf("  %d %9llu %9.3f %8llu %8.1f %9u %13.3f %13.3f\n", q,
+                   (unsigned long long)st.tx_pkts,
+                   secs > 0 ? (double)st.tx_bytes * 8 / secs / 1e9 : 0.0,
+                   (unsigned long long)st.drop_pkts,
+                   tm->now ? (double)st.occ_sum / (double)tm->now : 0.0,
+                   st.peak_cells,
+                   st.tx_pkts ? (double)st.delay_sum_ns / (double)st.tx_pkts * 1e-3 : 0.0,
+                   (double)st.delay_max_ns * 1e-3);
+        }
+    }
+}
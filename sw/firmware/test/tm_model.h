@@ -0,0 +1,112 @@
+// tm_model.h
+// 流量管理器（TM）排队模型 — 接在 pkt_forward() 之后的出口调度仿真
+//
+// 按固定时间步长推进的出口模型，用于在上线前验证 QoS 配置的性能表现：
+//
+//   - 32 端口 × 8 队列，队列号 = fwd_result_t.qos_prio（0 最低）；
+//   - 调度参数直接读 qos.c 写入的 TM CSR 镜像（sim_qos_dwrr / sim_qos_pir /
+//     sim_qos_mode），运行中修改配置下一个时间步即生效：
+//       DWRR     每队列亏额计数器，权重（bytes）即每轮量子；权重 0 的队列不被调度
+//       SP       高队列号严格优先
+//       SP_DWRR  高 sp_queues 个队列 SP，其余 DWRR（sp_queues 不在 CSR 中，
+//                由 tm_cfg_t.sp_queues 给出）
+//       PIR      端口级令牌桶（帧字节计），0 = 不限速
+//   - 端口线速按线上字节（帧长 + 前导码/IFG）计；
+//   - 共享缓冲按 cell 计（每 cell 60B 数据，与 rv_p4_pkg CELL_DATA_BYTES 一致），
+//     入队时做总容量检查与动态门限（队列 cell 数 < alpha × 空闲 cell 数）。
+//
+// 统计：每队列入队 / 发送 / 丢弃的包数与字节数、当前与峰值占用、
+// 时间加权平均占用、排队时延（入队到开始发送）的平均值与最大值。
+//
+// 时间单位 ns，由调用者提供的报文到达时间驱动；非线程安全。
+
+#ifndef TM_MODEL_H
+#define TM_MODEL_H
+
+#include <stdint.h>
+#include "pkt_model.h"
+#include "qos.h"
+
+#define TM_PORTS            32
+#define TM_QUEUES           QOS_QUEUES_PER_PORT
+#define TM_CELL_DATA_BYTES  60      // 每 cell 有效数据（rv_p4_pkg CELL_DATA_BYTES）
+
+// tm_enqueue 返回值
+#define TM_ENQ_OK           0
+#define TM_ENQ_DROP         1       // 缓冲不足 / 超过动态门限，尾丢弃
+#define TM_ENQ_SKIP         2       // 转发结果为丢弃 / 上送 CPU / 泛洪，不进入出口队列
+
+typedef struct tm_model tm_model_t;
+
+typedef struct {
+    uint64_t port_bps;              // 端口线速（默认 100 Gbps）
+    uint32_t tick_ns;               // 时间步长（默认 100 ns）
+    uint32_t buffer_cells;          // 共享缓冲 cell 数（默认 65536）
+    double   dt_alpha;              // 动态门限系数（默认 1.0；<= 0 只检查总容量）
+    uint32_t pir_burst;             // PIR 令牌桶深度 bytes（默认 16384）
+    uint8_t  ifg_bytes;             // 每帧线上开销：前导码 + IFG（默认 20）
+    uint8_t  sp_queues[TM_PORTS];   // SP_DWRR 模式下的 SP 队列数（默认 0）
+} tm_cfg_t;
+
+typedef struct {
+    uint64_t enq_pkts,  enq_bytes;
+    uint64_t tx_pkts,   tx_bytes;
+    uint64_t drop_pkts, drop_bytes;
+    uint32_t qlen_pkts;             // 当前队列长度
+    uint32_t qlen_cells;
+    uint32_t peak_cells;
+    uint64_t occ_sum;               // Σ 队列 cell 数 × 持续 ns（平均占用 = occ_sum / 经过时间）
+    uint64_t delay_sum_ns;          // Σ 排队时延（对 tx_pkts 求平均）
+    uint64_t delay_max_ns;
+} tm_qstats_t;
+
+/** 填充默认配置 */
+void tm_cfg_default(tm_cfg_t *cfg);
+
+/**
+ * tm_create - 创建 TM 模型
+ * @cfg: NULL 使用默认配置
+ * 失败返回 NULL。
+ */
+tm_model_t *tm_create(const tm_cfg_t *cfg);
+
+void tm_destroy(tm_model_t *tm);
+
+/** 清空全部队列与统计，时间回到 0 */
+void tm_reset(tm_model_t *tm);
+
+/**
+ * tm_enqueue - 报文在 t_ns 时刻到达出口队列
+ * 先把模型推进到 t_ns，再做缓冲准入。t_ns 早于当前时间时按当前时间处理。
+ * 返回 TM_ENQ_OK / TM_ENQ_DROP；端口或队列越界返回 -1。
+ */
+int tm_enqueue(tm_model_t *tm, uint64_t t_ns, uint8_t port, uint8_t queue, uint16_t len);
+
+/**
+ * tm_enqueue_result - 按 pkt_forward 的转发结果入队
+ * 出端口 = result->eg_port，队列 = result->qos_prio；
+ * drop / punt / 泛洪（eg_port 0xFF，复制不建模）返回 TM_ENQ_SKIP。
+ */
+int tm_enqueue_result(tm_model_t *tm, uint64_t t_ns, const fwd_result_t *result, uint16_t len);
+
+/** 把模型推进到 t_ns（执行其间的所有时间步） */
+void tm_advance(tm_model_t *tm, uint64_t t_ns);
+
+/** 推进直到全部队列排空，返回排空时刻 */
+uint64_t tm_drain(tm_model_t *tm);
+
+/** 当前模型时间（ns） */
+uint64_t tm_now(const tm_model_t *tm);
+
+/** 共享缓冲当前占用 cell 数 */
+uint32_t tm_buffer_used(const tm_model_t *tm);
+
+int tm_get_qstats(const tm_model_t *tm, uint8_t port, uint8_t queue, tm_qstats_t *st);
+
+/**
+ * tm_report - 打印有流量端口的每队列吞吐、丢包、占用与时延
+ * @port: 0-31 只打印该端口；其他值打印全部端口
+ */
+void tm_report(const tm_model_t *tm, int port);
+
+#endif /* TM_MODEL_H */
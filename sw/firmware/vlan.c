@@ -4,7 +4,7 @@
 //
 // 数据面规则布局：
 //   Stage 4（入口）：(ing_port[7:0], vlan_tci[15:0]) → 分配 meta.vlan_id
-//   Stage 6（出口）：(eg_port[7:0],  meta.vlan_id[7:0]) → strip / keep 标签
+//   Stage 7（出口）：(eg_port[7:0],  meta.vlan_id[7:0]) → strip / keep 标签
 
 #include "vlan.h"
 #include "table_map.h"
@@ -92,7 +92,7 @@ int vlan_port_set_mode(port_id_t port, uint8_t mode);
 
 /**
  * vlan_install_port_rules - 向数据面安装指定端口的 VLAN 入口+出口规则
- *   内部调用 hal_tcam_insert()，在 stage 4（入口）和 stage 6（出口）写规则
+ *   内部调用 hal_tcam_insert()，在 stage 4（入口）和 stage 7（出口）写规则
  */
 void vlan_install_port_rules(port_id_t port);
 
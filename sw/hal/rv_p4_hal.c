@@ -22,6 +22,69 @@ static int tue_wait_idle(void) {
     return HAL_ERR_TIMEOUT;
 }
 
+// 等待刚写入的 COMMIT / 关批生效：tue.sv 从写入当拍起报 busy，先看到 busy 再等
+// 它离开（DONE 或回到 IDLE）；只看 IDLE 会在 FSM 接收请求之前就返回
+static int tue_wait_done(void) {
+    int timeout = 100000;
+    int seen_busy = 0;
+    while (timeout--) {
+        uint32_t st = MMIO_RD32(HAL_BASE_TUE + TUE_REG_STATUS) & 0x3;
+        if (st == TUE_STATUS_ERROR)
+            return HAL_ERR_BUSY;
+        if (st == TUE_STATUS_BUSY)
+            seen_busy = 1;
+        else if (st == TUE_STATUS_DONE || seen_busy)
+            return HAL_OK;
+    }
+    return HAL_ERR_TIMEOUT;
+}
+
+// TUE 寄存器影子：CMD..ACTION_P2 在事务之间保持不变（tue.sv 只在 APB 写时
+// 更新），与上次写入相同的值不再重复写。相邻路由条目通常只有 table_id、
+// key/mask 首个字与 action 参数不同，每条约 40 次 APB 写降到 10 次以内。
+// TUE 与香山核同一复位域，影子只需在上电时为空。
+static uint32_t tue_shadow[TUE_REG_STATUS / 4];
+static uint8_t  tue_shadow_ok[TUE_REG_STATUS / 4];
+
+static void tue_wr(uint32_t off, uint32_t val) {
+    uint32_t i = off / 4;
+    if (tue_shadow_ok[i] && tue_shadow[i] == val) return;
+    MMIO_WR32(HAL_BASE_TUE + off, val);
+    tue_shadow[i]    = val;
+    tue_shadow_ok[i] = 1;
+}
+
+// 批量状态（hal_tcam_batch_begin / commit）
+static int tue_batch_open;
+static int tue_batch_n;         // 本批已入队条数
+static int tue_batch_depth;     // TUE 暂存 FIFO 条数（BATCH 读回），0 = 逐条提交
+static int tue_batch_err;       // 本批自动提交的第一个错误，由 commit 返回
+
+// 关闭当前批：整批排空一次后逐条生效（空批不启动事务，不会报 busy）
+static int tue_batch_close(void) {
+    int n = tue_batch_n;
+    MMIO_WR32(HAL_BASE_TUE + TUE_REG_BATCH, 0x0);
+    tue_batch_n = 0;
+    return n ? tue_wait_done() : tue_wait_idle();
+}
+
+// 每个 TUE 操作写寄存器前调用：非批量时等上一事务结束；
+// 批量时队列已满则先提交当前批（等全部生效，TUE 回到 IDLE），再开新批。
+// 提交失败时不重开批（TUE 未回到 IDLE，BATCH 写 1 会把后续请求压进一个
+// 无人关闭的批）：返回错误，本批余下的调用改为逐条提交
+static int tue_begin(void) {
+    if (!tue_batch_open || !tue_batch_depth) return tue_wait_idle();
+    if (tue_batch_n < tue_batch_depth) return HAL_OK;
+    int ret = tue_batch_close();
+    if (ret != HAL_OK) {
+        tue_batch_depth = 0;
+        tue_batch_err   = ret;
+        return ret;
+    }
+    MMIO_WR32(HAL_BASE_TUE + TUE_REG_BATCH, 0x1);
+    return HAL_OK;
+}
+
 // 将 64B key/mask 写入 TUE 寄存器（16 × 32b）
 static void tue_write_key(uint32_t base_off, const uint8_t *data, uint8_t len) {
     uint8_t buf[64] = {0};
@@ -32,14 +95,18 @@ static void tue_write_key(uint32_t base_off, const uint8_t *data, uint8_t len) {
                         ((uint32_t)buf[i*4+1] << 8)  |
                         ((uint32_t)buf[i*4+2] << 16) |
                         ((uint32_t)buf[i*4+3] << 24);
-        MMIO_WR32(HAL_BASE_TUE + base_off + i * 4, word);
+        tue_wr(base_off + (uint32_t)i * 4, word);
     }
 }
 
-// 提交 TUE 事务并等待完成
+// 提交 TUE 事务并等待完成（批量模式下只入队）
 static int tue_commit(void) {
     MMIO_WR32(HAL_BASE_TUE + TUE_REG_COMMIT, 0x1);
-    return tue_wait_idle();
+    if (tue_batch_open && tue_batch_depth) {
+        tue_batch_n++;
+        return HAL_OK;
+    }
+    return tue_wait_done();
 }
 
 // ─────────────────────────────────────────────
@@ -49,20 +116,20 @@ static int tue_commit(void) {
 int hal_tcam_insert(const tcam_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
 
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
     // 写命令和目标
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,      TUE_CMD_INSERT);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_TABLE_ID, entry->table_id);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE,    entry->stage);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_INSERT);
+    tue_wr(TUE_REG_TABLE_ID, entry->table_id);
+    tue_wr(TUE_REG_STAGE,    entry->stage);
 
     // 写 key / mask
     tue_write_key(TUE_REG_KEY_BASE,  entry->key.bytes,  entry->key.key_len);
     tue_write_key(TUE_REG_MASK_BASE, entry->mask.bytes, entry->mask.key_len);
 
     // 写 action
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_ID, entry->action_id);
+    tue_wr(TUE_REG_ACTION_ID, entry->action_id);
 
     uint32_t p0 = 0, p1 = 0, p2 = 0;
     for (int i = 0; i < 4 && i < 12; i++)
@@ -72,20 +139,20 @@ int hal_tcam_insert(const tcam_entry_t *entry) {
     for (int i = 0; i < 4 && (i+8) < 12; i++)
         p2 |= ((uint32_t)entry->action_params[i+8] << (i * 8));
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P0, p0);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P1, p1);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P2, p2);
+    tue_wr(TUE_REG_ACTION_P0, p0);
+    tue_wr(TUE_REG_ACTION_P1, p1);
+    tue_wr(TUE_REG_ACTION_P2, p2);
 
     return tue_commit();
 }
 
 int hal_tcam_delete(uint8_t stage, uint16_t table_id) {
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,      TUE_CMD_DELETE);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_TABLE_ID, table_id);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE,    stage);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_DELETE);
+    tue_wr(TUE_REG_TABLE_ID, table_id);
+    tue_wr(TUE_REG_STAGE,    stage);
 
     return tue_commit();
 }
@@ -93,33 +160,56 @@ int hal_tcam_delete(uint8_t stage, uint16_t table_id) {
 int hal_tcam_modify(const tcam_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
 
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,      TUE_CMD_MODIFY);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_TABLE_ID, entry->table_id);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE,    entry->stage);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_MODIFY);
+    tue_wr(TUE_REG_TABLE_ID, entry->table_id);
+    tue_wr(TUE_REG_STAGE,    entry->stage);
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_ID, entry->action_id);
+    tue_wr(TUE_REG_ACTION_ID, entry->action_id);
 
     uint32_t p0 = 0, p1 = 0, p2 = 0;
     for (int i = 0; i < 4; i++) p0 |= ((uint32_t)entry->action_params[i]   << (i*8));
     for (int i = 0; i < 4; i++) p1 |= ((uint32_t)entry->action_params[i+4] << (i*8));
     for (int i = 0; i < 4; i++) p2 |= ((uint32_t)entry->action_params[i+8] << (i*8));
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P0, p0);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P1, p1);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_ACTION_P2, p2);
+    tue_wr(TUE_REG_ACTION_P0, p0);
+    tue_wr(TUE_REG_ACTION_P1, p1);
+    tue_wr(TUE_REG_ACTION_P2, p2);
 
     return tue_commit();
 }
 
-int hal_tcam_flush(uint8_t stage) {
+// TUE 未实现暂存 FIFO（BATCH 读回 depth = 0，rv_p4_top 默认配置）时批内
+// 各调用退化为逐条提交，接口语义不变
+int hal_tcam_batch_begin(void) {
+    if (tue_batch_open) return HAL_ERR_BUSY;
     int ret = tue_wait_idle();
     if (ret != HAL_OK) return ret;
+    uint32_t depth = (MMIO_RD32(HAL_BASE_TUE + TUE_REG_BATCH) >> 8) & 0xFF;
+    tue_batch_depth = depth < HAL_TCAM_BATCH_MAX ? (int)depth : HAL_TCAM_BATCH_MAX;
+    if (tue_batch_depth)
+        MMIO_WR32(HAL_BASE_TUE + TUE_REG_BATCH, 0x1);
+    tue_batch_open = 1;
+    tue_batch_n    = 0;
+    tue_batch_err  = HAL_OK;
+    return HAL_OK;
+}
+
+int hal_tcam_batch_commit(void) {
+    if (!tue_batch_open) return HAL_ERR_INVAL;
+    tue_batch_open = 0;
+    int ret = tue_batch_depth ? tue_batch_close() : HAL_OK;
+    return tue_batch_err != HAL_OK ? tue_batch_err : ret;
+}
+
+int hal_tcam_flush(uint8_t stage) {
+    int ret = tue_begin();
+    if (ret != HAL_OK) return ret;
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,   TUE_CMD_FLUSH);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE, stage);
+    tue_wr(TUE_REG_CMD,   TUE_CMD_FLUSH);
+    tue_wr(TUE_REG_STAGE, stage);
 
     return tue_commit();
 }
@@ -163,14 +253,14 @@ int hal_meter_config(meter_id_t id, const meter_cfg_t *cfg) {
 int hal_parser_add_state(const fsm_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
 
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
     // 将 FSM 条目编码为 key 字段传递给 TUE
     // stage=0x1F 表示 Parser 目标
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,      TUE_CMD_INSERT);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE,    0x1F);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_TABLE_ID, entry->cur_state);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_INSERT);
+    tue_wr(TUE_REG_STAGE,    0x1F);
+    tue_wr(TUE_REG_TABLE_ID, entry->cur_state);
 
     // key[0] = cur_state + key_window[0..7]
     uint8_t key_buf[64] = {0};
@@ -190,12 +280,12 @@ int hal_parser_add_state(const fsm_entry_t *entry) {
 }
 
 int hal_parser_del_state(uint8_t state_id) {
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_CMD,      TUE_CMD_DELETE);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_STAGE,    0x1F);
-    MMIO_WR32(HAL_BASE_TUE + TUE_REG_TABLE_ID, state_id);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_DELETE);
+    tue_wr(TUE_REG_STAGE,    0x1F);
+    tue_wr(TUE_REG_TABLE_ID, state_id);
 
     return tue_commit();
 }
@@ -321,14 +411,7 @@ int hal_qos_dscp_map_set(uint8_t dscp, uint8_t queue) {
  *   slot 起始地址 = PUNT_RING_RX_BASE + (prod % SLOTS) * SLOT_SIZE
  *   描述符 = punt_pkt_t，前 8 字节为 ing_port/eg_port/pkt_len/vlan_id/reason
  */
-int hal_punt_rx_poll(punt_pkt_t *pkt) {
-    if (!pkt) return HAL_ERR_INVAL;
-
-    uint32_t prod = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_PROD);
-    uint32_t cons = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_CONS);
-    if (prod == cons)
-        return -1;   // 环空
-
+static void punt_rx_read_slot(uint32_t cons, punt_pkt_t *pkt) {
     /* 计算槽地址 */
     uint32_t slot = cons % PUNT_RING_SLOTS;
     uintptr_t base = (uintptr_t)(HAL_BASE_PUNT + PUNT_RING_RX_BASE +
@@ -356,12 +439,43 @@ int hal_punt_rx_poll(punt_pkt_t *pkt) {
         if (off + 2 < data_len) pkt->data[off+2] = (uint8_t)((d >> 16) & 0xFF);
         if (off + 3 < data_len) pkt->data[off+3] = (uint8_t)((d >> 24) & 0xFF);
     }
+}
+
+int hal_punt_rx_poll(punt_pkt_t *pkt) {
+    if (!pkt) return HAL_ERR_INVAL;
+
+    uint32_t prod = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_PROD);
+    uint32_t cons = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_CONS);
+    if (prod == cons)
+        return -1;   // 环空
+
+    punt_rx_read_slot(cons, pkt);
 
     /* 消费指针推进 */
     MMIO_WR32(HAL_BASE_PUNT + PUNT_REG_RX_CONS, cons + 1);
     return HAL_OK;
 }
 
+/*
+ * 批量收包：PROD / CONS 各读一次，取走 min(max, prod - cons) 个槽后
+ * 只写一次 CONS，HW 一次性看到释放的槽位
+ */
+int hal_punt_rx_poll_burst(punt_pkt_t *pkts, int max) {
+    if (!pkts || max <= 0) return 0;
+
+    uint32_t prod = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_PROD);
+    uint32_t cons = MMIO_RD32(HAL_BASE_PUNT + PUNT_REG_RX_CONS);
+    uint32_t n    = prod - cons;
+    if (n > (uint32_t)max) n = (uint32_t)max;
+    if (n == 0) return 0;
+
+    for (uint32_t i = 0; i < n; i++)
+        punt_rx_read_slot(cons + i, &pkts[i]);
+
+    MMIO_WR32(HAL_BASE_PUNT + PUNT_REG_RX_CONS, cons + n);
+    return (int)n;
+}
+
 int hal_punt_tx_send(const punt_pkt_t *pkt) {
     if (!pkt) return HAL_ERR_INVAL;
 
@@ -431,7 +545,7 @@ void hal_uart_puts(const char *s) {
 // ─────────────────────────────────────────────
 int hal_init(void) {
     // 等待 TUE 就绪
-    int ret = tue_wait_idle();
+    int ret = tue_begin();
     if (ret != HAL_OK) return ret;
 
     // 使能所有端口
@@ -30,6 +30,7 @@
 #define TUE_REG_ACTION_P2   0x09C
 #define TUE_REG_STATUS      0x0A0
 #define TUE_REG_COMMIT      0x0A4
+#define TUE_REG_BATCH       0x0A8   // 写 1 开批 / 写 0 提交；读 [0]=open [15:8]=FIFO 深度 [31:16]=已入队条数
 
 // TUE 命令
 #define TUE_CMD_INSERT      0x0
@@ -109,15 +110,25 @@ typedef struct {
 // ─────────────────────────────────────────────
 // MMIO 访问宏
 // ─────────────────────────────────────────────
+#ifdef HAL_MMIO_HOOK
+// host 端寄存器模型替换 MMIO（bench/bench_tue.c 的 TUE 时序模型）
+void     hal_mmio_wr32(uintptr_t addr, uint32_t val);
+uint32_t hal_mmio_rd32(uintptr_t addr);
+#define MMIO_WR32(addr, val) hal_mmio_wr32((uintptr_t)(addr), (val))
+#define MMIO_RD32(addr)      hal_mmio_rd32((uintptr_t)(addr))
+#else
 #define MMIO_WR32(addr, val) \
     (*(volatile uint32_t *)(uintptr_t)(addr) = (val))
 
 #define MMIO_RD32(addr) \
     (*(volatile uint32_t *)(uintptr_t)(addr))
+#endif
 
 // ─────────────────────────────────────────────
 // TCAM 表操作
 // ─────────────────────────────────────────────
+#define HAL_TCAM_DEPTH      2048    // 每级条目数，与 rv_p4_pkg.sv MAU_TCAM_DEPTH 一致；
+                                    // mau_tcam.sv 按 table_id 低 11 位寻址
 
 /**
  * hal_tcam_insert - 插入一条 TCAM 表项
@@ -143,6 +154,28 @@ int hal_tcam_modify(const tcam_entry_t *entry);
  */
 int hal_tcam_flush(uint8_t stage);
 
+// 批量更新：begin 与 commit 之间的 insert/delete/modify/flush 只写寄存器并
+// 入队（TUE 暂存 FIFO，深度由 TUE_REG_BATCH 读回，HAL 最多用 HAL_TCAM_BATCH_MAX
+// 条），不等排空；commit 时整批只排空一次，再按调用顺序逐条生效。
+// 批不是原子的：数据面看到的中间状态与逐条调用相同，省掉的只是排空。
+// 队列满时 HAL 自动提交当前批并开新批。批内各调用只校验参数，写入错误
+// 由 hal_tcam_batch_commit 返回。自动提交失败时，触发它的调用返回该错误，
+// 不再开新批，本批余下的调用逐条提交，commit 仍返回该错误。TUE 未实现 FIFO
+// （depth = 0，rv_p4_top 默认）时批内各调用逐条提交。
+#define HAL_TCAM_BATCH_MAX  64      // HAL 单批上限（TUE FIFO 可更小，见 tue.sv）
+
+/**
+ * hal_tcam_batch_begin - 开始批量更新
+ * 已在批量模式中返回 HAL_ERR_BUSY
+ */
+int hal_tcam_batch_begin(void);
+
+/**
+ * hal_tcam_batch_commit - 提交批量更新并等待全部条目生效
+ * 返回 HAL_OK 或错误码；未调用 hal_tcam_batch_begin 返回 HAL_ERR_INVAL
+ */
+int hal_tcam_batch_commit(void);
+
 // ─────────────────────────────────────────────
 // 计数器操作
 // ─────────────────────────────────────────────
@@ -247,6 +280,7 @@ typedef struct {
 #define PUNT_REASON_OTHER   1
 
 int hal_punt_rx_poll(punt_pkt_t *pkt);      /* 有包返回 HAL_OK，否则 -1 */
+int hal_punt_rx_poll_burst(punt_pkt_t *pkts, int max); /* 批量收包，返回个数；每批只写一次 RX_CONS */
 int hal_punt_tx_send(const punt_pkt_t *pkt); /* 写到 TX ring */
 
 // ─────────────────────────────────────────────
@@ -21,13 +21,59 @@
 //   CS-RTL-1: IPv4 LPM routing  → packet exits on expected TX port
 //   CS-RTL-2: L2 FDB forwarding → packet exits on expected TX port
 //   CS-RTL-3: ACL Deny          → no TX output (packet dropped)
+//   ... (RTL_TESTS[] lists every case)
+//   Each case runs in a forked process with its own model, --jobs at a
+//   time; --filter / --shard select cases (see run_tests()).
+//
+// Benchmark:
+//   cosim_sim --bench [N] — program one route, push N packets through the
+//   pipeline and report simulated dp-cycles/sec and packets/sec (wall clock).
+//   `make bench` runs this for THREADS=1/2/4/8.
+//
+// PCAP replay:
+//   cosim_sim --pcap-in in.pcap [--pcap-out DIR] [--rx-ports MASK]
+//             [--ifg BYTES] [--rate GBPS] [--port-rate P=GBPS]
+//             [--route A.B.C.D/LEN=PORT ...] [--no-tag] [--latency-csv F]
+//   Streams the capture across the RX ports, writes DIR/tx_portNN.pcap and
+//   reports per-port Mpps / Gbps (see run_replay()), plus per-egress-port
+//   latency min/p50/p99/max with a queueing breakdown (see lat_report()).
+//
+// Lockstep (differential check against sw/firmware/test/pkt_model.c):
+//   cosim_sim --lockstep route|acl|fdb [--lockstep-pkts N] [--lockstep-rules R]
+//             [--seed S] [--strict-rewrite] [--rx-ports MASK] [--rate GBPS]
+//   Same random rules into both models, same random packets, per-packet
+//   compare and greedy rule-set minimization of the first mismatch
+//   (see run_lockstep()).
+//   cosim_sim --lockstep parser [--lockstep-pkts N] [--lockstep-rules PROGS]
+//   Same random parser programs into pkt_parser.c and p4_parser.sv, per-frame
+//   compare of the parsed PHV (see run_parser_lockstep()).
+//
+// Warm start (make SAVABLE=1):
+//   Tests start from warm_start(profile, setup): a Verilator snapshot taken
+//   right after reset + parser programming + the test's table programming
+//   (routes, FDB, ACLs), cached under --snap-dir (default snap/).
+//   --no-snap forces the cold path.
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <fnmatch.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
 
 #include <verilated.h>
+#include <svdpi.h>
+#ifdef COSIM_SAVABLE
+#include <verilated_save.h>
+#endif
 #include "Vrv_p4_top.h"
 
 #include "../../sw/hal/rv_p4_hal.h"
@@ -35,6 +81,17 @@
 #include "../../sw/firmware/route.h"
 #include "../../sw/firmware/fdb.h"
 #include "../../sw/firmware/acl.h"
+#include "../../sw/firmware/test/sim_tcam.h"
+#include "../../sw/firmware/test/pkt_model.h"
+#include "../../sw/firmware/test/pkt_parser.h"
+
+#include "pcap_io.h"
+#ifdef COSIM_SPARSE_PB
+#include "pkt_buffer_dpi.h"
+#endif
+#ifdef COSIM_TCAM_DPI
+#include "mau_tcam_dpi.h"
+#endif
 
 // ─────────────────────────────────────────────────────────────────────────────
 // Global simulation state
@@ -47,29 +104,110 @@ static uint64_t    g_sim_time = 0;
 static int g_pass = 0;
 static int g_fail = 0;
 
+#ifndef COSIM_THREADS
+#define COSIM_THREADS 1
+#endif
+
+// Simulated dp cycles since model construction (g_sim_time counts half-periods)
+static inline uint64_t dp_cycles() { return g_sim_time / 2; }
+
+// Host wall-clock seconds since t0
+static double wall_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
-// Clock management
+// Clock management — edge-driven multi-domain scheduler
 //
-// We simulate at half-period resolution of clk_dp.
-// Ratios (half-periods of clk_dp):
-//   clk_dp   : 1 per tick  (1.6 GHz)
-//   clk_ctrl : 8 per tick  (200 MHz,  ratio dp:ctrl = 8:1)
-//   clk_mac  : 4 per tick  (390.625 MHz, ratio dp:mac ≈ 4:1)
-//   clk_cpu  : 1 per tick  (same phase as clk_dp for simplicity)
+// Time base: 1 tick = half a clk_dp period (312.5 ps).  Each clock domain
+// toggles every `half` ticks:
+//   clk_dp   : 1 tick   (1.6 GHz)
+//   clk_ctrl : 8 ticks  (200 MHz,  ratio dp:ctrl = 8:1)
+//   clk_mac  : 4 ticks  (390.625 MHz, ratio dp:mac ≈ 4:1)
+//   clk_cpu  : 1 tick   (same phase as clk_dp for simplicity)
+//
+// sched_run() jumps straight from one toggle time to the next and calls
+// eval() once per distinct edge time, never in between.  A domain can be
+// gated (clock held at its current level, no edges generated); while the
+// data path is idle the APB/TUE helpers gate dp/mac/cpu so that control
+// programming only evaluates the model on clk_ctrl edges (8× fewer evals),
+// and a commit skips the TUE's WAIT_DRAIN countdown (see tue_wait_done()).
+//
+// Data path "idle" = no RX valid, no TX valid and no RX/TX activity for
+// DP_DRAIN_TICKS — i.e. every injected frame has had time to leave the
+// pipeline.  Fast-forward can be disabled with --no-ff.
 // ─────────────────────────────────────────────────────────────────────────────
 
-static void step_half() {
-    g_sim_time++;
-    g_top->clk_dp   = (g_sim_time       % 2 == 0) ? 1 : 0;
-    g_top->clk_cpu  = (g_sim_time       % 2 == 0) ? 1 : 0;
-    g_top->clk_ctrl = ((g_sim_time / 8) % 2 == 0) ? 1 : 0;
-    g_top->clk_mac  = ((g_sim_time / 4) % 2 == 0) ? 1 : 0;
-    g_top->eval();
+enum { CLK_DP = 0, CLK_CTRL, CLK_MAC, CLK_CPU, CLK_NUM };
+
+struct clk_domain_t {
+    uint64_t half;      // half period in ticks
+    uint64_t next;      // absolute tick of the next toggle
+    uint8_t  level;
+    bool     gated;
+};
+
+static clk_domain_t g_clk[CLK_NUM];
+static uint64_t     g_evals         = 0;     // eval() calls (scheduler cost)
+static bool         g_ff_enable     = true;  // fast-forward allowed
+static uint64_t     g_last_dp_activity = 0;  // tick of last RX/TX activity
+
+static const uint64_t DP_DRAIN_TICKS = 2 * 512;  // 512 dp cycles
+
+static void clk_drive() {
+    g_top->clk_dp   = g_clk[CLK_DP].level;
+    g_top->clk_ctrl = g_clk[CLK_CTRL].level;
+    g_top->clk_mac  = g_clk[CLK_MAC].level;
+    g_top->clk_cpu  = g_clk[CLK_CPU].level;
+}
+
+static void sched_init() {
+    static const uint64_t halves[CLK_NUM] = { 1, 8, 4, 1 };
+    for (int d = 0; d < CLK_NUM; d++) {
+        g_clk[d].half  = halves[d];
+        g_clk[d].next  = g_sim_time + 1;   // every domain rises on the first tick
+        g_clk[d].level = 0;
+        g_clk[d].gated = false;
+    }
+    clk_drive();
+}
+
+// Gate / ungate a clock domain.  An ungated domain resumes one half period
+// after the current time with the level it was frozen at.
+static void sched_gate(int d, bool gated) {
+    if (g_clk[d].gated == gated) return;
+    g_clk[d].gated = gated;
+    if (!gated) g_clk[d].next = g_sim_time + g_clk[d].half;
+}
+
+// Advance simulated time by `ticks`, evaluating only at clock edges.
+// Returns a bitmask (1 << CLK_*) of domains that saw a rising edge.
+static uint32_t sched_run(uint64_t ticks) {
+    uint64_t end  = g_sim_time + ticks;
+    uint32_t rise = 0;
+    for (;;) {
+        uint64_t t = UINT64_MAX;
+        for (int d = 0; d < CLK_NUM; d++)
+            if (!g_clk[d].gated && g_clk[d].next < t) t = g_clk[d].next;
+        if (t > end) break;
+        for (int d = 0; d < CLK_NUM; d++) {
+            if (g_clk[d].gated || g_clk[d].next != t) continue;
+            g_clk[d].level ^= 1;
+            g_clk[d].next  += g_clk[d].half;
+            if (g_clk[d].level) rise |= 1U << d;
+        }
+        g_sim_time = t;
+        clk_drive();
+        g_top->eval();
+        g_evals++;
+    }
+    g_sim_time = end;
+    return rise;
 }
 
 // Step n dp rising+falling edges (n full dp cycles)
 static void step_dp(int n) {
-    for (int i = 0; i < n * 2; i++) step_half();
+    sched_run((uint64_t)n * 2);
 }
 
 // Step n ctrl cycles (each ctrl cycle = 8 dp cycles)
@@ -82,6 +220,32 @@ static void step_mac(int n) {
     step_dp(n * 4);
 }
 
+static void dp_note_activity() { g_last_dp_activity = g_sim_time; }
+
+static bool g_tue_apply_pending = false;   // keep clk_dp running for APPLY
+
+static bool dp_idle() {
+    return !g_tue_apply_pending &&
+           g_top->rx_valid == 0 && g_top->tx_valid == 0 &&
+           g_sim_time - g_last_dp_activity >= DP_DRAIN_TICKS;
+}
+
+// Step n ctrl cycles; if the data path is idle only clk_ctrl is clocked.
+static void step_ctrl_quiet(int n) {
+    bool ff = g_ff_enable && dp_idle();
+    if (ff) {
+        sched_gate(CLK_DP,  true);
+        sched_gate(CLK_MAC, true);
+        sched_gate(CLK_CPU, true);
+    }
+    step_ctrl(n);
+    if (ff) {
+        sched_gate(CLK_DP,  false);
+        sched_gate(CLK_MAC, false);
+        sched_gate(CLK_CPU, false);
+    }
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // TUE APB transactions (via tb_tue_* backdoor)
 // APB protocol: setup phase (psel=1, penable=0) + access phase (psel=1, penable=1)
@@ -95,10 +259,10 @@ static void apb_write(uint32_t addr, uint32_t data) {
     g_top->tb_tue_pwrite  = 1;
     g_top->tb_tue_paddr   = addr & 0xFFF;
     g_top->tb_tue_pwdata  = data;
-    step_ctrl(1);
+    step_ctrl_quiet(1);
     // Access phase: data latched at posedge clk_ctrl when psel && penable && pwrite
     g_top->tb_tue_penable = 1;
-    step_ctrl(1);
+    step_ctrl_quiet(1);
     // Deassert
     g_top->tb_tue_psel    = 0;
     g_top->tb_tue_penable = 0;
@@ -110,86 +274,225 @@ static uint32_t apb_read(uint32_t addr) {
     g_top->tb_tue_penable = 0;
     g_top->tb_tue_pwrite  = 0;
     g_top->tb_tue_paddr   = addr & 0xFFF;
-    step_ctrl(1);
+    step_ctrl_quiet(1);
     g_top->tb_tue_penable = 1;
-    step_ctrl(1);
+    step_ctrl_quiet(1);
     uint32_t data = g_top->tb_tue_prdata;
     g_top->tb_tue_psel    = 0;
     g_top->tb_tue_penable = 0;
     return data;
 }
 
-// Wait for TUE transaction to complete.
-// The TUE FSM takes ~36 ctrl cycles (1 IDLE + 33 WAIT_DRAIN + 1 APPLY + 1 DONE).
-// We wait 60 ctrl cycles to be safe, then extra dp cycles for apply_pulse_dp sync.
-static void tue_wait_done() {
-    step_ctrl(60);   // more than enough (36 cycles needed)
-    step_dp(16);     // extra margin for 2-FF clk_ctrl→clk_dp synchronizer
-}
-
 // ─────────────────────────────────────────────────────────────────────────────
-// Parser TCAM programming (via tb_parser_wr_* backdoor)
+// TUE register shadow + status-polled commit
 //
-// Parser TCAM entry format (640 bits):
-//   [639:634] key_state      (6b) — FSM state to match
-//   [633:570] key_window     (64b) — byte window to match (all 0 = don't care with full mask)
-//   [569:564] mask_state     (6b)  — 0=match exactly
-//   [563:506] padding        (58b)
-//   [505:442] mask_window    (64b) — 1=don't care (full = 0xFFFF_FFFF_FFFF_FFFF)
-//   [441:436] next_state     (6b)
-//   [435:428] extract_offset (8b)  — absolute byte offset in cell to extract
-//   [427:420] extract_len    (8b)  — (effectively 1; parser extracts 1 byte per entry)
-//   [419:410] phv_dst_offset (10b) — destination byte in PHV
-//   [409:402] hdr_advance    (8b)
-//   [401]     valid
-//   [400:0]   reserved
-//
-// In Verilator, tb_parser_wr_data[639:0] is VlWide<20> (word[0]=bits31:0, etc.)
-// ─────────────────────────────────────────────────────────────────────────────
-
-static void set_bits(uint32_t *words, int hi, int lo, uint64_t value) {
-    for (int bit = lo; bit <= hi; bit++) {
-        int w = bit / 32;
-        int b = bit % 32;
-        if ((value >> (uint64_t)(bit - lo)) & 1ULL)
-            words[w] |= (1U << b);
-        else
-            words[w] &= ~(1U << b);
+// Shadow: the TUE keeps CMD/TABLE_ID/STAGE/KEY/MASK/ACTION registers until
+// they are rewritten, so tue_wr() skips an APB write whose value equals the
+// last one written to that address (consecutive routes usually differ in a
+// single key/mask word).  COMMIT is self-clearing and never shadowed.  The
+// shadow is invalidated by do_reset().
+//
+// Commit: after COMMIT the TUE counts 32 ctrl cycles in WAIT_DRAIN.  With
+// the data path idle there is nothing to drain, so tue_drain_skip() tells
+// tue.sv (TUE_DRAIN_DPI) to clear the countdown on its next ctrl edge and
+// only TUE_DRAIN_SKIPPED ctrl cycles are stepped.  Otherwise (traffic in
+// flight, or --no-ff) TUE_DRAIN_QUIET cycles of the countdown are stepped,
+// ctrl-only when possible.  TUE_REG_STATUS is then polled with all clocks
+// running until it leaves BUSY.  tue.sv reports BUSY from the
+// cycle COMMIT / BATCH = 0 is written, so the poll first requires BUSY and
+// then accepts DONE or IDLE (DONE lasts a single ctrl cycle); an IDLE read
+// before BUSY means the request has not been accepted yet.
+//
+// Batch (hal_tcam_batch_begin/commit): COMMIT only queues the register set in
+// the TUE staging FIFO; writing TUE_REG_BATCH = 0 drains once and applies the
+// queue back-to-back, TUE_APPLY_GAP ctrl cycles per entry.  A full queue
+// (FIFO depth read back from TUE_REG_BATCH, capped at HAL_TCAM_BATCH_MAX) is
+// committed and a new batch opened automatically.  Built with TUE_BATCH=0
+// (no FIFO, the rv_p4_top default) every call commits on its own, as in
+// rv_p4_hal.c.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#define TUE_SHADOW_WORDS   (TUE_REG_COMMIT / 4)
+#define TUE_DRAIN_QUIET    28      // ctrl cycles of WAIT_DRAIN skipped unpolled
+#define TUE_DRAIN_SKIPPED  2       // IDLE → WAIT_DRAIN, countdown cleared
+#define TUE_POLL_MAX       64      // status reads before HAL_ERR_TIMEOUT
+
+static uint32_t g_tue_shadow[TUE_SHADOW_WORDS];
+static bool     g_tue_shadow_ok[TUE_SHADOW_WORDS];
+
+static bool g_tue_drain_skip = false;      // read by tue.sv in WAIT_DRAIN
+
+// DPI import (see the TUE_DRAIN_DPI block in rtl/tue/tue.sv)
+extern "C" svBit tue_drain_skip() {
+    return g_tue_drain_skip;
+}
+
+#define TUE_APPLY_GAP      4       // ctrl cycles per batched entry (rv_p4_pkg.sv)
+
+static bool g_tue_batch_open  = false;
+static int  g_tue_batch_n     = 0;
+static int  g_tue_batch_depth = 0;         // TUE FIFO entries, 0 = no batching
+static int  g_tue_batch_err   = HAL_OK;    // first auto-commit error, returned by commit
+
+struct tue_stats_t {
+    uint64_t commits;             // drains: single commits + batch commits
+    uint64_t batched;             // entries applied through a batch
+    uint64_t apb_writes;          // writes actually issued
+    uint64_t apb_skipped;         // writes elided by the shadow
+    uint64_t status_polls;
+    uint64_t lat_ctrl_total;      // ctrl cycles, first write → complete
+    uint64_t lat_ctrl_min;
+    uint64_t lat_ctrl_max;
+    double   lat_wall_total_us;   // host wall time
+};
+
+static tue_stats_t g_tue_stats;
+
+static void tue_shadow_invalidate() {
+    memset(g_tue_shadow_ok, 0, sizeof(g_tue_shadow_ok));
+}
+
+static void tue_wr(uint32_t addr, uint32_t data) {
+    uint32_t idx = addr / 4;
+    if (idx < TUE_SHADOW_WORDS) {
+        if (g_tue_shadow_ok[idx] && g_tue_shadow[idx] == data) {
+            g_tue_stats.apb_skipped++;
+            return;
+        }
+        g_tue_shadow[idx]    = data;
+        g_tue_shadow_ok[idx] = true;
     }
+    g_tue_stats.apb_writes++;
+    apb_write(addr, data);
 }
 
-// Build a parser TCAM entry: match state=key_state (exact), wildcard window
-// extract 1 byte from extract_offset in cell → phv_dst in PHV
-// transition to next_state
-static void make_parser_entry(uint32_t e[20],
-                               uint8_t  key_state,
-                               uint8_t  next_state,
-                               uint8_t  extract_offset,
-                               uint16_t phv_dst)
-{
-    memset(e, 0, 20 * sizeof(uint32_t));
-    set_bits(e, 639, 634, key_state);               // key_state = FSM state
-    // key_window = 0, mask_state = 0 (exact state match)
-    set_bits(e, 505, 442, 0xFFFFFFFFFFFFFFFFULL);   // mask_window = full don't care
-    set_bits(e, 441, 436, next_state);              // next_state
-    set_bits(e, 435, 428, extract_offset);          // extract_offset (absolute cell byte)
-    set_bits(e, 427, 420, 1);                       // extract_len = 1
-    set_bits(e, 419, 410, phv_dst);                 // phv_dst_offset
-    set_bits(e, 409, 402, 0);                       // hdr_advance = 0
-    e[401 / 32] |= (1U << (401 % 32));              // valid = 1
+// Start a timed TUE transaction (call before its first register write)
+static uint64_t                              g_tue_t0_tick;
+static std::chrono::steady_clock::time_point g_tue_t0_wall;
+
+static void tue_begin() {
+    g_tue_t0_tick = g_sim_time;
+    g_tue_t0_wall = std::chrono::steady_clock::now();
+}
+
+// Wait for a transaction started by COMMIT or BATCH=0 to leave BUSY.
+// @entries: queued entries applied after the drain (0 = single commit)
+static int tue_wait_done(int entries) {
+    g_tue_drain_skip = g_ff_enable && dp_idle();
+    step_ctrl_quiet(g_tue_drain_skip ? TUE_DRAIN_SKIPPED : TUE_DRAIN_QUIET);
+    g_tue_apply_pending = true;           // clk_dp must see apply_pulse
+
+    int  rc        = HAL_ERR_TIMEOUT;
+    bool seen_busy = false;
+    for (int i = 0; i < TUE_POLL_MAX + entries * TUE_APPLY_GAP; i++) {
+        uint32_t st = apb_read(TUE_REG_STATUS) & 0x3;
+        g_tue_stats.status_polls++;
+        if (st == TUE_STATUS_ERROR) { rc = HAL_ERR_BUSY; break; }
+        if (st == TUE_STATUS_BUSY) seen_busy = true;
+        else if (st == TUE_STATUS_DONE || seen_busy) { rc = HAL_OK; break; }
+    }
+    step_dp(4);                           // 2-FF sync + TCAM write edge
+    g_tue_apply_pending = false;
+    g_tue_drain_skip    = false;
+
+    uint64_t lat = (g_sim_time - g_tue_t0_tick) / 16;   // 16 ticks per ctrl cycle
+    if (g_tue_stats.commits == 0 || lat < g_tue_stats.lat_ctrl_min)
+        g_tue_stats.lat_ctrl_min = lat;
+    if (lat > g_tue_stats.lat_ctrl_max)
+        g_tue_stats.lat_ctrl_max = lat;
+    g_tue_stats.lat_ctrl_total += lat;
+    g_tue_stats.lat_wall_total_us += std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - g_tue_t0_wall).count();
+    g_tue_stats.commits++;
+    g_tue_stats.batched += (uint64_t)entries;
+    return rc;
 }
 
+// Close the open batch: one drain, then every queued entry in order.
+static int tue_batch_close() {
+    int n = g_tue_batch_n;
+    g_tue_batch_n = 0;
+    tue_begin();                          // latency measured from BATCH = 0
+    g_tue_stats.apb_writes++;
+    apb_write(TUE_REG_BATCH, 0);
+    return n ? tue_wait_done(n) : HAL_OK;
+}
+
+// Write COMMIT and wait for the TUE to leave BUSY (batch: queue only).
+static int tue_commit_wait() {
+    if (g_tue_batch_open && g_tue_batch_depth && g_tue_batch_n == g_tue_batch_depth) {
+        // Registers are already written; queue them in a fresh batch.  If the
+        // drain failed the TUE is not idle: do not reopen, and let the rest of
+        // this batch commit one by one (same as rv_p4_hal.c).
+        int rc = tue_batch_close();
+        if (rc != HAL_OK) {
+            g_tue_batch_depth = 0;
+            g_tue_batch_err   = rc;
+            return rc;
+        }
+        g_tue_stats.apb_writes++;
+        apb_write(TUE_REG_BATCH, 1);
+    }
+    g_tue_stats.apb_writes++;
+    apb_write(TUE_REG_COMMIT, 1);
+    if (g_tue_batch_open && g_tue_batch_depth) {
+        g_tue_batch_n++;
+        return HAL_OK;
+    }
+    return tue_wait_done(0);
+}
+
+static void tue_stats_print() {
+    const tue_stats_t &t = g_tue_stats;
+    uint64_t n = t.commits ? t.commits : 1;
+    printf("  TUE     : %llu commits, latency ctrl cycles min/avg/max = %llu/%.1f/%llu, "
+           "%.1f us wall/commit\n",
+           (unsigned long long)t.commits, (unsigned long long)t.lat_ctrl_min,
+           (double)t.lat_ctrl_total / n, (unsigned long long)t.lat_ctrl_max,
+           t.lat_wall_total_us / n);
+    printf("            APB writes %llu issued / %llu skipped by shadow, %llu status polls, "
+           "%llu entries batched\n",
+           (unsigned long long)t.apb_writes, (unsigned long long)t.apb_skipped,
+           (unsigned long long)t.status_polls, (unsigned long long)t.batched);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Parser TCAM programming (via tb_parser_wr_* backdoor)
+//
+// Parser programs are written in the model's fsm_entry_t convention
+// (extract_offset relative to hdr_ptr, key_mask bit = 1 → compare) and
+// converted by pkt_parser_to_rtl() (sw/firmware/test/pkt_parser.c) into
+// parser_tcam.sv's 640-bit entries: absolute cell offsets, one extracted
+// byte per entry, mask_window bit = 1 → don't care.  CS-16 checks the
+// converter against the model; --lockstep parser checks it against the RTL.
+//
+// In Verilator, tb_parser_wr_data[639:0] is VlWide<20> (word[0]=bits31:0,
+// etc.), the layout of pkt_parser_rtl_entry_t.
+// ─────────────────────────────────────────────────────────────────────────────
+
 // Write one parser TCAM entry via tb_parser_wr_* backdoor
-static void write_parser_entry(uint8_t addr, const uint32_t e[20]) {
+static void write_parser_entry(uint8_t addr, const pkt_parser_rtl_entry_t &e) {
     g_top->tb_parser_wr_en   = 1;
     g_top->tb_parser_wr_addr = addr;
-    for (int i = 0; i < 20; i++)
-        g_top->tb_parser_wr_data[i] = e[i];
+    for (int i = 0; i < PKT_PARSER_RTL_WORDS; i++)
+        g_top->tb_parser_wr_data[i] = e.w[i];
     step_dp(2);     // hold for 2 dp cycles (parser latches on posedge clk_dp)
     g_top->tb_parser_wr_en = 0;
     step_dp(2);
 }
 
+// Convert `prog` and load it into all PKT_PARSER_ENTRIES slots (the parser
+// TCAM's valid bits have no reset, so unused slots are written invalid).
+// Returns the number of RTL entries, -1 if the program is not representable.
+static int parser_load(const fsm_entry_t *prog, int n) {
+    static pkt_parser_rtl_entry_t rtl[PKT_PARSER_ENTRIES];
+    int nr = pkt_parser_to_rtl(prog, n, rtl, PKT_PARSER_ENTRIES);
+    if (nr < 0) return -1;
+    for (int i = nr; i < PKT_PARSER_ENTRIES; i++) rtl[i] = pkt_parser_rtl_entry_t();
+    for (int i = 0; i < PKT_PARSER_ENTRIES; i++) write_parser_entry((uint8_t)i, rtl[i]);
+    return nr;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // HAL implementation — converts firmware TCAM entries to RTL format
 //
@@ -208,11 +511,16 @@ static void write_parser_entry(uint8_t addr, const uint32_t e[20]) {
 //   ACTION_DENY     (0x2002) → 0x9000  (OP_DROP)
 //   ACTION_PERMIT   (0x2001) → 0x0000  (OP_NOP)
 //   ACTION_L2_FORWARD(0x3001)→ 0xA000  (OP_SET_PORT, imm_val=port)
+//   ACTION_ECMP_GROUP(0x1003)→ 0xC001  (OP_HASH_SET / HASH_SUB_BUCKET)
 //
-// ALU param encoding for OP_SET_PORT:
-//   imm_val = action_params[47:16] = ASRAM[47:16]
-//   ASRAM[47:0] = {16'b0, dp_action_params[95:0]}[47:0] = P0[31:0]
-//   → P0 = port → ACTION_P0 = port
+// ALU param encoding:
+//   imm_val = action_params[47:16] = {P1[15:0], P0[31:16]}
+//   fwidth  = action_params[15:8]  = P0[15:8]
+//   dst_off = action_params[111:102] = 0 (TUE writes ASRAM[111:96] = 0)
+//   OP_SET_PORT:     P0[31:16] = port
+//   HASH_SUB_BUCKET: P1[15:0] = base, P0[31:16] = mask, fwidth = 2
+//     → PHV[0:1] = base + (crc32(PHV[0:15]) & mask), big-endian, which is
+//       where the member table's 2-byte ecmp_idx key is matched.
 // ─────────────────────────────────────────────────────────────────────────────
 
 static uint16_t fw_to_rtl_action_id(uint16_t fw_id) {
@@ -223,6 +531,7 @@ static uint16_t fw_to_rtl_action_id(uint16_t fw_id) {
     case ACTION_DENY:       return 0x9000;  // OP_DROP
     case ACTION_L2_FORWARD: return 0xA000;  // OP_SET_PORT
     case ACTION_FLOOD:      return 0xA000;  // OP_SET_PORT (port=0xFF)
+    case ACTION_ECMP_GROUP: return 0xC001;  // OP_HASH_SET, HASH_SUB_BUCKET
     default:                return 0x0000;
     }
 }
@@ -236,23 +545,51 @@ static uint32_t fw_to_rtl_p0(uint16_t fw_id, const uint8_t *params) {
         return (uint32_t)params[0] << 16;
     case ACTION_FLOOD:
         return 0xFFU << 16;
+    case ACTION_ECMP_GROUP:
+        // params[2:3] = mask (big-endian); fwidth = 2
+        return ((uint32_t)params[2] << 24) | ((uint32_t)params[3] << 16) | (2U << 8);
+    default:
+        return 0;
+    }
+}
+
+static uint32_t fw_to_rtl_p1(uint16_t fw_id, const uint8_t *params) {
+    switch (fw_id) {
+    case ACTION_ECMP_GROUP:
+        // params[0:1] = base (big-endian) → imm_val[31:16]
+        return ((uint32_t)params[0] << 8) | params[1];
     default:
         return 0;
     }
 }
 
+// Shadow-only mode: TCAM HAL calls validate their arguments and return
+// HAL_OK without touching the RTL.  Used by warm_start() to rebuild the
+// firmware's own tables after a snapshot restore (the RTL already holds
+// the entries).
+static bool g_hal_shadow_only = false;
+
+// Every TCAM HAL call is also mirrored into the host TCAM store
+// (sw/firmware/test/sim_tcam.c), so pkt_model.c sees exactly the entries
+// the RTL was programmed with (see --lockstep).
+
 // hal_tcam_insert: called by firmware (route_add, fdb_add_static, etc.)
 int hal_tcam_insert(const tcam_entry_t *entry) {
     if (!entry) return HAL_ERR_INVAL;
-    if (entry->stage >= 7) return HAL_ERR_INVAL;
+    if (entry->stage >= SIM_TCAM_STAGES) return HAL_ERR_INVAL;
+    sim_tcam_insert(entry);
+    if (g_hal_shadow_only) return HAL_OK;
 
     uint16_t rtl_action_id = fw_to_rtl_action_id(entry->action_id);
     uint32_t rtl_p0        = fw_to_rtl_p0(entry->action_id, entry->action_params);
+    uint32_t rtl_p1        = fw_to_rtl_p1(entry->action_id, entry->action_params);
+
+    tue_begin();
 
     // Write CMD, TABLE_ID, STAGE
-    apb_write(TUE_REG_CMD,      TUE_CMD_INSERT);
-    apb_write(TUE_REG_TABLE_ID, entry->table_id);
-    apb_write(TUE_REG_STAGE,    entry->stage);
+    tue_wr(TUE_REG_CMD,      TUE_CMD_INSERT);
+    tue_wr(TUE_REG_TABLE_ID, entry->table_id);
+    tue_wr(TUE_REG_STAGE,    entry->stage);
 
     // Write 512-bit key (16 × 32-bit words)
     // Firmware key.bytes[i] → RTL TCAM key[i] (PHV byte i)
@@ -264,7 +601,7 @@ int hal_tcam_insert(const tcam_entry_t *entry) {
             if (idx < 64 && idx < (int)entry->key.key_len)
                 word |= ((uint32_t)entry->key.bytes[idx]) << (b * 8);
         }
-        apb_write(TUE_REG_KEY_BASE + (uint32_t)(w * 4), word);
+        tue_wr(TUE_REG_KEY_BASE + (uint32_t)(w * 4), word);
     }
 
     // Write 512-bit mask (16 × 32-bit words)
@@ -284,45 +621,64 @@ int hal_tcam_insert(const tcam_entry_t *entry) {
                 word |= ((uint32_t)rtl_m) << (b * 8);
             }
         }
-        apb_write(TUE_REG_MASK_BASE + (uint32_t)(w * 4), word);
+        tue_wr(TUE_REG_MASK_BASE + (uint32_t)(w * 4), word);
     }
 
     // Write action
-    apb_write(TUE_REG_ACTION_ID, rtl_action_id);
-    apb_write(TUE_REG_ACTION_P0, rtl_p0);
-    apb_write(TUE_REG_ACTION_P1, 0);
-    apb_write(TUE_REG_ACTION_P2, 0);
-
-    // Commit — triggers TUE state machine
-    apb_write(TUE_REG_COMMIT, 1);
-
-    // Wait for completion (~36 ctrl cycles + clock domain crossing)
-    tue_wait_done();
+    tue_wr(TUE_REG_ACTION_ID, rtl_action_id);
+    tue_wr(TUE_REG_ACTION_P0, rtl_p0);
+    tue_wr(TUE_REG_ACTION_P1, rtl_p1);
+    tue_wr(TUE_REG_ACTION_P2, 0);
 
-    return HAL_OK;
+    // Commit — triggers TUE state machine, polls STATUS until complete
+    return tue_commit_wait();
 }
 
 int hal_tcam_delete(uint8_t stage, uint16_t table_id) {
+    sim_tcam_delete(stage, table_id);
+    if (g_hal_shadow_only) return HAL_OK;
     // Write CMD=DELETE, TABLE_ID, STAGE, COMMIT
-    apb_write(TUE_REG_CMD,      TUE_CMD_DELETE);
-    apb_write(TUE_REG_TABLE_ID, table_id);
-    apb_write(TUE_REG_STAGE,    stage);
-    apb_write(TUE_REG_COMMIT,   1);
-    tue_wait_done();
-    return HAL_OK;
+    tue_begin();
+    tue_wr(TUE_REG_CMD,      TUE_CMD_DELETE);
+    tue_wr(TUE_REG_TABLE_ID, table_id);
+    tue_wr(TUE_REG_STAGE,    stage);
+    return tue_commit_wait();
 }
 
 int hal_tcam_modify(const tcam_entry_t *entry) {
     return hal_tcam_insert(entry);  // INSERT overwrites existing entry at same table_id
 }
 
+int hal_tcam_batch_begin(void) {
+    if (g_tue_batch_open) return HAL_ERR_BUSY;
+    g_tue_batch_open = true;
+    g_tue_batch_n    = 0;
+    g_tue_batch_err  = HAL_OK;
+    if (g_hal_shadow_only) return HAL_OK;
+    int depth = (int)((apb_read(TUE_REG_BATCH) >> 8) & 0xFF);
+    g_tue_batch_depth = std::min(depth, HAL_TCAM_BATCH_MAX);
+    if (!g_tue_batch_depth) return HAL_OK;
+    g_tue_stats.apb_writes++;
+    apb_write(TUE_REG_BATCH, 1);
+    return HAL_OK;
+}
+
+int hal_tcam_batch_commit(void) {
+    if (!g_tue_batch_open) return HAL_ERR_INVAL;
+    g_tue_batch_open = false;
+    if (g_hal_shadow_only) return HAL_OK;
+    int rc = g_tue_batch_depth ? tue_batch_close() : HAL_OK;
+    return g_tue_batch_err != HAL_OK ? g_tue_batch_err : rc;
+}
+
 int hal_tcam_flush(uint8_t stage) {
+    sim_tcam_flush(stage);
+    if (g_hal_shadow_only) return HAL_OK;
     // Write CMD=FLUSH, STAGE, COMMIT — clears all entries in the stage
-    apb_write(TUE_REG_CMD,    TUE_CMD_FLUSH);
-    apb_write(TUE_REG_STAGE,  stage);
-    apb_write(TUE_REG_COMMIT, 1);
-    tue_wait_done();
-    return HAL_OK;
+    tue_begin();
+    tue_wr(TUE_REG_CMD,   TUE_CMD_FLUSH);
+    tue_wr(TUE_REG_STAGE, stage);
+    return tue_commit_wait();
 }
 
 // Stub HAL functions (non-TCAM operations — no RTL counterpart in this design)
@@ -345,6 +701,7 @@ int hal_qos_pir_set(port_id_t, uint64_t)                  { return HAL_OK; }
 int hal_qos_sched_mode_set(port_id_t, uint8_t)            { return HAL_OK; }
 int hal_qos_dscp_map_set(uint8_t, uint8_t)                { return HAL_OK; }
 int hal_punt_rx_poll(punt_pkt_t *p)                        { if(p)memset(p,0,sizeof(*p)); return -1; }
+int hal_punt_rx_poll_burst(punt_pkt_t *, int)              { return 0; }
 int hal_punt_tx_send(const punt_pkt_t *)                   { return HAL_OK; }
 int hal_uart_putc(char c)                                  { putchar(c); return 0; }
 int hal_uart_getc(void)                                    { return -1; }
@@ -426,6 +783,7 @@ static void inject_pkt(const uint8_t *pkt, int len) {
     g_top->rx_sof   = 1U;         // port 0 SOF
     g_top->rx_eof   = 1U;         // port 0 EOF
     g_top->tx_ready = 0xFFFFFFFFU; // accept TX on all ports
+    dp_note_activity();
 
     // Hold for 10 dp cycles (≈2.5 mac cycles) so parser can latch
     step_dp(10);
@@ -440,6 +798,7 @@ static void inject_pkt(const uint8_t *pkt, int len) {
     g_top->rx_valid = 0;
     g_top->rx_sof   = 0;
     g_top->rx_eof   = 0;
+    dp_note_activity();
 }
 
 // Poll TX for up to max_dp_cycles dp cycles; return the first non-zero tx_valid mask
@@ -448,7 +807,7 @@ static uint32_t poll_tx(int max_dp_cycles) {
     for (int i = 0; i < max_dp_cycles; i++) {
         step_dp(1);
         uint32_t tv = g_top->tx_valid;
-        if (tv) return tv;
+        if (tv) { dp_note_activity(); return tv; }
     }
     return 0;
 }
@@ -478,6 +837,213 @@ static void do_reset() {
     step_dp(20);     // hold reset for 20 dp cycles
     g_top->rst_n = 1;
     step_dp(20);     // allow reset synchronizers to propagate
+    dp_note_activity();
+    tue_shadow_invalidate();   // TUE registers are back at reset values
+    sim_tcam_reset();          // MAU TCAMs are empty again
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Parser profiles + warm start (Verilator --savable snapshots)
+//
+// A parser profile is the chain of 1-byte extract entries (states 1→2→…→
+// ACCEPT) that places packet fields at PHV[0:…] to line up with a firmware
+// TCAM key.  warm_start(profile[, name, setup]) brings the model to
+//   reset → parser profile loaded → optional firmware setup (routes, ACLs…)
+// Cold path: do_reset(), APB/backdoor programming, then (SAVABLE builds)
+//   save model + harness state to <snap_dir>/<profile>[+<name>].snap.
+// Warm path: restore that file, then re-run the setup with the HAL in
+//   shadow-only mode so firmware tables (route_table, acl_rules, …) match
+//   the restored TCAM contents without any APB traffic.
+// The name identifies the setup's table contents: setups that depend on
+// run-time input fold a hash of it into the name.  A setup without a name
+// is not captured — it runs over APB after the profile snapshot (used for
+// one-off rule sets such as lockstep shrink candidates).
+// Returns the setup's status (HAL_OK without one); a failed cold-path setup
+// is not saved.
+// Snapshots carry the build stamp of this file; stale ones are rebuilt.
+//
+// Build with `make SAVABLE=1` (adds --savable, single-threaded only).
+// Without it warm_start() always takes the cold path.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct parser_profile_t {
+    const char *name;
+    int         n;
+    uint8_t     pkt_off[10];  // packet byte to extract (hdr_ptr stays 0)
+    uint16_t    phv_dst[10];  // destination PHV byte
+};
+
+static const parser_profile_t PROF_IPV4_DST        = { "ipv4_dst",       4,
+    {30, 31, 32, 33},         {0, 1, 2, 3} };
+static const parser_profile_t PROF_ETH_DST         = { "eth_dst",        6,
+    {0, 1, 2, 3, 4, 5},       {0, 1, 2, 3, 4, 5} };
+static const parser_profile_t PROF_IPV4_SRC        = { "ipv4_src",       4,
+    {26, 27, 28, 29},         {0, 1, 2, 3} };
+static const parser_profile_t PROF_IPV4_SRC_DPORT  = { "ipv4_src_dport", 6,
+    {26, 27, 28, 29, 36, 37}, {0, 1, 2, 3, 8, 9} };
+// Full ACL key: src(4) + dst(4) + dport(2) → PHV[0:9]
+static const parser_profile_t PROF_ACL             = { "acl",            10,
+    {26, 27, 28, 29, 30, 31, 32, 33, 36, 37}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9} };
+
+static void parser_load_profile(const parser_profile_t &pp) {
+    fsm_entry_t prog[10];
+    memset(prog, 0, sizeof(prog));
+    for (int i = 0; i < pp.n; i++) {
+        prog[i].cur_state      = (uint8_t)(i + 1);
+        prog[i].next_state     = (i == pp.n - 1) ? PKT_PARSER_ACCEPT : (uint8_t)(i + 2);
+        prog[i].extract_offset = pp.pkt_off[i];
+        prog[i].extract_len    = 1;
+        prog[i].phv_dst_offset = pp.phv_dst[i];
+    }
+    if (parser_load(prog, pp.n) < 0) {
+        printf("parser profile %s: not representable in parser_tcam.sv\n", pp.name);
+        abort();
+    }
+}
+
+static const char *g_snap_dir    = "snap";
+static bool        g_snap_enable = true;
+static uint64_t    g_snap_saves  = 0;
+static uint64_t    g_snap_hits   = 0;
+
+#ifdef COSIM_SAVABLE
+
+#define SNAP_MAGIC   0x52565034534E4150ULL    // "RVP4SNAP"
+static const char SNAP_STAMP[] = __DATE__ " " __TIME__;
+
+// Harness state that must travel with the model
+struct snap_harness_t {
+    uint64_t     sim_time;
+    uint64_t     last_dp_activity;
+    clk_domain_t clk[CLK_NUM];
+    uint32_t     tue_shadow[TUE_SHADOW_WORDS];
+    bool         tue_shadow_ok[TUE_SHADOW_WORDS];
+};
+
+static void snap_path(char *buf, size_t n, const parser_profile_t &pp, const char *setup) {
+    snprintf(buf, n, "%s/%s%s%s.snap", g_snap_dir, pp.name,
+             setup ? "+" : "", setup ? setup : "");
+}
+
+static bool snap_save(const char *path) {
+    snap_harness_t h;
+    h.sim_time         = g_sim_time;
+    h.last_dp_activity = g_last_dp_activity;
+    memcpy(h.clk, g_clk, sizeof(h.clk));
+    memcpy(h.tue_shadow, g_tue_shadow, sizeof(h.tue_shadow));
+    memcpy(h.tue_shadow_ok, g_tue_shadow_ok, sizeof(h.tue_shadow_ok));
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "mkdir -p '%s'", g_snap_dir);
+    if (system(cmd) != 0) return false;
+
+    // Parallel test processes may save the same profile at once: write a
+    // private temp file and rename() it into place.
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, (int)getpid());
+    VerilatedSave os;
+    os.open(tmp);
+    if (!os.isOpen()) return false;
+    uint64_t magic = SNAP_MAGIC;
+    os.write(&magic, sizeof(magic));
+    os.write(SNAP_STAMP, sizeof(SNAP_STAMP));
+    os.write(&h, sizeof(h));
+    os << *g_top;
+#ifdef COSIM_TCAM_DPI
+    // MAU TCAM contents live on the C side of the DPI lookup model
+    std::vector<uint8_t> tcam_img;
+    mau_tcam_save(tcam_img);
+    uint64_t tcam_len = tcam_img.size();
+    os.write(&tcam_len, sizeof(tcam_len));
+    os.write(tcam_img.data(), tcam_img.size());
+#endif
+    os.close();
+    if (rename(tmp, path) != 0) { remove(tmp); return false; }
+    g_snap_saves++;
+    return true;
+}
+
+static bool snap_restore(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    uint64_t magic = 0;
+    char     stamp[sizeof(SNAP_STAMP)] = {};
+    bool ok = fread(&magic, sizeof(magic), 1, fp) == 1 &&
+              fread(stamp, sizeof(stamp), 1, fp) == 1 &&
+              magic == SNAP_MAGIC && memcmp(stamp, SNAP_STAMP, sizeof(stamp)) == 0;
+    fclose(fp);
+    if (!ok) return false;          // missing, foreign or from an older build
+
+    VerilatedRestore is;
+    is.open(path);
+    if (!is.isOpen()) return false;
+    snap_harness_t h;
+    is.read(&magic, sizeof(magic));
+    is.read(stamp, sizeof(stamp));
+    is.read(&h, sizeof(h));
+    is >> *g_top;
+#ifdef COSIM_TCAM_DPI
+    uint64_t tcam_len = 0;
+    is.read(&tcam_len, sizeof(tcam_len));
+    std::vector<uint8_t> tcam_img(tcam_len);
+    is.read(tcam_img.data(), tcam_img.size());
+    bool tcam_ok = mau_tcam_restore(tcam_img.data(), tcam_img.size());
+#endif
+    is.close();
+#ifdef COSIM_TCAM_DPI
+    if (!tcam_ok) return false;     // model state is partial: caller must cold-start
+#endif
+
+    g_sim_time         = h.sim_time;
+    g_last_dp_activity = h.last_dp_activity;
+    memcpy(g_clk, h.clk, sizeof(g_clk));
+    memcpy(g_tue_shadow, h.tue_shadow, sizeof(g_tue_shadow));
+    memcpy(g_tue_shadow_ok, h.tue_shadow_ok, sizeof(g_tue_shadow_ok));
+    return true;
+}
+
+#endif // COSIM_SAVABLE
+
+// FNV-1a; names snapshots of data-driven setups (replay routes, lockstep rules)
+static uint32_t fnv1a(uint32_t h, const void *p, size_t n) {
+    const uint8_t *b = (const uint8_t *)p;
+    while (n--) { h ^= *b++; h *= 16777619U; }
+    return h;
+}
+#define FNV1A_INIT 2166136261U
+
+static int warm_start(const parser_profile_t &pp,
+                      const char *setup_name = nullptr,
+                      int (*setup)() = nullptr)
+{
+    // Unnamed setup: restore / capture the bare profile, then program live
+    if (setup && !setup_name) {
+        warm_start(pp);
+        return setup();
+    }
+#ifdef COSIM_SAVABLE
+    char path[512];
+    snap_path(path, sizeof(path), pp, setup_name);
+    if (g_snap_enable && snap_restore(path)) {
+        g_snap_hits++;
+        sim_tcam_reset();
+        int rc = HAL_OK;
+        if (setup) {
+            g_hal_shadow_only = true;
+            rc = setup();
+            g_hal_shadow_only = false;
+        }
+        return rc;
+    }
+#endif
+    do_reset();
+    parser_load_profile(pp);
+    int rc = setup ? setup() : HAL_OK;
+#ifdef COSIM_SAVABLE
+    if (rc == HAL_OK && g_snap_enable && !snap_save(path))
+        printf("  (warm_start: could not save %s)\n", path);
+#endif
+    return rc;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -503,28 +1069,20 @@ static void do_reset() {
 // Expect: tx_valid[3] goes high (packet exits on port 3)
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Install route: 10.10.0.0/16 → port 3, next-hop MAC = AA:BB:CC:DD:EE:FF
+static int setup_rtl_route_forward() {
+    route_init();
+    return route_add(0x0A0A0000u, 16, 3, 0xAABBCCDDEEFFULL);
+}
+
 static void test_rtl_route_forward() {
     const char *name = "CS-RTL-1 : IPv4 LPM routing → TX port 3";
     TEST_BEGIN(name);
 
-    do_reset();
-    route_init();
-
     // Parser setup: 4 entries, states 1→2→3→4→ACCEPT
     // Each entry extracts 1 byte from IPv4 DST (packet bytes 30-33) into PHV[0:3]
     // IPv4 DST byte 0 = packet byte 30 (14 ETH + 16 IPv4 hdr offset = 30)
-    for (int i = 0; i < 4; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 3) ? 0x3F : (uint8_t)(i + 2);  // ACCEPT=0x3F after 4th
-        make_parser_entry(e, (uint8_t)(i + 1), ns,
-                          (uint8_t)(30 + i),  // extract_offset: packet bytes 30-33
-                          (uint16_t)i);        // phv_dst: PHV bytes 0-3
-        write_parser_entry((uint8_t)i, e);
-    }
-
-    // Install route: 10.10.0.0/16 → port 3, next-hop MAC = AA:BB:CC:DD:EE:FF
-    uint64_t nhop_mac = 0xAABBCCDDEEFFULL;
-    int rc = route_add(0x0A0A0000u, 16, 3, nhop_mac);
+    int rc = warm_start(PROF_IPV4_DST, "route_forward", setup_rtl_route_forward);
     if (rc != 0) {
         TEST_FAIL(name, "route_add returned %d", rc);
         return;
@@ -563,26 +1121,19 @@ static void test_rtl_route_forward() {
 // Expect: tx_valid[7] goes high (packet exits on port 7)
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Install FDB: DE:AD:BE:EF:00:01 → port 7
+static int setup_rtl_fdb_forward() {
+    fdb_init();
+    return fdb_add_static(0xDEADBEEF0001ULL, 7, 0);
+}
+
 static void test_rtl_fdb_forward() {
     const char *name = "CS-RTL-2 : L2 FDB forwarding → TX port 7";
     TEST_BEGIN(name);
 
-    do_reset();
-    fdb_init();
-
     // Parser setup: 6 entries, states 1→2→3→4→5→6→ACCEPT
     // Extract ETH_DST (packet bytes 0-5) into PHV[0:5]
-    for (int i = 0; i < 6; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 5) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns,
-                          (uint8_t)i,         // extract_offset: packet bytes 0-5
-                          (uint16_t)i);        // phv_dst: PHV bytes 0-5
-        write_parser_entry((uint8_t)i, e);
-    }
-
-    // Install FDB: DE:AD:BE:EF:00:01 → port 7
-    int rc = fdb_add_static(0xDEADBEEF0001ULL, 7, 0);
+    int rc = warm_start(PROF_ETH_DST, "fdb_forward", setup_rtl_fdb_forward);
     if (rc != 0) {
         TEST_FAIL(name, "fdb_add_static returned %d", rc);
         return;
@@ -618,28 +1169,22 @@ static void test_rtl_fdb_forward() {
 // Expect: no TX output within timeout (packet dropped)
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Install ACL deny: src 172.16.0.0/12 → deny
+// acl_add_deny(src_ip, src_mask, dst_ip, dst_mask, dport)
+static int setup_rtl_acl_deny() {
+    acl_init();
+    int rid = acl_add_deny(0xAC100000u, 0xFFF00000u, 0, 0, 0);
+    return rid < 0 ? rid : HAL_OK;
+}
+
 static void test_rtl_acl_deny() {
     const char *name = "CS-RTL-3 : ACL deny → no TX output (packet dropped)";
     TEST_BEGIN(name);
 
-    do_reset();
-    acl_init();
-
     // Parser setup: 4 entries, states 1→2→3→4→ACCEPT
     // Extract IPv4 SRC (packet bytes 26-29) into PHV[0:3]
     // IPv4 SRC = packet bytes 26-29 (14 ETH + 12 IPv4 SRC offset = 26)
-    for (int i = 0; i < 4; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 3) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns,
-                          (uint8_t)(26 + i),  // extract_offset: packet bytes 26-29
-                          (uint16_t)i);        // phv_dst: PHV bytes 0-3
-        write_parser_entry((uint8_t)i, e);
-    }
-
-    // Install ACL deny: src 172.16.0.0/12 → deny
-    // acl_add_deny(src_ip, src_mask, dst_ip, dst_mask, dport)
-    int rid = acl_add_deny(0xAC100000u, 0xFFF00000u, 0, 0, 0);
+    int rid = warm_start(PROF_IPV4_SRC, "acl_deny", setup_rtl_acl_deny);
     if (rid < 0) {
         TEST_FAIL(name, "acl_add_deny returned %d", rid);
         return;
@@ -674,20 +1219,19 @@ static void test_rtl_acl_deny() {
 // 验证：hal_tcam_delete → TUE CMD=DELETE → mau_tcam valid 位清零
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Phase A 的路由：10.20.0.0/16 → port 2
+static int setup_rtl_route_delete() {
+    route_init();
+    return route_add(0x0A140000u, 16, 2, 0xAABBCCDDEEFFULL);
+}
+
 static void test_rtl_route_delete() {
     const char *name = "CS-RTL-4 : route_del → TCAM entry cleared, default fwd";
     TEST_BEGIN(name);
 
-    do_reset();
-    route_init();
-
     // Parser: IPv4 DST (bytes 30-33) → PHV[0:3]，与 CS-RTL-1 相同
-    for (int i = 0; i < 4; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 3) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns, (uint8_t)(30 + i), (uint16_t)i);
-        write_parser_entry((uint8_t)i, e);
-    }
+    int rc = warm_start(PROF_IPV4_DST, "route_delete", setup_rtl_route_delete);
+    if (rc != 0) { TEST_FAIL(name, "route_add returned %d", rc); return; }
 
     static const uint8_t eth_dst4[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
     static const uint8_t eth_src4[6] = {0x00,0x11,0x22,0x33,0x44,0x55};
@@ -698,9 +1242,6 @@ static void test_rtl_route_delete() {
                                0, 0);
 
     // Phase A: 路由在线 → 期望 TX on port 2
-    int rc = route_add(0x0A140000u, 16, 2, 0xAABBCCDDEEFFULL);
-    if (rc != 0) { TEST_FAIL(name, "route_add returned %d", rc); return; }
-
     inject_pkt(pkt4, len4);
     uint32_t tv = poll_tx(2000);
     if (!(tv & (1U << 2))) {
@@ -729,32 +1270,26 @@ static void test_rtl_route_delete() {
 // 验证: 两张 TCAM 条目共存时，各自只命中自己对应的 MAC
 // ─────────────────────────────────────────────────────────────────────────────
 
+// MAC-A → port 5，MAC-B → port 11
+static int setup_rtl_fdb_two_entries() {
+    fdb_init();
+    int rc = fdb_add_static(0xAABBCCDDEE01ULL, 5, 0);
+    if (rc != 0) return rc;
+    return fdb_add_static(0xAABBCCDDEE02ULL, 11, 0);
+}
+
 static void test_rtl_fdb_two_entries() {
     const char *name = "CS-RTL-5 : two FDB entries → disambiguate by dst MAC";
     TEST_BEGIN(name);
 
-    do_reset();
-    fdb_init();
-
     // Parser: ETH DST bytes 0-5 → PHV[0:5]
-    for (int i = 0; i < 6; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 5) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns, (uint8_t)i, (uint16_t)i);
-        write_parser_entry((uint8_t)i, e);
-    }
+    int rc = warm_start(PROF_ETH_DST, "fdb_two_entries", setup_rtl_fdb_two_entries);
+    if (rc != 0) { TEST_FAIL(name, "fdb_add_static returned %d", rc); return; }
 
     static const uint8_t mac_a[6]   = {0xAA,0xBB,0xCC,0xDD,0xEE,0x01};
     static const uint8_t mac_b[6]   = {0xAA,0xBB,0xCC,0xDD,0xEE,0x02};
     static const uint8_t src_mac5[6] = {0x11,0x22,0x33,0x44,0x55,0x66};
 
-    if (fdb_add_static(0xAABBCCDDEE01ULL, 5,  0) != 0) {
-        TEST_FAIL(name, "fdb_add_static MAC-A failed"); return;
-    }
-    if (fdb_add_static(0xAABBCCDDEE02ULL, 11, 0) != 0) {
-        TEST_FAIL(name, "fdb_add_static MAC-B failed"); return;
-    }
-
     // 发送到 MAC-A → 期望 TX on port 5
     uint8_t pkt5[18] = {};
     int len5 = build_l2_pkt(pkt5, mac_a, src_mac5, 0x9000);
@@ -794,26 +1329,20 @@ static void test_rtl_fdb_two_entries() {
 // 验证: ACL 多字段 key，dport 精确匹配与 src prefix 掩码联合工作
 // ─────────────────────────────────────────────────────────────────────────────
 
+// deny 规则：src 172.16.0.0/16，任意 dst，dport=80
+static int setup_rtl_acl_dport() {
+    acl_init();
+    int rid = acl_add_deny(0xAC100000u, 0xFFFF0000u, 0, 0, 80);
+    return rid < 0 ? rid : HAL_OK;
+}
+
 static void test_rtl_acl_dport() {
     const char *name = "CS-RTL-6 : ACL deny src+dport filter";
     TEST_BEGIN(name);
 
-    do_reset();
-    acl_init();
-
     // Parser: src_ip bytes 26-29 → PHV[0:3]，dport bytes 36-37 → PHV[8:9]
     // 注意 extract_offset 可以非连续（跳过 bytes 30-35 的 dst_ip + sport）
-    const uint8_t pkt_offsets[6] = {26, 27, 28, 29, 36, 37};
-    const uint8_t phv_dsts6[6]   = { 0,  1,  2,  3,  8,  9};
-    for (int i = 0; i < 6; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 5) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns, pkt_offsets[i], phv_dsts6[i]);
-        write_parser_entry((uint8_t)i, e);
-    }
-
-    // 安装 deny 规则：src 172.16.0.0/16，任意 dst，dport=80
-    int rid = acl_add_deny(0xAC100000u, 0xFFFF0000u, 0, 0, 80);
+    int rid = warm_start(PROF_IPV4_SRC_DPORT, "acl_dport", setup_rtl_acl_dport);
     if (rid < 0) { TEST_FAIL(name, "acl_add_deny returned %d", rid); return; }
 
     static const uint8_t eth_d6[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
@@ -873,35 +1402,29 @@ static void test_rtl_acl_dport() {
 //       TM 在 meta.drop=1 时正确丢弃报文
 // ─────────────────────────────────────────────────────────────────────────────
 
-static void test_rtl_route_acl_coexist() {
-    const char *name = "CS-RTL-7 : route+ACL coexist — stage-1 drop overrides stage-0 port";
-    TEST_BEGIN(name);
-
-    do_reset();
+static int setup_rtl_route_acl_coexist() {
     route_init();
     acl_init();
 
-    // Parser: IPv4 DST bytes 30-33 → PHV[0:3]
-    for (int i = 0; i < 4; i++) {
-        uint32_t e[20];
-        uint8_t  ns = (i == 3) ? 0x3F : (uint8_t)(i + 2);
-        make_parser_entry(e, (uint8_t)(i + 1), ns, (uint8_t)(30 + i), (uint16_t)i);
-        write_parser_entry((uint8_t)i, e);
-    }
-
     // Stage 0: 两条路由
-    if (route_add(0x0A0A0000u, 16, 3, 0xAABBCCDDEEFFULL) != 0) {
-        TEST_FAIL(name, "route_add 10.10.0.0/16 failed"); return;
-    }
-    if (route_add(0x0A140000u, 16, 5, 0xAABBCCDDEEFFULL) != 0) {
-        TEST_FAIL(name, "route_add 10.20.0.0/16 failed"); return;
-    }
+    int rc = route_add(0x0A0A0000u, 16, 3, 0xAABBCCDDEEFFULL);
+    if (rc != 0) return rc;
+    rc = route_add(0x0A140000u, 16, 5, 0xAABBCCDDEEFFULL);
+    if (rc != 0) return rc;
 
     // Stage 1: ACL deny key[0:3]=10.10.0.0/16（因 parser 将 IPv4 DST → PHV[0:3]，
     //          此规则实为拒绝 dst∈10.10.x.x 的报文）
-    if (acl_add_deny(0x0A0A0000u, 0xFFFF0000u, 0, 0, 0) < 0) {
-        TEST_FAIL(name, "acl_add_deny failed"); return;
-    }
+    int rid = acl_add_deny(0x0A0A0000u, 0xFFFF0000u, 0, 0, 0);
+    return rid < 0 ? rid : HAL_OK;
+}
+
+static void test_rtl_route_acl_coexist() {
+    const char *name = "CS-RTL-7 : route+ACL coexist — stage-1 drop overrides stage-0 port";
+    TEST_BEGIN(name);
+
+    // Parser: IPv4 DST bytes 30-33 → PHV[0:3]
+    int rc = warm_start(PROF_IPV4_DST, "route_acl_coexist", setup_rtl_route_acl_coexist);
+    if (rc != 0) { TEST_FAIL(name, "route / ACL setup returned %d", rc); return; }
 
     static const uint8_t eth_d7[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
     static const uint8_t eth_s7[6] = {0x00,0x11,0x22,0x33,0x44,0x55};
@@ -931,22 +1454,1272 @@ static void test_rtl_route_acl_coexist() {
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// main
+// CS-RTL-8: ECMP — Stage 0 ecmp_group 选桶，Stage 6 成员表选下一跳
+//
+// Parser: IPv4 DST (bytes 30-33) → PHV[0:3]，PHV[4:15] 为 0
+// 组 2 成员 port 3 / 5 / 9 / 12；route_ecmp_add(10.30.0.0/16 → 组 2)
+//   Stage 0: ecmp_group → OP_HASH_SET / HASH_SUB_BUCKET
+//            PHV[0:1] = base + (crc32(PHV[0:15]) & 63)（大端）
+//   Stage 6: 成员表按 PHV[0:1] = ecmp_idx 精确匹配 → OP_SET_PORT
+//
+// Phase A: 每条流的 TX 端口 = route_ecmp_select(组, 同一 crc32) 选出的成员
+// Phase B: route_ecmp_member_del(port 5) 后，原先不走 port 5 的流端口不变，
+//          走 port 5 的流改走控制面新选出的成员
 // ─────────────────────────────────────────────────────────────────────────────
 
-int main(int argc, char **argv) {
-    Verilated::commandArgs(argc, argv);
+#define RTL8_GRP    2
+#define RTL8_FLOWS  32
 
-    printf("RV-P4 RTL Co-Simulation\n");
-    printf("========================\n");
-    printf("Data plane : Verilator RTL (rv_p4_top)\n");
-    printf("Control plane : C firmware (route_add, fdb_add_static, acl_add_deny)\n");
-    printf("Bridge : TUE APB via tb_tue_* backdoor ports\n");
-    printf("========================\n\n");
+static const uint8_t RTL8_PORTS[4] = {3, 5, 9, 12};
 
-    // Create Verilator model
-    g_top = new Vrv_p4_top;
+// 第 i 条流：dst = 10.30.i.(7i)；*hash = RTL Stage 0 的 CRC32（PHV[0:15]）
+static uint32_t rtl8_dst(int i, uint32_t *hash) {
+    uint32_t dst = 0x0A1E0000u | ((uint32_t)i << 8) | ((uint32_t)(i * 7) & 0xFF);
+    uint8_t  k[16] = { (uint8_t)(dst >> 24), (uint8_t)(dst >> 16),
+                       (uint8_t)(dst >> 8),  (uint8_t)dst };
+    *hash = pkt_hash_crc32(k, 16);
+    return dst;
+}
+
+// 注入第 i 条流，返回 TX 端口；无输出或多个端口返回 -1
+static int rtl8_send(int i) {
+    static const uint8_t eth_d8[6] = {0x02,0x00,0x00,0x00,0x00,0xFE};
+    static const uint8_t eth_s8[6] = {0x00,0x11,0x22,0x33,0x44,0x55};
+    uint32_t h;
+    uint8_t  pkt8[64] = {};
+    int len8 = build_ipv4_pkt(pkt8, eth_d8, eth_s8, 0x01020304u, rtl8_dst(i, &h), 6, 80);
+    inject_pkt(pkt8, len8);
+    uint32_t tv = poll_tx(2000);
+    for (int p = 0; p < 32; p++)
+        if (tv == (1U << p)) return p;
+    return -1;
+}
+
+static int setup_rtl_ecmp() {
+    route_init();
+    for (int m = 0; m < 4; m++) {
+        int rc = route_ecmp_member_add(RTL8_GRP, RTL8_PORTS[m], 0x020000000000ULL | RTL8_PORTS[m]);
+        if (rc != 0) return rc;
+    }
+    return route_ecmp_add(0x0A1E0000u, 16, RTL8_GRP);
+}
+
+static void test_rtl_ecmp() {
+    const char *name = "CS-RTL-8 : ECMP bucket → next hop, stable on member delete";
+    TEST_BEGIN(name);
+
+    int rc = warm_start(PROF_IPV4_DST, "ecmp", setup_rtl_ecmp);
+    if (rc != 0) { TEST_FAIL(name, "ECMP group / route setup returned %d", rc); return; }
+
+    // Phase A: 桶 → 下一跳与控制面一致
+    int      port0[RTL8_FLOWS];
+    uint32_t used = 0;
+    for (int i = 0; i < RTL8_FLOWS; i++) {
+        uint32_t  h;
+        port_id_t want = 0;
+        rtl8_dst(i, &h);
+        route_ecmp_select(RTL8_GRP, h, &want, NULL);
+        port0[i] = rtl8_send(i);
+        if (port0[i] != want) {
+            TEST_FAIL(name, "Phase A flow %d (bucket %u): expected port %d, got %d",
+                      i, h & (ROUTE_ECMP_BUCKETS - 1), want, port0[i]);
+            return;
+        }
+        used |= 1U << port0[i];
+    }
+    if (!(used & (1U << 5)) || __builtin_popcount(used) < 3) {
+        TEST_FAIL(name, "flows cover too few members (port mask 0x%X)", used); return;
+    }
+
+    // Phase B: 删除 port 5，只有原先走 port 5 的流迁移
+    if (route_ecmp_member_del(RTL8_GRP, 5, 0x020000000005ULL) != 0) {
+        TEST_FAIL(name, "route_ecmp_member_del port 5 failed"); return;
+    }
+    for (int i = 0; i < RTL8_FLOWS; i++) {
+        uint32_t  h;
+        port_id_t want = 0;
+        rtl8_dst(i, &h);
+        route_ecmp_select(RTL8_GRP, h, &want, NULL);
+        int p = rtl8_send(i);
+        if (p != want || p == 5) {
+            TEST_FAIL(name, "Phase B flow %d: expected port %d, got %d", i, want, p); return;
+        }
+        if (port0[i] != 5 && p != port0[i]) {
+            TEST_FAIL(name, "Phase B flow %d moved %d → %d although its member stayed",
+                      i, port0[i], p);
+            return;
+        }
+    }
+    TEST_PASS(name);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PCAP replay / capture driver (--pcap-in)
+//
+// Streams the frames of a pcap file round-robin across the enabled RX ports
+// as multi-cell streams (64B cells, eop_len on the last cell), paced per
+// port by line rate + inter-frame gap, and captures every TX beat into
+// per-port pcap files.  Reports offered/achieved Mpps and Gbps per port.
+//
+// RX handshake: mac_rx_arb runs on clk_mac but p4_parser consumes cells on
+// clk_dp, and both look at the same valid/ready pair.  The driver therefore
+//   - advances to the next cell on every clk_dp edge where the parser took
+//     the current one (rx_valid & rx_ready sampled before the edge), and
+//   - after the last cell, keeps presenting a release beat (valid, !sof,
+//     eof) until a clk_mac edge sees it accepted, so the arbiter leaves
+//     S_GRANT.  The parser ignores it: it only latches cells with sof in
+//     PS_IDLE and is out of PS_PAYLOAD once it has taken the EOF cell.
+//
+// TX capture: traffic_manager never drives tx_sof and reports eop_len = 64
+// for every beat, so captured frames are the concatenated 64B beats of
+// port p up to tx_eof (i.e. padded to a cell multiple).
+//
+// Time: 1 dp cycle = 0.625 ns; 1 scheduler tick = 0.3125 ns.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#define NS_PER_TICK     0.3125
+#define DRV_MAX_FRAME   16383          // phv_meta.pkt_len is 14 bits
+
+struct replay_cfg_t {
+    const char *pcap_in       = nullptr;
+    const char *pcap_out_dir  = nullptr;    // nullptr → no capture files
+    uint32_t    rx_port_mask  = 0xFFFFFFFFU;
+    int         ifg_bytes     = 20;         // IFG 12 + preamble/SFD 8
+    double      rate_gbps[32];              // per-port line rate
+    int         n_routes      = 0;
+    uint32_t    route_pfx[16];
+    uint8_t     route_len[16];
+    uint8_t     route_port[16];
+    uint64_t    drain_dp      = 4000;       // stop after this many idle dp cycles
+    bool        tag           = true;       // latency tags in the payload
+    const char *latency_csv   = nullptr;    // per-packet latency records
+};
+
+enum { DRV_IDLE = 0, DRV_CELLS, DRV_RELEASE };
+
+struct port_drv_t {
+    std::vector<int> queue;       // frame indices to send, in order
+    size_t   qpos       = 0;
+    int      state      = DRV_IDLE;
+    int      cell       = 0;      // current cell index within the frame
+    int      n_cells    = 0;
+    uint64_t next_tick  = 0;      // earliest tick the next cell/frame may start
+    uint64_t cell_ticks = 0;      // serialization time of one 64B cell
+    int64_t  shown      = -1;     // signature of the beat currently driven
+    // stats
+    uint64_t rx_frames = 0, rx_bytes = 0;
+    uint64_t tx_frames = 0, tx_bytes = 0, tx_beats = 0;
+    uint64_t first_rx_tick = 0, last_tx_tick = 0;
+    std::vector<uint8_t> tx_buf;  // frame being reassembled from TX beats
+    uint64_t             tx_first_tick = 0;   // first beat of tx_buf
+    pcap_writer_t        pcap;
+};
+
+static uint64_t rate_ticks(uint64_t bytes, double gbps) {
+    // bytes*8 / gbps  [ns]  →  / NS_PER_TICK  [ticks]
+    return (uint64_t)((double)bytes * 8.0 / gbps / NS_PER_TICK + 0.5);
+}
+
+template <class W>
+static void wide_put(W &w, int lo, int width, uint32_t v) {
+    for (int i = 0; i < width; i++) {
+        int bit = lo + i;
+        if ((v >> i) & 1U) w[bit / 32] |=  (1U << (bit % 32));
+        else               w[bit / 32] &= ~(1U << (bit % 32));
+    }
+}
+
+// Drive port p's rx_* lanes: one 64B cell (or zeros), flags and eop_len
+static void rx_lane_set(int p, const uint8_t *cell, int n,
+                        bool valid, bool sof, bool eof, int eop_len) {
+    for (int w = 0; w < 16; w++) {
+        uint32_t word = 0;
+        for (int b = 0; b < 4; b++) {
+            int idx = w * 4 + b;
+            if (cell && idx < n) word |= (uint32_t)cell[idx] << (b * 8);
+        }
+        g_top->rx_data[p * 16 + w] = word;
+    }
+    uint32_t bit = 1U << p;
+    g_top->rx_valid = valid ? (g_top->rx_valid | bit) : (g_top->rx_valid & ~bit);
+    g_top->rx_sof   = sof   ? (g_top->rx_sof   | bit) : (g_top->rx_sof   & ~bit);
+    g_top->rx_eof   = eof   ? (g_top->rx_eof   | bit) : (g_top->rx_eof   & ~bit);
+    wide_put(g_top->rx_eop_len, p * 7, 7, (uint32_t)eop_len);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Latency tagging
+//
+// Every replayed frame carries a 12-byte tag in its last 12 bytes (frames
+// shorter than 60 B are zero-padded to 60 B first, so the tag never
+// overlaps Ethernet/IPv4/L4 headers):
+//   [0:3] magic "RVLT"  [4:7] seq (BE)  [8] ig port  [9] 0  [10:11] check
+// On TX the reassembled frame is scanned backwards for the magic (captured
+// frames are padded to 64B beats), and the sequence number is matched to
+// the ingress record.
+//
+// Per-frame timestamps (scheduler ticks):
+//   t_ready : first cell driven valid       t_sof : parser took cell 0
+//   t_eof   : parser took the last cell     t_tx0 : first TX beat
+//   t_tx1   : TX EOF beat
+// Breakdown:
+//   rx-arb wait   = t_sof - t_ready   (queueing in front of the shared parser)
+//   rx serialize  = t_eof - t_sof
+//   pipeline + TM = t_tx0 - t_eof     (parser, 24 MAU stages, TM queueing)
+//   tx serialize  = t_tx1 - t_tx0
+//   total         = t_tx1 - t_ready
+// ─────────────────────────────────────────────────────────────────────────────
+
+#define LAT_TAG_LEN     12
+#define LAT_MIN_FRAME   60
+static const uint8_t LAT_MAGIC[4] = { 'R', 'V', 'L', 'T' };
+
+struct lat_rec_t {
+    uint64_t t_ready = 0, t_sof = 0, t_eof = 0, t_tx0 = 0, t_tx1 = 0;
+    uint8_t  ig_port = 0, eg_port = 0;
+    bool     sent = false, seen = false;
+};
+
+static uint16_t lat_check(uint32_t seq, uint8_t port) {
+    return (uint16_t)((seq >> 16) ^ (seq & 0xFFFF) ^ ((uint16_t)port << 8) ^ 0x5A5A);
+}
+
+static void lat_tag(std::vector<uint8_t> &f, uint32_t seq, uint8_t port) {
+    if (f.size() < LAT_MIN_FRAME) f.resize(LAT_MIN_FRAME, 0);
+    uint8_t *t = f.data() + f.size() - LAT_TAG_LEN;
+    uint16_t ck = lat_check(seq, port);
+    memcpy(t, LAT_MAGIC, 4);
+    t[4] = (uint8_t)(seq >> 24); t[5] = (uint8_t)(seq >> 16);
+    t[6] = (uint8_t)(seq >> 8);  t[7] = (uint8_t)seq;
+    t[8] = port; t[9] = 0;
+    t[10] = (uint8_t)(ck >> 8); t[11] = (uint8_t)ck;
+}
+
+// Returns the tag's seq, or -1 if the frame carries no valid tag
+static int64_t lat_find(const std::vector<uint8_t> &f) {
+    for (int off = (int)f.size() - LAT_TAG_LEN; off >= 0; off--) {
+        const uint8_t *t = f.data() + off;
+        if (memcmp(t, LAT_MAGIC, 4) != 0) continue;
+        uint32_t seq = ((uint32_t)t[4] << 24) | ((uint32_t)t[5] << 16) |
+                       ((uint32_t)t[6] << 8) | t[7];
+        if ((((uint16_t)t[10] << 8) | t[11]) == lat_check(seq, t[8]))
+            return seq;
+    }
+    return -1;
+}
+
+static uint64_t pct(const std::vector<uint64_t> &v, double q) {
+    if (v.empty()) return 0;
+    size_t i = (size_t)(q * (double)(v.size() - 1) + 0.5);
+    return v[i];
+}
+
+// Sorted per-component vectors in dp cycles
+struct lat_set_t {
+    std::vector<uint64_t> total, arb, rxser, pipe, txser;
+    void add(const lat_rec_t &r) {
+        total.push_back((r.t_tx1 - r.t_ready) / 2);
+        arb.push_back((r.t_sof - r.t_ready) / 2);
+        rxser.push_back((r.t_eof - r.t_sof) / 2);
+        pipe.push_back((r.t_tx0 - r.t_eof) / 2);
+        txser.push_back((r.t_tx1 - r.t_tx0) / 2);
+    }
+    void sort_all() {
+        for (auto *v : { &total, &arb, &rxser, &pipe, &txser })
+            std::sort(v->begin(), v->end());
+    }
+};
+
+static void lat_print_row(const char *label, const std::vector<uint64_t> &v) {
+    if (v.empty()) return;
+    printf("    %-14s %7llu %7llu %7llu %7llu   cyc   %9.1f %9.1f %9.1f %9.1f ns\n", label,
+           (unsigned long long)v.front(), (unsigned long long)pct(v, 0.50),
+           (unsigned long long)pct(v, 0.99), (unsigned long long)v.back(),
+           v.front() * 0.625, pct(v, 0.50) * 0.625, pct(v, 0.99) * 0.625, v.back() * 0.625);
+}
+
+static void lat_report(const std::vector<lat_rec_t> &recs, const char *csv_path) {
+    lat_set_t per_port[32], all;
+    uint64_t sent = 0, seen = 0;
+    for (const lat_rec_t &r : recs) {
+        if (!r.sent) continue;
+        sent++;
+        if (!r.seen) continue;
+        seen++;
+        per_port[r.eg_port].add(r);
+        all.add(r);
+    }
+    printf("\n  Latency (%llu/%llu tagged frames matched, %llu not seen on TX)\n",
+           (unsigned long long)seen, (unsigned long long)sent,
+           (unsigned long long)(sent - seen));
+    printf("    %-14s %7s %7s %7s %7s         %9s %9s %9s %9s\n",
+           "", "min", "p50", "p99", "max", "min", "p50", "p99", "max");
+    for (int p = 0; p < 32; p++) {
+        lat_set_t &ls = per_port[p];
+        if (ls.total.empty()) continue;
+        ls.sort_all();
+        printf("  eg port %d (%zu pkts)\n", p, ls.total.size());
+        lat_print_row("total",         ls.total);
+        lat_print_row("rx-arb wait",   ls.arb);
+        lat_print_row("rx serialize",  ls.rxser);
+        lat_print_row("pipeline+TM",   ls.pipe);
+        lat_print_row("tx serialize",  ls.txser);
+    }
+    if (!all.total.empty()) {
+        all.sort_all();
+        // log2 histogram of total latency
+        printf("  total latency histogram (dp cycles):\n");
+        uint64_t buckets[64] = {};
+        int hi = 0;
+        for (uint64_t c : all.total) {
+            int b = 0;
+            while ((2ULL << b) <= c) b++;
+            buckets[b]++;
+            if (b > hi) hi = b;
+        }
+        for (int b = 0; b <= hi; b++) {
+            if (!buckets[b]) continue;
+            int bar = (int)(50.0 * (double)buckets[b] / (double)all.total.size() + 0.5);
+            printf("    [%6llu, %6llu) %8llu %.*s\n", (unsigned long long)(b ? 1ULL << b : 0),
+                   (unsigned long long)(2ULL << b), (unsigned long long)buckets[b], bar,
+                   "##################################################");
+        }
+    }
+
+    if (csv_path) {
+        FILE *fp = fopen(csv_path, "w");
+        if (!fp) { printf("  cannot write %s\n", csv_path); return; }
+        fprintf(fp, "seq,ig_port,eg_port,total_cyc,arb_cyc,rxser_cyc,pipe_cyc,txser_cyc\n");
+        for (size_t i = 0; i < recs.size(); i++) {
+            const lat_rec_t &r = recs[i];
+            if (!r.seen) continue;
+            fprintf(fp, "%zu,%u,%u,%llu,%llu,%llu,%llu,%llu\n", i, r.ig_port, r.eg_port,
+                    (unsigned long long)((r.t_tx1 - r.t_ready) / 2),
+                    (unsigned long long)((r.t_sof - r.t_ready) / 2),
+                    (unsigned long long)((r.t_eof - r.t_sof) / 2),
+                    (unsigned long long)((r.t_tx0 - r.t_eof) / 2),
+                    (unsigned long long)((r.t_tx1 - r.t_tx0) / 2));
+        }
+        fclose(fp);
+        printf("  per-packet latency: %s\n", csv_path);
+    }
+}
+
+// TX frame callback: `seq` is the latency-tag sequence number, or -1
+typedef void (*tx_frame_cb_t)(void *ctx, int port, const std::vector<uint8_t> &frame,
+                              int64_t seq);
+
+struct traffic_run_t {
+    port_drv_t             drv[32];
+    std::vector<lat_rec_t> lat;            // indexed by frame number
+    uint64_t               t_start = 0;
+    double                 wall_s  = 0;
+    tx_frame_cb_t          on_tx   = nullptr;
+    void                  *ctx     = nullptr;
+};
+
+// Drive `frames` (tagged in place when cfg.tag) through the RX ports and
+// collect TX until the data path has been idle for cfg.drain_dp cycles.
+static int traffic_run(std::vector<pcap_frame_t> &frames, const replay_cfg_t &cfg,
+                       traffic_run_t &tr)
+{
+    // Distribute frames round-robin over enabled RX ports
+    int ports[32], n_ports = 0;
+    for (int p = 0; p < 32; p++) {
+        tr.drv[p].cell_ticks = rate_ticks(64, cfg.rate_gbps[p]);
+        if (cfg.rx_port_mask & (1U << p)) ports[n_ports++] = p;
+    }
+    if (n_ports == 0) { printf("  no RX ports enabled\n"); return -1; }
+    int skipped = 0;
+    for (size_t i = 0, k = 0; i < frames.size(); i++) {
+        size_t len = frames[i].data.size();
+        if (len < 14 || len > DRV_MAX_FRAME) { skipped++; continue; }
+        tr.drv[ports[k++ % n_ports]].queue.push_back((int)i);
+    }
+    if (skipped) printf("  skipped %d frames outside 14..%d bytes\n", skipped, DRV_MAX_FRAME);
+
+    tr.lat.assign(frames.size(), lat_rec_t());
+    for (int p = 0; p < 32; p++)
+        for (int fi : tr.drv[p].queue) {
+            tr.lat[fi].ig_port = (uint8_t)p;
+            tr.lat[fi].sent    = cfg.tag;
+            if (cfg.tag) lat_tag(frames[fi].data, (uint32_t)fi, (uint8_t)p);
+        }
+
+    if (cfg.pcap_out_dir) {
+        char path[512];
+        for (int p = 0; p < 32; p++) {
+            snprintf(path, sizeof(path), "%s/tx_port%02d.pcap", cfg.pcap_out_dir, p);
+            pcap_writer_open(&tr.drv[p].pcap, path);
+        }
+    }
+
+    g_top->rx_valid = g_top->rx_sof = g_top->rx_eof = 0;
+    g_top->tx_ready = 0xFFFFFFFFU;
+
+    const uint64_t t_start  = g_sim_time;
+    tr.t_start = t_start;
+    uint64_t       last_act = g_sim_time;
+    auto           w0       = std::chrono::steady_clock::now();
+
+    for (;;) {
+        // ── present the current beat on every port ──
+        bool pending = false, dirty = false;
+        for (int p = 0; p < 32; p++) {
+            port_drv_t &d = tr.drv[p];
+            if (d.state == DRV_IDLE && d.qpos < d.queue.size() && g_sim_time >= d.next_tick) {
+                d.state     = DRV_CELLS;
+                d.cell      = 0;
+                d.next_tick = g_sim_time;     // no catch-up bursts above line rate
+                d.n_cells = (int)((frames[d.queue[d.qpos]].data.size() + 63) / 64);
+                if (d.rx_frames == 0) d.first_rx_tick = g_sim_time;
+                tr.lat[d.queue[d.qpos]].t_ready = g_sim_time;
+            }
+            bool    on  = g_sim_time >= d.next_tick;
+            int64_t sig = d.state == DRV_CELLS
+                        ? ((int64_t)d.qpos << 24) | ((int64_t)d.cell << 2) | (on ? 3 : 2)
+                        : d.state;
+            if (sig != d.shown) {
+                d.shown = sig;
+                dirty   = true;
+                if (d.state == DRV_CELLS) {
+                    const std::vector<uint8_t> &f = frames[d.queue[d.qpos]].data;
+                    int  off  = d.cell * 64;
+                    int  n    = (int)f.size() - off; if (n > 64) n = 64;
+                    bool last = (d.cell == d.n_cells - 1);
+                    rx_lane_set(p, f.data() + off, n, on, d.cell == 0, last, last ? n : 64);
+                } else if (d.state == DRV_RELEASE) {
+                    rx_lane_set(p, nullptr, 0, true, false, true, 0);
+                } else {
+                    rx_lane_set(p, nullptr, 0, false, false, false, 0);
+                }
+            }
+            if (d.state != DRV_IDLE || d.qpos < d.queue.size()) pending = true;
+        }
+        if (dirty) g_top->eval();
+
+        // ── sample handshakes just before the next edge ──
+        uint32_t rx_take = g_top->rx_valid & g_top->rx_ready;
+        uint32_t tx_take = g_top->tx_valid & g_top->tx_ready;
+        uint32_t tx_eof  = g_top->tx_eof;
+        bool dp_rise_next = !g_clk[CLK_DP].gated && g_clk[CLK_DP].level == 0 &&
+                            g_clk[CLK_DP].next == g_sim_time + 1;
+        if (!dp_rise_next) tx_take = 0;
+        if (tx_take) {
+            for (int p = 0; p < 32; p++) {
+                if (!(tx_take & (1U << p))) continue;
+                port_drv_t &d = tr.drv[p];
+                if (d.tx_buf.empty()) d.tx_first_tick = g_sim_time + 1;
+                for (int b = 0; b < 64; b++)
+                    d.tx_buf.push_back((uint8_t)(g_top->tx_data[p * 16 + b / 4] >> ((b % 4) * 8)));
+            }
+        }
 
+        uint32_t rise = sched_run(1);
+
+        if (rise & (1U << CLK_DP)) {
+            for (int p = 0; p < 32; p++) {
+                uint32_t bit = 1U << p;
+                port_drv_t &d = tr.drv[p];
+                if ((tx_take & bit)) {
+                    d.tx_beats++;
+                    if (tx_eof & bit) {
+                        d.tx_frames++;
+                        d.tx_bytes += d.tx_buf.size();
+                        d.last_tx_tick = g_sim_time;
+                        pcap_writer_put(&d.pcap, (uint64_t)((g_sim_time - t_start) * NS_PER_TICK),
+                                        d.tx_buf.data(), (uint32_t)d.tx_buf.size());
+                        int64_t seq = cfg.tag ? lat_find(d.tx_buf) : -1;
+                        if (tr.on_tx) tr.on_tx(tr.ctx, p, d.tx_buf, seq);
+                        if (seq >= 0 && (size_t)seq < tr.lat.size() && tr.lat[seq].sent && !tr.lat[seq].seen) {
+                            lat_rec_t &r = tr.lat[seq];
+                            r.seen    = true;
+                            r.eg_port = (uint8_t)p;
+                            r.t_tx0   = d.tx_first_tick;
+                            r.t_tx1   = g_sim_time;
+                        }
+                        d.tx_buf.clear();
+                    }
+                    last_act = g_sim_time;
+                }
+                if (d.state == DRV_CELLS && (rx_take & bit)) {
+                    last_act = g_sim_time;
+                    lat_rec_t &r = tr.lat[d.queue[d.qpos]];
+                    if (d.cell == 0)            r.t_sof = g_sim_time;
+                    if (d.cell == d.n_cells - 1) r.t_eof = g_sim_time;
+                    d.next_tick += d.cell_ticks;
+                    if (d.cell + 1 < d.n_cells) {
+                        d.cell++;
+                    } else {
+                        size_t len = frames[d.queue[d.qpos]].data.size();
+                        d.rx_frames++;
+                        d.rx_bytes += len;
+                        // next frame: line rate for the whole frame + IFG
+                        d.next_tick = (d.next_tick - (uint64_t)d.n_cells * d.cell_ticks) +
+                                      rate_ticks(len + (uint64_t)cfg.ifg_bytes, cfg.rate_gbps[p]);
+                        d.qpos++;
+                        d.state = ((rise & (1U << CLK_MAC)) != 0) ? DRV_IDLE : DRV_RELEASE;
+                    }
+                }
+            }
+        }
+        if (rise & (1U << CLK_MAC)) {
+            for (int p = 0; p < 32; p++)
+                if (tr.drv[p].state == DRV_RELEASE && (rx_take & (1U << p)))
+                    tr.drv[p].state = DRV_IDLE;
+        }
+
+        if (!pending && g_sim_time - last_act >= cfg.drain_dp * 2) break;
+        if (pending && g_sim_time - last_act >= 200000ULL * 2) {
+            printf("  RX stalled for 200000 dp cycles — aborting\n");
+            break;
+        }
+    }
+    dp_note_activity();
+    tr.wall_s = wall_since(w0);
+    for (int p = 0; p < 32; p++) pcap_writer_close(&tr.drv[p].pcap);
+    return 0;
+}
+
+
+static const replay_cfg_t *g_replay_cfg;     // warm_start setup context
+
+static int setup_replay_routes() {
+    const replay_cfg_t &cfg = *g_replay_cfg;
+    route_init();
+    for (int r = 0; r < cfg.n_routes; r++) {
+        int rc = route_add(cfg.route_pfx[r], cfg.route_len[r], cfg.route_port[r],
+                           0x020000000001ULL);
+        if (rc != 0) {
+            printf("  route_add #%d failed\n", r);
+            return rc;
+        }
+    }
+    return HAL_OK;
+}
+
+static int run_replay(const replay_cfg_t &cfg) {
+    std::vector<pcap_frame_t> frames;
+    if (pcap_read(cfg.pcap_in, frames) < 0) return 1;
+
+    printf("[ REPLAY ] %s: %zu frames, rx ports 0x%08X, IFG %d B\n\n",
+           cfg.pcap_in, frames.size(), cfg.rx_port_mask, cfg.ifg_bytes);
+
+    // Data plane setup: IPv4 DST → PHV[0:3] (CS-RTL-1 profile) + routes,
+    // snapshot named by the route list so a rerun skips the APB programming
+    uint32_t h = FNV1A_INIT;
+    for (int r = 0; r < cfg.n_routes; r++) {
+        h = fnv1a(h, &cfg.route_pfx[r],  sizeof(cfg.route_pfx[r]));
+        h = fnv1a(h, &cfg.route_len[r],  sizeof(cfg.route_len[r]));
+        h = fnv1a(h, &cfg.route_port[r], sizeof(cfg.route_port[r]));
+    }
+    char setup_name[32];
+    snprintf(setup_name, sizeof(setup_name), "routes-%08x", h);
+    g_replay_cfg = &cfg;
+    if (warm_start(PROF_IPV4_DST, setup_name, setup_replay_routes) != HAL_OK) return 1;
+
+    traffic_run_t *tr = new traffic_run_t();
+    int rc = traffic_run(frames, cfg, *tr);
+    if (rc != 0) { delete tr; return 1; }
+    port_drv_t *drv = tr->drv;
+    const uint64_t t_start = tr->t_start;
+    double wall_s = tr->wall_s;
+
+    // ── report ──
+    printf("  port   rx_pkts    rx_Mpps   rx_Gbps   tx_pkts  tx_beats    tx_Mpps   tx_Gbps\n");
+    uint64_t trx = 0, ttx = 0, trxb = 0, ttxb = 0;
+    for (int p = 0; p < 32; p++) {
+        port_drv_t &d = drv[p];
+        if (!d.rx_frames && !d.tx_frames) continue;
+        double rx_ns = (double)(g_sim_time - d.first_rx_tick) * NS_PER_TICK;
+        double tx_ns = (double)(d.last_tx_tick - t_start) * NS_PER_TICK;
+        if (rx_ns <= 0) rx_ns = 1;
+        if (tx_ns <= 0) tx_ns = 1;
+        printf("  %4d  %8llu  %9.3f %9.3f  %8llu  %8llu  %9.3f %9.3f\n", p,
+               (unsigned long long)d.rx_frames, d.rx_frames * 1e3 / rx_ns, d.rx_bytes * 8.0 / rx_ns,
+               (unsigned long long)d.tx_frames, (unsigned long long)d.tx_beats,
+               d.tx_frames * 1e3 / tx_ns, d.tx_bytes * 8.0 / tx_ns);
+        trx += d.rx_frames; ttx += d.tx_frames; trxb += d.rx_bytes; ttxb += d.tx_bytes;
+    }
+    double sim_ns = (double)(g_sim_time - t_start) * NS_PER_TICK;
+    printf("  total %8llu  %9.3f %9.3f  %8llu            %9.3f %9.3f\n",
+           (unsigned long long)trx, trx * 1e3 / sim_ns, trxb * 8.0 / sim_ns,
+           (unsigned long long)ttx, ttx * 1e3 / sim_ns, ttxb * 8.0 / sim_ns);
+    printf("\n  simulated %.3f us in %.3f s wall\n", sim_ns / 1e3, wall_s);
+    if (cfg.pcap_out_dir)
+        printf("  TX capture: %s/tx_portNN.pcap\n", cfg.pcap_out_dir);
+    if (cfg.tag)
+        lat_report(tr->lat, cfg.latency_csv);
+    delete tr;
+    return 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Differential lockstep: pkt_model.c vs RTL (--lockstep route|acl|fdb)
+//
+// The TCAM HAL mirrors every entry into sim_tcam.c, so one firmware call
+// (route_add / acl_add_* / fdb_add_static) programs both pkt_process() and
+// rv_p4_top.  A seeded random rule set is installed, a seeded random packet
+// stream is replayed at line rate through traffic_run(), and every tagged
+// TX frame is checked against the model's decision for the same frame:
+//   drop      → the frame must not appear on TX
+//   otherwise → exactly one copy on port (eg_port & 0x1F), with the input
+//               bytes; eth_dst is compared against the model's rewrite only
+//               with --strict-rewrite (the RTL TM path does not rewrite yet,
+//               so by default such frames are counted as a known divergence)
+// For the first mismatching packet the rule set is shrunk greedily — drop
+// one rule, re-run that packet from warm_start(), keep the removal if it
+// still fails — and the minimal reproducer is printed.
+//
+// One table per run: every RTL stage matches on PHV[0:63], which a single
+// parser profile fills, while the model extracts a per-stage key.  Frames
+// stay within one 64B cell (the TM may re-emit non-last cells).
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum { LS_ROUTE = 0, LS_ACL, LS_FDB, LS_PARSER };
+
+struct lockstep_cfg_t {
+    int         mode    = -1;
+    int         pkts    = 2000;
+    int         rules   = 32;
+    uint64_t    seed    = 1;
+    bool        strict  = false;   // --strict-rewrite
+    int         max_log = 10;      // mismatches listed in detail
+};
+
+struct ls_rule_t {
+    uint32_t a = 0, a_len = 0;     // route prefix/len, ACL src/len
+    uint32_t b = 0, b_len = 0;     // ACL dst/len
+    uint64_t mac   = 0;            // FDB
+    uint16_t dport = 0;            // ACL (0 = any)
+    uint8_t  port  = 0;            // route/FDB egress
+    bool     deny  = false;        // ACL
+};
+
+struct ls_obs_t {
+    int                  port   = -1;
+    int                  copies = 0;
+    std::vector<uint8_t> data;
+};
+
+struct ls_ctx_t {
+    std::vector<ls_obs_t> obs;
+    uint64_t              untagged = 0;
+};
+
+static uint64_t ls_rand(uint64_t &s) {           // xorshift64*
+    s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+    return s * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t ls_mask(uint32_t len) {
+    return len ? 0xFFFFFFFFU << (32 - len) : 0;
+}
+
+static const char *ls_ip(uint32_t ip, char *buf) {
+    sprintf(buf, "%u.%u.%u.%u", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF);
+    return buf;
+}
+
+static void ls_rule_print(int mode, const ls_rule_t &r) {
+    char x[16], y[16];
+    if (mode == LS_ROUTE)
+        printf("      route_add(%s/%u, port %u)\n", ls_ip(r.a, x), r.a_len, r.port);
+    else if (mode == LS_ACL)
+        printf("      acl_add_%s(src %s/%u, dst %s/%u, dport %u)\n", r.deny ? "deny" : "permit",
+               ls_ip(r.a, x), r.a_len, ls_ip(r.b, y), r.b_len, r.dport);
+    else
+        printf("      fdb_add_static(%012llX, port %u)\n", (unsigned long long)r.mac, r.port);
+}
+
+static const uint16_t LS_DPORTS[4] = { 22, 53, 80, 443 };
+
+static ls_rule_t ls_gen_rule(int mode, uint64_t &s) {
+    ls_rule_t r;
+    r.port = (uint8_t)(1 + ls_rand(s) % 15);      // never 0: 0 is the miss port
+    if (mode == LS_ROUTE) {
+        r.a_len = 8 + (uint32_t)(ls_rand(s) % 25);
+        r.a     = (0x0A000000U | (uint32_t)(ls_rand(s) & 0x00FFFFFF)) & ls_mask(r.a_len);
+    } else if (mode == LS_ACL) {
+        static const uint8_t lens[4] = { 8, 16, 24, 32 };
+        r.a_len = lens[ls_rand(s) % 4];
+        r.b_len = lens[ls_rand(s) % 4];
+        r.a     = (0x0A000000U | (uint32_t)(ls_rand(s) & 0x0003FFFF)) & ls_mask(r.a_len);
+        r.b     = (0xC0A80000U | (uint32_t)(ls_rand(s) & 0x0000FFFF)) & ls_mask(r.b_len);
+        r.deny  = (ls_rand(s) & 1) != 0;
+        // acl_add_permit has no dport field
+        r.dport = (r.deny && (ls_rand(s) & 1)) ? LS_DPORTS[ls_rand(s) % 4] : 0;
+    } else {
+        r.mac = 0x020000000000ULL | (ls_rand(s) & 0xFFFF);
+    }
+    return r;
+}
+
+// Packet aimed at a random rule 3/4 of the time, at random space otherwise
+static void ls_gen_pkt(int mode, const std::vector<ls_rule_t> &rules, uint64_t &s,
+                       std::vector<uint8_t> &out) {
+    uint8_t  eth_dst[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    uint8_t  eth_src[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+    uint32_t src   = 0x0A000000U | (uint32_t)(ls_rand(s) & 0x0003FFFF);
+    uint32_t dst   = (mode == LS_ACL ? 0xC0A80000U | (uint32_t)(ls_rand(s) & 0xFFFF)
+                                     : 0x0A000000U | (uint32_t)(ls_rand(s) & 0x00FFFFFF));
+    uint16_t dport = LS_DPORTS[ls_rand(s) % 4];
+    uint64_t mac   = 0x020000000000ULL | (ls_rand(s) & 0xFFFF);
+
+    if (!rules.empty() && (ls_rand(s) & 3) != 0) {
+        const ls_rule_t &r = rules[ls_rand(s) % rules.size()];
+        uint32_t host = (uint32_t)ls_rand(s);
+        if (mode == LS_ROUTE) {
+            dst = r.a | (host & ~ls_mask(r.a_len));
+        } else if (mode == LS_ACL) {
+            src = r.a | (host & ~ls_mask(r.a_len));
+            dst = r.b | ((uint32_t)ls_rand(s) & ~ls_mask(r.b_len));
+            if (r.dport) dport = r.dport;
+        } else {
+            mac = r.mac;
+        }
+    }
+    for (int i = 0; i < 6; i++) eth_dst[i] = (uint8_t)(mac >> (40 - 8 * i));
+
+    uint8_t pkt[64];
+    int len = build_ipv4_pkt(pkt, eth_dst, eth_src, src, dst, 17, dport);
+    out.assign(pkt, pkt + len);
+}
+
+// warm_start setup context for ls_program()
+static struct {
+    int                           mode;
+    const std::vector<ls_rule_t> *rules;
+    const std::vector<bool>      *keep;
+    int                           rejected;
+} g_ls;
+
+// Firmware rejections are part of the scenario, not a setup failure
+static int setup_ls_rules() {
+    route_init();
+    acl_init();
+    fdb_init();
+    g_ls.rejected = 0;
+    for (size_t i = 0; i < g_ls.rules->size(); i++) {
+        if (!(*g_ls.keep)[i]) continue;
+        const ls_rule_t &r = (*g_ls.rules)[i];
+        int rc;
+        if (g_ls.mode == LS_ROUTE)
+            rc = route_add(r.a, (uint8_t)r.a_len, r.port, 0x020000000000ULL | r.port);
+        else if (g_ls.mode == LS_ACL && r.deny)
+            rc = acl_add_deny(r.a, ls_mask(r.a_len), r.b, ls_mask(r.b_len), r.dport);
+        else if (g_ls.mode == LS_ACL)
+            rc = acl_add_permit(r.a, ls_mask(r.a_len), r.b, ls_mask(r.b_len));
+        else
+            rc = fdb_add_static(r.mac, r.port, 1);
+        if (rc < 0) g_ls.rejected++;
+    }
+    return HAL_OK;
+}
+
+// warm_start + firmware programming of the rules selected by keep[].
+// The full rule set is snapshotted under a hash of the rules; the one-off
+// subsets tried while minimizing are programmed live on the profile snapshot.
+static int ls_program(int mode, const std::vector<ls_rule_t> &rules,
+                      const std::vector<bool> &keep) {
+    static const parser_profile_t *prof[3] = { &PROF_IPV4_DST, &PROF_ACL, &PROF_ETH_DST };
+    g_ls.mode  = mode;
+    g_ls.rules = &rules;
+    g_ls.keep  = &keep;
+
+    bool all = true;
+    uint32_t h = FNV1A_INIT;
+    for (size_t i = 0; i < rules.size(); i++) {
+        const ls_rule_t &r = rules[i];
+        all = all && keep[i];
+        h = fnv1a(h, &r.a, sizeof(r.a));       h = fnv1a(h, &r.a_len, sizeof(r.a_len));
+        h = fnv1a(h, &r.b, sizeof(r.b));       h = fnv1a(h, &r.b_len, sizeof(r.b_len));
+        h = fnv1a(h, &r.mac, sizeof(r.mac));   h = fnv1a(h, &r.dport, sizeof(r.dport));
+        h = fnv1a(h, &r.port, sizeof(r.port)); h = fnv1a(h, &r.deny, sizeof(r.deny));
+    }
+    char setup_name[32];
+    snprintf(setup_name, sizeof(setup_name), "ls-%08x", h);
+    warm_start(*prof[mode], all ? setup_name : nullptr, setup_ls_rules);
+    return g_ls.rejected;
+}
+
+static void ls_on_tx(void *ctx, int port, const std::vector<uint8_t> &frame, int64_t seq) {
+    ls_ctx_t *c = (ls_ctx_t *)ctx;
+    if (seq < 0 || (size_t)seq >= c->obs.size()) { c->untagged++; return; }
+    ls_obs_t &o = c->obs[seq];
+    if (o.copies++ == 0) {
+        o.port = port;
+        o.data = frame;
+    }
+}
+
+enum { LS_OK = 0, LS_OK_REWRITE, LS_BAD_DROP, LS_BAD_LOST, LS_BAD_PORT, LS_BAD_DUP, LS_BAD_DATA };
+static const char *const LS_WHAT[] = {
+    "ok", "ok (rewrite skipped)", "model drops, RTL forwards", "model forwards, RTL drops",
+    "wrong egress port", "duplicated on TX", "TX bytes differ",
+};
+
+// Compare one frame (tagged input `in`, arrived on ig_port) with its TX
+static int ls_check(const std::vector<uint8_t> &in, uint8_t ig_port, const ls_obs_t &o,
+                    bool strict, fwd_result_t &res) {
+    phv_t phv;
+    memset(&res, 0, sizeof(res));
+    if (pkt_parse(in.data(), (uint16_t)in.size(), ig_port, &phv) != 0) return LS_OK;
+    pkt_forward(&phv, &res);
+
+    if (res.drop)              return o.copies ? LS_BAD_DROP : LS_OK;
+    if (!o.copies)             return LS_BAD_LOST;
+    if (o.port != (res.eg_port & 0x1F)) return LS_BAD_PORT;
+    if (o.copies > 1)          return LS_BAD_DUP;
+    if (o.data.size() < in.size() ||
+        memcmp(o.data.data() + 6, in.data() + 6, in.size() - 6) != 0)
+        return LS_BAD_DATA;
+    const uint8_t *want = &phv.hdr[PHV_OFF_ETH_DST];
+    if (memcmp(o.data.data(), want, 6) == 0) return LS_OK;
+    if (memcmp(o.data.data(), in.data(), 6) == 0 && !strict) return LS_OK_REWRITE;
+    return LS_BAD_DATA;
+}
+
+// One lockstep pass over `frames` (copied: traffic_run tags them in place).
+// Returns the number of mismatches; *first = index of the first one.
+static int ls_pass(std::vector<pcap_frame_t> frames, const replay_cfg_t &rc, bool strict,
+                   int *first, int max_log, uint64_t *rewrites, double *wall_s) {
+    ls_ctx_t ctx;
+    ctx.obs.resize(frames.size());
+    traffic_run_t *tr = new traffic_run_t();
+    tr->on_tx = ls_on_tx;
+    tr->ctx   = &ctx;
+    if (traffic_run(frames, rc, *tr) != 0) { delete tr; return -1; }
+    if (wall_s) *wall_s = tr->wall_s;
+
+    int bad = 0;
+    *first = -1;
+    for (size_t i = 0; i < frames.size(); i++) {
+        fwd_result_t res;
+        int v = ls_check(frames[i].data, tr->lat[i].ig_port, ctx.obs[i], strict, res);
+        if (v == LS_OK_REWRITE && rewrites) (*rewrites)++;
+        if (v <= LS_OK_REWRITE) continue;
+        if (*first < 0) *first = (int)i;
+        if (bad++ < max_log)
+            printf("    pkt %zu (ig %u): %s — model %s port %u, RTL %d cop%s on port %d\n",
+                   i, tr->lat[i].ig_port, LS_WHAT[v], res.drop ? "drop" : "fwd",
+                   res.eg_port & 0x1F, ctx.obs[i].copies, ctx.obs[i].copies == 1 ? "y" : "ies",
+                   ctx.obs[i].port);
+    }
+    if (ctx.untagged) {
+        printf("    %llu TX frames without a valid tag\n", (unsigned long long)ctx.untagged);
+        bad += (int)ctx.untagged;
+        if (*first < 0) *first = 0;
+    }
+    delete tr;
+    return bad;
+}
+
+static int run_lockstep(const lockstep_cfg_t &lc, const replay_cfg_t &base) {
+    static const char *const mode_name[3] = { "route", "acl", "fdb" };
+    uint64_t s = lc.seed ? lc.seed : 1;
+
+    std::vector<ls_rule_t> rules;
+    for (int i = 0; i < lc.rules; i++) rules.push_back(ls_gen_rule(lc.mode, s));
+    std::vector<pcap_frame_t> frames(lc.pkts);
+    for (int i = 0; i < lc.pkts; i++) ls_gen_pkt(lc.mode, rules, s, frames[i].data);
+
+    replay_cfg_t rc = base;
+    rc.pcap_in      = nullptr;
+    rc.pcap_out_dir = nullptr;
+    rc.latency_csv  = nullptr;
+    rc.tag          = true;
+
+    printf("[ LOCKSTEP ] %s: %d rules, %d pkts, seed %llu, rx ports 0x%08X\n\n",
+           mode_name[lc.mode], lc.rules, lc.pkts, (unsigned long long)lc.seed,
+           rc.rx_port_mask);
+
+    std::vector<bool> keep(rules.size(), true);
+    int rejected = ls_program(lc.mode, rules, keep);
+    printf("  programmed %d rules (%d rejected by firmware), %d model TCAM entries\n",
+           lc.rules - rejected, rejected, sim_tcam_count_stage(lc.mode == LS_ROUTE ? 0 :
+                                                              lc.mode == LS_ACL ? 1 : 2));
+
+    // Model-only throughput on the same stream (burst API), as the reference figure
+    std::vector<pkt_desc_t>   descs(frames.size());
+    std::vector<fwd_result_t> model_res(frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+        descs[i] = {frames[i].data.data(), (uint16_t)frames[i].data.size(), 0};
+    auto t0 = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 100; rep++)
+        pkt_process_burst(descs.data(), (int)descs.size(), model_res.data());
+    double model_s = wall_since(t0);
+
+    int first = -1;
+    uint64_t rewrites = 0;
+    double wall_s = 0;
+    int bad = ls_pass(frames, rc, lc.strict, &first, lc.max_log, &rewrites, &wall_s);
+    if (bad < 0) return 1;
+    printf("  RTL  : %d pkts in %.3f s wall → %.0f pkts/s\n", lc.pkts, wall_s,
+           wall_s > 0 ? lc.pkts / wall_s : 0.0);
+    printf("  model: %d pkts in %.6f s wall → %.0f pkts/s (%.0fx)\n", lc.pkts * 100, model_s,
+           model_s > 0 ? lc.pkts * 100 / model_s : 0.0,
+           (model_s > 0 && wall_s > 0) ? (lc.pkts * 100 / model_s) / (lc.pkts / wall_s) : 0.0);
+    if (rewrites)
+        printf("  %llu frames: model rewrites eth_dst, RTL does not "
+               "(known divergence, --strict-rewrite to fail on it)\n",
+               (unsigned long long)rewrites);
+    printf("  mismatches: %d/%d\n", bad, lc.pkts);
+    if (bad == 0) return 0;
+
+    // ── greedy rule-set minimization for the first failing packet ──
+    if (first >= 0 && first < (int)frames.size()) {
+        std::vector<pcap_frame_t> one(1, frames[first]);
+        replay_cfg_t rc1 = rc;
+        // same ingress port as in the full run (traffic_run's round-robin)
+        int ports[32], n_ports = 0;
+        for (int p = 0; p < 32; p++)
+            if (rc.rx_port_mask & (1U << p)) ports[n_ports++] = p;
+        int ig = ports[first % n_ports];
+        rc1.rx_port_mask = 1U << ig;
+
+        printf("\n  minimizing pkt %d over %zu rules ...\n", first, rules.size());
+        int f1 = -1;
+        ls_program(lc.mode, rules, keep);
+        if (ls_pass(one, rc1, lc.strict, &f1, 0, nullptr, nullptr) <= 0) {
+            printf("  pkt %d does not fail on its own (ordering/congestion dependent)\n", first);
+        } else {
+            for (size_t i = 0; i < rules.size(); i++) {
+                keep[i] = false;
+                ls_program(lc.mode, rules, keep);
+                if (ls_pass(one, rc1, lc.strict, &f1, 0, nullptr, nullptr) <= 0)
+                    keep[i] = true;                  // needed to reproduce
+            }
+            int n = 0;
+            for (size_t i = 0; i < rules.size(); i++) n += keep[i];
+            printf("  minimal reproducer (%d rule%s, ig port %d):\n", n, n == 1 ? "" : "s", ig);
+            for (size_t i = 0; i < rules.size(); i++)
+                if (keep[i]) ls_rule_print(lc.mode, rules[i]);
+            ls_program(lc.mode, rules, keep);
+            ls_pass(one, rc1, lc.strict, &f1, 1, nullptr, nullptr);
+            printf("    frame (%zu B, before tagging):", frames[first].data.size());
+            for (size_t b = 0; b < frames[first].data.size(); b++)
+                printf("%s%02X", (b % 16) ? " " : "\n      ", frames[first].data[b]);
+            printf("\n");
+        }
+    }
+    return 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Parser lockstep: pkt_parser.c vs p4_parser.sv (--lockstep parser)
+//
+// --lockstep-rules random parser programs (acyclic, 2-6 states, 1-3 entries
+// per state comparing one window byte, 0-3 byte extracts, hdr_advance 0-8)
+// go into the model with pkt_parser_write() and into the RTL through
+// pkt_parser_to_rtl() / parser_load().  Each program gets an equal share of
+// --lockstep-pkts random 64-byte frames, injected one at a time on port 0.
+// The PHV the parser hands to MAU[0] (tb_parser_phv_*) is compared with
+// pkt_parser_run() over the header region PHV[0:255]; no PHV within
+// PS_WAIT_DP cycles counts as a drop.  pkt_parser_rtl_run() — the C reading
+// of parser_tcam.sv on the converted entries — is printed next to each
+// mismatch, so it shows whether the converter or the RTL departs from the
+// model.  The model's built-in program is restored afterwards.
+// ─────────────────────────────────────────────────────────────────────────────
+
+static const int PS_WAIT_DP = 512;    // > 3 dp cycles × the longest RTL entry chain
+
+static uint8_t ps_byte(uint64_t &s) {
+    static const uint8_t alpha[4] = { 0x00, 0x11, 0xA5, 0xFF };
+    uint64_t r = ls_rand(s);
+    return (r & 3) ? alpha[(r >> 2) & 3] : (uint8_t)(r >> 8);
+}
+
+static int ps_gen_prog(uint64_t &s, fsm_entry_t *prog) {
+    int n = 0, n_st = 2 + (int)(ls_rand(s) % 5);
+    for (int st = 1; st <= n_st; st++) {
+        int k = 1 + (int)(ls_rand(s) % 3);
+        for (int j = 0; j < k; j++) {
+            fsm_entry_t *e = &prog[n++];
+            memset(e, 0, sizeof(*e));
+            e->cur_state = (uint8_t)st;
+            if (j < k - 1 || (ls_rand(s) & 1)) {          // last entry: half are catch-alls
+                int pos = (int)(ls_rand(s) % 8);
+                e->key_window[pos] = ps_byte(s);
+                e->key_mask[pos]   = (ls_rand(s) & 1) ? 0xFF : 0xF0;
+            }
+            uint64_t r = ls_rand(s);
+            e->next_state = (st == n_st || (r & 3) == 0)
+                          ? PKT_PARSER_ACCEPT
+                          : (uint8_t)(st + 1 + (int)((r >> 2) % (uint64_t)(n_st - st)));
+            e->extract_offset = (uint8_t)((r >> 8) % 8);
+            e->extract_len    = (uint8_t)((r >> 16) % 4);
+            e->hdr_advance    = (uint8_t)((r >> 24) % 9);
+            e->phv_dst_offset = (uint16_t)((r >> 32) % 240);
+        }
+    }
+    return n;
+}
+
+// Inject one single-cell frame on port 0 (same handshake as inject_pkt())
+// and sample the parser output every dp cycle.  Returns the number of PHVs
+// seen; the first one's header region is copied to hdr.
+static int ps_inject(const uint8_t *pkt, int len, uint8_t *hdr) {
+    int seen = 0;
+    auto poll = [&]() {
+        step_dp(1);
+        if (!g_top->tb_parser_phv_valid) return;
+        if (seen++ == 0)
+            for (int b = 0; b < PHV_OFF_IG_PORT; b++)
+                hdr[b] = (uint8_t)(g_top->tb_parser_phv_data[b / 4] >> ((b % 4) * 8));
+    };
+    g_top->rx_eop_len[0] = (g_top->rx_eop_len[0] & ~0x7FU) | ((uint32_t)len & 0x7F);
+    fill_rx_data_port0(pkt, len);
+    g_top->rx_valid = 1U;
+    g_top->rx_sof   = 1U;
+    g_top->rx_eof   = 1U;
+    g_top->tx_ready = 0xFFFFFFFFU;
+    dp_note_activity();
+    for (int i = 0; i < 10; i++) poll();
+    for (int w = 0; w < 200 && !(g_top->rx_ready & 1U); w++) poll();
+    g_top->rx_valid = 0;
+    g_top->rx_sof   = 0;
+    g_top->rx_eof   = 0;
+    for (int i = 0; i < PS_WAIT_DP; i++) poll();
+    dp_note_activity();
+    return seen;
+}
+
+static void ps_print_prog(const fsm_entry_t *prog, int n) {
+    for (int i = 0; i < n; i++) {
+        const fsm_entry_t &e = prog[i];
+        printf("      [%2d] st %2u win", i, e.cur_state);
+        for (int k = 0; k < 8; k++) printf(" %02X/%02X", e.key_window[k], e.key_mask[k]);
+        printf(" → %2u  ext +%u×%u → PHV[%u]  adv %u\n", e.next_state, e.extract_offset,
+               e.extract_len, e.phv_dst_offset, e.hdr_advance);
+    }
+}
+
+static int run_parser_lockstep(const lockstep_cfg_t &lc) {
+    uint64_t s = lc.seed ? lc.seed : 1;
+    int progs = lc.rules > 0 ? lc.rules : 1;
+    int per   = lc.pkts / progs > 0 ? lc.pkts / progs : 1;
+
+    printf("[ LOCKSTEP ] parser: %d programs × %d pkts, seed %llu\n\n",
+           progs, per, (unsigned long long)lc.seed);
+
+    static fsm_entry_t            prog[PKT_PARSER_ENTRIES];
+    static pkt_parser_rtl_entry_t rtl[PKT_PARSER_ENTRIES];
+    int bad = 0, total = 0, skipped = 0, accepted = 0;
+    do_reset();
+    for (int t = 0; t < progs; t++) {
+        int n  = ps_gen_prog(s, prog);
+        int nr = pkt_parser_to_rtl(prog, n, rtl, PKT_PARSER_ENTRIES);
+        if (nr < 0 || parser_load(prog, n) != nr) { skipped++; continue; }
+        pkt_parser_clear();
+        for (int i = 0; i < n; i++) pkt_parser_write(i, &prog[i]);
+
+        for (int k = 0; k < per; k++) {
+            uint8_t pkt[PKT_PARSER_RTL_CELL];
+            for (int b = 0; b < PKT_PARSER_RTL_CELL; b++) pkt[b] = ps_byte(s);
+            uint8_t model_hdr[PHV_OFF_IG_PORT] = {}, rtl_hdr[PHV_OFF_IG_PORT] = {};
+            uint8_t ref_phv[PKT_PARSER_RTL_SCRATCH + 1] = {};
+            int rm   = pkt_parser_run(pkt_parser_current(), pkt, sizeof(pkt), model_hdr);
+            int rr   = pkt_parser_rtl_run(rtl, nr, pkt, sizeof(pkt), ref_phv);
+            int seen = ps_inject(pkt, sizeof(pkt), rtl_hdr);
+            total++;
+            if (rm == 0) accepted++;
+            bool ok = (rm != 0) ? seen == 0
+                                : seen == 1 && memcmp(model_hdr, rtl_hdr, sizeof(rtl_hdr)) == 0;
+            if (ok) continue;
+            if (bad++ >= lc.max_log) continue;
+            printf("    program %d pkt %d: model %s, RTL %d PHV%s, C mirror %s%s\n", t, k,
+                   rm ? "drop" : "accept", seen, seen == 1 ? "" : "s", rr ? "drop" : "accept",
+                   (rr == 0 && memcmp(ref_phv, model_hdr, sizeof(model_hdr)) != 0)
+                       ? " (PHV differs from model)" : "");
+            if (rm == 0 && seen == 1)
+                for (int b = 0; b < PHV_OFF_IG_PORT; b++)
+                    if (model_hdr[b] != rtl_hdr[b])
+                        printf("      PHV[%d]: model %02X, RTL %02X\n", b, model_hdr[b], rtl_hdr[b]);
+            if (bad == 1) {
+                ps_print_prog(prog, n);
+                printf("      frame:");
+                for (int b = 0; b < PKT_PARSER_RTL_CELL; b++)
+                    printf("%s%02X", (b % 16) ? " " : "\n        ", pkt[b]);
+                printf("\n");
+            }
+        }
+    }
+    pkt_parser_reset();
+
+    printf("  %d programs loaded (%d not representable), %d pkts, %d accepted by the model\n",
+           progs - skipped, skipped, total, accepted);
+    printf("  mismatches: %d/%d\n", bad, total);
+    return bad == 0 && total > 0 ? 0 : 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Simulation-speed benchmark (--bench)
+//
+// Phase 1 (idle): free-running clocks after reset, no traffic — raw eval()
+//                 cost of the 24-stage model.
+// Phase 2 (traffic): CS-RTL-1 setup (IPv4 DST → PHV[0:3], 10.10.0.0/16 →
+//                 port 3), then n_pkts packets injected back-to-back, each
+//                 polled to TX.  Reports dp-cycles/sec and packets/sec.
+//
+// The final "BENCH ..." line is the machine-readable summary collected by
+// `make bench`.
+// ─────────────────────────────────────────────────────────────────────────────
+
+static int run_bench(int n_pkts) {
+    printf("[ BENCH ] threads=%d pkts=%d\n\n", COSIM_THREADS, n_pkts);
+
+    do_reset();
+
+    // Phase 1: idle clocking
+    const int idle_cycles = 200000;
+    uint64_t c0 = dp_cycles();
+    auto t0 = std::chrono::steady_clock::now();
+    step_dp(idle_cycles);
+    double idle_s   = wall_since(t0);
+    double idle_cps = (double)(dp_cycles() - c0) / idle_s;
+    printf("  idle    : %llu dp cycles in %.3f s → %.0f dp-cycles/s\n",
+           (unsigned long long)(dp_cycles() - c0), idle_s, idle_cps);
+
+    // Phase 2: forwarding traffic
+    route_init();
+    parser_load_profile(PROF_IPV4_DST);
+    if (route_add(0x0A0A0000u, 16, 3, 0xAABBCCDDEEFFULL) != 0) {
+        printf("  route_add failed\n");
+        return 1;
+    }
+
+    // Table programming cost: 64 more /24 routes outside 10.10.0.0/16
+    const int n_routes = 64;
+    uint64_t e0 = g_evals;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < n_routes; r++)
+        route_add(0xC0A80000u | ((uint32_t)r << 8), 24, 1, 0x020000000001ULL);
+    double prog_s = wall_since(t0);
+    printf("  program : %d routes in %.3f s → %.0f routes/s, %.0f evals/route\n",
+           n_routes, prog_s, n_routes / prog_s,
+           (double)(g_evals - e0) / n_routes);
+    tue_stats_print();
+
+    static const uint8_t eth_dst[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+    static const uint8_t eth_src[6] = {0x00,0x11,0x22,0x33,0x44,0x55};
+    uint8_t pkt[64] = {};
+
+    int delivered = 0;
+    c0 = dp_cycles();
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_pkts; i++) {
+        int len = build_ipv4_pkt(pkt, eth_dst, eth_src, 0x01020304u,
+                                 0x0A0A0000u | (uint32_t)(i & 0xFFFF), 0, 0);
+        inject_pkt(pkt, len);
+        if (poll_tx(2000) & (1U << 3)) delivered++;
+    }
+    double traf_s   = wall_since(t0);
+    uint64_t traf_c = dp_cycles() - c0;
+    double traf_cps = (double)traf_c / traf_s;
+    double pps      = (double)delivered / traf_s;
+    printf("  traffic : %d/%d pkts, %llu dp cycles in %.3f s → %.0f dp-cycles/s, %.1f pkts/s\n",
+           delivered, n_pkts, (unsigned long long)traf_c, traf_s, traf_cps, pps);
+    printf("            (%.1f simulated dp cycles per packet)\n",
+           delivered ? (double)traf_c / delivered : 0.0);
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("  memory  : max RSS %.1f MiB\n", ru.ru_maxrss / 1024.0);
+#ifdef COSIM_TCAM_DPI
+    mau_tcam_stats_t ts = mau_tcam_stats();
+    printf("            mau_tcam DPI: %d instances, %d entries in %d mask groups, "
+           "%llu lookups, %.2f probes/lookup\n",
+           ts.instances, ts.entries, ts.groups, (unsigned long long)ts.lookups,
+           ts.lookups ? (double)ts.probes / ts.lookups : 0.0);
+#endif
+#ifdef COSIM_SPARSE_PB
+    pb_sparse_stats_t pb = pb_sparse_stats();
+    printf("            pkt_buffer sparse store: %llu cell + %llu free-list pages, %.1f KiB "
+           "(%llu writes, %llu reads)\n",
+           (unsigned long long)pb.cell_pages, (unsigned long long)pb.fl_pages, pb.bytes / 1024.0,
+           (unsigned long long)pb.writes, (unsigned long long)pb.reads);
+#endif
+    printf("\n");
+
+    printf("BENCH threads=%d idle_cps=%.0f traffic_cps=%.0f pkts_per_s=%.1f "
+           "routes_per_s=%.0f pkts=%d/%d maxrss_kb=%ld\n",
+           COSIM_THREADS, idle_cps, traf_cps, pps, n_routes / prog_s,
+           delivered, n_pkts, ru.ru_maxrss);
+    return (delivered == n_pkts) ? 0 : 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test registry and parallel runner
+//
+// Every CS-RTL case runs in its own forked process with its own
+// Vrv_p4_top, so cases cannot leak model or firmware state into each
+// other and a crash/hang only fails that case.  Up to --jobs children run
+// at once (default: host cores / COSIM_THREADS); each child's output is
+// captured and printed as one block when it exits, followed by a
+// pass/fail + wall-time summary.
+//
+//   --list                 print case names and exit
+//   --filter PAT[,PAT...]  fnmatch(3) patterns on the case name
+//   --shard I/N            run only cases with hash(name) % N == I (stable
+//                          when cases are added, for CI fan-out)
+//   --jobs N / -j N        parallel children (1 = one at a time)
+//   --timeout SEC          per-case wall limit (default 600)
+//   --no-fork              run selected cases in-process, sequentially
+//                          (single model, for gdb)
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct rtl_test_t {
+    const char *name;
+    void      (*fn)();
+};
+
+static const rtl_test_t RTL_TESTS[] = {
+    { "route_forward",     test_rtl_route_forward     },   // CS-RTL-1
+    { "fdb_forward",       test_rtl_fdb_forward       },   // CS-RTL-2
+    { "acl_deny",          test_rtl_acl_deny          },   // CS-RTL-3
+    { "route_delete",      test_rtl_route_delete      },   // CS-RTL-4
+    { "fdb_two_entries",   test_rtl_fdb_two_entries   },   // CS-RTL-5
+    { "acl_dport",         test_rtl_acl_dport         },   // CS-RTL-6
+    { "route_acl_coexist", test_rtl_route_acl_coexist },   // CS-RTL-7
+    { "ecmp",              test_rtl_ecmp              },   // CS-RTL-8
+};
+#define RTL_NUM_TESTS  ((int)(sizeof(RTL_TESTS) / sizeof(RTL_TESTS[0])))
+
+struct runner_cfg_t {
+    const char *filter    = nullptr;
+    int         shard_i   = 0;
+    int         shard_n   = 1;
+    int         jobs      = 0;          // 0 → auto
+    int         timeout_s = 600;
+    bool        fork      = true;
+    bool        list      = false;
+};
+
+static uint32_t name_hash(const char *s) {
+    return fnv1a(FNV1A_INIT, s, strlen(s));
+}
+
+static bool runner_selected(const runner_cfg_t &rc, const char *name) {
+    if (name_hash(name) % (uint32_t)rc.shard_n != (uint32_t)rc.shard_i) return false;
+    if (!rc.filter) return true;
+    char pat[256];
+    const char *p = rc.filter;
+    while (*p) {
+        size_t n = strcspn(p, ",");
+        if (n > 0 && n < sizeof(pat)) {
+            memcpy(pat, p, n);
+            pat[n] = 0;
+            if (fnmatch(pat, name, 0) == 0) return true;
+        }
+        p += n;
+        if (*p == ',') p++;
+    }
+    return false;
+}
+
+static void model_create() {
+    g_top = new Vrv_p4_top;
     // Initialize clocks (start at 0)
     g_top->clk_dp   = 0;
     g_top->clk_ctrl = 0;
@@ -954,28 +2727,304 @@ int main(int argc, char **argv) {
     g_top->clk_cpu  = 0;
     g_top->rst_n    = 0;
     g_top->eval();
+    sched_init();
+}
+
+static void model_destroy() {
+    g_top->final();
+    delete g_top;
+    g_top = nullptr;
+}
+
+struct runner_job_t {
+    int         test;
+    pid_t       pid     = -1;
+    int         fd      = -1;
+    std::string out;
+    std::chrono::steady_clock::time_point t0;
+    double      wall_s  = 0;
+    int         status  = 0;          // 0 pass, 1 fail, 2 crash, 3 timeout
+};
+
+static const char *const RUNNER_STATUS[] = { "PASS", "FAIL", "CRASH", "TIMEOUT" };
+
+static bool runner_spawn(runner_job_t &j) {
+    int pfd[2];
+    if (pipe(pfd) != 0) return false;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) { close(pfd[0]); close(pfd[1]); return false; }
+    if (pid == 0) {
+        close(pfd[0]);
+        dup2(pfd[1], STDOUT_FILENO);
+        dup2(pfd[1], STDERR_FILENO);
+        close(pfd[1]);
+        model_create();
+        RTL_TESTS[j.test].fn();
+        model_destroy();
+#ifdef COSIM_SAVABLE
+        printf("  (warm start: %s)\n", g_snap_hits ? "restored" : g_snap_saves ? "saved" : "cold");
+#endif
+        fflush(stdout);
+        _exit((g_fail == 0 && g_pass > 0) ? 0 : 1);
+    }
+    close(pfd[1]);
+    j.pid = pid;
+    j.fd  = pfd[0];
+    j.t0  = std::chrono::steady_clock::now();
+    return true;
+}
 
-    printf("[ SUITE ] RTL Data-Plane Co-Simulation (7 cases)\n\n");
+// Returns the number of failed cases
+static int run_tests(const runner_cfg_t &rc) {
+    std::vector<int> sel;
+    for (int t = 0; t < RTL_NUM_TESTS; t++)
+        if (runner_selected(rc, RTL_TESTS[t].name)) sel.push_back(t);
 
-    test_rtl_route_forward();
-    test_rtl_fdb_forward();
-    test_rtl_acl_deny();
-    test_rtl_route_delete();
-    test_rtl_fdb_two_entries();
-    test_rtl_acl_dport();
-    test_rtl_route_acl_coexist();
+    if (rc.list) {
+        for (int t : sel) printf("%s\n", RTL_TESTS[t].name);
+        return 0;
+    }
 
-    // Summary
-    int total = g_pass + g_fail;
+    int jobs = rc.jobs;
+    if (jobs <= 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (int)(ncpu > 0 ? ncpu : 1) / COSIM_THREADS;
+        if (jobs < 1) jobs = 1;
+    }
+    if (!rc.fork) jobs = 1;
+
+    printf("[ SUITE ] RTL Data-Plane Co-Simulation (%zu of %d cases", sel.size(), RTL_NUM_TESTS);
+    if (rc.shard_n > 1) printf(", shard %d/%d", rc.shard_i, rc.shard_n);
+    printf(rc.fork ? ", %d job%s)\n\n" : ", in-process)\n\n", jobs, jobs == 1 ? "" : "s");
+
+    auto w0 = std::chrono::steady_clock::now();
+    std::vector<runner_job_t> done;
+
+    if (!rc.fork) {
+        model_create();
+        for (int t : sel) {
+            runner_job_t j;
+            j.test = t;
+            int f0 = g_fail, p0 = g_pass;
+            auto t0 = std::chrono::steady_clock::now();
+            RTL_TESTS[t].fn();
+            j.wall_s = wall_since(t0);
+            j.status = (g_fail == f0 && g_pass > p0) ? 0 : 1;
+            done.push_back(j);
+        }
+        model_destroy();
+    } else {
+        std::vector<runner_job_t> running;
+        size_t next = 0;
+        while (next < sel.size() || !running.empty()) {
+            while (next < sel.size() && (int)running.size() < jobs) {
+                runner_job_t j;
+                j.test = sel[next++];
+                if (!runner_spawn(j)) {
+                    printf("  fork failed for %s\n", RTL_TESTS[j.test].name);
+                    j.status = 2;
+                    done.push_back(j);
+                    continue;
+                }
+                running.push_back(j);
+            }
+            if (running.empty()) break;
+
+            std::vector<struct pollfd> pfds(running.size());
+            for (size_t k = 0; k < running.size(); k++) {
+                pfds[k].fd     = running[k].fd;
+                pfds[k].events = POLLIN;
+            }
+            poll(pfds.data(), pfds.size(), 100);
+
+            for (size_t k = 0; k < running.size(); ) {
+                runner_job_t &j = running[k];
+                bool eof = false;
+                if (pfds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    char buf[4096];
+                    ssize_t n = read(j.fd, buf, sizeof(buf));
+                    if (n > 0) j.out.append(buf, (size_t)n);
+                    else       eof = true;
+                }
+                j.wall_s = wall_since(j.t0);
+                if (!eof && j.wall_s > rc.timeout_s) {
+                    kill(j.pid, SIGKILL);
+                    j.status = 3;
+                    eof = true;
+                }
+                if (!eof) { k++; continue; }
+
+                int ws = 0;
+                waitpid(j.pid, &ws, 0);
+                close(j.fd);
+                if (j.status != 3)
+                    j.status = WIFEXITED(ws) ? (WEXITSTATUS(ws) == 0 ? 0 : 1) : 2;
+                fputs(j.out.c_str(), stdout);
+                if (j.status >= 2)
+                    printf("  [%-5s] %s (%s)\n", RUNNER_STATUS[j.status], RTL_TESTS[j.test].name,
+                           WIFSIGNALED(ws) ? strsignal(WTERMSIG(ws)) : "no result");
+                fflush(stdout);
+                done.push_back(j);
+                pfds.erase(pfds.begin() + (long)k);
+                running.erase(running.begin() + (long)k);
+            }
+        }
+    }
+    double wall_s = wall_since(w0);
+
+    // ── summary ──
+    std::sort(done.begin(), done.end(),
+              [](const runner_job_t &a, const runner_job_t &b) { return a.test < b.test; });
+    int pass = 0;
+    double sum_s = 0;
+    printf("\n  %-24s %-7s %9s\n", "case", "result", "wall (s)");
+    for (const runner_job_t &j : done) {
+        printf("  %-24s %-7s %9.2f\n", RTL_TESTS[j.test].name, RUNNER_STATUS[j.status], j.wall_s);
+        pass  += (j.status == 0);
+        sum_s += j.wall_s;
+    }
+    int total = (int)done.size();
     printf("\n========================\n");
-    printf("Results: %d/%d passed", g_pass, total);
-    if (g_fail == 0)
+    printf("Results: %d/%d passed", pass, total);
+    if (pass == total)
         printf("  ALL PASS\n");
     else
-        printf("  %d FAILED\n", g_fail);
+        printf("  %d FAILED\n", total - pass);
+    printf("Wall: %.2f s (sum of cases %.2f s, %.1fx)\n", wall_s, sum_s,
+           wall_s > 0 ? sum_s / wall_s : 0.0);
     printf("========================\n");
+    return total - pass;
+}
 
-    g_top->final();
-    delete g_top;
-    return (g_fail == 0) ? 0 : 1;
+// ─────────────────────────────────────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────────────────────────────────────
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+
+    int bench_pkts = 0;
+    replay_cfg_t rcfg;
+    lockstep_cfg_t lcfg;
+    runner_cfg_t   tcfg;
+    for (int p = 0; p < 32; p++) rcfg.rate_gbps[p] = 100.0;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(a, "--pcap-in") == 0 && v) {
+            rcfg.pcap_in = v; i++;
+        } else if (strcmp(a, "--pcap-out") == 0 && v) {
+            rcfg.pcap_out_dir = v; i++;
+        } else if (strcmp(a, "--rx-ports") == 0 && v) {
+            rcfg.rx_port_mask = (uint32_t)strtoul(v, nullptr, 0); i++;
+        } else if (strcmp(a, "--snap-dir") == 0 && v) {
+            g_snap_dir = v; i++;
+        } else if (strcmp(a, "--no-snap") == 0) {
+            g_snap_enable = false;
+        } else if (strcmp(a, "--no-tag") == 0) {
+            rcfg.tag = false;
+        } else if (strcmp(a, "--latency-csv") == 0 && v) {
+            rcfg.latency_csv = v; i++;
+        } else if (strcmp(a, "--ifg") == 0 && v) {
+            rcfg.ifg_bytes = atoi(v); i++;
+        } else if (strcmp(a, "--rate") == 0 && v) {
+            for (int p = 0; p < 32; p++) rcfg.rate_gbps[p] = atof(v);
+            i++;
+        } else if (strcmp(a, "--port-rate") == 0 && v) {
+            int p; double g;
+            if (sscanf(v, "%d=%lf", &p, &g) == 2 && p >= 0 && p < 32 && g > 0)
+                rcfg.rate_gbps[p] = g;
+            i++;
+        } else if (strcmp(a, "--route") == 0 && v) {
+            unsigned a0, a1, a2, a3, len, port;
+            if (rcfg.n_routes < 16 &&
+                sscanf(v, "%u.%u.%u.%u/%u=%u", &a0, &a1, &a2, &a3, &len, &port) == 6) {
+                rcfg.route_pfx[rcfg.n_routes]  = (a0 << 24) | (a1 << 16) | (a2 << 8) | a3;
+                rcfg.route_len[rcfg.n_routes]  = (uint8_t)len;
+                rcfg.route_port[rcfg.n_routes] = (uint8_t)port;
+                rcfg.n_routes++;
+            }
+            i++;
+        } else if (strcmp(a, "--lockstep") == 0 && v) {
+            lcfg.mode = strcmp(v, "route") == 0 ? LS_ROUTE :
+                        strcmp(v, "acl")   == 0 ? LS_ACL   :
+                        strcmp(v, "fdb")   == 0 ? LS_FDB   :
+                        strcmp(v, "parser") == 0 ? LS_PARSER : -2;
+            i++;
+        } else if (strcmp(a, "--lockstep-pkts") == 0 && v) {
+            lcfg.pkts = atoi(v); i++;
+        } else if (strcmp(a, "--lockstep-rules") == 0 && v) {
+            lcfg.rules = atoi(v); i++;
+        } else if (strcmp(a, "--seed") == 0 && v) {
+            lcfg.seed = strtoull(v, nullptr, 0); i++;
+        } else if (strcmp(a, "--strict-rewrite") == 0) {
+            lcfg.strict = true;
+        } else if (strcmp(a, "--list") == 0) {
+            tcfg.list = true;
+        } else if (strcmp(a, "--filter") == 0 && v) {
+            tcfg.filter = v; i++;
+        } else if (strcmp(a, "--shard") == 0 && v) {
+            if (sscanf(v, "%d/%d", &tcfg.shard_i, &tcfg.shard_n) != 2 ||
+                tcfg.shard_n < 1 || tcfg.shard_i < 0 || tcfg.shard_i >= tcfg.shard_n) {
+                printf("--shard: expected I/N with 0 <= I < N\n");
+                return 2;
+            }
+            i++;
+        } else if ((strcmp(a, "--jobs") == 0 || strcmp(a, "-j") == 0) && v) {
+            tcfg.jobs = atoi(v); i++;
+        } else if (strcmp(a, "--timeout") == 0 && v) {
+            tcfg.timeout_s = atoi(v); i++;
+        } else if (strcmp(a, "--no-fork") == 0) {
+            tcfg.fork = false;
+        } else if (strcmp(a, "--bench") == 0) {
+            bench_pkts = 1000;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                bench_pkts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-ff") == 0) {
+            g_ff_enable = false;
+        }
+    }
+
+    if (tcfg.list) return run_tests(tcfg);
+
+    printf("RV-P4 RTL Co-Simulation\n");
+    printf("========================\n");
+    printf("Data plane : Verilator RTL (rv_p4_top)\n");
+    printf("Control plane : C firmware (route_add, fdb_add_static, acl_add_deny)\n");
+    printf("Bridge : TUE APB via tb_tue_* backdoor ports\n");
+    printf("========================\n\n");
+
+    if (lcfg.mode == -2) {
+        printf("--lockstep: expected route, acl, fdb or parser\n");
+        return 2;
+    }
+
+    // Single-model modes: one Verilator model in this process
+    if (lcfg.mode >= 0 || rcfg.pcap_in || bench_pkts > 0) {
+        model_create();
+        int rc;
+        if (lcfg.mode == LS_PARSER) {
+            rc = run_parser_lockstep(lcfg);
+        } else if (lcfg.mode >= 0) {
+            if (rcfg.rx_port_mask == 0xFFFFFFFFU) rcfg.rx_port_mask = 0xF;
+            rc = run_lockstep(lcfg, rcfg);
+        } else if (rcfg.pcap_in) {
+            rc = run_replay(rcfg);
+        } else {
+            rc = run_bench(bench_pkts);
+        }
+        model_destroy();
+        return rc;
+    }
+
+    // Test suite: one forked model per case (see run_tests())
+    int failed = run_tests(tcfg);
+
+#ifdef COSIM_SAVABLE
+    if (!tcfg.fork)     // forked cases report their own warm-start use
+        printf("\nSnapshots: %llu restored, %llu saved (%s/)\n",
+               (unsigned long long)g_snap_hits, (unsigned long long)g_snap_saves, g_snap_dir);
+#endif
+    return failed == 0 ? 0 : 1;
 }
@@ -0,0 +1,260 @@
+// mau_tcam_dpi.cpp
+// Indexed TCAM lookup model for mau_tcam.sv (see mau_tcam_dpi.h)
+//
+// The RTL compares the key against all 2048 × 512b entries and priority-
+// encodes the lowest matching index, which Verilator evaluates in full for
+// each of the 24 stages.  Here entries are grouped by their care mask
+// (tuple-space search): within a group, an entry matches iff
+// (key & care) == (t_key & care), so each group is a hash table keyed by
+// the masked entry key, holding the entry indices in ascending order.
+// A lookup is one hash probe per group; groups are kept sorted by their
+// lowest index, so the scan stops at the first group that cannot beat the
+// best hit so far.  Firmware tables use a handful of masks (one per prefix
+// length at most), so a lookup costs a few probes instead of 2048 compares.
+//
+// Bit-exact with the RTL:
+//   match(i) = valid[i] && ((key ^ t_key[i]) & ~t_mask[i]) == 0
+//   hit      = lowest matching i;  action fields of entry i, else 0
+// (t_mask bit = 1 → don't care, RTL convention.)
+
+#include "mau_tcam_dpi.h"
+#include "svdpi.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+
+#define MT_MAX_WORDS    16      // MAU_TCAM_KEY_W ≤ 512
+
+struct mt_key_t {
+    uint32_t w[MT_MAX_WORDS];
+    bool operator==(const mt_key_t &o) const { return memcmp(w, o.w, sizeof(w)) == 0; }
+};
+
+// Hashes only the words the group cares about (firmware keys occupy the
+// first few bytes of PHV, so typically 1-3 of the 16 words)
+struct mt_key_hash_t {
+    const std::vector<int> *cw = nullptr;
+    size_t operator()(const mt_key_t &k) const {
+        uint64_t h = 1469598103934665603ULL;            // FNV-1a over care words
+        for (int i : *cw) { h ^= k.w[i]; h *= 1099511628211ULL; }
+        return (size_t)(h ^ (h >> 32));
+    }
+};
+
+struct mt_group_t {
+    mt_key_t          care;                              // ~t_mask
+    std::vector<int>  cw;                                // words with care bits
+    std::unordered_map<mt_key_t, std::set<uint16_t>, mt_key_hash_t> buckets;
+    std::set<uint16_t> members;                          // all indices in the group
+    int               lo = 0;                            // lowest member
+
+    explicit mt_group_t(const mt_key_t &c)
+        : care(c), buckets(16, mt_key_hash_t{ &cw }) {
+        for (int i = 0; i < MT_MAX_WORDS; i++)
+            if (c.w[i]) cw.push_back(i);
+    }
+};
+
+struct mt_entry_t {
+    mt_key_t    key;                                     // t_key & care
+    uint16_t    action_id  = 0;
+    uint16_t    action_ptr = 0;
+    mt_group_t *group      = nullptr;                    // nullptr = invalid
+};
+
+struct mt_tcam_t {
+    int                       depth = 0;
+    int                       words = 0;
+    uint32_t                  top_mask = 0xFFFFFFFFU;   // valid bits of the last word
+    std::vector<mt_entry_t>   e;
+    std::vector<mt_group_t *> groups;                   // sorted by lowest member
+    uint64_t                  lookups = 0, probes = 0, writes = 0;
+};
+
+static std::vector<mt_tcam_t *> g_mt;
+
+static inline mt_tcam_t *mt_get(int h) {
+    return (h >= 0 && h < (int)g_mt.size()) ? g_mt[h] : nullptr;
+}
+
+static void mt_load(const mt_tcam_t *t, mt_key_t &k, const svBitVecVal *v) {
+    memset(&k, 0, sizeof(k));
+    memcpy(k.w, v, (size_t)t->words * sizeof(uint32_t));
+    k.w[t->words - 1] &= t->top_mask;
+}
+
+static void mt_sort_groups(mt_tcam_t *t) {
+    for (mt_group_t *g : t->groups) g->lo = *g->members.begin();
+    std::sort(t->groups.begin(), t->groups.end(),
+              [](const mt_group_t *a, const mt_group_t *b) { return a->lo < b->lo; });
+}
+
+static void mt_remove(mt_tcam_t *t, int addr) {
+    mt_entry_t &en = t->e[addr];
+    mt_group_t *g  = en.group;
+    if (!g) return;
+    auto it = g->buckets.find(en.key);
+    it->second.erase((uint16_t)addr);
+    if (it->second.empty()) g->buckets.erase(it);
+    g->members.erase((uint16_t)addr);
+    en.group = nullptr;
+    if (g->members.empty()) {
+        t->groups.erase(std::find(t->groups.begin(), t->groups.end(), g));
+        delete g;
+    }
+}
+
+static void mt_insert(mt_tcam_t *t, int addr, const mt_key_t &key, const mt_key_t &care,
+                      uint16_t action_id, uint16_t action_ptr) {
+    mt_group_t *g = nullptr;
+    for (mt_group_t *c : t->groups)
+        if (c->care == care) { g = c; break; }
+    if (!g) {
+        g = new mt_group_t(care);
+        t->groups.push_back(g);
+    }
+    mt_entry_t &en = t->e[addr];
+    for (int i = 0; i < MT_MAX_WORDS; i++) en.key.w[i] = key.w[i] & care.w[i];
+    en.action_id  = action_id;
+    en.action_ptr = action_ptr;
+    en.group      = g;
+    g->buckets[en.key].insert((uint16_t)addr);
+    g->members.insert((uint16_t)addr);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// DPI imports (see the MAU_TCAM_DPI block in rtl/mau/mau_tcam.sv)
+// ─────────────────────────────────────────────────────────────────────────────
+
+extern "C" int mau_tcam_new(int depth, int key_w) {
+    mt_tcam_t *t = new mt_tcam_t();
+    t->depth = depth;
+    t->words = (key_w + 31) / 32;
+    if (t->words > MT_MAX_WORDS) t->words = MT_MAX_WORDS;
+    if (key_w % 32) t->top_mask = (1U << (key_w % 32)) - 1;
+    t->e.resize(depth);
+    g_mt.push_back(t);
+    return (int)g_mt.size() - 1;
+}
+
+extern "C" void mau_tcam_write(int h, int addr, const svBitVecVal *key, const svBitVecVal *mask,
+                               int act_id, int act_ptr, svBit valid) {
+    mt_tcam_t *t = mt_get(h);
+    if (!t || addr < 0 || addr >= t->depth) return;
+    t->writes++;
+    mt_remove(t, addr);
+    if (valid) {
+        mt_key_t k, m, care;
+        mt_load(t, k, key);
+        mt_load(t, m, mask);
+        memset(&care, 0, sizeof(care));
+        for (int i = 0; i < t->words; i++) care.w[i] = ~m.w[i];
+        care.w[t->words - 1] &= t->top_mask;
+        mt_insert(t, addr, k, care, (uint16_t)act_id, (uint16_t)act_ptr);
+    }
+    mt_sort_groups(t);
+}
+
+extern "C" int mau_tcam_lookup(int h, const svBitVecVal *key, int *act_id, int *act_ptr) {
+    mt_tcam_t *t = mt_get(h);
+    *act_id  = 0;
+    *act_ptr = 0;
+    if (!t) return -1;
+    t->lookups++;
+
+    mt_key_t k, mk;
+    mt_load(t, k, key);
+    int best = -1;
+    for (const mt_group_t *g : t->groups) {
+        if (best >= 0 && g->lo >= best) break;
+        memset(&mk, 0, sizeof(mk));
+        for (int i : g->cw) mk.w[i] = k.w[i] & g->care.w[i];
+        t->probes++;
+        auto it = g->buckets.find(mk);
+        if (it == g->buckets.end()) continue;
+        int idx = *it->second.begin();
+        if (best < 0 || idx < best) best = idx;
+    }
+    if (best >= 0) {
+        *act_id  = t->e[best].action_id;
+        *act_ptr = t->e[best].action_ptr;
+    }
+    return best;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Harness side
+// ─────────────────────────────────────────────────────────────────────────────
+
+mau_tcam_stats_t mau_tcam_stats() {
+    mau_tcam_stats_t st = {};
+    st.instances = (int)g_mt.size();
+    for (const mt_tcam_t *t : g_mt) {
+        st.groups  += (int)t->groups.size();
+        for (const mt_group_t *g : t->groups) st.entries += (int)g->members.size();
+        st.lookups += t->lookups;
+        st.probes  += t->probes;
+        st.writes  += t->writes;
+    }
+    return st;
+}
+
+// Image: u32 n_inst, then per instance u32 n_valid and n_valid records of
+//        { u32 addr, u16 action_id, u16 action_ptr, key[16], care[16] }
+template <typename T> static void put(std::vector<uint8_t> &o, const T &v) {
+    const uint8_t *p = (const uint8_t *)&v;
+    o.insert(o.end(), p, p + sizeof(T));
+}
+
+void mau_tcam_save(std::vector<uint8_t> &out) {
+    put(out, (uint32_t)g_mt.size());
+    for (const mt_tcam_t *t : g_mt) {
+        uint32_t n = 0;
+        for (const mt_group_t *g : t->groups) n += (uint32_t)g->members.size();
+        put(out, n);
+        for (int a = 0; a < t->depth; a++) {
+            const mt_entry_t &en = t->e[a];
+            if (!en.group) continue;
+            put(out, (uint32_t)a);
+            put(out, en.action_id);
+            put(out, en.action_ptr);
+            put(out, en.key);
+            put(out, en.group->care);
+        }
+    }
+}
+
+bool mau_tcam_restore(const uint8_t *buf, size_t len) {
+    size_t off = 0;
+    auto get = [&](void *dst, size_t n) {
+        if (off + n > len) return false;
+        memcpy(dst, buf + off, n);
+        off += n;
+        return true;
+    };
+    uint32_t n_inst = 0;
+    if (!get(&n_inst, 4) || n_inst != g_mt.size()) return false;
+
+    struct rec_t { uint32_t addr; uint16_t aid, aptr; mt_key_t key, care; };
+    std::vector<std::vector<rec_t>> img(n_inst);
+    for (uint32_t i = 0; i < n_inst; i++) {
+        uint32_t n = 0;
+        if (!get(&n, 4)) return false;
+        img[i].resize(n);
+        for (rec_t &r : img[i]) {
+            if (!get(&r.addr, 4) || !get(&r.aid, 2) || !get(&r.aptr, 2) ||
+                !get(&r.key, sizeof(r.key)) || !get(&r.care, sizeof(r.care)) ||
+                r.addr >= (uint32_t)g_mt[i]->depth)
+                return false;
+        }
+    }
+    for (uint32_t i = 0; i < n_inst; i++) {
+        mt_tcam_t *t = g_mt[i];
+        for (int a = 0; a < t->depth; a++) mt_remove(t, a);
+        for (const rec_t &r : img[i]) mt_insert(t, (int)r.addr, r.key, r.care, r.aid, r.aptr);
+        mt_sort_groups(t);
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+// mau_tcam_dpi.h
+// Indexed TCAM lookup model behind mau_tcam.sv (MAU_TCAM_DPI, Verilator default)
+//
+// The DPI entry points are declared by Verilator in Vrv_p4_top__Dpi.h; this
+// header exposes the harness side: statistics and snapshot serialization
+// (the C-side tables are not part of a Verilator --savable image).
+
+#ifndef MAU_TCAM_DPI_H
+#define MAU_TCAM_DPI_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct mau_tcam_stats_t {
+    int      instances;     // mau_tcam instances (one per MAU stage)
+    int      entries;       // valid entries, all instances
+    int      groups;        // mask groups, all instances
+    uint64_t lookups;
+    uint64_t probes;        // hash probes (≤ groups per lookup)
+    uint64_t writes;
+};
+
+mau_tcam_stats_t mau_tcam_stats();
+
+// Append every instance's valid entries to `out`
+void mau_tcam_save(std::vector<uint8_t> &out);
+
+// Replace every instance's contents from a mau_tcam_save() image.
+// Returns false (tables unchanged) on a malformed image.
+bool mau_tcam_restore(const uint8_t *buf, size_t len);
+
+#endif // MAU_TCAM_DPI_H
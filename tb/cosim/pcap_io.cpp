@@ -0,0 +1,121 @@
+// pcap_io.cpp
+// Minimal libpcap file reader / writer (see pcap_io.h)
+
+#include "pcap_io.h"
+
+#include <cstring>
+
+#define PCAP_MAGIC_US       0xA1B2C3D4U
+#define PCAP_MAGIC_NS       0xA1B23C4DU
+#define PCAP_LINKTYPE_ETH   1U
+#define PCAP_SNAPLEN        65535U
+
+struct pcap_file_hdr_t {
+    uint32_t magic;
+    uint16_t ver_major;
+    uint16_t ver_minor;
+    int32_t  thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct pcap_rec_hdr_t {
+    uint32_t ts_sec;
+    uint32_t ts_frac;   // µs or ns depending on magic
+    uint32_t caplen;
+    uint32_t origlen;
+};
+
+static uint32_t bswap32(uint32_t v) {
+    return (v >> 24) | ((v >> 8) & 0xFF00U) | ((v << 8) & 0xFF0000U) | (v << 24);
+}
+
+int pcap_read(const char *path, std::vector<pcap_frame_t> &out) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "pcap: cannot open %s\n", path);
+        return -1;
+    }
+
+    pcap_file_hdr_t fh;
+    if (fread(&fh, sizeof(fh), 1, fp) != 1) {
+        fprintf(stderr, "pcap: %s: short file header\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    bool swap = false, nsec = false;
+    switch (fh.magic) {
+    case PCAP_MAGIC_US:          break;
+    case PCAP_MAGIC_NS:          nsec = true; break;
+    default:
+        if (bswap32(fh.magic) == PCAP_MAGIC_US)      swap = true;
+        else if (bswap32(fh.magic) == PCAP_MAGIC_NS) swap = nsec = true;
+        else {
+            fprintf(stderr, "pcap: %s: bad magic 0x%08X (pcapng not supported)\n",
+                    path, fh.magic);
+            fclose(fp);
+            return -1;
+        }
+    }
+    uint32_t linktype = swap ? bswap32(fh.linktype) : fh.linktype;
+    if ((linktype & 0xFFFFU) != PCAP_LINKTYPE_ETH) {
+        fprintf(stderr, "pcap: %s: linktype %u is not Ethernet\n", path, linktype);
+        fclose(fp);
+        return -1;
+    }
+
+    int n = 0;
+    pcap_rec_hdr_t rh;
+    while (fread(&rh, sizeof(rh), 1, fp) == 1) {
+        if (swap) {
+            rh.ts_sec  = bswap32(rh.ts_sec);
+            rh.ts_frac = bswap32(rh.ts_frac);
+            rh.caplen  = bswap32(rh.caplen);
+        }
+        if (rh.caplen > PCAP_SNAPLEN) {
+            fprintf(stderr, "pcap: %s: record %d caplen %u too large\n", path, n, rh.caplen);
+            break;
+        }
+        pcap_frame_t f;
+        f.ts_ns = (uint64_t)rh.ts_sec * 1000000000ULL +
+                  (nsec ? rh.ts_frac : (uint64_t)rh.ts_frac * 1000ULL);
+        f.data.resize(rh.caplen);
+        if (rh.caplen && fread(f.data.data(), 1, rh.caplen, fp) != rh.caplen) {
+            fprintf(stderr, "pcap: %s: truncated record %d\n", path, n);
+            break;
+        }
+        out.push_back(std::move(f));
+        n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+int pcap_writer_open(pcap_writer_t *w, const char *path) {
+    w->fp = fopen(path, "wb");
+    w->frames = w->bytes = 0;
+    if (!w->fp) {
+        fprintf(stderr, "pcap: cannot create %s\n", path);
+        return -1;
+    }
+    pcap_file_hdr_t fh = { PCAP_MAGIC_NS, 2, 4, 0, 0, PCAP_SNAPLEN, PCAP_LINKTYPE_ETH };
+    fwrite(&fh, sizeof(fh), 1, w->fp);
+    return 0;
+}
+
+void pcap_writer_put(pcap_writer_t *w, uint64_t ts_ns, const uint8_t *data, uint32_t len) {
+    if (!w->fp) return;
+    pcap_rec_hdr_t rh = { (uint32_t)(ts_ns / 1000000000ULL),
+                          (uint32_t)(ts_ns % 1000000000ULL), len, len };
+    fwrite(&rh, sizeof(rh), 1, w->fp);
+    fwrite(data, 1, len, w->fp);
+    w->frames++;
+    w->bytes += len;
+}
+
+void pcap_writer_close(pcap_writer_t *w) {
+    if (w->fp) fclose(w->fp);
+    w->fp = nullptr;
+}
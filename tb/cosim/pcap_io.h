@@ -0,0 +1,35 @@
+// pcap_io.h
+// Minimal libpcap file reader / writer for the cosim traffic driver
+//
+// Classic pcap only (no pcapng).  Reader accepts both byte orders and both
+// µs (0xa1b2c3d4) and ns (0xa1b23c4d) timestamp magics; the writer always
+// emits native-endian nanosecond pcap with LINKTYPE_ETHERNET, timestamped
+// with simulated time.
+
+#ifndef PCAP_IO_H
+#define PCAP_IO_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+struct pcap_frame_t {
+    uint64_t             ts_ns;     // capture timestamp (ns since epoch/sim start)
+    std::vector<uint8_t> data;      // captured bytes (caplen)
+};
+
+// Read every frame of `path` into `out`.  Returns number of frames, or -1 on
+// open / format error (message printed to stderr).
+int pcap_read(const char *path, std::vector<pcap_frame_t> &out);
+
+struct pcap_writer_t {
+    FILE    *fp     = nullptr;
+    uint64_t frames = 0;
+    uint64_t bytes  = 0;
+};
+
+int  pcap_writer_open(pcap_writer_t *w, const char *path);
+void pcap_writer_put(pcap_writer_t *w, uint64_t ts_ns, const uint8_t *data, uint32_t len);
+void pcap_writer_close(pcap_writer_t *w);
+
+#endif // PCAP_IO_H
@@ -0,0 +1,130 @@
+// pkt_buffer_dpi.cpp
+// Paged, lazily allocated cell store for pkt_buffer.sv (+define+PB_SPARSE_DPI)
+//
+// The RTL model of the 64 MiB buffer declares cell_data[1M] × 512b,
+// cell_next[1M], cell_eof[1M] and free_list[1M] and fills free_list in an
+// initial loop — ~70 MB per Verilated instance and a 1M-iteration startup.
+// Here each array is a two-level page table with PB_PAGE_CELLS cells per
+// page; a page is allocated on first write, reads of untouched pages
+// return the array's reset content without allocating:
+//   cell_data / cell_next / cell_eof : 0
+//   free_list[pos]                   : pos  (the RTL initial block)
+// A traffic run touches a few pages only, so an instance costs a few
+// hundred KiB and starts instantly.
+//
+// Handles are small integers (not chandles) so that they survive a
+// Verilator --savable snapshot restore in a fresh process.  The store
+// itself is not part of the snapshot; warm_start() snapshots are taken
+// before any traffic, when it is still empty.
+
+#include "pkt_buffer_dpi.h"
+#include "svdpi.h"
+
+#include <cstring>
+#include <vector>
+
+#define PB_PAGE_SHIFT   10
+#define PB_PAGE_CELLS   (1 << PB_PAGE_SHIFT)
+#define PB_CELL_WORDS   16      // 512b
+
+struct pb_cell_page_t {
+    uint32_t data[PB_PAGE_CELLS][PB_CELL_WORDS];
+    uint32_t next[PB_PAGE_CELLS];
+    uint8_t  eof[PB_PAGE_CELLS];
+};
+
+struct pb_fl_page_t {
+    uint32_t id[PB_PAGE_CELLS];
+};
+
+struct pb_store_t {
+    int                           num_cells = 0;
+    std::vector<pb_cell_page_t *> cell;
+    std::vector<pb_fl_page_t *>   fl;
+    uint64_t                      writes = 0, reads = 0;
+};
+
+static std::vector<pb_store_t *> g_pb_stores;
+
+static inline pb_store_t *pb_get(int h) {
+    return (h >= 0 && h < (int)g_pb_stores.size()) ? g_pb_stores[h] : nullptr;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// DPI imports (see the PB_SPARSE_DPI block in rtl/pkt_buffer/pkt_buffer.sv)
+// ─────────────────────────────────────────────────────────────────────────────
+
+extern "C" int pb_sparse_new(int num_cells) {
+    pb_store_t *s = new pb_store_t();
+    int pages = (num_cells + PB_PAGE_CELLS - 1) >> PB_PAGE_SHIFT;
+    s->num_cells = num_cells;
+    s->cell.assign(pages, nullptr);
+    s->fl.assign(pages, nullptr);
+    g_pb_stores.push_back(s);
+    return (int)g_pb_stores.size() - 1;
+}
+
+extern "C" void pb_sparse_wr(int h, int id, const svBitVecVal *data, int next, svBit eof) {
+    pb_store_t *s = pb_get(h);
+    if (!s || id < 0 || id >= s->num_cells) return;
+    pb_cell_page_t *&pg = s->cell[id >> PB_PAGE_SHIFT];
+    if (!pg) pg = new pb_cell_page_t();             // value-initialized: zeros
+    int i = id & (PB_PAGE_CELLS - 1);
+    memcpy(pg->data[i], data, sizeof(pg->data[i]));
+    pg->next[i] = (uint32_t)next;
+    pg->eof[i]  = eof;
+    s->writes++;
+}
+
+extern "C" void pb_sparse_rd(int h, int id, svBitVecVal *data, int *next, svBit *eof) {
+    pb_store_t *s = pb_get(h);
+    const pb_cell_page_t *pg = (s && id >= 0 && id < s->num_cells)
+                             ? s->cell[id >> PB_PAGE_SHIFT] : nullptr;
+    if (s) s->reads++;
+    if (!pg) {
+        memset(data, 0, PB_CELL_WORDS * sizeof(svBitVecVal));
+        *next = 0;
+        *eof  = 0;
+        return;
+    }
+    int i = id & (PB_PAGE_CELLS - 1);
+    memcpy(data, pg->data[i], PB_CELL_WORDS * sizeof(svBitVecVal));
+    *next = (int)pg->next[i];
+    *eof  = pg->eof[i];
+}
+
+extern "C" int pb_fl_get(int h, int pos) {
+    pb_store_t *s = pb_get(h);
+    if (!s || pos < 0 || pos >= s->num_cells) return pos;
+    const pb_fl_page_t *pg = s->fl[pos >> PB_PAGE_SHIFT];
+    return pg ? (int)pg->id[pos & (PB_PAGE_CELLS - 1)] : pos;
+}
+
+extern "C" void pb_fl_set(int h, int pos, int id) {
+    pb_store_t *s = pb_get(h);
+    if (!s || pos < 0 || pos >= s->num_cells) return;
+    pb_fl_page_t *&pg = s->fl[pos >> PB_PAGE_SHIFT];
+    if (!pg) {
+        pg = new pb_fl_page_t;
+        int base = pos & ~(PB_PAGE_CELLS - 1);
+        for (int i = 0; i < PB_PAGE_CELLS; i++) pg->id[i] = (uint32_t)(base + i);
+    }
+    pg->id[pos & (PB_PAGE_CELLS - 1)] = (uint32_t)id;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Harness report
+// ─────────────────────────────────────────────────────────────────────────────
+
+pb_sparse_stats_t pb_sparse_stats() {
+    pb_sparse_stats_t st = {};
+    for (const pb_store_t *s : g_pb_stores) {
+        for (const pb_cell_page_t *pg : s->cell) st.cell_pages += (pg != nullptr);
+        for (const pb_fl_page_t *pg : s->fl)     st.fl_pages   += (pg != nullptr);
+        st.bytes  += (s->cell.size() + s->fl.size()) * sizeof(void *);
+        st.writes += s->writes;
+        st.reads  += s->reads;
+    }
+    st.bytes += st.cell_pages * sizeof(pb_cell_page_t) + st.fl_pages * sizeof(pb_fl_page_t);
+    return st;
+}
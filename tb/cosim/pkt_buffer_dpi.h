@@ -0,0 +1,23 @@
+// pkt_buffer_dpi.h
+// Sparse cell store behind pkt_buffer.sv (+define+PB_SPARSE_DPI)
+//
+// The DPI entry points themselves are declared by Verilator in
+// Vrv_p4_top__Dpi.h; this header only exposes the harness-side report.
+
+#ifndef PKT_BUFFER_DPI_H
+#define PKT_BUFFER_DPI_H
+
+#include <cstdint>
+
+struct pb_sparse_stats_t {
+    uint64_t cell_pages;    // cell data/next/eof pages allocated
+    uint64_t fl_pages;      // free-list pages allocated
+    uint64_t bytes;         // total bytes held by the store
+    uint64_t writes;        // pb_sparse_wr calls
+    uint64_t reads;         // pb_sparse_rd calls
+};
+
+// Totals over every pkt_buffer instance in this process
+pb_sparse_stats_t pb_sparse_stats();
+
+#endif // PKT_BUFFER_DPI_H
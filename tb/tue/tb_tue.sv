@@ -23,7 +23,9 @@ module tb_tue;
     logic [PARSER_TCAM_WIDTH-1:0]  parser_wr_data;
 
     // ── DUT ───────────────────────────────────
-    tue dut (
+    localparam int BQ_DEPTH = 64;            // 批量 FIFO（TC5/TC6）；rv_p4_top 默认 0
+
+    tue #(.BATCH_DEPTH(BQ_DEPTH)) dut (
         .clk_ctrl    (clk_ctrl),
         .rst_ctrl_n  (rst_ctrl_n),
         .clk_dp      (clk_dp),
@@ -35,6 +37,26 @@ module tb_tue;
         .parser_wr_data (parser_wr_data)
     );
 
+    // ── 默认配置 DUT（BATCH_DEPTH = 0，TC7）────
+    apb_if      csr_nb     (.clk(clk_ctrl), .rst_n(rst_ctrl_n));
+    tue_req_if  req_nb     (.clk(clk_ctrl), .rst_n(rst_ctrl_n));
+    mau_cfg_if  mau_cfg_nb [NUM_MAU_STAGES] (.clk(clk_dp), .rst_n(rst_ctrl_n));
+    logic                          nb_parser_wr_en;
+    logic [7:0]                    nb_parser_wr_addr;
+    logic [PARSER_TCAM_WIDTH-1:0]  nb_parser_wr_data;
+
+    tue dut_nb (
+        .clk_ctrl    (clk_ctrl),
+        .rst_ctrl_n  (rst_ctrl_n),
+        .clk_dp      (clk_dp),
+        .csr         (csr_nb.slave),
+        .req         (req_nb.slave),
+        .mau_cfg     (mau_cfg_nb),
+        .parser_wr_en   (nb_parser_wr_en),
+        .parser_wr_addr (nb_parser_wr_addr),
+        .parser_wr_data (nb_parser_wr_data)
+    );
+
     // ── APB 写任务 ────────────────────────────
     task automatic apb_write(input logic [11:0] addr, input logic [31:0] data);
         @(posedge clk_ctrl);
@@ -58,6 +80,28 @@ module tb_tue;
         csr.psel = 0; csr.penable = 0;
     endtask
 
+    // ── dut_nb 的 APB 读写 ─────────────────────
+    task automatic apb_write_nb(input logic [11:0] addr, input logic [31:0] data);
+        @(posedge clk_ctrl);
+        csr_nb.psel    = 1; csr_nb.penable = 0;
+        csr_nb.pwrite  = 1; csr_nb.paddr   = addr; csr_nb.pwdata = data;
+        @(posedge clk_ctrl);
+        csr_nb.penable = 1;
+        @(posedge clk_ctrl);
+        csr_nb.psel = 0; csr_nb.penable = 0;
+    endtask
+
+    task automatic apb_read_nb(input logic [11:0] addr, output logic [31:0] data);
+        @(posedge clk_ctrl);
+        csr_nb.psel    = 1; csr_nb.penable = 0;
+        csr_nb.pwrite  = 0; csr_nb.paddr   = addr;
+        @(posedge clk_ctrl);
+        csr_nb.penable = 1;
+        @(posedge clk_ctrl);
+        data = csr_nb.prdata;
+        csr_nb.psel = 0; csr_nb.penable = 0;
+    endtask
+
     // ── 等待 TUE 完成（先等 busy，再等 done）──
     task automatic wait_done;
         logic [31:0] st;
@@ -107,6 +151,27 @@ module tb_tue;
             apb_write(base + 12'(i*4), val[i*32 +: 32]);
     endtask
 
+    // ── stage 0 TCAM 写入记录（按 apply 脉冲上升沿计数，TC6 用）──
+    int          wr_seen = 0;
+    logic [10:0] wr_log [128];
+    logic        wr_en_q = 1'b0;
+    always @(posedge clk_dp) begin
+        wr_en_q <= mau_cfg[0].tcam_wr_en;
+        if (mau_cfg[0].tcam_wr_en && !wr_en_q) begin
+            if (wr_seen < 128) wr_log[wr_seen] = mau_cfg[0].tcam_wr_addr;
+            wr_seen = wr_seen + 1;
+        end
+    end
+
+    // ── 入队一条 stage 0 INSERT（批量模式）──
+    task automatic batch_push(input int table_id);
+        apb_write(TUE_REG_CMD,       32'd0);
+        apb_write(TUE_REG_STAGE,     32'd0);
+        apb_write(TUE_REG_TABLE_ID,  32'(table_id));
+        apb_write(TUE_REG_ACTION_ID, 32'h1001);
+        apb_write(TUE_REG_COMMIT,    32'h1);
+    endtask
+
     // ── 测试主体 ──────────────────────────────
     logic        ok;
     logic [10:0] tcam_addr;
@@ -120,6 +185,9 @@ module tb_tue;
         csr.psel = 0; csr.penable = 0; csr.pwrite = 0;
         csr.paddr = '0; csr.pwdata = '0;
         req.valid = 0; req.req = '0;
+        csr_nb.psel = 0; csr_nb.penable = 0; csr_nb.pwrite = 0;
+        csr_nb.paddr = '0; csr_nb.pwdata = '0;
+        req_nb.valid = 0; req_nb.req = '0;
 
         #10 rst_ctrl_n = 1;
         repeat(4) @(posedge clk_ctrl);
@@ -193,6 +261,107 @@ module tb_tue;
         end
         $display("PASS TC4: MODIFY stage 3 did not affect stage 0");
 
+        // ── TC5：批量 — 3 条 INSERT 一次排空，按入队顺序写入 ──
+        wait_done;
+        apb_write(TUE_REG_BATCH, 32'h1);
+        for (int i = 0; i < 3; i++) begin
+            apb_write(TUE_REG_CMD,       32'd0);
+            apb_write(TUE_REG_STAGE,     32'd0);
+            apb_write(TUE_REG_TABLE_ID,  32'(20 + i));
+            apb_write(TUE_REG_ACTION_ID, 32'h1001);
+            apb_write(TUE_REG_COMMIT,    32'h1);
+        end
+        apb_read(TUE_REG_BATCH, rdata);
+        if (rdata !== {16'd3, 8'(BQ_DEPTH), 7'b0, 1'b1}) begin
+            $display("FAIL TC5: BATCH=%h, expected 3 queued, depth %0d", rdata, BQ_DEPTH);
+            $finish;
+        end
+        apb_read(TUE_REG_STATUS, rdata);
+        if (rdata[1:0] !== 2'b00) begin
+            $display("FAIL TC5: queued COMMIT should not start a transaction");
+            $finish;
+        end
+        apb_write(TUE_REG_BATCH, 32'h0);
+        for (int i = 0; i < 3; i++) begin
+            fork
+                wait_tcam_wr_s0( 2000, ok, tcam_addr, tcam_aid);
+            join
+            if (!ok || tcam_addr != 11'(20 + i)) begin
+                $display("FAIL TC5: entry %0d ok=%b addr=%0d", i, ok, tcam_addr);
+                $finish;
+            end
+            // 跳过本条 apply 脉冲，等下一条
+            while (mau_cfg[0].tcam_wr_en) @(posedge clk_dp);
+        end
+        $display("PASS TC5: batch of 3 applied in order after one drain");
+
+        // ── TC6：批满（64 条）后关批，排空期间立即重开；重开请求挂起不丢，
+        //         再入队 3 条，共 67 条按序写入（route_add_bulk > 64 条的路径）──
+        wait_done;
+        repeat (40) @(posedge clk_dp);
+        wr_seen = 0;
+        apb_write(TUE_REG_BATCH, 32'h1);
+        for (int i = 0; i < BQ_DEPTH; i++)
+            batch_push(100 + i);
+        apb_write(TUE_REG_BATCH, 32'h0);
+        // 关批写入后第一次读 STATUS 就必须是 busy（不能先读到 idle）
+        apb_read(TUE_REG_STATUS, rdata);
+        if (rdata[1:0] !== 2'b01) begin
+            $display("FAIL TC6: STATUS=%b right after BATCH=0, expected busy", rdata[1:0]);
+            $finish;
+        end
+        apb_write(TUE_REG_BATCH, 32'h1);       // FSM 仍在 WAIT_DRAIN / TS_BATCH
+        wait_done;
+        apb_read(TUE_REG_BATCH, rdata);
+        if (rdata !== {16'd0, 8'(BQ_DEPTH), 7'b0, 1'b1}) begin
+            $display("FAIL TC6: reopen during drain lost, BATCH=%h", rdata);
+            $finish;
+        end
+        for (int i = 0; i < 3; i++)
+            batch_push(100 + BQ_DEPTH + i);
+        apb_write(TUE_REG_BATCH, 32'h0);
+        wait_done;
+        repeat (40) @(posedge clk_dp);
+        if (wr_seen != BQ_DEPTH + 3) begin
+            $display("FAIL TC6: %0d TCAM writes, expected %0d", wr_seen, BQ_DEPTH + 3);
+            $finish;
+        end
+        for (int i = 0; i < BQ_DEPTH + 3; i++)
+            if (wr_log[i] != 11'(100 + i)) begin
+                $display("FAIL TC6: write %0d addr=%0d, expected %0d", i, wr_log[i], 100 + i);
+                $finish;
+            end
+        $display("PASS TC6: 64-entry batch + reopen during drain, 67 entries applied in order");
+
+        // ── TC7：默认配置（BATCH_DEPTH = 0）— 开批被忽略，读回 depth = 0，
+        //         随后的 COMMIT 按单条事务立即排空并写入 ──
+        apb_write_nb(TUE_REG_BATCH, 32'h1);
+        apb_read_nb(TUE_REG_BATCH, rdata);
+        if (rdata !== 32'h0) begin
+            $display("FAIL TC7: BATCH=%h on a TUE without batch FIFO, expected 0", rdata);
+            $finish;
+        end
+        apb_write_nb(TUE_REG_CMD,       32'd0);
+        apb_write_nb(TUE_REG_STAGE,     32'd0);
+        apb_write_nb(TUE_REG_TABLE_ID,  32'd7);
+        apb_write_nb(TUE_REG_ACTION_ID, 32'h1001);
+        apb_write_nb(TUE_REG_COMMIT,    32'h1);
+        apb_read_nb(TUE_REG_STATUS, rdata);
+        if (rdata[1:0] !== 2'b01) begin
+            $display("FAIL TC7: COMMIT after ignored BATCH=1 not busy, STATUS=%b", rdata[1:0]);
+            $finish;
+        end
+        ok = 0;
+        for (int c = 0; c < 2000 && !ok; c++) begin
+            @(posedge clk_dp);
+            if (mau_cfg_nb[0].tcam_wr_en && mau_cfg_nb[0].tcam_wr_addr == 11'd7) ok = 1;
+        end
+        if (!ok) begin
+            $display("FAIL TC7: single COMMIT not applied on BATCH_DEPTH=0 TUE");
+            $finish;
+        end
+        $display("PASS TC7: BATCH_DEPTH=0 ignores BATCH=1, COMMIT applies immediately");
+
         $display("\n=== All TUE tests PASSED ===");
         $finish;
     end